@@ -0,0 +1,87 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPENCENSUS_COMMON_INTERNAL_APPEND_ONLY_TABLE_H_
+#define OPENCENSUS_COMMON_INTERNAL_APPEND_ONLY_TABLE_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "absl/numeric/bits.h"
+
+namespace opencensus {
+namespace common {
+
+// AppendOnlyTable is a growable array of pointers with lock-free reads, for
+// process-lifetime registries. Block b holds kFirstBlockSize << b entries, so
+// entries never move when the table grows. Entries are never removed and the
+// table never deletes them: readers may hold on to them indefinitely.
+//
+// Append() must be externally serialized. operator[] and size() may be called
+// concurrently with Append() and with each other. The constructor is constexpr,
+// so a namespace-scope AppendOnlyTable needs no dynamic initialization.
+template <typename T>
+class AppendOnlyTable {
+ public:
+  constexpr AppendOnlyTable() : blocks_(), size_(0) {}
+
+  // Appends 'value' and returns its index.
+  uint64_t Append(T* value) {
+    const uint64_t index = size_.load(std::memory_order_relaxed);
+    int block;
+    uint64_t offset;
+    Locate(index, &block, &offset);
+    Slot* slots = blocks_[block].load(std::memory_order_relaxed);
+    if (slots == nullptr) {
+      slots = new Slot[kFirstBlockSize << block]();
+      blocks_[block].store(slots, std::memory_order_release);
+    }
+    slots[offset].store(value, std::memory_order_release);
+    size_.store(index + 1, std::memory_order_release);
+    return index;
+  }
+
+  // Returns the entry at 'index', which must be less than size().
+  T* operator[](uint64_t index) const {
+    int block;
+    uint64_t offset;
+    Locate(index, &block, &offset);
+    return blocks_[block]
+        .load(std::memory_order_acquire)[offset]
+        .load(std::memory_order_acquire);
+  }
+
+  uint64_t size() const { return size_.load(std::memory_order_acquire); }
+
+ private:
+  static constexpr int kFirstBlockBits = 4;
+  static constexpr uint64_t kFirstBlockSize = uint64_t{1} << kFirstBlockBits;
+  static constexpr int kNumBlocks = 64 - kFirstBlockBits;
+
+  using Slot = std::atomic<T*>;
+
+  static void Locate(uint64_t index, int* block, uint64_t* offset) {
+    const uint64_t n = index + kFirstBlockSize;
+    *block = static_cast<int>(absl::bit_width(n)) - 1 - kFirstBlockBits;
+    *offset = n - (kFirstBlockSize << *block);
+  }
+
+  std::atomic<Slot*> blocks_[kNumBlocks];
+  std::atomic<uint64_t> size_;
+};
+
+}  // namespace common
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_COMMON_INTERNAL_APPEND_ONLY_TABLE_H_
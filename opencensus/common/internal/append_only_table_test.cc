@@ -0,0 +1,84 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/common/internal/append_only_table.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "absl/base/attributes.h"
+#include "gtest/gtest.h"
+
+namespace opencensus {
+namespace common {
+namespace {
+
+ABSL_CONST_INIT AppendOnlyTable<const int> global_table;
+
+TEST(AppendOnlyTableTest, ConstantInitializedIsEmpty) {
+  EXPECT_EQ(0, global_table.size());
+}
+
+TEST(AppendOnlyTableTest, AppendAndRead) {
+  static AppendOnlyTable<const int> table;
+  std::vector<int> values(1000);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = i * 3;
+    EXPECT_EQ(i, table.Append(&values[i]));
+    EXPECT_EQ(i + 1, table.size());
+  }
+  for (size_t i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(&values[i], table[i]);
+  }
+}
+
+TEST(AppendOnlyTableTest, EntriesDoNotMove) {
+  static AppendOnlyTable<const int> table;
+  const int first = 1;
+  table.Append(&first);
+  const int other = 2;
+  for (int i = 0; i < 10000; ++i) {
+    table.Append(&other);
+    ASSERT_EQ(&first, table[0]);
+  }
+}
+
+TEST(AppendOnlyTableTest, ConcurrentReads) {
+  static AppendOnlyTable<const int> table;
+  std::vector<int> values(20000);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = i;
+  }
+  std::atomic<bool> done(false);
+  std::thread reader([&]() {
+    while (!done.load()) {
+      const uint64_t size = table.size();
+      for (uint64_t i = 0; i < size; ++i) {
+        ASSERT_EQ(i, *table[i]);
+      }
+    }
+  });
+  for (size_t i = 0; i < values.size(); ++i) {
+    table.Append(&values[i]);
+  }
+  done = true;
+  reader.join();
+}
+
+}  // namespace
+}  // namespace common
+}  // namespace opencensus
@@ -0,0 +1,90 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/common/internal/clock.h"
+
+#include <atomic>
+#include <cstdint>
+
+#ifdef __linux__
+#include <time.h>
+#endif
+
+#include "absl/base/internal/cycleclock.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace opencensus {
+namespace common {
+
+namespace {
+
+std::atomic<Clock::Source> clock_source{Clock::Source::kPrecise};
+// The kCached tolerance, in CycleClock cycles.
+std::atomic<int64_t> tolerance_cycles{0};
+
+absl::Time CoarseNow() {
+#ifdef CLOCK_REALTIME_COARSE
+  timespec ts;
+  if (clock_gettime(CLOCK_REALTIME_COARSE, &ts) == 0) {
+    return absl::TimeFromTimespec(ts);
+  }
+#endif
+  return absl::Now();
+}
+
+struct CachedTime {
+  int64_t cycles;
+  absl::Time time;
+};
+
+thread_local CachedTime cached_time = {0, absl::InfinitePast()};
+
+absl::Time CachedNow() {
+  const int64_t cycles = absl::base_internal::CycleClock::Now();
+  const int64_t elapsed = cycles - cached_time.cycles;
+  // The cycle counter may differ between CPUs, so refresh if it went backwards.
+  if (elapsed < 0 ||
+      elapsed > tolerance_cycles.load(std::memory_order_relaxed) ||
+      cached_time.time == absl::InfinitePast()) {
+    cached_time.cycles = cycles;
+    cached_time.time = absl::Now();
+  }
+  return cached_time.time;
+}
+
+}  // namespace
+
+absl::Time Clock::Now() {
+  switch (clock_source.load(std::memory_order_relaxed)) {
+    case Source::kPrecise:
+      return absl::Now();
+    case Source::kCoarse:
+      return CoarseNow();
+    case Source::kCached:
+      return CachedNow();
+  }
+  return absl::Now();
+}
+
+void Clock::SetSource(Source source, absl::Duration tolerance) {
+  tolerance_cycles.store(
+      static_cast<int64_t>(absl::ToDoubleSeconds(tolerance) *
+                           absl::base_internal::CycleClock::Frequency()),
+      std::memory_order_relaxed);
+  clock_source.store(source, std::memory_order_relaxed);
+}
+
+}  // namespace common
+}  // namespace opencensus
@@ -0,0 +1,59 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPENCENSUS_COMMON_INTERNAL_CLOCK_H_
+#define OPENCENSUS_COMMON_INTERNAL_CLOCK_H_
+
+#include "absl/time/time.h"
+
+namespace opencensus {
+namespace common {
+
+// Clock provides the current time for timestamps taken on hot paths, such as
+// span start and end times, span events and stats deltas, from a configurable
+// source. absl::Now() is accurate but can be slow where the kernel has no fast
+// path for reading the time, and a span with many events reads it many times.
+//
+// Clock is thread-safe.
+class Clock final {
+ public:
+  enum class Source {
+    // absl::Now(). The default.
+    kPrecise,
+    // The kernel's coarse real-time clock (CLOCK_REALTIME_COARSE, read through
+    // the vDSO on Linux), which typically advances every 1-4ms. Falls back to
+    // kPrecise on other platforms.
+    kCoarse,
+    // absl::Now(), cached per thread and reused until the CPU cycle counter
+    // shows that the tolerance has passed. Timestamps lag by at most the
+    // tolerance.
+    kCached,
+  };
+
+  // Returns the current time from the configured source.
+  static absl::Time Now();
+
+  // Sets the source for subsequent calls to Now(). 'tolerance' only applies to
+  // kCached.
+  static void SetSource(Source source,
+                        absl::Duration tolerance = absl::Milliseconds(1));
+
+ private:
+  Clock() = delete;
+};
+
+}  // namespace common
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_COMMON_INTERNAL_CLOCK_H_
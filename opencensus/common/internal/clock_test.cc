@@ -0,0 +1,73 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/common/internal/clock.h"
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+namespace opencensus {
+namespace common {
+namespace {
+
+class ClockTest : public ::testing::Test {
+ protected:
+  ~ClockTest() override { Clock::SetSource(Clock::Source::kPrecise); }
+};
+
+// Checks that Clock::Now() is within 'tolerance' of the real time.
+void ExpectCloseToNow(absl::Duration tolerance) {
+  const absl::Time before = absl::Now();
+  const absl::Time now = Clock::Now();
+  const absl::Time after = absl::Now();
+  EXPECT_LE(before - tolerance, now);
+  EXPECT_LE(now, after + tolerance);
+}
+
+TEST_F(ClockTest, Precise) {
+  ExpectCloseToNow(absl::ZeroDuration());
+}
+
+TEST_F(ClockTest, Coarse) {
+  Clock::SetSource(Clock::Source::kCoarse);
+  // The coarse clock resolution is a kernel tick.
+  ExpectCloseToNow(absl::Milliseconds(50));
+}
+
+TEST_F(ClockTest, CachedReusesTimeWithinTolerance) {
+  Clock::SetSource(Clock::Source::kCached, absl::Hours(1));
+  const absl::Time first = Clock::Now();
+  absl::SleepFor(absl::Milliseconds(2));
+  EXPECT_EQ(first, Clock::Now());
+}
+
+TEST_F(ClockTest, CachedRefreshesAfterTolerance) {
+  Clock::SetSource(Clock::Source::kCached, absl::Milliseconds(1));
+  const absl::Time first = Clock::Now();
+  absl::SleepFor(absl::Milliseconds(5));
+  EXPECT_LT(first, Clock::Now());
+  ExpectCloseToNow(absl::Milliseconds(1));
+}
+
+TEST_F(ClockTest, CachedWithZeroToleranceIsPrecise) {
+  Clock::SetSource(Clock::Source::kCached, absl::ZeroDuration());
+  const absl::Time first = Clock::Now();
+  absl::SleepFor(absl::Microseconds(100));
+  EXPECT_LT(first, Clock::Now());
+}
+
+}  // namespace
+}  // namespace common
+}  // namespace opencensus
@@ -0,0 +1,264 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPENCENSUS_COMMON_INTERNAL_GRPC_EXPORT_STREAM_H_
+#define OPENCENSUS_COMMON_INTERNAL_GRPC_EXPORT_STREAM_H_
+
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/support/sync_stream.h>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "opencensus/common/internal/grpc/status.h"
+
+namespace opencensus {
+namespace common {
+
+// ExportStream writes Requests over one long-lived bidirectional-streaming
+// Export RPC, such as those of the OcAgent trace and metrics services. Send()
+// only queues the request; a writer thread writes queued requests back to
+// back, without waiting for the server, and merges 'header' into the first
+// request on each stream. Responses are read and discarded by a reader thread.
+// If the stream breaks it is reopened, with exponential backoff, and the
+// failed request is written again.
+//
+// ExportStream is thread-safe.
+template <typename StubInterface, typename Request, typename Response>
+class ExportStream {
+ public:
+  // 'stub' must outlive the ExportStream. 'name' prefixes log messages.
+  ExportStream(StubInterface* stub, const Request& header,
+               absl::string_view name, absl::Duration initial_backoff,
+               absl::Duration max_backoff, int max_queued_requests);
+  // Writes the queued requests, then closes the stream.
+  ~ExportStream();
+
+  ExportStream(const ExportStream&) = delete;
+  ExportStream& operator=(const ExportStream&) = delete;
+
+  // Queues 'request' to be written. Returns false, dropping it, if
+  // max_queued_requests requests are already waiting.
+  bool Send(Request request) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Blocks until every request queued so far has been written or dropped.
+  void Flush() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // The number of streams opened so far. A change means that the server may
+  // have lost state associated with the previous stream.
+  int num_streams() const {
+    return num_streams_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Stream {
+    grpc::ClientContext context;
+    std::unique_ptr<grpc::ClientReaderWriterInterface<Request, Response>>
+        stream;
+    // Set by the reader when the server has closed the stream.
+    std::atomic<bool> ended{false};
+    std::thread reader;
+  };
+
+  void RunWriter() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Opens a new stream and starts reading it.
+  std::unique_ptr<Stream> OpenStream();
+  // Waits for the server to close 'stream', or cancels it, logging errors.
+  void CloseStream(std::unique_ptr<Stream> stream, bool cancel) const;
+
+  bool HasWork() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return !queue_.empty() || shutdown_;
+  }
+  bool IsIdle() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return queue_.empty() && !writing_;
+  }
+  bool IsShutdown() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return shutdown_;
+  }
+
+  StubInterface* const stub_;
+  const Request header_;
+  const std::string name_;
+  const absl::Duration initial_backoff_;
+  const absl::Duration max_backoff_;
+  const size_t max_queued_requests_;
+  std::atomic<int> num_streams_{0};
+
+  absl::Mutex mu_;
+  std::deque<Request> queue_ ABSL_GUARDED_BY(mu_);
+  // True while the writer holds a request taken from queue_.
+  bool writing_ ABSL_GUARDED_BY(mu_) = false;
+  bool shutdown_ ABSL_GUARDED_BY(mu_) = false;
+  std::thread writer_;
+};
+
+template <typename StubInterface, typename Request, typename Response>
+ExportStream<StubInterface, Request, Response>::ExportStream(
+    StubInterface* stub, const Request& header, absl::string_view name,
+    absl::Duration initial_backoff, absl::Duration max_backoff,
+    int max_queued_requests)
+    : stub_(stub),
+      header_(header),
+      name_(name),
+      initial_backoff_(initial_backoff),
+      max_backoff_(std::max(initial_backoff, max_backoff)),
+      max_queued_requests_(std::max(1, max_queued_requests)),
+      writer_(&ExportStream::RunWriter, this) {}
+
+template <typename StubInterface, typename Request, typename Response>
+ExportStream<StubInterface, Request, Response>::~ExportStream() {
+  {
+    absl::MutexLock l(&mu_);
+    shutdown_ = true;
+  }
+  writer_.join();
+}
+
+template <typename StubInterface, typename Request, typename Response>
+bool ExportStream<StubInterface, Request, Response>::Send(Request request) {
+  absl::MutexLock l(&mu_);
+  if (queue_.size() >= max_queued_requests_) {
+    return false;
+  }
+  queue_.push_back(std::move(request));
+  return true;
+}
+
+template <typename StubInterface, typename Request, typename Response>
+void ExportStream<StubInterface, Request, Response>::Flush() {
+  absl::MutexLock l(&mu_);
+  mu_.Await(absl::Condition(this, &ExportStream::IsIdle));
+}
+
+template <typename StubInterface, typename Request, typename Response>
+void ExportStream<StubInterface, Request, Response>::RunWriter() {
+  std::unique_ptr<Stream> stream;
+  absl::Duration backoff = initial_backoff_;
+  Request request;
+  while (true) {
+    bool more;
+    {
+      absl::MutexLock l(&mu_);
+      if (!writing_) {
+        mu_.Await(absl::Condition(this, &ExportStream::HasWork));
+        if (queue_.empty()) {
+          break;
+        }
+        request = std::move(queue_.front());
+        queue_.pop_front();
+        writing_ = true;
+      }
+      more = !queue_.empty();
+    }
+
+    if (stream == nullptr || stream->ended) {
+      if (stream != nullptr) {
+        CloseStream(std::move(stream), /*cancel=*/true);
+      }
+      stream = OpenStream();
+      // The server associates the header (e.g. the Node) with the stream, so
+      // it is only sent with the first request.
+      request.MergeFrom(header_);
+    }
+    grpc::WriteOptions write_options;
+    if (more) {
+      // Let gRPC coalesce this write with the next one.
+      write_options.set_buffer_hint();
+    }
+    if (stream->stream != nullptr &&
+        stream->stream->Write(request, write_options)) {
+      backoff = initial_backoff_;
+      request.Clear();
+      absl::MutexLock l(&mu_);
+      writing_ = false;
+      continue;
+    }
+
+    std::cerr << name_ << ": Export() stream broken.\n";
+    CloseStream(std::move(stream), /*cancel=*/true);
+    absl::MutexLock l(&mu_);
+    if (mu_.AwaitWithTimeout(absl::Condition(this, &ExportStream::IsShutdown),
+                             backoff)) {
+      std::cerr << name_ << ": dropping " << queue_.size() + 1
+                << " requests at shutdown.\n";
+      queue_.clear();
+      writing_ = false;
+      break;
+    }
+    backoff = std::min(2 * backoff, max_backoff_);
+  }
+
+  if (stream != nullptr) {
+    if (stream->stream != nullptr) {
+      stream->stream->WritesDone();
+    }
+    CloseStream(std::move(stream), /*cancel=*/false);
+  }
+}
+
+template <typename StubInterface, typename Request, typename Response>
+std::unique_ptr<typename ExportStream<StubInterface, Request, Response>::Stream>
+ExportStream<StubInterface, Request, Response>::OpenStream() {
+  auto stream = absl::make_unique<Stream>();
+  num_streams_.fetch_add(1, std::memory_order_relaxed);
+  stream->stream = stub_->Export(&stream->context);
+  if (stream->stream == nullptr) {
+    std::cerr << name_ << ": Export() got a NULL stream.\n";
+    stream->ended = true;
+    return stream;
+  }
+  Stream* s = stream.get();
+  stream->reader = std::thread([s]() {
+    Response response;
+    while (s->stream->Read(&response)) {
+    }
+    s->ended = true;
+  });
+  return stream;
+}
+
+template <typename StubInterface, typename Request, typename Response>
+void ExportStream<StubInterface, Request, Response>::CloseStream(
+    std::unique_ptr<Stream> stream, bool cancel) const {
+  if (cancel) {
+    // Has no effect if the stream has already ended.
+    stream->context.TryCancel();
+  }
+  if (stream->reader.joinable()) {
+    stream->reader.join();
+  }
+  if (stream->stream != nullptr) {
+    grpc::Status status = stream->stream->Finish();
+    if (!status.ok()) {
+      std::cerr << name_ << ": Export() failed: " << ToString(status) << "\n";
+    }
+  }
+}
+
+}  // namespace common
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_COMMON_INTERNAL_GRPC_EXPORT_STREAM_H_
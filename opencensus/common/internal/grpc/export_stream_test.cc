@@ -0,0 +1,193 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/common/internal/grpc/export_stream.h"
+
+#include <grpcpp/grpcpp.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+#include "opencensus/proto/agent/trace/v1/trace_service.grpc.pb.h"
+#include "opencensus/proto/agent/trace/v1/trace_service.pb.h"
+
+namespace opencensus {
+namespace common {
+namespace {
+
+using ::opencensus::proto::agent::trace::v1::ExportTraceServiceRequest;
+using ::opencensus::proto::agent::trace::v1::ExportTraceServiceResponse;
+using ::opencensus::proto::agent::trace::v1::TraceService;
+
+using TraceExportStream =
+    ExportStream<TraceService::StubInterface, ExportTraceServiceRequest,
+                 ExportTraceServiceResponse>;
+
+// An in-process OcAgent that records the requests it receives.
+class FakeAgent final : public TraceService::Service {
+ public:
+  struct Received {
+    int stream;
+    ExportTraceServiceRequest request;
+  };
+
+  // Makes the agent end each stream after 'n' requests.
+  void EndStreamsAfter(int n) {
+    absl::MutexLock l(&mu_);
+    end_streams_after_ = n;
+  }
+
+  grpc::Status Export(
+      grpc::ServerContext* context,
+      grpc::ServerReaderWriter<ExportTraceServiceResponse,
+                               ExportTraceServiceRequest>* stream) override {
+    int index;
+    int end_after;
+    {
+      absl::MutexLock l(&mu_);
+      index = num_streams_++;
+      end_after = end_streams_after_;
+    }
+    ExportTraceServiceRequest request;
+    for (int n = 1; stream->Read(&request); ++n) {
+      absl::MutexLock l(&mu_);
+      received_.push_back({index, request});
+      if (n == end_after) {
+        ++num_ended_streams_;
+        return grpc::Status(grpc::StatusCode::UNAVAILABLE, "going away");
+      }
+    }
+    absl::MutexLock l(&mu_);
+    ++num_ended_streams_;
+    return grpc::Status::OK;
+  }
+
+  void WaitForEndedStreams(int n) {
+    absl::MutexLock l(&mu_);
+    struct Arg {
+      const int* num_ended_streams;
+      int n;
+    } arg = {&num_ended_streams_, n};
+    mu_.Await(absl::Condition(
+        +[](Arg* arg) { return *arg->num_ended_streams >= arg->n; }, &arg));
+  }
+
+  int num_streams() {
+    absl::MutexLock l(&mu_);
+    return num_streams_;
+  }
+
+  std::vector<Received> received() {
+    absl::MutexLock l(&mu_);
+    return received_;
+  }
+
+ private:
+  absl::Mutex mu_;
+  int end_streams_after_ ABSL_GUARDED_BY(mu_) = 0;
+  int num_streams_ ABSL_GUARDED_BY(mu_) = 0;
+  int num_ended_streams_ ABSL_GUARDED_BY(mu_) = 0;
+  std::vector<Received> received_ ABSL_GUARDED_BY(mu_);
+};
+
+class ExportStreamTest : public ::testing::Test {
+ protected:
+  ExportStreamTest() {
+    grpc::ServerBuilder builder;
+    builder.RegisterService(&agent_);
+    server_ = builder.BuildAndStart();
+    stub_ = TraceService::NewStub(
+        server_->InProcessChannel(grpc::ChannelArguments()));
+    header_.mutable_node()->mutable_service_info()->set_name("test_service");
+  }
+
+  ~ExportStreamTest() override { server_->Shutdown(); }
+
+  // Returns a request with one span, whose name is 'name'.
+  static ExportTraceServiceRequest Request(const std::string& name) {
+    ExportTraceServiceRequest request;
+    request.add_spans()->mutable_name()->set_value(name);
+    return request;
+  }
+
+  static std::string SpanName(const FakeAgent::Received& received) {
+    return received.request.spans(0).name().value();
+  }
+
+  FakeAgent agent_;
+  std::unique_ptr<grpc::Server> server_;
+  std::unique_ptr<TraceService::Stub> stub_;
+  ExportTraceServiceRequest header_;
+};
+
+TEST_F(ExportStreamTest, WritesRequestsToOneStream) {
+  {
+    TraceExportStream stream(stub_.get(), header_, "test",
+                             absl::Milliseconds(1), absl::Seconds(1), 16);
+    for (int i = 0; i < 5; ++i) {
+      ASSERT_TRUE(stream.Send(Request(absl::StrCat("span", i))));
+    }
+    stream.Flush();
+  }
+  agent_.WaitForEndedStreams(1);
+  EXPECT_EQ(1, agent_.num_streams());
+  const std::vector<FakeAgent::Received> received = agent_.received();
+  ASSERT_EQ(5, received.size());
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(absl::StrCat("span", i), SpanName(received[i]));
+    // Only the first request carries the header.
+    EXPECT_EQ(i == 0, received[i].request.has_node());
+  }
+  EXPECT_EQ("test_service",
+            received[0].request.node().service_info().name());
+}
+
+TEST_F(ExportStreamTest, ReopensEndedStream) {
+  agent_.EndStreamsAfter(2);
+  {
+    TraceExportStream stream(stub_.get(), header_, "test",
+                             absl::Milliseconds(1), absl::Seconds(1), 16);
+    ASSERT_TRUE(stream.Send(Request("span0")));
+    ASSERT_TRUE(stream.Send(Request("span1")));
+    stream.Flush();
+    agent_.WaitForEndedStreams(1);
+    // Let the exporter see the end of the stream.
+    absl::SleepFor(absl::Milliseconds(100));
+    ASSERT_TRUE(stream.Send(Request("span2")));
+    ASSERT_TRUE(stream.Send(Request("span3")));
+    stream.Flush();
+    EXPECT_EQ(2, stream.num_streams());
+  }
+  agent_.WaitForEndedStreams(2);
+  EXPECT_EQ(2, agent_.num_streams());
+  const std::vector<FakeAgent::Received> received = agent_.received();
+  ASSERT_EQ(4, received.size());
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(absl::StrCat("span", i), SpanName(received[i]));
+    EXPECT_EQ(i / 2, received[i].stream);
+    // Each stream starts with the header.
+    EXPECT_EQ(i % 2 == 0, received[i].request.has_node());
+  }
+}
+
+}  // namespace
+}  // namespace common
+}  // namespace opencensus
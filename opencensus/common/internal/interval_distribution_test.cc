@@ -0,0 +1,196 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/common/internal/interval_distribution.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "opencensus/common/internal/stats_object.h"
+
+namespace opencensus {
+namespace common {
+namespace {
+
+struct DistributionSnapshot {
+  uint64_t count;
+  double mean;
+  double sum_of_squared_deviation;
+  double min;
+  double max;
+  std::vector<uint64_t> histogram;
+};
+
+template <typename T>
+DistributionSnapshot Snapshot(const T& obj, int num_histogram_buckets,
+                              absl::Time now) {
+  DistributionSnapshot s;
+  s.histogram.resize(num_histogram_buckets);
+  obj.DistributionInto(&s.count, &s.mean, &s.sum_of_squared_deviation, &s.min,
+                       &s.max, absl::Span<uint64_t>(s.histogram), now);
+  return s;
+}
+
+TEST(IntervalDistributionTest, InitiallyEmpty) {
+  const absl::Time t0 = absl::UnixEpoch();
+  IntervalDistribution<4> obj(3, absl::Minutes(1), t0);
+  EXPECT_TRUE(obj.IsEmpty(t0));
+  const DistributionSnapshot s = Snapshot(obj, 3, t0);
+  EXPECT_EQ(0, s.count);
+  EXPECT_EQ(0, s.mean);
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), s.min);
+  EXPECT_EQ(-std::numeric_limits<double>::infinity(), s.max);
+  EXPECT_THAT(s.histogram, ::testing::ElementsAre(0, 0, 0));
+}
+
+TEST(IntervalDistributionTest, Add) {
+  const absl::Time t0 = absl::UnixEpoch();
+  IntervalDistribution<4> obj(3, absl::Minutes(1), t0);
+  obj.Add(1, 0, t0);
+  obj.Add(3, 1, t0 + absl::Seconds(20));
+  obj.Add(8, 2, t0 + absl::Seconds(40));
+  EXPECT_FALSE(obj.IsEmpty(t0 + absl::Seconds(40)));
+  const DistributionSnapshot s = Snapshot(obj, 3, t0 + absl::Seconds(40));
+  EXPECT_EQ(3, s.count);
+  EXPECT_DOUBLE_EQ(4, s.mean);
+  EXPECT_DOUBLE_EQ(26, s.sum_of_squared_deviation);
+  EXPECT_EQ(1, s.min);
+  EXPECT_EQ(8, s.max);
+  EXPECT_THAT(s.histogram, ::testing::ElementsAre(1, 1, 1));
+}
+
+TEST(IntervalDistributionTest, MutableCurrentBucket) {
+  const absl::Time t0 = absl::UnixEpoch();
+  IntervalDistribution<4> obj(2, absl::Minutes(1), t0);
+  IntervalDistribution<4>::MutableBucket bucket = obj.MutableCurrentBucket(t0);
+  ASSERT_EQ(2, bucket.histogram_buckets.size());
+  bucket.moments->count = 2;
+  bucket.moments->mean = 5;
+  bucket.moments->sum_of_squared_deviation = 2;
+  bucket.moments->min = 4;
+  bucket.moments->max = 6;
+  bucket.histogram_buckets[1] = 2;
+  const DistributionSnapshot s = Snapshot(obj, 2, t0);
+  EXPECT_EQ(2, s.count);
+  EXPECT_EQ(5, s.mean);
+  EXPECT_EQ(2, s.sum_of_squared_deviation);
+  EXPECT_EQ(4, s.min);
+  EXPECT_EQ(6, s.max);
+  EXPECT_THAT(s.histogram, ::testing::ElementsAre(0, 2));
+}
+
+TEST(IntervalDistributionTest, Expires) {
+  const absl::Time t0 = absl::UnixEpoch();
+  IntervalDistribution<4> obj(1, absl::Minutes(1), t0);
+  obj.Add(1, 0, t0);
+  EXPECT_FALSE(obj.IsEmpty(t0 + absl::Seconds(70)));
+  EXPECT_TRUE(obj.IsEmpty(t0 + absl::Seconds(75)));
+  EXPECT_TRUE(obj.IsEmpty(absl::InfiniteFuture()));
+  EXPECT_EQ(0, Snapshot(obj, 1, t0 + absl::Seconds(75)).count);
+
+  // Recording after the window has passed starts over.
+  obj.Add(2, 0, t0 + absl::Hours(1));
+  const DistributionSnapshot s = Snapshot(obj, 1, t0 + absl::Hours(1));
+  EXPECT_EQ(1, s.count);
+  EXPECT_EQ(2, s.min);
+}
+
+// IntervalDistribution keeps the same data as a StatsObject laid out as
+// described in StatsObject::DistributionInto(), so the two must agree.
+TEST(IntervalDistributionTest, MatchesStatsObject) {
+  constexpr int kNumHistogramBuckets = 4;
+  const absl::Time t0 = absl::UnixEpoch() + absl::Seconds(7);
+  IntervalDistribution<4> obj(kNumHistogramBuckets, absl::Minutes(1), t0);
+  StatsObject<4> reference(kNumHistogramBuckets + 5, absl::Minutes(1), t0);
+  for (int i = 0; i < 200; ++i) {
+    const absl::Time now = t0 + absl::Seconds(i * 1.3);
+    const double value = (i * 37) % 101 / 7.0;
+    obj.Add(value, i % kNumHistogramBuckets, now);
+    reference.AddToDistribution(value, i % kNumHistogramBuckets, now);
+
+    for (const absl::Time t : {now, now + absl::Seconds(20)}) {
+      const DistributionSnapshot actual =
+          Snapshot(obj, kNumHistogramBuckets, t);
+      const DistributionSnapshot expected =
+          Snapshot(reference, kNumHistogramBuckets, t);
+      EXPECT_EQ(expected.count, actual.count);
+      EXPECT_DOUBLE_EQ(expected.mean, actual.mean);
+      EXPECT_NEAR(expected.sum_of_squared_deviation,
+                  actual.sum_of_squared_deviation, 1e-9);
+      EXPECT_EQ(expected.min, actual.min);
+      EXPECT_EQ(expected.max, actual.max);
+      EXPECT_EQ(expected.histogram, actual.histogram);
+      EXPECT_EQ(reference.IsEmpty(t), obj.IsEmpty(t));
+    }
+  }
+}
+
+// Snapshots read running totals of the middle buckets, which must stay right
+// across shifts of one and of several buckets.
+TEST(IntervalDistributionTest, MatchesStatsObjectWithGaps) {
+  constexpr int kNumHistogramBuckets = 3;
+  const absl::Time t0 = absl::UnixEpoch();
+  IntervalDistribution<4> obj(kNumHistogramBuckets, absl::Minutes(1), t0);
+  StatsObject<4> reference(kNumHistogramBuckets + 5, absl::Minutes(1), t0);
+  absl::Time now = t0;
+  for (int i = 0; i < 100; ++i) {
+    // Mostly within a bucket, sometimes skipping several.
+    now += absl::Seconds(i % 9 == 0 ? 41 : 4);
+    const double value = i % 13;
+    obj.Add(value, i % kNumHistogramBuckets, now);
+    reference.AddToDistribution(value, i % kNumHistogramBuckets, now);
+    const DistributionSnapshot actual =
+        Snapshot(obj, kNumHistogramBuckets, now);
+    const DistributionSnapshot expected =
+        Snapshot(reference, kNumHistogramBuckets, now);
+    EXPECT_EQ(expected.count, actual.count);
+    EXPECT_DOUBLE_EQ(expected.mean, actual.mean);
+    EXPECT_NEAR(expected.sum_of_squared_deviation,
+                actual.sum_of_squared_deviation, 1e-9);
+    EXPECT_EQ(expected.min, actual.min);
+    EXPECT_EQ(expected.max, actual.max);
+    EXPECT_EQ(expected.histogram, actual.histogram);
+  }
+}
+
+TEST(IntervalDistributionTest, HistogramCountsSaturate) {
+  const absl::Time t0 = absl::UnixEpoch();
+  IntervalDistribution<4> obj(1, absl::Minutes(1), t0);
+  IntervalDistribution<4>::MutableBucket bucket = obj.MutableCurrentBucket(t0);
+  bucket.histogram_buckets[0] = std::numeric_limits<uint32_t>::max() - 1;
+  obj.Add(1, 0, t0);
+  obj.Add(1, 0, t0);
+  EXPECT_EQ(std::numeric_limits<uint32_t>::max(),
+            Snapshot(obj, 1, t0).histogram[0]);
+  IntervalDistribution<4>::SaturatingAdd(
+      5, &obj.MutableCurrentBucket(t0).histogram_buckets[0]);
+  EXPECT_EQ(std::numeric_limits<uint32_t>::max(),
+            Snapshot(obj, 1, t0).histogram[0]);
+}
+
+TEST(IntervalDistributionTest, VeryLargeYear) {
+  const absl::Time t = absl::FromUnixSeconds(32503680000);  // Year 3000.
+  IntervalDistribution<4> obj(1, absl::Minutes(1), t);
+  obj.Add(1, 0, t);
+  EXPECT_EQ(1, Snapshot(obj, 1, t).count);
+}
+
+}  // namespace
+}  // namespace common
+}  // namespace opencensus
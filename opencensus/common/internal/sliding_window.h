@@ -0,0 +1,212 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPENCENSUS_COMMON_INTERNAL_SLIDING_WINDOW_H_
+#define OPENCENSUS_COMMON_INTERNAL_SLIDING_WINDOW_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#include "absl/base/macros.h"
+#include "absl/time/time.h"
+
+namespace opencensus {
+namespace common {
+
+// SlidingWindow<N> is the clock shared by the sliding-window aggregates
+// (StatsObject and IntervalDistribution).  It divides a period of interest
+// into N buckets of I seconds each, aligned to multiples of I from the Unix
+// epoch, and keeps N + 1 slots of a ring buffer so that sums can interpolate
+// the oldest bucket (see stats_object.h for the full semantics).
+//
+// SlidingWindow only tracks which slot holds the current bucket, when it ends,
+// and how much of the oldest bucket a sum should include; the owner stores the
+// per-bucket data and clears slots as they expire.
+//
+// Thread-compatible.
+template <uint16_t N>
+class SlidingWindow {
+ public:
+  // 'interval' will be rounded to 1 second if it is smaller.
+  SlidingWindow(absl::Duration interval, absl::Time now);
+
+  static constexpr uint16_t NumBuckets() { return N + 1; }
+
+  // The duration covered by one bucket.
+  absl::Duration bucket_interval() const { return bucket_interval_; }
+
+  absl::Time CurBucketStartTime() const {
+    return next_bucket_start_time_ - bucket_interval_;
+  }
+  absl::Time next_bucket_start_time() const { return next_bucket_start_time_; }
+  float initial_bucket_fraction_filled() const {
+    return initial_bucket_fraction_filled_;
+  }
+
+  // The slot of the current bucket.
+  uint32_t cur_bucket() const { return cur_bucket_; }
+
+  // Gets the slot of the Nth bucket, where the 0th bucket is the current
+  // bucket.
+  uint32_t NthBucketIndex(uint32_t n) const {
+    int32_t bucket = cur_bucket_ - n;
+    if (bucket < 0) {
+      bucket += NumBuckets();
+    }
+    ABSL_ASSERT(bucket == (cur_bucket_ + NumBuckets() - n) % NumBuckets());
+    return bucket;
+  }
+
+  // By how many bucket intervals is 'now' ahead of the current bucket?  Returns
+  // 0 if 'now' is behind the current bucket, or numeric_limits<uint32_t>::max()
+  // if now is way ahead of the current bucket.
+  //
+  // If the returned value isn't saturated to numeric_limits<uint32_t>::max(),
+  // the following inequality is satisfied
+  //   next_bucket_start_time_ + bucket_interval_ * BucketsAhead(now) > now.
+  uint32_t BucketsAhead(absl::Time now) const {
+    if (now < next_bucket_start_time_) {
+      return 0;
+    }
+    // Exact integer division of the durations; no floating point is involved.
+    absl::Duration remainder;
+    const int64_t whole_intervals = absl::IDivDuration(
+        now - next_bucket_start_time_, bucket_interval_, &remainder);
+    if (whole_intervals >= std::numeric_limits<uint32_t>::max()) {
+      return std::numeric_limits<uint32_t>::max();
+    }
+    ABSL_ASSERT(next_bucket_start_time_ +
+                    bucket_interval_ * (whole_intervals + 1) >
+                now);
+    return static_cast<uint32_t>(whole_intervals + 1);
+  }
+
+  // Returns the proportion (in [0,1]) of the oldest bucket to add based on how
+  // much time has passed in the most recent bucket and
+  // initial_bucket_fraction_filled_.
+  double LastBucketPortion(absl::Time now) const;
+
+  // Moves the current bucket forward so that next_bucket_start_time() > now,
+  // given num_shifts == BucketsAhead(now) > 0.  Before calling this, the owner
+  // must clear the min(NumBuckets(), num_shifts) oldest slots, i.e.
+  // NthBucketIndex(NumBuckets() - 1 - i) for each i in that range.
+  void Advance(absl::Time now, uint32_t num_shifts);
+
+  // Takes the larger initial_bucket_fraction_filled() of this and 'other', for
+  // merging the data of 'other' into this.
+  void MergeInitialFraction(const SlidingWindow<N>& other) {
+    initial_bucket_fraction_filled_ = std::max(
+        other.initial_bucket_fraction_filled_, initial_bucket_fraction_filled_);
+  }
+
+ private:
+  static_assert(N > 0, "Number of buckets must be greater than 0.");
+
+  // The interval covered by each bucket.
+  const absl::Duration bucket_interval_;
+  // Index of the current bucket's slot.  We use uint16_t and float for
+  // cur_bucket_ and initial_bucket_fraction_filled_ so they'll pack together.
+  uint16_t cur_bucket_;
+  // initial_bucket_fraction_filled_ helps us solve a particular data
+  // interpolation problem which occurs when the object has roughly N * I
+  // seconds' worth of data.
+  //
+  // Suppose bucket_interval_ = 15 and we create an object at t = 20 seconds.
+  // SlidingWindow aligns its intervals to multiples of bucket_interval_,
+  // so the first interval will go from t = 20s to t = 30s, which means that the
+  // very first bucket will record data for 30 - 20 = 10s, instead of the normal
+  // 15s. In this case, we set initial_bucket_fraction_filled_ to 10 / 15 =
+  // 0.667 in our constructor, and set it to 1 once the very first bucket has
+  // been shifted out.
+  float initial_bucket_fraction_filled_;
+  // Start time of the bucket after the one we're currently recording stats for.
+  // Always a multiple of bucket_interval_.  This means that the current bucket
+  // records stats for the half-open interval
+  //   [next_bucket_start_time_ - bucket_interval_, next_bucket_start_time_)
+  // The fact that this interval is open on the RHS is significant to
+  // BucketsAhead()!
+  absl::Time next_bucket_start_time_;
+};
+
+template <uint16_t N>
+SlidingWindow<N>::SlidingWindow(absl::Duration interval, absl::Time now)
+    : bucket_interval_(std::max(interval, absl::Seconds(1)) / N),
+      cur_bucket_(0) {
+  ABSL_ASSERT(interval >= absl::Seconds(1) &&
+              "Too small stats object interval");
+  absl::Time cur_bucket_start_time =
+      absl::UnixEpoch() +
+      absl::Floor(now - absl::UnixEpoch(), bucket_interval_);
+  next_bucket_start_time_ = cur_bucket_start_time + bucket_interval_;
+  initial_bucket_fraction_filled_ =
+      1 - absl::FDivDuration(now - cur_bucket_start_time, bucket_interval_);
+}
+
+template <uint16_t N>
+double SlidingWindow<N>::LastBucketPortion(absl::Time now) const {
+  // Compute the portion of the requested bucket's interval that has passed.  We
+  // interpolate the remainder of the interval's data from the last bucket.
+  const double requested_bucket_portion = absl::FDivDuration(
+      (now - absl::UnixEpoch()) % bucket_interval_, bucket_interval_);
+
+  // To understand the computation below, first consider the common case when
+  // initial_bucket_fraction_filled_ == 0.  This happens after the object has
+  // seen more than NumBuckets() intervals pass.  In this case,
+  // last_bucket_fraction_filled = 1, and
+  // last_bucket_portion = 1 - cur_bucket_portion.  Simple interpolation.
+  //
+  // Now, if the object has seen strictly fewer than NumBuckets() intervals
+  // pass, the last bucket will be empty, and it doesn't matter what value we
+  // choose for last_bucket_portion, because we're going to multiply it by zero.
+  //
+  // The interesting case is when the object has seen exactly NumBuckets()
+  // intervals pass.  In this case, we want to take a fraction of the last
+  // bucket that corresponds to time - cur_bucket_start_time seconds, unless
+  // that value exceeds the number of seconds in the last bucket
+  // (bucket_interval_ - first_bucket_lag_seconds), in which case we should
+  // just take all of the last bucket.
+  return std::min(
+      1.0, (1 - requested_bucket_portion) / initial_bucket_fraction_filled_);
+}
+
+template <uint16_t N>
+void SlidingWindow<N>::Advance(absl::Time now, uint32_t num_shifts) {
+  ABSL_ASSERT(num_shifts > 0 && num_shifts == BucketsAhead(now));
+  const uint32_t num_buckets_cleared =
+      std::min<uint32_t>(NumBuckets(), num_shifts);
+  // cur_bucket_ starts at 0, so this checks whether we've seen more than
+  // NumBuckets() total shifts.  If so, the initial bucket is gone.
+  if (num_buckets_cleared + cur_bucket_ >= NumBuckets()) {
+    initial_bucket_fraction_filled_ = 1;
+  }
+  cur_bucket_ = NthBucketIndex(NumBuckets() - num_buckets_cleared);
+  // Advancing by num_shifts intervals keeps next_bucket_start_time_ aligned
+  // without another division, but doesn't work when now is much larger than
+  // next_bucket_time_, saturating num_shifts to numeric_limits<uint32_t>::max.
+  if (num_shifts < std::numeric_limits<uint32_t>::max()) {
+    next_bucket_start_time_ += bucket_interval_ * num_shifts;
+  } else {
+    next_bucket_start_time_ = absl::UnixEpoch() +
+                              absl::Floor(now - absl::UnixEpoch(),
+                                          bucket_interval_) +
+                              bucket_interval_;
+  }
+  ABSL_ASSERT(now < next_bucket_start_time_);
+}
+
+}  // namespace common
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_COMMON_INTERNAL_SLIDING_WINDOW_H_
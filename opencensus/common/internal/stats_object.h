@@ -30,6 +30,7 @@
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "opencensus/common/internal/sliding_window.h"
 
 namespace opencensus {
 namespace common {
@@ -63,6 +64,13 @@ namespace common {
 // time", the object may implicitly increase 'now', possibly up to the current
 // time.
 //
+// Besides the buckets, StatsObject keeps a running total of every bucket but
+// the current one, updated as buckets are shifted in and out.  This lets Sum()
+// and the count and histogram parts of DistributionInto() be computed in
+// O(num_stats) when 'now' falls in the current bucket, instead of summing all
+// N + 1 buckets.  The total is recomputed from the buckets once per full
+// rotation so that rounding error cannot accumulate.
+//
 // Thread-compatible.
 template <uint16_t N>
 class StatsObject {
@@ -72,9 +80,9 @@ class StatsObject {
   StatsObject& operator=(const StatsObject<N>&) = delete;
 
   // The duration covered by one of this object's buckets.
-  absl::Duration bucket_interval() const { return bucket_interval_; }
+  absl::Duration bucket_interval() const { return window_.bucket_interval(); }
   // The duration covered by this object.
-  absl::Duration total_interval() const { return N * bucket_interval_; }
+  absl::Duration total_interval() const { return N * bucket_interval(); }
 
   // Create a new StatsObject keeping num_stats distinct stats over the past
   // 'interval'. 'interval' will be rounded to 1 second if it is smaller.
@@ -145,109 +153,71 @@ class StatsObject {
   std::string DebugString() const;
 
  private:
-  static_assert(N > 0, "Number of buckets must be greater than 0.");
-
-  constexpr uint16_t NumBuckets() const { return N + 1; }
-  absl::Time CurBucketStartTime() const {
-    return next_bucket_start_time_ - bucket_interval_;
+  static constexpr uint16_t NumBuckets() {
+    return SlidingWindow<N>::NumBuckets();
+  }
+  uint32_t NthBucketIndex(uint32_t n) const {
+    return window_.NthBucketIndex(n);
   }
 
-  // Gets the index into the array of the Nth bucket, where the 0th bucket is
-  // the current bucket.
-  uint32_t NthBucketIndex(uint32_t n) const;
-
-  // Gets the data in the Nth bucket.
+  // Gets the data in the Nth bucket, where the 0th bucket is the current
+  // bucket.
   absl::Span<double> NthBucket(uint32_t n);
   absl::Span<const double> NthBucket(uint32_t n) const;
 
-  // By how many bucket intervals is 'now' ahead of the current bucket?  Returns
-  // 0 if 'now' is behind the current bucket, or numeric_limits<uint32_t>::max()
-  // if now is way ahead of the current bucket.
-  //
-  // If the returned value isn't saturated to numeric_limits<uint32_t>::max(),
-  // the following inequality is satisfied
-  //   next_bucket_start_time_ + bucket_interval_ * BucketsAhead(now) > now.
-  uint32_t BucketsAhead(absl::Time now) const {
-    double v = std::max(
-        0.0, std::floor(absl::FDivDuration(now - next_bucket_start_time_,
-                                           bucket_interval_) +
-                        1));
-    // This will fail if now is so large that
-    //   (now / bucket_interval_) + 1 == (now / bucket_interval_),
-    // but this whole class is liable to fall apart in that case.
-    ABSL_ASSERT(next_bucket_start_time_ + bucket_interval_ * v > now);
-    return v <= std::numeric_limits<uint32_t>::max()
-               ? static_cast<uint32_t>(v)
-               : std::numeric_limits<uint32_t>::max();
+  // Gets the data in the bucket stored at 'index' in data_, or the running
+  // total when index == NumBuckets().
+  double* Row(uint32_t index) { return data_.data() + index * num_stats_; }
+  const double* Row(uint32_t index) const {
+    return data_.data() + index * num_stats_;
   }
 
+  // Row arithmetic over num_stats_ contiguous doubles.  These are plain
+  // indexed loops so that the compiler can vectorize them.
+  void AddRow(const double* src, double* dst) const {
+    for (uint32_t i = 0; i < num_stats_; ++i) {
+      dst[i] += src[i];
+    }
+  }
+  void SubtractRow(const double* src, double* dst) const {
+    for (uint32_t i = 0; i < num_stats_; ++i) {
+      dst[i] -= src[i];
+    }
+  }
+
+  // Writes into 'out' the windowed sum of stats
+  // [first_stat, first_stat + out.size()), as of a time 'buckets_ahead'
+  // (< NumBuckets()) intervals past the current bucket, taking
+  // 'last_bucket_portion' of the oldest bucket still in the window.
+  template <typename T>
+  void WindowSumInto(uint32_t first_stat, absl::Span<T> out,
+                     uint32_t buckets_ahead, double last_bucket_portion) const;
+
+  // Recomputes the running total from the buckets.
+  void RecomputeClosedTotal();
+
   // Shifts our data forward in time so that next_bucket_start_time > now.
   void Shift(absl::Time now);
 
-  // Returns the proportion (in [0,1]) of the oldest bucket to add based on how
-  // much time has passed in the most recent bucket and
-  // initial_bucket_fraction_filled_.
-  double LastBucketPortion(absl::Time now) const;
-
-  // The interval covered by each bucket.
-  const absl::Duration bucket_interval_;
-  // We use uint16_t and float for num_stats_, cur_bucket_, and
-  // initial_bucket_fraction_filled_ so they'll pack into 8 bytes.
+  SlidingWindow<N> window_;
   const uint16_t num_stats_;
-  // Index of the current bucket in data_.  That is, the current bucket's data
-  // is stored in the num_stats_ elements starting at
-  // data_.data() + cur_bucket_ * num_stats_.
-  uint16_t cur_bucket_;
-  // initial_bucket_fraction_filled_ helps us solve a particular data
-  // interpolation problem which occurs when the object has roughly N * I
-  // seconds' worth of data.
-  //
-  // Suppose bucket_interval_ = 15 and we create an object at t = 20 seconds.
-  // StatsObject aligns its intervals to multiples of bucket_interval_,
-  // so the first interval will go from t = 20s to t = 30s, which means that the
-  // very first bucket will record data for 30 - 20 = 10s, instead of the normal
-  // 15s. In this case, we set initial_bucket_fraction_filled_ to 10 / 15 =
-  // 0.667 in our constructor, and set it to 0 once the very first bucket has
-  // been shifted out.
-  float initial_bucket_fraction_filled_;
-  // Start time of the bucket after the one we're currently recording stats for.
-  // Always a multiple of bucket_interval_.  This means that the current bucket
-  // records stats for the half-open interval
-  //   [next_bucket_start_time_ - bucket_interval_, next_bucket_start_time_)
-  // The fact that this interval is open on the RHS is significant to
-  // BucketsAhead()!
-  absl::Time next_bucket_start_time_;
+  // Number of buckets shifted out since the running total was last recomputed
+  // from scratch.
+  uint16_t shifts_since_recompute_;
   // Stores this object's data.  Bucket b contains num_stats_ elements at
-  // indices [b * num_stats_, (b + 1) * num_stats_).
+  // indices [b * num_stats_, (b + 1) * num_stats_).  The row after the last
+  // bucket (b == NumBuckets()) holds the running total of all buckets except
+  // the current one.
   std::vector<double> data_;
 };
 
 template <uint16_t N>
 StatsObject<N>::StatsObject(uint16_t num_stats, absl::Duration interval,
                             absl::Time now)
-    : bucket_interval_(std::max(interval, absl::Seconds(1)) / N),
+    : window_(interval, now),
       num_stats_(num_stats),
-      cur_bucket_(0),
-      data_(num_stats * (N + 1)) {
-  ABSL_ASSERT(interval >= absl::Seconds(1) &&
-              "Too small stats object interval");
-  absl::Time cur_bucket_start_time =
-      absl::UnixEpoch() +
-      absl::Floor(now - absl::UnixEpoch(), bucket_interval_);
-  next_bucket_start_time_ = cur_bucket_start_time + bucket_interval_;
-  initial_bucket_fraction_filled_ =
-      1 - absl::FDivDuration(now - cur_bucket_start_time, bucket_interval_);
-}
-
-template <uint16_t N>
-uint32_t StatsObject<N>::NthBucketIndex(uint32_t n) const {
-  int32_t bucket = cur_bucket_ - n;
-  if (bucket < 0) {
-    bucket += NumBuckets();
-  }
-  ABSL_ASSERT(bucket == (cur_bucket_ + NumBuckets() - n) % NumBuckets());
-  return bucket;
-}
+      shifts_since_recompute_(0),
+      data_(num_stats * (N + 2)) {}
 
 template <uint16_t N>
 absl::Span<double> StatsObject<N>::NthBucket(uint32_t n) {
@@ -299,15 +269,15 @@ void StatsObject<N>::AddToDistribution(double value, int histogram_bucket,
 template <uint16_t N>
 absl::Span<double> StatsObject<N>::MutableCurrentBucket(absl::Time now) {
   Shift(now);
-  if (now < CurBucketStartTime()) {
+  if (now < window_.CurBucketStartTime()) {
     std::cerr
-        << "now=" << now << " < CurBucketStartTime()=" << CurBucketStartTime()
+        << "now=" << now
+        << " < CurBucketStartTime()=" << window_.CurBucketStartTime()
         << "; returning current bucket anyway.  If the difference is small it "
            "might be due to an inconsequential clock perturbation, but if you "
            "see this warning often, it is likely a bug.\n";
   }
-  return absl::Span<double>(data_.data() + cur_bucket_ * num_stats_,
-                            num_stats_);
+  return absl::Span<double>(Row(window_.cur_bucket()), num_stats_);
 }
 
 template <uint16_t N>
@@ -317,33 +287,6 @@ std::vector<double> StatsObject<N>::Sum(absl::Time now) const {
   return sum;
 }
 
-template <uint16_t N>
-double StatsObject<N>::LastBucketPortion(absl::Time now) const {
-  // Compute the portion of the requested bucket's interval that has passed.  We
-  // interpolate the remainder of the interval's data from the last bucket.
-  const double requested_bucket_portion = absl::FDivDuration(
-      (now - absl::UnixEpoch()) % bucket_interval_, bucket_interval_);
-
-  // To understand the computation below, first consider the common case when
-  // initial_bucket_fraction_filled_ == 0.  This happens after the object has
-  // seen more than NumBuckets() intervals pass.  In this case,
-  // last_bucket_fraction_filled = 1, and
-  // last_bucket_portion = 1 - cur_bucket_portion.  Simple interpolation.
-  //
-  // Now, if the object has seen strictly fewer than NumBuckets() intervals
-  // pass, the last bucket will be empty, and it doesn't matter what value we
-  // choose for last_bucket_portion, because we're going to multiply it by zero.
-  //
-  // The interesting case is when the object has seen exactly NumBuckets()
-  // intervals pass.  In this case, we want to take a fraction of the last
-  // bucket that corresponds to time - cur_bucket_start_time seconds, unless
-  // that value exceeds the number of seconds in the last bucket
-  // (bucket_interval_ - first_bucket_lag_seconds), in which case we should
-  // just take all of the last bucket.
-  return std::min(
-      1.0, (1 - requested_bucket_portion) / initial_bucket_fraction_filled_);
-}
-
 template <uint16_t N>
 void StatsObject<N>::SumInto(absl::Span<double> val, absl::Time now) const {
   ABSL_ASSERT(val.size() >= num_stats_);
@@ -351,25 +294,48 @@ void StatsObject<N>::SumInto(absl::Span<double> val, absl::Time now) const {
     std::fill(val.begin(), val.end(), 0);
     return;
   }
-  std::fill(val.begin(), val.begin() + num_stats_, 0);
-  const uint32_t buckets_ahead = BucketsAhead(now);
+  const uint32_t buckets_ahead = window_.BucketsAhead(now);
   if (buckets_ahead >= NumBuckets()) {
+    std::fill(val.begin(), val.begin() + num_stats_, 0);
     return;
   }
+  WindowSumInto(0, val.subspan(0, num_stats_), buckets_ahead,
+                window_.LastBucketPortion(now));
+}
 
-  for (uint32_t i = 0; i < NumBuckets() - 1 - buckets_ahead; ++i) {
-    absl::Span<const double> bucket = NthBucket(i);
-    for (uint32_t j = 0; j < num_stats_; ++j) {
-      val[j] += bucket[j];
+template <uint16_t N>
+template <typename T>
+void StatsObject<N>::WindowSumInto(uint32_t first_stat, absl::Span<T> out,
+                                   uint32_t buckets_ahead,
+                                   double last_bucket_portion) const {
+  const uint32_t num_out = out.size();
+  T* const result = out.data();
+  if (buckets_ahead == 0) {
+    // The window is every bucket but (a portion of) the oldest one:
+    //   closed_total + current - oldest + portion * oldest.
+    // Evaluated in this order, the integer-valued part is exact, so counts
+    // truncate exactly as if the buckets had been summed one by one.
+    const double* closed = Row(NumBuckets()) + first_stat;
+    const double* current = Row(window_.cur_bucket()) + first_stat;
+    const double* oldest = Row(NthBucketIndex(NumBuckets() - 1)) + first_stat;
+    for (uint32_t i = 0; i < num_out; ++i) {
+      result[i] = static_cast<T>((closed[i] + current[i] - oldest[i]) +
+                                 last_bucket_portion * oldest[i]);
     }
+    return;
   }
 
-  // Now add (possibly only a part of) the data from the last bucket.
-  const double last_bucket_portion = LastBucketPortion(now);
-  absl::Span<const double> last_bucket =
-      NthBucket(NumBuckets() - 1 - buckets_ahead);
-  for (uint32_t i = 0; i < num_stats_; ++i) {
-    val[i] += last_bucket_portion * last_bucket[i];
+  // 'now' is past the current bucket, so the running total includes buckets
+  // that have left the window; sum the remaining buckets directly.
+  const uint32_t last_bucket = NumBuckets() - 1 - buckets_ahead;
+  for (uint32_t i = 0; i < num_out; ++i) {
+    double sum = 0;
+    for (uint32_t b = 0; b < last_bucket; ++b) {
+      sum += Row(NthBucketIndex(b))[first_stat + i];
+    }
+    result[i] = static_cast<T>(
+        sum + last_bucket_portion *
+                  Row(NthBucketIndex(last_bucket))[first_stat + i]);
   }
 }
 
@@ -396,7 +362,7 @@ void StatsObject<N>::DistributionInto(uint64_t* count, double* mean,
                                       absl::Span<uint64_t> histogram_buckets,
                                       absl::Time now) const {
   ABSL_ASSERT(histogram_buckets.size() + 5 == num_stats_);
-  const uint32_t buckets_ahead = BucketsAhead(now);
+  const uint32_t buckets_ahead = window_.BucketsAhead(now);
   *count = 0;
   *mean = 0;
   *sum_of_squared_deviation = 0;
@@ -408,50 +374,53 @@ void StatsObject<N>::DistributionInto(uint64_t* count, double* mean,
     return;
   }
 
+  const double last_bucket_portion = window_.LastBucketPortion(now);
+
+  // The histogram is a plain sum, so it comes from the running total.
+  WindowSumInto(5, histogram_buckets, buckets_ahead, last_bucket_portion);
+
+  // The moments have to be combined bucket by bucket, but that only reads the
+  // first five stats of each bucket.
+  double merged_count = 0;
   // Updates stats with a new bucket, scaling it by scaling_factor.
-  const auto UpdateFromBucket =
-      [count, mean, sum_of_squared_deviation, min, max, histogram_buckets](
-          absl::Span<const double> bucket, double scaling_factor) {
-        // Skip empty buckets, since they have not been initialized correctly.
-        if (!bucket[0]) {
-          return;
-        }
-        // Combine statistics using the parallel algorithm.
-        const double delta = bucket[1] - *mean;
-        const double bucket_count = bucket[0] * scaling_factor;
-        const double bucket_sum_of_squared_deviation =
-            bucket[2] * scaling_factor;
-        *sum_of_squared_deviation =
-            *sum_of_squared_deviation + bucket_sum_of_squared_deviation +
-            pow(delta, 2) * *count * bucket_count / (*count + bucket_count);
-        *mean = ((*mean * *count) + (bucket[1] * bucket_count)) /
-                (*count + bucket_count);
-        // Note that scaling_factor will be one for all but the last update and
-        // the count and histogram buckets should be integers, so this is
-        // equivalent to summing to a double and then rounding.
-        *count += bucket_count;
-        *min = std::min(*min, bucket[3]);
-        *max = std::max(*max, bucket[4]);
-        for (int i = 0; i < histogram_buckets.size(); ++i) {
-          histogram_buckets[i] += bucket[i + 5] * scaling_factor;
-        }
-      };
-
-  for (uint32_t i = 0; i < NumBuckets() - 1 - buckets_ahead; ++i) {
-    UpdateFromBucket(NthBucket(i), 1.0);
+  const auto UpdateFromBucket = [&merged_count, mean, sum_of_squared_deviation,
+                                 min, max](const double* bucket,
+                                           double scaling_factor) {
+    // Skip empty buckets, since they have not been initialized correctly.
+    if (!bucket[0]) {
+      return;
+    }
+    // Combine statistics using the parallel algorithm.
+    const double delta = bucket[1] - *mean;
+    const double bucket_count = bucket[0] * scaling_factor;
+    const double bucket_sum_of_squared_deviation = bucket[2] * scaling_factor;
+    *sum_of_squared_deviation =
+        *sum_of_squared_deviation + bucket_sum_of_squared_deviation +
+        pow(delta, 2) * merged_count * bucket_count /
+            (merged_count + bucket_count);
+    *mean = ((*mean * merged_count) + (bucket[1] * bucket_count)) /
+            (merged_count + bucket_count);
+    merged_count += bucket_count;
+    *min = std::min(*min, bucket[3]);
+    *max = std::max(*max, bucket[4]);
+  };
+
+  const uint32_t last_bucket = NumBuckets() - 1 - buckets_ahead;
+  for (uint32_t i = 0; i < last_bucket; ++i) {
+    UpdateFromBucket(Row(NthBucketIndex(i)), 1.0);
   }
-
   // Now add (possibly only a part of) the data from the last bucket.
-  const double last_bucket_portion = LastBucketPortion(now);
-  absl::Span<const double> last_bucket =
-      NthBucket(NumBuckets() - 1 - buckets_ahead);
-  UpdateFromBucket(last_bucket, last_bucket_portion);
+  UpdateFromBucket(Row(NthBucketIndex(last_bucket)), last_bucket_portion);
+  // Note that the scaling factor is one for all but the last update and the
+  // counts should be integers, so this is equivalent to summing to a double
+  // and then rounding.
+  *count = static_cast<uint64_t>(merged_count);
 }
 
 template <uint16_t N>
 bool StatsObject<N>::IsEmpty(absl::Time now) const {
-  const int32_t buckets_ahead = BucketsAhead(now);
-  for (int32_t i = 0; i < NumBuckets() - buckets_ahead; ++i) {
+  const uint32_t buckets_ahead = window_.BucketsAhead(now);
+  for (uint32_t i = 0; i + buckets_ahead < NumBuckets(); ++i) {
     for (const double& val : NthBucket(i)) {
       if (val != 0) {
         return false;
@@ -463,31 +432,47 @@ bool StatsObject<N>::IsEmpty(absl::Time now) const {
 
 template <uint16_t N>
 void StatsObject<N>::Shift(absl::Time now) {
-  if (now < next_bucket_start_time_) {
+  if (now < window_.next_bucket_start_time()) {
     return;
   }
 
-  uint64_t num_shifts = BucketsAhead(now);
+  const uint32_t num_shifts = window_.BucketsAhead(now);
   uint32_t num_buckets_to_clear = std::min<uint32_t>(NumBuckets(), num_shifts);
-  for (uint32_t i = 0; i < num_buckets_to_clear; ++i) {
-    absl::Span<double> bucket = NthBucket(NumBuckets() - i - 1);
-    std::fill(bucket.begin(), bucket.end(), 0);
+  if (num_buckets_to_clear == NumBuckets()) {
+    // Everything expired, including the running total.
+    std::fill(data_.begin(), data_.end(), 0);
+    shifts_since_recompute_ = 0;
+  } else {
+    // The current bucket closes, and the oldest buckets leave the window.
+    double* closed_total = Row(NumBuckets());
+    AddRow(Row(window_.cur_bucket()), closed_total);
+    for (uint32_t i = 0; i < num_buckets_to_clear; ++i) {
+      double* bucket = Row(NthBucketIndex(NumBuckets() - i - 1));
+      SubtractRow(bucket, closed_total);
+      std::fill(bucket, bucket + num_stats_, 0);
+    }
+    shifts_since_recompute_ += num_buckets_to_clear;
   }
 
-  // cur_bucket_ starts at 0, so this checks whether we've seen more than
-  // NumBuckets() total shifts.  If so, the initial bucket is gone.
-  if (num_buckets_to_clear + cur_bucket_ >= NumBuckets()) {
-    initial_bucket_fraction_filled_ = 1;
+  window_.Advance(now, num_shifts);
+
+  // Bound rounding error in the running total, which matters for non-integer
+  // stats.
+  if (shifts_since_recompute_ >= NumBuckets()) {
+    RecomputeClosedTotal();
   }
-  cur_bucket_ = NthBucketIndex(NumBuckets() - num_buckets_to_clear);
-  // We could equivalently write
-  // next_bucket_start_time_ += bucket_interval_ * num_shifts;,
-  // but that doesn't work when now is much larger than next_bucket_time_,
-  // saturating num_shifts to numeric_limits<uint32_t>::max.
-  next_bucket_start_time_ =
-      absl::UnixEpoch() +
-      absl::Floor(now - absl::UnixEpoch(), bucket_interval_) + bucket_interval_;
-  ABSL_ASSERT(now < next_bucket_start_time_);
+}
+
+template <uint16_t N>
+void StatsObject<N>::RecomputeClosedTotal() {
+  double* closed_total = Row(NumBuckets());
+  std::fill(closed_total, closed_total + num_stats_, 0);
+  for (uint32_t b = 0; b < NumBuckets(); ++b) {
+    if (b != window_.cur_bucket()) {
+      AddRow(Row(b), closed_total);
+    }
+  }
+  shifts_since_recompute_ = 0;
 }
 
 template <uint16_t N>
@@ -497,37 +482,36 @@ void StatsObject<N>::Merge(const StatsObject<N>& other) {
               << other.num_stats_ << "\n";
     return;
   }
-  if (bucket_interval_ != other.bucket_interval_) {
-    std::cerr << "bucket_interval_ mismatch: Expected " << bucket_interval_
-              << ", but was " << other.bucket_interval_ << "\n";
+  if (bucket_interval() != other.bucket_interval()) {
+    std::cerr << "bucket_interval_ mismatch: Expected " << bucket_interval()
+              << ", but was " << other.bucket_interval() << "\n";
     return;
   }
-  Shift(other.CurBucketStartTime());
-  ABSL_ASSERT(next_bucket_start_time_ >= other.next_bucket_start_time_);
+  Shift(other.window_.CurBucketStartTime());
+  ABSL_ASSERT(window_.next_bucket_start_time() >=
+              other.window_.next_bucket_start_time());
   // We guaranteed that our data isn't behind other's by calling Shift() above,
   // but our data may still be ahead of other's.
-  uint32_t intervals_ahead = other.BucketsAhead(CurBucketStartTime());
+  uint32_t intervals_ahead =
+      other.window_.BucketsAhead(window_.CurBucketStartTime());
   if (intervals_ahead >= NumBuckets()) {
     return;
   }
 
-  initial_bucket_fraction_filled_ = std::max(
-      other.initial_bucket_fraction_filled_, initial_bucket_fraction_filled_);
+  window_.MergeInitialFraction(other.window_);
 
   for (uint32_t i = 0; i < NumBuckets() - intervals_ahead; ++i) {
-    absl::Span<double> this_bucket = NthBucket(i + intervals_ahead);
-    absl::Span<const double> other_bucket = other.NthBucket(i);
-    for (uint32_t j = 0; j < num_stats_; ++j) {
-      this_bucket[j] += other_bucket[j];
-    }
+    AddRow(other.Row(other.NthBucketIndex(i)),
+           Row(NthBucketIndex(i + intervals_ahead)));
   }
+  RecomputeClosedTotal();
 }
 
 template <uint16_t N>
 std::string StatsObject<N>::DebugString() const {
   std::string s =
       absl::Substitute("StatsObject<$0> with $2 stat$3 over $1 intervals.", N,
-                       absl::FormatDuration(bucket_interval_), num_stats(),
+                       absl::FormatDuration(bucket_interval()), num_stats(),
                        num_stats() == 1 ? "" : "s");
   for (uint32_t stat = 0; stat < num_stats(); ++stat) {
     absl::StrAppend(&s, "\n");
@@ -540,13 +524,14 @@ std::string StatsObject<N>::DebugString() const {
     }
     absl::StrAppend(&s, "}");
   }
+  const absl::Time next_bucket_start_time = window_.next_bucket_start_time();
   absl::StrAppend(&s, "\nnext_bucket_start_time_ = ",
-                  absl::FormatTime(next_bucket_start_time_), ", ",
-                  absl::FormatDuration(next_bucket_start_time_ - absl::Now()),
+                  absl::FormatTime(next_bucket_start_time), ", ",
+                  absl::FormatDuration(next_bucket_start_time - absl::Now()),
                   " from now.");
-  if (initial_bucket_fraction_filled_ != 1) {
+  if (window_.initial_bucket_fraction_filled() != 1) {
     absl::StrAppend(&s, "\ninitial_bucket_fraction_filled_ = ",
-                    initial_bucket_fraction_filled_);
+                    window_.initial_bucket_fraction_filled());
   }
   return s;
 }
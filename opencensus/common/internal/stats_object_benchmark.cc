@@ -0,0 +1,113 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "benchmark/benchmark.h"
+#include "opencensus/common/internal/stats_object.h"
+
+namespace opencensus {
+namespace common {
+namespace {
+
+// The same shape as interval view rows: 4 buckets over a minute.
+using IntervalStatsObject = StatsObject<4>;
+
+constexpr int kNumHistogramBuckets = 32;
+
+// Fills every bucket of 'obj' with data, ending at 'now'.
+void Fill(IntervalStatsObject* obj, absl::Time start, absl::Time now) {
+  const std::vector<double> values(obj->num_stats(), 1.0);
+  for (absl::Time t = start; t <= now; t += obj->bucket_interval() / 8) {
+    obj->Add(values, t);
+  }
+}
+
+// Fills every bucket of 'obj' with distribution data, ending at 'now'.
+void FillDistribution(IntervalStatsObject* obj, absl::Time start,
+                      absl::Time now) {
+  int i = 0;
+  for (absl::Time t = start; t <= now; t += obj->bucket_interval() / 8, ++i) {
+    obj->AddToDistribution(i, i % kNumHistogramBuckets, t);
+  }
+}
+
+// Argument: number of stats.
+void BM_Add(benchmark::State& state) {
+  const int num_stats = state.range(0);
+  const absl::Time start = absl::UnixEpoch() + absl::Hours(1);
+  IntervalStatsObject obj(num_stats, absl::Minutes(1), start);
+  const std::vector<double> values(num_stats, 1.0);
+  absl::Time now = start;
+  for (auto _ : state) {
+    obj.Add(values, now);
+    now += absl::Milliseconds(1);
+  }
+}
+BENCHMARK(BM_Add)->Arg(1)->Arg(kNumHistogramBuckets + 5);
+
+// Every iteration crosses a bucket boundary.
+// Argument: number of stats.
+void BM_Shift(benchmark::State& state) {
+  const int num_stats = state.range(0);
+  const absl::Time start = absl::UnixEpoch() + absl::Hours(1);
+  IntervalStatsObject obj(num_stats, absl::Minutes(1), start);
+  const std::vector<double> values(num_stats, 1.0);
+  absl::Time now = start;
+  for (auto _ : state) {
+    now += obj.bucket_interval();
+    obj.Add(values, now);
+  }
+}
+BENCHMARK(BM_Shift)->Arg(1)->Arg(kNumHistogramBuckets + 5);
+
+// Argument: number of stats.
+void BM_Sum(benchmark::State& state) {
+  const int num_stats = state.range(0);
+  const absl::Time start = absl::UnixEpoch() + absl::Hours(1);
+  const absl::Time now = start + absl::Minutes(2) + absl::Seconds(7);
+  IntervalStatsObject obj(num_stats, absl::Minutes(1), start);
+  Fill(&obj, start, now);
+  std::vector<double> sum(num_stats);
+  for (auto _ : state) {
+    obj.SumInto(absl::Span<double>(sum), now);
+    benchmark::DoNotOptimize(sum.data());
+  }
+}
+BENCHMARK(BM_Sum)->Arg(1)->Arg(kNumHistogramBuckets + 5);
+
+void BM_DistributionInto(benchmark::State& state) {
+  const absl::Time start = absl::UnixEpoch() + absl::Hours(1);
+  const absl::Time now = start + absl::Minutes(2) + absl::Seconds(7);
+  IntervalStatsObject obj(kNumHistogramBuckets + 5, absl::Minutes(1), start);
+  FillDistribution(&obj, start, now);
+  uint64_t count;
+  double mean, sum_of_squared_deviation, min, max;
+  std::vector<uint64_t> histogram(kNumHistogramBuckets);
+  for (auto _ : state) {
+    obj.DistributionInto(&count, &mean, &sum_of_squared_deviation, &min, &max,
+                         absl::Span<uint64_t>(histogram), now);
+    benchmark::DoNotOptimize(histogram.data());
+  }
+}
+BENCHMARK(BM_DistributionInto);
+
+}  // namespace
+}  // namespace common
+}  // namespace opencensus
+
+BENCHMARK_MAIN();
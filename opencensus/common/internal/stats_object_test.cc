@@ -402,6 +402,42 @@ TEST(StatsObjectTest, MergeMismatchedInterval) {
   CheckSum(obj2, t0 + obj2.total_interval() - epsilon, {2});
 }
 
+TEST(StatsObjectTest, SumAcrossManyShifts) {
+  // Exercises the running total across several full rotations, including
+  // skipped buckets, against sums computed from a history of each bucket.
+  const absl::Time t0 = absl::UnixEpoch();
+  StatsObject<4> obj(2, absl::Minutes(1), t0);
+  const absl::Duration interval = obj.bucket_interval();
+  std::deque<std::vector<double>> history;  // Front is the current bucket.
+  int bucket = 0;
+  for (int i = 0; i < 50; ++i) {
+    const int skip = (i % 7 == 3) ? 3 : 1;
+    bucket += skip;
+    for (int j = 0; j < skip; ++j) {
+      history.push_front({0, 0});
+    }
+    const absl::Time now = t0 + interval * bucket + epsilon;
+    obj.Add({1.0 * i, 0.1 * i}, now);
+    history.front()[0] += 1.0 * i;
+    history.front()[1] += 0.1 * i;
+
+    // Halfway through the current bucket, the window holds the 4 most recent
+    // buckets and half of the fifth; half a bucket later it has lost another
+    // bucket and holds half of the fourth.
+    const absl::Time mid = t0 + interval * bucket + interval / 2;
+    std::vector<double> expected(2), expected_next(2);
+    for (int b = 0; b < 5 && b < history.size(); ++b) {
+      for (int s = 0; s < 2; ++s) {
+        const double portion = b == 4 ? 0.5 : 1;
+        expected[s] += portion * history[b][s];
+        if (b < 4) expected_next[s] += (b == 3 ? 0.5 : 1) * history[b][s];
+      }
+    }
+    CheckSum(obj, mid, expected);
+    CheckSum(obj, mid + interval, expected_next);
+  }
+}
+
 TEST(StatsObjectTest, Empty) {
   const absl::Time t0 = absl::UnixEpoch();
   StatsObject<4> obj(2, absl::Minutes(1), t0);
@@ -16,10 +16,35 @@
 #include "absl/time/time.h"
 #include "benchmark/benchmark.h"
 #include "google/protobuf/timestamp.pb.h"
+#include "opencensus/common/internal/clock.h"
 #include "opencensus/common/internal/timestamp.h"
 
 namespace {
 
+using ::opencensus::common::Clock;
+
+void BM_AbslNow(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(absl::Now());
+  }
+}
+BENCHMARK(BM_AbslNow);
+
+// Clock::Now() with each source. Arg is the kCached tolerance in microseconds.
+void BM_ClockNow(benchmark::State& state, Clock::Source source) {
+  Clock::SetSource(source, absl::Microseconds(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Clock::Now());
+  }
+  Clock::SetSource(Clock::Source::kPrecise);
+}
+BENCHMARK_CAPTURE(BM_ClockNow, Precise, Clock::Source::kPrecise)->Arg(0);
+BENCHMARK_CAPTURE(BM_ClockNow, Coarse, Clock::Source::kCoarse)->Arg(0);
+BENCHMARK_CAPTURE(BM_ClockNow, Cached, Clock::Source::kCached)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000);
+
 void BM_SetTimestamp(benchmark::State& state) {
   absl::Time t = absl::Now();
   google::protobuf::Timestamp proto;
@@ -45,11 +45,12 @@ class Context {
   // Returns a const reference to the current (thread local) Context.
   static const Context& Current();
 
-  // Context is copiable and movable.
-  Context(const Context&) = default;
-  Context(Context&&) = default;
-  Context& operator=(const Context&) = default;
-  Context& operator=(Context&&) = default;
+  // Context is copiable and movable. Copies always own their TagMap and Span,
+  // even if the source refers to a WithTagMap or WithSpan frame.
+  Context(const Context& other);
+  Context(Context&& other);
+  Context& operator=(const Context& other);
+  Context& operator=(Context&& other);
 
   // Returns an std::function wrapped to run with a copy of this Context.
   std::function<void()> Wrap(std::function<void()> fn) const;
@@ -73,8 +74,16 @@ class Context {
   friend class ::opencensus::trace::ContextPeer;
   friend class ::opencensus::trace::WithSpan;
 
-  opencensus::tags::TagMap tags_;
-  opencensus::trace::Span span_;
+  // Storage for the TagMap and Span owned by this Context.
+  opencensus::tags::TagMap owned_tags_;
+  opencensus::trace::Span owned_span_;
+
+  // The active TagMap and Span. These point either at the owned values above,
+  // or (for the thread-local Context) at the innermost WithTagMap or WithSpan
+  // on the current thread's stack. Installing and restoring a frame is a plain
+  // pointer store, so scope entry and exit never copy a TagMap or Span.
+  const opencensus::tags::TagMap* tags_;
+  const opencensus::trace::Span* span_;
 };
 
 }  // namespace context
@@ -41,8 +41,54 @@ thread_local ContextWrapper g_wrapper;
 }  // namespace
 
 Context::Context()
-    : tags_(opencensus::tags::TagMap({})),
-      span_(opencensus::trace::Span::BlankSpan()) {}
+    : owned_tags_(opencensus::tags::TagMap({})),
+      owned_span_(opencensus::trace::Span::BlankSpan()),
+      tags_(&owned_tags_),
+      span_(&owned_span_) {}
+
+Context::Context(const Context& other)
+    : owned_tags_(*other.tags_),
+      owned_span_(*other.span_),
+      tags_(&owned_tags_),
+      span_(&owned_span_) {}
+
+Context::Context(Context&& other)
+    : owned_tags_(other.tags_ == &other.owned_tags_
+                      ? std::move(other.owned_tags_)
+                      : *other.tags_),
+      owned_span_(other.span_ == &other.owned_span_
+                      ? std::move(other.owned_span_)
+                      : *other.span_),
+      tags_(&owned_tags_),
+      span_(&owned_span_) {}
+
+Context& Context::operator=(const Context& other) {
+  if (this != &other) {
+    owned_tags_ = *other.tags_;
+    owned_span_ = *other.span_;
+    tags_ = &owned_tags_;
+    span_ = &owned_span_;
+  }
+  return *this;
+}
+
+Context& Context::operator=(Context&& other) {
+  if (this != &other) {
+    if (other.tags_ == &other.owned_tags_) {
+      owned_tags_ = std::move(other.owned_tags_);
+    } else {
+      owned_tags_ = *other.tags_;
+    }
+    if (other.span_ == &other.owned_span_) {
+      owned_span_ = std::move(other.owned_span_);
+    } else {
+      owned_span_ = *other.span_;
+    }
+    tags_ = &owned_tags_;
+    span_ = &owned_span_;
+  }
+  return *this;
+}
 
 // static
 const Context& Context::Current() { return *InternalMutableCurrent(); }
@@ -57,17 +103,33 @@ std::function<void()> Context::Wrap(std::function<void()> fn) const {
 
 std::string Context::DebugString() const {
   return absl::StrCat("ctx@", absl::Hex(this),
-                      " span=", span_.context().ToString(),
-                      ", tags=", tags_.DebugString());
+                      " span=", span_->context().ToString(),
+                      ", tags=", tags_->DebugString());
 }
 
 // static
 Context* Context::InternalMutableCurrent() { return g_wrapper.get(); }
 
-void swap(Context& a, Context& b) {
+namespace {
+
+// Swaps the owned values of two Contexts along with the pointers to the active
+// values. A pointer that referred to its own Context's storage is redirected
+// to the storage it was swapped into; a pointer to an outside frame is kept.
+template <typename T>
+void SwapFrame(T* a_owned, const T** a_active, T* b_owned,
+               const T** b_active) {
   using std::swap;
-  swap(a.span_, b.span_);
-  swap(a.tags_, b.tags_);
+  swap(*a_owned, *b_owned);
+  const T* a_prev = *a_active;
+  *a_active = (*b_active == b_owned) ? a_owned : *b_active;
+  *b_active = (a_prev == a_owned) ? b_owned : a_prev;
+}
+
+}  // namespace
+
+void swap(Context& a, Context& b) {
+  SwapFrame(&a.owned_span_, &a.span_, &b.owned_span_, &b.span_);
+  SwapFrame(&a.owned_tags_, &a.tags_, &b.owned_tags_, &b.tags_);
 }
 
 }  // namespace context
@@ -19,6 +19,7 @@
 #include <thread>
 
 #include "gtest/gtest.h"
+#include "opencensus/context/with_context.h"
 #include "opencensus/tags/context_util.h"
 #include "opencensus/tags/tag_key.h"
 #include "opencensus/tags/tag_map.h"
@@ -100,6 +101,24 @@ TEST(ContextTest, ThreadDoesNotLeak) {
   span.End();
 }
 
+TEST(ContextTest, WithContextInsideWithSpan) {
+  auto span = opencensus::trace::Span::StartSpan("MySpan");
+  const opencensus::context::Context empty_ctx =
+      opencensus::context::Context::Current();
+  {
+    opencensus::tags::WithTagMap wt(ExampleTagMap());
+    opencensus::trace::WithSpan ws(span);
+    Callback1(span);
+    {
+      opencensus::context::WithContext wc(empty_ctx);
+      ExpectEmptyContext();
+    }
+    Callback1(span);
+  }
+  ExpectEmptyContext();
+  span.End();
+}
+
 TEST(ContextTest, WrappedFnIsCopiable) {
   std::function<void()> fn1, fn2;
   {
@@ -0,0 +1,244 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/exporters/stats/ocagent/internal/metrics_encoder.h"
+
+#include <cstdint>
+
+#include "absl/base/macros.h"
+#include "opencensus/common/internal/timestamp.h"
+
+namespace opencensus {
+namespace exporters {
+namespace stats {
+
+namespace {
+
+using ::opencensus::proto::metrics::v1::MetricDescriptor;
+
+MetricDescriptor::Type GetType(
+    const opencensus::stats::ViewDescriptor& descriptor) {
+  const bool is_int64 = descriptor.measure_descriptor().type() ==
+                        opencensus::stats::MeasureDescriptor::Type::kInt64;
+  switch (descriptor.aggregation().type()) {
+    case opencensus::stats::Aggregation::Type::kCount:
+      return MetricDescriptor::CUMULATIVE_INT64;
+    case opencensus::stats::Aggregation::Type::kSum:
+      return is_int64 ? MetricDescriptor::CUMULATIVE_INT64
+                      : MetricDescriptor::CUMULATIVE_DOUBLE;
+    case opencensus::stats::Aggregation::Type::kLastValue:
+      return is_int64 ? MetricDescriptor::GAUGE_INT64
+                      : MetricDescriptor::GAUGE_DOUBLE;
+    case opencensus::stats::Aggregation::Type::kDistribution:
+      return MetricDescriptor::CUMULATIVE_DISTRIBUTION;
+    case opencensus::stats::Aggregation::Type::kQuantiles:
+      return MetricDescriptor::SUMMARY;
+  }
+  ABSL_ASSERT(false && "Bad descriptor type.");
+  return MetricDescriptor::UNSPECIFIED;
+}
+
+void SetMetricDescriptor(const opencensus::stats::ViewDescriptor& descriptor,
+                         MetricDescriptor* proto) {
+  proto->set_name(descriptor.name());
+  proto->set_description(descriptor.description());
+  proto->set_unit(descriptor.aggregation() ==
+                          opencensus::stats::Aggregation::Count()
+                      ? "1"
+                      : descriptor.measure_descriptor().units());
+  proto->set_type(GetType(descriptor));
+  for (const auto& column : descriptor.columns()) {
+    proto->add_label_keys()->set_key(column.name());
+  }
+}
+
+// Overloaded function for converting ViewData values to Points. Sum
+// aggregation with an int64 measure returns doubles, which are exported as
+// int64s to match the MetricDescriptor.
+void SetPointValue(double value, MetricDescriptor::Type type,
+                   opencensus::proto::metrics::v1::Point* point) {
+  if (type == MetricDescriptor::CUMULATIVE_INT64 ||
+      type == MetricDescriptor::GAUGE_INT64) {
+    point->set_int64_value(static_cast<int64_t>(value));
+  } else {
+    point->set_double_value(value);
+  }
+}
+void SetPointValue(int64_t value, MetricDescriptor::Type type,
+                   opencensus::proto::metrics::v1::Point* point) {
+  point->set_int64_value(value);
+}
+void SetPointValue(const opencensus::stats::Distribution& value,
+                   MetricDescriptor::Type type,
+                   opencensus::proto::metrics::v1::Point* point) {
+  auto* distribution = point->mutable_distribution_value();
+  distribution->set_count(value.count());
+  distribution->set_sum(value.count() * value.mean());
+  distribution->set_sum_of_squared_deviation(value.sum_of_squared_deviation());
+  const auto& bounds = value.bucket_boundaries().lower_boundaries();
+  if (!bounds.empty()) {
+    auto* buckets = distribution->mutable_bucket_options()->mutable_explicit_();
+    for (const double bound : bounds) {
+      buckets->add_bounds(bound);
+    }
+    for (const auto bucket_count : value.bucket_counts()) {
+      distribution->add_buckets()->set_count(bucket_count);
+    }
+  }
+}
+// Only sketches need the aggregation, for the quantiles to export.
+template <typename DataValueT>
+void SetPointValue(const DataValueT& value, MetricDescriptor::Type type,
+                   const opencensus::stats::Aggregation& aggregation,
+                   opencensus::proto::metrics::v1::Point* point) {
+  SetPointValue(value, type, point);
+}
+void SetPointValue(const opencensus::stats::QuantileSketch& value,
+                   MetricDescriptor::Type type,
+                   const opencensus::stats::Aggregation& aggregation,
+                   opencensus::proto::metrics::v1::Point* point) {
+  auto* summary = point->mutable_summary_value();
+  summary->mutable_count()->set_value(value.count());
+  summary->mutable_sum()->set_value(value.sum());
+  // The snapshot covers the same values as the summary, which is cumulative
+  // or, for interval views, already limited to the interval.
+  auto* snapshot = summary->mutable_snapshot();
+  snapshot->mutable_count()->set_value(value.count());
+  snapshot->mutable_sum()->set_value(value.sum());
+  for (const double quantile : aggregation.quantiles()) {
+    auto* percentile = snapshot->add_percentile_values();
+    percentile->set_percentile(quantile * 100);
+    percentile->set_value(value.Quantile(quantile));
+  }
+}
+
+}  // namespace
+
+int MetricsEncoder::Encode(
+    const std::vector<std::pair<opencensus::stats::ViewDescriptor,
+                                opencensus::stats::ViewData>>& data,
+    opencensus::proto::agent::metrics::v1::ExportMetricsServiceRequest*
+        request) {
+  ++num_encodes_;
+  int num_rows = 0;
+  for (const auto& datum : data) {
+    const opencensus::stats::ViewDescriptor& descriptor = datum.first;
+    View& view = views_[descriptor.name()];
+    if (view.last_encode == 0 || view.descriptor != descriptor) {
+      // A new view, or one that was re-registered with another descriptor.
+      view.descriptor = descriptor;
+      view.metric_descriptor.Clear();
+      SetMetricDescriptor(descriptor, &view.metric_descriptor);
+      view.rows.clear();
+    }
+    view.last_encode = num_encodes_;
+
+    const opencensus::stats::ViewData& view_data = datum.second;
+    switch (view_data.type()) {
+      case opencensus::stats::ViewData::Type::kDouble:
+        num_rows +=
+            EncodeRows(view_data.double_data(), view_data, &view, request);
+        break;
+      case opencensus::stats::ViewData::Type::kInt64:
+        num_rows += EncodeRows(view_data.int_data(), view_data, &view, request);
+        break;
+      case opencensus::stats::ViewData::Type::kDistribution:
+        num_rows += EncodeRows(view_data.distribution_data(), view_data, &view,
+                               request);
+        break;
+      case opencensus::stats::ViewData::Type::kQuantiles:
+        num_rows +=
+            EncodeRows(view_data.quantile_data(), view_data, &view, request);
+        break;
+    }
+  }
+
+  // Forget views that are no longer exported.
+  if (views_.size() > data.size()) {
+    for (auto it = views_.begin(); it != views_.end();) {
+      if (it->second.last_encode != num_encodes_) {
+        it = views_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  return num_rows;
+}
+
+// static
+template <typename DataValueT>
+int MetricsEncoder::EncodeRows(
+    const opencensus::stats::ViewData::DataMap<DataValueT>& data,
+    const opencensus::stats::ViewData& view_data, View* view,
+    opencensus::proto::agent::metrics::v1::ExportMetricsServiceRequest*
+        request) {
+  const MetricDescriptor::Type type = view->metric_descriptor.type();
+  const bool is_gauge = type == MetricDescriptor::GAUGE_INT64 ||
+                        type == MetricDescriptor::GAUGE_DOUBLE;
+  const auto& start_times = view_data.start_times();
+  opencensus::proto::metrics::v1::Metric* metric = nullptr;
+  int num_rows = 0;
+  for (const auto& row : data) {
+    const auto start_time = start_times.find(row.first);
+    const Row encoded(start_time == start_times.end() ? absl::InfinitePast()
+                                                      : start_time->second,
+                      row.second);
+    const auto it = view->rows.find(row.first);
+    if (it == view->rows.end()) {
+      view->rows.emplace(row.first, encoded);
+    } else if (it->second == encoded) {
+      continue;
+    } else {
+      it->second = encoded;
+    }
+
+    if (metric == nullptr) {
+      metric = request->add_metrics();
+      *metric->mutable_metric_descriptor() = view->metric_descriptor;
+    }
+    auto* time_series = metric->add_timeseries();
+    // Gauges have no start time.
+    if (!is_gauge) {
+      opencensus::common::SetTimestamp(encoded.start_time,
+                                       time_series->mutable_start_timestamp());
+    }
+    for (const auto& tag_value : row.first) {
+      auto* label_value = time_series->add_label_values();
+      label_value->set_value(tag_value);
+      label_value->set_has_value(true);
+    }
+    auto* point = time_series->add_points();
+    opencensus::common::SetTimestamp(view_data.end_time(),
+                                     point->mutable_timestamp());
+    SetPointValue(row.second, type, view->descriptor.aggregation(), point);
+    ++num_rows;
+  }
+
+  // Forget rows that are no longer in the view.
+  if (view->rows.size() > data.size()) {
+    for (auto it = view->rows.begin(); it != view->rows.end();) {
+      if (data.find(it->first) == data.end()) {
+        it = view->rows.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  return num_rows;
+}
+
+}  // namespace stats
+}  // namespace exporters
+}  // namespace opencensus
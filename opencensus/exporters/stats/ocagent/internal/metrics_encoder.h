@@ -0,0 +1,108 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPENCENSUS_EXPORTERS_STATS_OCAGENT_INTERNAL_METRICS_ENCODER_H_
+#define OPENCENSUS_EXPORTERS_STATS_OCAGENT_INTERNAL_METRICS_ENCODER_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "opencensus/common/internal/string_vector_hash.h"
+#include "opencensus/proto/agent/metrics/v1/metrics_service.pb.h"
+#include "opencensus/proto/metrics/v1/metrics.pb.h"
+#include "opencensus/stats/stats.h"
+
+namespace opencensus {
+namespace exporters {
+namespace stats {
+
+// MetricsEncoder converts ViewData into OcAgent metrics. It remembers the last
+// value it encoded for each row, and leaves out rows that have not changed
+// since, so that steady-state exports only carry the rows that were recorded
+// to. 'data' may hold only the changed rows (see
+// StatsExporter::Handler::ExportChangedRowsOnly()); views left out of it are
+// forgotten, which costs nothing since their rows have not changed.
+//
+// MetricsEncoder is thread-compatible.
+class MetricsEncoder final {
+ public:
+  // Adds a Metric to 'request' for each view in 'data' with rows that changed
+  // since the last call, holding just those rows. Returns the number of
+  // TimeSeries added.
+  int Encode(const std::vector<std::pair<opencensus::stats::ViewDescriptor,
+                                         opencensus::stats::ViewData>>& data,
+             opencensus::proto::agent::metrics::v1::ExportMetricsServiceRequest*
+                 request);
+
+  // Forgets what was encoded, so that the next Encode() includes every row.
+  // Used when earlier requests may not have reached the agent.
+  void Reset() { views_.clear(); }
+
+ private:
+  // What was last encoded for a row. Distributions and sketches are compared
+  // by count and mean or sum, since any record changes the count.
+  struct Row {
+    Row(absl::Time start_time, double value)
+        : start_time(start_time), double_value(value) {}
+    Row(absl::Time start_time, int64_t value)
+        : start_time(start_time), int_value(value) {}
+    Row(absl::Time start_time, const opencensus::stats::Distribution& value)
+        : start_time(start_time),
+          int_value(value.count()),
+          double_value(value.mean()) {}
+    Row(absl::Time start_time, const opencensus::stats::QuantileSketch& value)
+        : start_time(start_time),
+          int_value(value.count()),
+          double_value(value.sum()) {}
+
+    bool operator==(const Row& other) const {
+      return start_time == other.start_time && int_value == other.int_value &&
+             double_value == other.double_value;
+    }
+
+    absl::Time start_time;
+    int64_t int_value = 0;
+    double double_value = 0;
+  };
+
+  struct View {
+    opencensus::stats::ViewDescriptor descriptor;
+    // Converted once, and copied into each Metric for the view.
+    opencensus::proto::metrics::v1::MetricDescriptor metric_descriptor;
+    std::unordered_map<std::vector<std::string>, Row, common::StringVectorHash>
+        rows;
+    // The value of num_encodes_ when the view was last encoded.
+    uint64_t last_encode = 0;
+  };
+
+  template <typename DataValueT>
+  static int EncodeRows(
+      const opencensus::stats::ViewData::DataMap<DataValueT>& data,
+      const opencensus::stats::ViewData& view_data, View* view,
+      opencensus::proto::agent::metrics::v1::ExportMetricsServiceRequest*
+          request);
+
+  uint64_t num_encodes_ = 0;
+  std::unordered_map<std::string, View> views_;
+};
+
+}  // namespace stats
+}  // namespace exporters
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_EXPORTERS_STATS_OCAGENT_INTERNAL_METRICS_ENCODER_H_
@@ -0,0 +1,197 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/exporters/stats/ocagent/internal/metrics_encoder.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "opencensus/stats/stats.h"
+#include "opencensus/stats/testing/test_utils.h"
+
+using opencensus::stats::testing::TestUtils;
+
+namespace opencensus {
+namespace exporters {
+namespace stats {
+namespace {
+
+using ::opencensus::proto::agent::metrics::v1::ExportMetricsServiceRequest;
+using ::opencensus::proto::metrics::v1::MetricDescriptor;
+
+using ViewDataVector = std::vector<
+    std::pair<opencensus::stats::ViewDescriptor, opencensus::stats::ViewData>>;
+
+opencensus::stats::ViewDescriptor SumDescriptor(absl::string_view name) {
+  static const auto measure = opencensus::stats::MeasureDouble::Register(
+      "ocagent_encoder_measure", "", "ms");
+  return opencensus::stats::ViewDescriptor()
+      .set_name(std::string(name))
+      .set_measure(measure.GetDescriptor().name())
+      .set_aggregation(opencensus::stats::Aggregation::Sum())
+      .add_column(opencensus::tags::TagKey::Register("key"));
+}
+
+// Returns the label values of each TimeSeries in 'metric', in order.
+std::vector<std::string> LabelValues(
+    const opencensus::proto::metrics::v1::Metric& metric) {
+  std::vector<std::string> values;
+  for (const auto& time_series : metric.timeseries()) {
+    values.push_back(time_series.label_values(0).value());
+  }
+  return values;
+}
+
+TEST(MetricsEncoderTest, EncodesDescriptorAndRows) {
+  const auto descriptor = SumDescriptor("view");
+  const ViewDataVector data = {
+      {descriptor, TestUtils::MakeViewData(descriptor, {{{"a"}, 1.5}})}};
+  MetricsEncoder encoder;
+  ExportMetricsServiceRequest request;
+  EXPECT_EQ(1, encoder.Encode(data, &request));
+
+  ASSERT_EQ(1, request.metrics_size());
+  const auto& metric = request.metrics(0);
+  EXPECT_EQ("view", metric.metric_descriptor().name());
+  EXPECT_EQ("ms", metric.metric_descriptor().unit());
+  EXPECT_EQ(MetricDescriptor::CUMULATIVE_DOUBLE,
+            metric.metric_descriptor().type());
+  ASSERT_EQ(1, metric.metric_descriptor().label_keys_size());
+  EXPECT_EQ("key", metric.metric_descriptor().label_keys(0).key());
+
+  ASSERT_EQ(1, metric.timeseries_size());
+  const auto& time_series = metric.timeseries(0);
+  EXPECT_EQ(absl::ToUnixSeconds(absl::UnixEpoch()),
+            time_series.start_timestamp().seconds());
+  ASSERT_EQ(1, time_series.label_values_size());
+  EXPECT_EQ("a", time_series.label_values(0).value());
+  EXPECT_TRUE(time_series.label_values(0).has_value());
+  ASSERT_EQ(1, time_series.points_size());
+  EXPECT_EQ(1.5, time_series.points(0).double_value());
+  EXPECT_EQ(absl::ToUnixSeconds(data[0].second.end_time()),
+            time_series.points(0).timestamp().seconds());
+}
+
+TEST(MetricsEncoderTest, OnlyEncodesChangedRows) {
+  const auto descriptor1 = SumDescriptor("view1");
+  const auto descriptor2 = SumDescriptor("view2");
+  MetricsEncoder encoder;
+  {
+    ExportMetricsServiceRequest request;
+    EXPECT_EQ(3, encoder.Encode(
+                     {{descriptor1, TestUtils::MakeViewData(
+                                        descriptor1, {{{"a"}, 1}, {{"b"}, 1}})},
+                      {descriptor2,
+                       TestUtils::MakeViewData(descriptor2, {{{"a"}, 1}})}},
+                     &request));
+    EXPECT_EQ(2, request.metrics_size());
+  }
+  {
+    // Only view1's row "b" changed.
+    ExportMetricsServiceRequest request;
+    EXPECT_EQ(1, encoder.Encode(
+                     {{descriptor1, TestUtils::MakeViewData(
+                                        descriptor1, {{{"a"}, 1}, {{"b"}, 2}})},
+                      {descriptor2,
+                       TestUtils::MakeViewData(descriptor2, {{{"a"}, 1}})}},
+                     &request));
+    ASSERT_EQ(1, request.metrics_size());
+    EXPECT_EQ("view1", request.metrics(0).metric_descriptor().name());
+    EXPECT_EQ(std::vector<std::string>({"b"}),
+              LabelValues(request.metrics(0)));
+  }
+  {
+    // Nothing changed.
+    ExportMetricsServiceRequest request;
+    EXPECT_EQ(0, encoder.Encode(
+                     {{descriptor1, TestUtils::MakeViewData(
+                                        descriptor1, {{{"a"}, 1}, {{"b"}, 2}})},
+                      {descriptor2,
+                       TestUtils::MakeViewData(descriptor2, {{{"a"}, 1}})}},
+                     &request));
+    EXPECT_EQ(0, request.metrics_size());
+  }
+}
+
+TEST(MetricsEncoderTest, ResetEncodesEveryRow) {
+  const auto descriptor = SumDescriptor("view");
+  const ViewDataVector data = {
+      {descriptor,
+       TestUtils::MakeViewData(descriptor, {{{"a"}, 1}, {{"b"}, 1}})}};
+  MetricsEncoder encoder;
+  ExportMetricsServiceRequest request;
+  EXPECT_EQ(2, encoder.Encode(data, &request));
+  request.Clear();
+  EXPECT_EQ(0, encoder.Encode(data, &request));
+  encoder.Reset();
+  EXPECT_EQ(2, encoder.Encode(data, &request));
+}
+
+TEST(MetricsEncoderTest, DistributionAndGauge) {
+  const auto measure = opencensus::stats::MeasureInt64::Register(
+      "ocagent_encoder_int_measure", "", "By");
+  const auto tag_key = opencensus::tags::TagKey::Register("key");
+  const auto distribution_descriptor =
+      opencensus::stats::ViewDescriptor()
+          .set_name("distribution")
+          .set_measure(measure.GetDescriptor().name())
+          .set_aggregation(opencensus::stats::Aggregation::Distribution(
+              opencensus::stats::BucketBoundaries::Explicit({0, 10})))
+          .add_column(tag_key);
+  const auto gauge_descriptor =
+      opencensus::stats::ViewDescriptor()
+          .set_name("gauge")
+          .set_measure(measure.GetDescriptor().name())
+          .set_aggregation(opencensus::stats::Aggregation::LastValue())
+          .add_column(tag_key);
+  MetricsEncoder encoder;
+  ExportMetricsServiceRequest request;
+  EXPECT_EQ(2, encoder.Encode(
+                   {{distribution_descriptor,
+                     TestUtils::MakeViewData(distribution_descriptor,
+                                             {{{"a"}, 5}, {{"a"}, 15}})},
+                    {gauge_descriptor,
+                     TestUtils::MakeViewData(gauge_descriptor, {{{"a"}, 7}})}},
+                   &request));
+  ASSERT_EQ(2, request.metrics_size());
+
+  const auto& distribution = request.metrics(0);
+  EXPECT_EQ(MetricDescriptor::CUMULATIVE_DISTRIBUTION,
+            distribution.metric_descriptor().type());
+  ASSERT_EQ(1, distribution.timeseries_size());
+  const auto& value = distribution.timeseries(0).points(0).distribution_value();
+  EXPECT_EQ(2, value.count());
+  EXPECT_EQ(20, value.sum());
+  EXPECT_EQ(50, value.sum_of_squared_deviation());
+  ASSERT_EQ(2, value.bucket_options().explicit_().bounds_size());
+  EXPECT_EQ(10, value.bucket_options().explicit_().bounds(1));
+  ASSERT_EQ(3, value.buckets_size());
+  EXPECT_EQ(0, value.buckets(0).count());
+  EXPECT_EQ(1, value.buckets(1).count());
+  EXPECT_EQ(1, value.buckets(2).count());
+
+  const auto& gauge = request.metrics(1);
+  EXPECT_EQ("By", gauge.metric_descriptor().unit());
+  EXPECT_EQ(MetricDescriptor::GAUGE_INT64, gauge.metric_descriptor().type());
+  ASSERT_EQ(1, gauge.timeseries_size());
+  EXPECT_FALSE(gauge.timeseries(0).has_start_timestamp());
+  EXPECT_EQ(7, gauge.timeseries(0).points(0).int64_value());
+}
+
+}  // namespace
+}  // namespace stats
+}  // namespace exporters
+}  // namespace opencensus
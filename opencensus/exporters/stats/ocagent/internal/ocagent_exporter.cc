@@ -0,0 +1,165 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/exporters/stats/ocagent/ocagent_exporter.h"
+
+#include <grpcpp/grpcpp.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "opencensus/common/internal/grpc/export_stream.h"
+#include "opencensus/common/internal/grpc/with_user_agent.h"
+#include "opencensus/common/internal/hostname.h"
+#include "opencensus/common/internal/timestamp.h"
+#include "opencensus/common/version.h"
+#include "opencensus/exporters/stats/ocagent/internal/metrics_encoder.h"
+#include "opencensus/proto/agent/metrics/v1/metrics_service.pb.h"
+#include "opencensus/stats/stats.h"
+
+namespace opencensus {
+namespace exporters {
+namespace stats {
+namespace {
+
+using ::opencensus::proto::agent::metrics::v1::ExportMetricsServiceRequest;
+using ::opencensus::proto::agent::metrics::v1::ExportMetricsServiceResponse;
+using ::opencensus::proto::agent::metrics::v1::MetricsService;
+
+using ExportStream =
+    ::opencensus::common::ExportStream<MetricsService::StubInterface,
+                                       ExportMetricsServiceRequest,
+                                       ExportMetricsServiceResponse>;
+
+class Handler : public ::opencensus::stats::StatsExporter::Handler {
+ public:
+  explicit Handler(OcAgentOptions&& opts);
+
+  void ExportViewData(
+      const std::vector<std::pair<opencensus::stats::ViewDescriptor,
+                                  opencensus::stats::ViewData>>& data) override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // The encoder leaves out unchanged rows anyway, so it only needs the changed
+  // ones, except to resend everything.
+  bool ExportChangedRowsOnly() const override { return true; }
+  bool NeedsAllRows() override ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  ExportMetricsServiceRequest MakeHeader() const;
+
+  // Resets encoder_ and sets needs_all_rows_ if the stream was reopened since
+  // the last check, in case the agent lost anything written to the old stream.
+  void CheckStreamLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const OcAgentOptions opts_;
+  std::unique_ptr<ExportStream> stream_;
+
+  absl::Mutex mu_;
+  MetricsEncoder encoder_ ABSL_GUARDED_BY(mu_);
+  // stream_->num_streams() as of the last export.
+  int num_streams_ ABSL_GUARDED_BY(mu_) = 0;
+  // Whether the next export needs every row, to resend rows that were lost.
+  bool needs_all_rows_ ABSL_GUARDED_BY(mu_) = false;
+};
+
+Handler::Handler(OcAgentOptions&& opts) : opts_(std::move(opts)) {
+  stream_ = absl::make_unique<ExportStream>(
+      opts_.metrics_service_stub.get(), MakeHeader(), "OcAgent stats exporter",
+      opts_.initial_backoff, opts_.max_backoff, opts_.max_queued_requests);
+}
+
+void Handler::ExportViewData(
+    const std::vector<std::pair<opencensus::stats::ViewDescriptor,
+                                opencensus::stats::ViewData>>& data) {
+  absl::MutexLock l(&mu_);
+  // If the stream was reopened since NeedsAllRows(), 'data' only holds the
+  // changed rows; the rest follow in the next export.
+  CheckStreamLocked();
+  ExportMetricsServiceRequest request;
+  const int num_rows = encoder_.Encode(data, &request);
+  if (num_rows == 0) {
+    return;
+  }
+  if (!stream_->Send(std::move(request))) {
+    std::cerr << "OcAgent stats exporter: dropped " << num_rows
+              << " rows, too many requests waiting to be sent.\n";
+    encoder_.Reset();
+    needs_all_rows_ = true;
+  }
+}
+
+bool Handler::NeedsAllRows() {
+  absl::MutexLock l(&mu_);
+  CheckStreamLocked();
+  const bool needs_all_rows = needs_all_rows_;
+  needs_all_rows_ = false;
+  return needs_all_rows;
+}
+
+void Handler::CheckStreamLocked() {
+  const int num_streams = stream_->num_streams();
+  if (num_streams != num_streams_) {
+    num_streams_ = num_streams;
+    encoder_.Reset();
+    needs_all_rows_ = true;
+  }
+}
+
+ExportMetricsServiceRequest Handler::MakeHeader() const {
+  ExportMetricsServiceRequest header;
+  auto* node = header.mutable_node();
+
+  auto* identifier = node->mutable_identifier();
+  identifier->set_host_name(::opencensus::common::Hostname());
+  identifier->set_pid(getpid());
+  opencensus::common::SetTimestamp(absl::Now(),
+                                   identifier->mutable_start_timestamp());
+
+  auto* library_info = node->mutable_library_info();
+  library_info->set_language(
+      ::opencensus::proto::agent::common::v1::LibraryInfo_Language_CPP);
+  library_info->set_exporter_version(OPENCENSUS_VERSION);
+  library_info->set_core_library_version(OPENCENSUS_VERSION);
+
+  if (!opts_.service_name.empty()) {
+    node->mutable_service_info()->set_name(opts_.service_name);
+  }
+  return header;
+}
+
+}  // namespace
+
+// static
+void OcAgentExporter::Register(OcAgentOptions&& opts) {
+  if (opts.metrics_service_stub == nullptr) {
+    auto channel = grpc::CreateCustomChannel(
+        opts.address, grpc::InsecureChannelCredentials(),
+        ::opencensus::common::WithUserAgent());
+    opts.metrics_service_stub = MetricsService::NewStub(channel);
+  }
+  opencensus::stats::StatsExporter::RegisterPushHandler(
+      absl::make_unique<Handler>(std::move(opts)));
+}
+
+}  // namespace stats
+}  // namespace exporters
+}  // namespace opencensus
@@ -0,0 +1,68 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPENCENSUS_EXPORTERS_STATS_OCAGENT_OCAGENT_EXPORTER_H_
+#define OPENCENSUS_EXPORTERS_STATS_OCAGENT_OCAGENT_EXPORTER_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/time/time.h"
+#include "opencensus/proto/agent/metrics/v1/metrics_service.grpc.pb.h"
+
+namespace opencensus {
+namespace exporters {
+namespace stats {
+
+struct OcAgentOptions {
+  // The OcAgent address to use.
+  std::string address;
+
+  // If the Export stream breaks, it is reopened after initial_backoff, which
+  // doubles after each failed attempt up to max_backoff.
+  absl::Duration initial_backoff = absl::Milliseconds(100);
+  absl::Duration max_backoff = absl::Seconds(30);
+
+  // The maximum number of exports waiting to be written to the stream.
+  // Exports made while this many are waiting are dropped.
+  int max_queued_requests = 4;
+
+  // (optional) If not empty, set the service name to this.
+  std::string service_name;
+
+  // (optional) By default, the exporter connects to OcAgent using address. If
+  // this stub is non-null, the exporter will use this stub to send
+  // gRPC calls instead and ignore the address. Useful for testing.
+  std::unique_ptr<
+      opencensus::proto::agent::metrics::v1::MetricsService::StubInterface>
+      metrics_service_stub;
+};
+
+// Exports views to OcAgent as metrics. Each export only includes the rows that
+// changed since the previous one, and all exports are written to one
+// long-lived Export stream.
+class OcAgentExporter {
+ public:
+  // Registers the exporter.
+  static void Register(OcAgentOptions&& opts);
+
+ private:
+  OcAgentExporter() = delete;
+};
+
+}  // namespace stats
+}  // namespace exporters
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_EXPORTERS_STATS_OCAGENT_OCAGENT_EXPORTER_H_
@@ -14,9 +14,12 @@
 
 #include "opencensus/exporters/stats/prometheus/prometheus_exporter.h"
 
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
 #include "opencensus/exporters/stats/prometheus/internal/prometheus_utils.h"
 #include "opencensus/stats/stats.h"
 #include "prometheus/metric_family.h"
@@ -25,13 +28,21 @@ namespace opencensus {
 namespace exporters {
 namespace stats {
 
+PrometheusExporter::PrometheusExporter()
+    : collector_(absl::make_unique<PrometheusCollector>()) {}
+
+PrometheusExporter::~PrometheusExporter() = default;
+
 std::vector<prometheus::MetricFamily> PrometheusExporter::Collect() const {
   const auto data = opencensus::stats::StatsExporter::GetViewData();
-  std::vector<prometheus::MetricFamily> output(data.size());
-  for (int i = 0; i < data.size(); ++i) {
-    SetMetricFamily(data[i].first, data[i].second, &output[i]);
-  }
-  return output;
+  absl::MutexLock l(&mu_);
+  return collector_->Collect(data);
+}
+
+void PrometheusExporter::WriteText(std::string* out) const {
+  const auto data = opencensus::stats::StatsExporter::GetViewData();
+  absl::MutexLock l(&mu_);
+  collector_->WriteText(data, out);
 }
 
 }  // namespace stats
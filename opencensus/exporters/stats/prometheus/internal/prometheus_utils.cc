@@ -15,7 +15,10 @@
 #include "opencensus/exporters/stats/prometheus/internal/prometheus_utils.h"
 
 #include <cctype>
+#include <cmath>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <limits>
 #include <string>
 #include <utility>
@@ -53,6 +56,8 @@ prometheus::MetricType MetricType(opencensus::stats::Aggregation::Type type) {
       return prometheus::MetricType::Gauge;
     case opencensus::stats::Aggregation::Type::kDistribution:
       return prometheus::MetricType::Histogram;
+    case opencensus::stats::Aggregation::Type::kQuantiles:
+      return prometheus::MetricType::Summary;
   }
   ABSL_ASSERT(false && "Bad MetricType.");
   return prometheus::MetricType::Untyped;
@@ -110,55 +115,373 @@ void SetValue(const opencensus::stats::Distribution& value,
   }
 }
 
-template <typename T>
-void SetData(const opencensus::stats::ViewDescriptor& descriptor,
-             const opencensus::stats::ViewData::DataMap<T>& data, int64_t time,
-             prometheus::MetricType type,
-             prometheus::MetricFamily* metric_family) {
-  metric_family->metric.reserve(data.size());
-  for (const auto& row : data) {
-    metric_family->metric.emplace_back();
-    prometheus::ClientMetric& metric = metric_family->metric.back();
-    metric.timestamp_ms = time;
-    metric.label.resize(descriptor.num_columns());
-    for (int i = 0; i < descriptor.num_columns(); ++i) {
-      metric.label[i].name = SanitizeName(descriptor.columns()[i].name());
-      metric.label[i].value = row.first[i];
-    }
-    SetValue(row.second, type, &metric);
+void SetValue(const opencensus::stats::QuantileSketch& value,
+              const std::vector<double>& quantiles,
+              prometheus::ClientMetric* metric) {
+  auto& summary = metric->summary;
+  summary.sample_count = value.count();
+  summary.sample_sum = value.sum();
+  summary.quantile.resize(quantiles.size());
+  for (int i = 0; i < quantiles.size(); ++i) {
+    summary.quantile[i].quantile = quantiles[i];
+    summary.quantile[i].value = value.Quantile(quantiles[i]);
   }
 }
 
-}  // namespace
+std::vector<std::string> LabelNames(
+    const opencensus::stats::ViewDescriptor& descriptor) {
+  std::vector<std::string> label_names;
+  label_names.reserve(descriptor.num_columns());
+  for (const auto& column : descriptor.columns()) {
+    label_names.push_back(SanitizeName(column.name()));
+  }
+  return label_names;
+}
 
-void SetMetricFamily(const opencensus::stats::ViewDescriptor& descriptor,
-                     const opencensus::stats::ViewData& data,
+// Sets the fields of metric_family that depend only on the descriptor.
+void SetFamilyHeader(const opencensus::stats::ViewDescriptor& descriptor,
                      prometheus::MetricFamily* metric_family) {
-  const prometheus::MetricType type =
-      MetricType(descriptor.aggregation().type());
   // TODO(sturdy): convert common units into base units (e.g. ms->s).
   metric_family->name = SanitizeName(absl::StrCat(
       descriptor.name(), "_", descriptor.measure_descriptor().units()));
   metric_family->help = descriptor.description();
-  metric_family->type = type;
+  metric_family->type = MetricType(descriptor.aggregation().type());
+}
+
+// Appends a metric with the labels of a row to metric_family.
+prometheus::ClientMetric* AddMetric(const std::vector<std::string>& label_names,
+                                    const std::vector<std::string>& tag_values,
+                                    int64_t time,
+                                    prometheus::MetricFamily* metric_family) {
+  metric_family->metric.emplace_back();
+  prometheus::ClientMetric& metric = metric_family->metric.back();
+  metric.timestamp_ms = time;
+  metric.label.resize(label_names.size());
+  for (int i = 0; i < label_names.size(); ++i) {
+    metric.label[i].name = label_names[i];
+    metric.label[i].value = tag_values[i];
+  }
+  return &metric;
+}
+
+template <typename T>
+void SetData(const std::vector<std::string>& label_names,
+             const opencensus::stats::ViewData::DataMap<T>& data, int64_t time,
+             prometheus::MetricType type,
+             prometheus::MetricFamily* metric_family) {
+  metric_family->metric.reserve(data.size());
+  for (const auto& row : data) {
+    SetValue(row.second, type,
+             AddMetric(label_names, row.first, time, metric_family));
+  }
+}
 
+void SetQuantileData(
+    const std::vector<std::string>& label_names,
+    const opencensus::stats::ViewData::DataMap<
+        opencensus::stats::QuantileSketch>& data,
+    const std::vector<double>& quantiles, int64_t time,
+    prometheus::MetricFamily* metric_family) {
+  metric_family->metric.reserve(data.size());
+  for (const auto& row : data) {
+    SetValue(row.second, quantiles,
+             AddMetric(label_names, row.first, time, metric_family));
+  }
+}
+
+void SetMetrics(const std::vector<std::string>& label_names,
+                const opencensus::stats::ViewData& data,
+                prometheus::MetricFamily* metric_family) {
+  const prometheus::MetricType type = metric_family->type;
   const int64_t time = absl::ToUnixMillis(data.end_time());
   switch (data.type()) {
     case opencensus::stats::ViewData::Type::kDouble: {
-      SetData(descriptor, data.double_data(), time, type, metric_family);
+      SetData(label_names, data.double_data(), time, type, metric_family);
       break;
     }
     case opencensus::stats::ViewData::Type::kInt64: {
-      SetData(descriptor, data.int_data(), time, type, metric_family);
+      SetData(label_names, data.int_data(), time, type, metric_family);
       break;
     }
     case opencensus::stats::ViewData::Type::kDistribution: {
-      SetData(descriptor, data.distribution_data(), time, type, metric_family);
+      SetData(label_names, data.distribution_data(), time, type,
+              metric_family);
+      break;
+    }
+    case opencensus::stats::ViewData::Type::kQuantiles: {
+      SetQuantileData(label_names, data.quantile_data(),
+                      data.aggregation().quantiles(), time, metric_family);
       break;
     }
   }
 }
 
+// Text exposition format.
+
+absl::string_view TypeName(prometheus::MetricType type) {
+  switch (type) {
+    case prometheus::MetricType::Counter:
+      return "counter";
+    case prometheus::MetricType::Gauge:
+      return "gauge";
+    case prometheus::MetricType::Summary:
+      return "summary";
+    case prometheus::MetricType::Untyped:
+      return "untyped";
+    case prometheus::MetricType::Histogram:
+      return "histogram";
+  }
+  ABSL_ASSERT(false && "Bad MetricType.");
+  return "untyped";
+}
+
+// Escapes backslashes and newlines, and if escape_quotes, double quotes.
+void AppendEscaped(absl::string_view value, bool escape_quotes,
+                   std::string* out) {
+  for (const char c : value) {
+    if (c == '\\') {
+      out->append("\\\\");
+    } else if (c == '\n') {
+      out->append("\\n");
+    } else if (c == '"' && escape_quotes) {
+      out->append("\\\"");
+    } else {
+      out->push_back(c);
+    }
+  }
+}
+
+void AppendDouble(double value, std::string* out) {
+  if (std::isnan(value)) {
+    out->append("NaN");
+  } else if (std::isinf(value)) {
+    out->append(value > 0 ? "+Inf" : "-Inf");
+  } else if (value == std::trunc(value) && std::abs(value) < 1e15) {
+    // Integral values, like most counts and sums, are formatted exactly.
+    absl::StrAppend(out, static_cast<int64_t>(value));
+  } else {
+    // Use the shortest of 15 or 17 significant digits that round-trips.
+    char buffer[32];
+    int size = snprintf(buffer, sizeof(buffer), "%.15g", value);
+    if (strtod(buffer, nullptr) != value) {
+      size = snprintf(buffer, sizeof(buffer), "%.17g", value);
+    }
+    out->append(buffer, size);
+  }
+}
+
+// Appends name+suffix, with 'labels' and a 'bound_name' label (e.g. "le" or
+// "quantile") of value 'bound' if not empty.
+void AppendSeries(absl::string_view name, absl::string_view suffix,
+                  absl::string_view labels, absl::string_view bound_name,
+                  absl::string_view bound, std::string* out) {
+  absl::StrAppend(out, name, suffix);
+  if (!labels.empty() || !bound.empty()) {
+    out->push_back('{');
+    out->append(labels.data(), labels.size());
+    if (!bound.empty()) {
+      if (!labels.empty()) {
+        out->push_back(',');
+      }
+      absl::StrAppend(out, bound_name, "=\"", bound, "\"");
+    }
+    out->push_back('}');
+  }
+  out->push_back(' ');
+}
+
+// Overloaded function for appending the samples of a row. 'time' holds the
+// timestamp and the line ending.
+void AppendRow(absl::string_view name, absl::string_view labels, double value,
+               absl::string_view time, std::string* out) {
+  AppendSeries(name, "", labels, "", "", out);
+  AppendDouble(value, out);
+  out->append(time.data(), time.size());
+}
+
+void AppendRow(absl::string_view name, absl::string_view labels,
+               int64_t value, absl::string_view time, std::string* out) {
+  AppendSeries(name, "", labels, "", "", out);
+  absl::StrAppend(out, value, time);
+}
+
+void AppendRow(absl::string_view name, absl::string_view labels,
+               const opencensus::stats::Distribution& value,
+               absl::string_view time, std::string* out) {
+  AppendSeries(name, "_count", labels, "", "", out);
+  absl::StrAppend(out, value.count(), time);
+  AppendSeries(name, "_sum", labels, "", "", out);
+  AppendDouble(value.count() * value.mean(), out);
+  out->append(time.data(), time.size());
+
+  // As in SetValue(), lower boundaries become upper boundaries.
+  const auto& boundaries = value.bucket_boundaries().lower_boundaries();
+  std::string le;
+  int64_t cumulative_count = 0;
+  for (int i = 0; i < value.bucket_boundaries().num_buckets(); ++i) {
+    cumulative_count += value.bucket_counts()[i];
+    le.clear();
+    if (i < boundaries.size()) {
+      AppendDouble(boundaries[i], &le);
+    } else {
+      le = "+Inf";
+    }
+    AppendSeries(name, "_bucket", labels, "le", le, out);
+    absl::StrAppend(out, cumulative_count, time);
+  }
+}
+
+void AppendRow(absl::string_view name, absl::string_view labels,
+               const opencensus::stats::QuantileSketch& value,
+               const std::vector<double>& quantiles, absl::string_view time,
+               std::string* out) {
+  std::string quantile;
+  for (double q : quantiles) {
+    quantile.clear();
+    AppendDouble(q, &quantile);
+    AppendSeries(name, "", labels, "quantile", quantile, out);
+    AppendDouble(value.Quantile(q), out);
+    out->append(time.data(), time.size());
+  }
+  AppendSeries(name, "_sum", labels, "", "", out);
+  AppendDouble(value.sum(), out);
+  out->append(time.data(), time.size());
+  AppendSeries(name, "_count", labels, "", "", out);
+  absl::StrAppend(out, value.count(), time);
+}
+
+// Sets *labels to the label pairs of the row with 'tag_values'.
+void SetLabels(const std::vector<std::string>& label_names,
+               const std::vector<std::string>& tag_values,
+               std::string* labels) {
+  labels->clear();
+  for (int i = 0; i < label_names.size(); ++i) {
+    if (i > 0) {
+      labels->push_back(',');
+    }
+    absl::StrAppend(labels, label_names[i], "=\"");
+    AppendEscaped(tag_values[i], /*escape_quotes=*/true, labels);
+    labels->push_back('"');
+  }
+}
+
+template <typename T>
+void AppendRows(absl::string_view name,
+                const std::vector<std::string>& label_names,
+                const opencensus::stats::ViewData::DataMap<T>& data,
+                absl::string_view time, std::string* out) {
+  // Reused across rows.
+  std::string labels;
+  for (const auto& row : data) {
+    SetLabels(label_names, row.first, &labels);
+    AppendRow(name, labels, row.second, time, out);
+  }
+}
+
+void AppendQuantileRows(absl::string_view name,
+                        const std::vector<std::string>& label_names,
+                        const opencensus::stats::ViewData::DataMap<
+                            opencensus::stats::QuantileSketch>& data,
+                        const std::vector<double>& quantiles,
+                        absl::string_view time, std::string* out) {
+  std::string labels;
+  for (const auto& row : data) {
+    SetLabels(label_names, row.first, &labels);
+    AppendRow(name, labels, row.second, quantiles, time, out);
+  }
+}
+
+}  // namespace
+
+void SetMetricFamily(const opencensus::stats::ViewDescriptor& descriptor,
+                     const opencensus::stats::ViewData& data,
+                     prometheus::MetricFamily* metric_family) {
+  SetFamilyHeader(descriptor, metric_family);
+  SetMetrics(LabelNames(descriptor), data, metric_family);
+}
+
+std::vector<prometheus::MetricFamily> PrometheusCollector::Collect(
+    const ViewDataVector& data) {
+  ++num_collections_;
+  std::vector<prometheus::MetricFamily> output(data.size());
+  for (int i = 0; i < data.size(); ++i) {
+    const View& view = GetView(data[i].first);
+    output[i].name = view.family.name;
+    output[i].help = view.family.help;
+    output[i].type = view.family.type;
+    SetMetrics(view.label_names, data[i].second, &output[i]);
+  }
+  EvictStaleViews(data.size());
+  return output;
+}
+
+void PrometheusCollector::WriteText(const ViewDataVector& data,
+                                    std::string* out) {
+  ++num_collections_;
+  for (const auto& datum : data) {
+    const View& view = GetView(datum.first);
+    out->append(view.text_header);
+    const opencensus::stats::ViewData& view_data = datum.second;
+    const std::string time =
+        absl::StrCat(" ", absl::ToUnixMillis(view_data.end_time()), "\n");
+    switch (view_data.type()) {
+      case opencensus::stats::ViewData::Type::kDouble: {
+        AppendRows(view.family.name, view.label_names, view_data.double_data(),
+                   time, out);
+        break;
+      }
+      case opencensus::stats::ViewData::Type::kInt64: {
+        AppendRows(view.family.name, view.label_names, view_data.int_data(),
+                   time, out);
+        break;
+      }
+      case opencensus::stats::ViewData::Type::kDistribution: {
+        AppendRows(view.family.name, view.label_names,
+                   view_data.distribution_data(), time, out);
+        break;
+      }
+      case opencensus::stats::ViewData::Type::kQuantiles: {
+        AppendQuantileRows(view.family.name, view.label_names,
+                           view_data.quantile_data(),
+                           view_data.aggregation().quantiles(), time, out);
+        break;
+      }
+    }
+  }
+  EvictStaleViews(data.size());
+}
+
+const PrometheusCollector::View& PrometheusCollector::GetView(
+    const opencensus::stats::ViewDescriptor& descriptor) {
+  View& view = views_[descriptor.name()];
+  if (view.last_collection == 0 || view.descriptor != descriptor) {
+    view.descriptor = descriptor;
+    SetFamilyHeader(descriptor, &view.family);
+    view.label_names = LabelNames(descriptor);
+    view.text_header.clear();
+    absl::StrAppend(&view.text_header, "# HELP ", view.family.name, " ");
+    AppendEscaped(view.family.help, /*escape_quotes=*/false,
+                  &view.text_header);
+    absl::StrAppend(&view.text_header, "\n# TYPE ", view.family.name, " ",
+                    TypeName(view.family.type), "\n");
+  }
+  view.last_collection = num_collections_;
+  return view;
+}
+
+void PrometheusCollector::EvictStaleViews(size_t num_views) {
+  if (views_.size() <= num_views) {
+    return;
+  }
+  for (auto it = views_.begin(); it != views_.end();) {
+    if (it->second.last_collection != num_collections_) {
+      it = views_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
 }  // namespace stats
 }  // namespace exporters
 }  // namespace opencensus
@@ -15,6 +15,9 @@
 #ifndef OPENCENSUS_EXPORTERS_STATS_PROMETHEUS_INTERNAL_PROMETHEUS_UTILS_H_
 #define OPENCENSUS_EXPORTERS_STATS_PROMETHEUS_INTERNAL_PROMETHEUS_UTILS_H_
 
+#include <cstdint>
+#include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -30,6 +33,49 @@ void SetMetricFamily(const opencensus::stats::ViewDescriptor& descriptor,
                      const opencensus::stats::ViewData& data,
                      prometheus::MetricFamily* metric_family);
 
+// PrometheusCollector converts views to Prometheus metrics. Unlike
+// SetMetricFamily(), it derives the metric name, label names, help and type of
+// each view only when the view's descriptor changes, rather than on every
+// collection. WriteText() writes the text exposition format straight from the
+// ViewData, without building MetricFamilies.
+//
+// PrometheusCollector is thread-compatible.
+class PrometheusCollector final {
+ public:
+  using ViewDataVector =
+      std::vector<std::pair<opencensus::stats::ViewDescriptor,
+                            opencensus::stats::ViewData>>;
+
+  // Returns a MetricFamily for each view in 'data', the same as calling
+  // SetMetricFamily() for each.
+  std::vector<prometheus::MetricFamily> Collect(const ViewDataVector& data);
+
+  // Appends the text exposition format of 'data' to *out. Callers serving
+  // repeated scrapes can reuse *out to keep its capacity.
+  void WriteText(const ViewDataVector& data, std::string* out);
+
+ private:
+  struct View {
+    opencensus::stats::ViewDescriptor descriptor;
+    // The name, help and type, with no metrics.
+    prometheus::MetricFamily family;
+    std::vector<std::string> label_names;
+    // The HELP and TYPE lines of the text format.
+    std::string text_header;
+    // The value of num_collections_ when the view was last collected.
+    uint64_t last_collection = 0;
+  };
+
+  // Returns the View for 'descriptor', rebuilding it if the descriptor
+  // changed.
+  const View& GetView(const opencensus::stats::ViewDescriptor& descriptor);
+  // Forgets views that were not in the latest collection.
+  void EvictStaleViews(size_t num_views);
+
+  std::unordered_map<std::string, View> views_;
+  uint64_t num_collections_ = 0;
+};
+
 }  // namespace stats
 }  // namespace exporters
 }  // namespace opencensus
@@ -0,0 +1,100 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "opencensus/exporters/stats/prometheus/internal/prometheus_utils.h"
+#include "opencensus/stats/stats.h"
+#include "opencensus/stats/testing/test_utils.h"
+
+namespace opencensus {
+namespace exporters {
+namespace stats {
+namespace {
+
+// Makes state.range(0) views, each with state.range(1) rows.
+PrometheusCollector::ViewDataVector MakeData(benchmark::State& state) {
+  static const auto measure = opencensus::stats::MeasureDouble::Register(
+      "prometheus_benchmark_measure", "", "ms");
+  const auto key1 = opencensus::tags::TagKey::Register("method.name");
+  const auto key2 = opencensus::tags::TagKey::Register("status.code");
+  PrometheusCollector::ViewDataVector data;
+  for (int i = 0; i < state.range(0); ++i) {
+    const auto descriptor =
+        opencensus::stats::ViewDescriptor()
+            .set_name(absl::StrCat("example.com/view/", i))
+            .set_measure(measure.GetDescriptor().name())
+            .set_aggregation(opencensus::stats::Aggregation::Sum())
+            .add_column(key1)
+            .add_column(key2)
+            .set_description("A view.");
+    std::vector<opencensus::stats::testing::TestViewValue> values(
+        state.range(1));
+    for (int j = 0; j < values.size(); ++j) {
+      values[j].tag_values = {absl::StrCat("method", j / 10),
+                              absl::StrCat("code", j % 10)};
+      values[j].value = j;
+    }
+    data.emplace_back(
+        descriptor,
+        opencensus::stats::testing::TestUtils::MakeViewDataWithStartTimes(
+            descriptor, values));
+  }
+  return data;
+}
+
+void BM_SetMetricFamily(benchmark::State& state) {
+  const auto data = MakeData(state);
+  for (auto _ : state) {
+    std::vector<prometheus::MetricFamily> output(data.size());
+    for (int i = 0; i < data.size(); ++i) {
+      SetMetricFamily(data[i].first, data[i].second, &output[i]);
+    }
+    benchmark::DoNotOptimize(output);
+  }
+}
+BENCHMARK(BM_SetMetricFamily)->Args({1, 1000})->Args({30, 1000});
+
+void BM_CollectorCollect(benchmark::State& state) {
+  const auto data = MakeData(state);
+  PrometheusCollector collector;
+  for (auto _ : state) {
+    auto output = collector.Collect(data);
+    benchmark::DoNotOptimize(output);
+  }
+}
+BENCHMARK(BM_CollectorCollect)->Args({1, 1000})->Args({30, 1000});
+
+void BM_CollectorWriteText(benchmark::State& state) {
+  const auto data = MakeData(state);
+  PrometheusCollector collector;
+  std::string text;
+  for (auto _ : state) {
+    text.clear();
+    collector.WriteText(data, &text);
+    benchmark::DoNotOptimize(text);
+  }
+}
+BENCHMARK(BM_CollectorWriteText)->Args({1, 1000})->Args({30, 1000});
+
+}  // namespace
+}  // namespace stats
+}  // namespace exporters
+}  // namespace opencensus
+
+BENCHMARK_MAIN();
@@ -18,6 +18,7 @@
 #include <string>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "opencensus/stats/stats.h"
@@ -565,6 +566,209 @@ TEST(StackdriverUtilsTest, MakeTimeSeriesDistributionDouble) {
                                                   infinity())))))))))));
 }
 
+TEST(PrometheusCollectorTest, CollectMatchesSetMetricFamily) {
+  const auto measure = opencensus::stats::MeasureDouble::Register(
+      "measure_collector_collect", "", "units");
+  const auto view_descriptor =
+      opencensus::stats::ViewDescriptor()
+          .set_name("collector/view")
+          .set_measure(measure.GetDescriptor().name())
+          .set_aggregation(opencensus::stats::Aggregation::Sum())
+          .add_column(opencensus::tags::TagKey::Register("foo.bar"))
+          .set_description("description");
+  const opencensus::stats::ViewData data =
+      TestUtils::MakeViewData(view_descriptor, {{{"v1"}, 1.5}});
+  prometheus::MetricFamily expected;
+  SetMetricFamily(view_descriptor, data, &expected);
+
+  PrometheusCollector collector;
+  for (int i = 0; i < 2; ++i) {
+    const std::vector<prometheus::MetricFamily> actual =
+        collector.Collect({{view_descriptor, data}});
+    ASSERT_EQ(1, actual.size());
+    EXPECT_EQ("collector_view_units", actual[0].name);
+    EXPECT_EQ(expected.name, actual[0].name);
+    EXPECT_EQ(expected.help, actual[0].help);
+    EXPECT_EQ(expected.type, actual[0].type);
+    ASSERT_EQ(1, actual[0].metric.size());
+    ASSERT_EQ(1, actual[0].metric[0].label.size());
+    EXPECT_EQ("foo_bar", actual[0].metric[0].label[0].name);
+    EXPECT_EQ("v1", actual[0].metric[0].label[0].value);
+    EXPECT_EQ(1.5, actual[0].metric[0].untyped.value);
+    EXPECT_EQ(expected.metric[0].timestamp_ms,
+              actual[0].metric[0].timestamp_ms);
+  }
+}
+
+TEST(PrometheusCollectorTest, UpdatesChangedDescriptor) {
+  const auto measure = opencensus::stats::MeasureDouble::Register(
+      "measure_collector_changed", "", "units");
+  const auto view_descriptor_1 =
+      opencensus::stats::ViewDescriptor()
+          .set_name("collector_changed")
+          .set_measure(measure.GetDescriptor().name())
+          .set_aggregation(opencensus::stats::Aggregation::Count());
+  const auto view_descriptor_2 =
+      opencensus::stats::ViewDescriptor(view_descriptor_1)
+          .set_aggregation(opencensus::stats::Aggregation::LastValue());
+  PrometheusCollector collector;
+  EXPECT_EQ(prometheus::MetricType::Counter,
+            collector
+                .Collect({{view_descriptor_1,
+                           TestUtils::MakeViewData(view_descriptor_1, {})}})[0]
+                .type);
+  EXPECT_EQ(prometheus::MetricType::Gauge,
+            collector
+                .Collect({{view_descriptor_2,
+                           TestUtils::MakeViewData(view_descriptor_2, {})}})[0]
+                .type);
+}
+
+TEST(PrometheusCollectorTest, WriteTextCount) {
+  const auto measure = opencensus::stats::MeasureDouble::Register(
+      "measure_collector_text_count", "", "units");
+  const auto view_descriptor =
+      opencensus::stats::ViewDescriptor()
+          .set_name("text_count")
+          .set_measure(measure.GetDescriptor().name())
+          .set_aggregation(opencensus::stats::Aggregation::Count())
+          .add_column(opencensus::tags::TagKey::Register("foo"))
+          .add_column(opencensus::tags::TagKey::Register("bar"))
+          .set_description("Line 1\\\nline 2");
+  const std::string tag_value = "a\"b\\c\n";
+  const opencensus::stats::ViewData data = TestUtils::MakeViewData(
+      view_descriptor, {{{"v1", tag_value}, 1.0}, {{"v1", tag_value}, 1.0}});
+  PrometheusCollector collector;
+  std::string text = "existing\n";
+  collector.WriteText({{view_descriptor, data}}, &text);
+  EXPECT_EQ(
+      absl::StrCat("existing\n"
+                   "# HELP text_count_units Line 1\\\\\\nline 2\n"
+                   "# TYPE text_count_units counter\n"
+                   "text_count_units{foo=\"v1\",bar=\"a\\\"b\\\\c\\n\"} 2 ",
+                   absl::ToUnixMillis(data.end_time()), "\n"),
+      text);
+}
+
+TEST(PrometheusCollectorTest, WriteTextDistribution) {
+  const auto measure = opencensus::stats::MeasureDouble::Register(
+      "measure_collector_text_distribution", "", "units");
+  const auto view_descriptor =
+      opencensus::stats::ViewDescriptor()
+          .set_name("text_distribution")
+          .set_measure(measure.GetDescriptor().name())
+          .set_aggregation(opencensus::stats::Aggregation::Distribution(
+              opencensus::stats::BucketBoundaries::Explicit({0, 2.5})))
+          .add_column(opencensus::tags::TagKey::Register("foo"));
+  const opencensus::stats::ViewData data = TestUtils::MakeViewData(
+      view_descriptor, {{{"v1"}, -1.0}, {{"v1"}, 0.25}, {{"v1"}, 11.0}});
+  PrometheusCollector collector;
+  std::string text;
+  collector.WriteText({{view_descriptor, data}}, &text);
+  const std::string time =
+      absl::StrCat(" ", absl::ToUnixMillis(data.end_time()), "\n");
+  const std::string name = "text_distribution_units";
+  EXPECT_EQ(absl::StrCat("# HELP ", name, " \n",
+                         "# TYPE ", name, " histogram\n",
+                         name, "_count{foo=\"v1\"} 3", time,
+                         name, "_sum{foo=\"v1\"} 10.25", time,
+                         name, "_bucket{foo=\"v1\",le=\"0\"} 1", time,
+                         name, "_bucket{foo=\"v1\",le=\"2.5\"} 2", time,
+                         name, "_bucket{foo=\"v1\",le=\"+Inf\"} 3", time),
+            text);
+}
+
+TEST(PrometheusCollectorTest, WriteTextAutoLogLinear) {
+  const auto measure = opencensus::stats::MeasureDouble::Register(
+      "measure_collector_text_auto_log_linear", "", "units");
+  const auto view_descriptor =
+      opencensus::stats::ViewDescriptor()
+          .set_name("text_auto_log_linear")
+          .set_measure(measure.GetDescriptor().name())
+          .set_aggregation(opencensus::stats::Aggregation::Distribution(
+              opencensus::stats::BucketBoundaries::AutoLogLinear(1)))
+          .add_column(opencensus::tags::TagKey::Register("foo"));
+  const opencensus::stats::ViewData data =
+      TestUtils::MakeViewData(view_descriptor, {{{"v1"}, 3.0}, {{"v1"}, 5.0}});
+  PrometheusCollector collector;
+  std::string text;
+  collector.WriteText({{view_descriptor, data}}, &text);
+  const std::string time =
+      absl::StrCat(" ", absl::ToUnixMillis(data.end_time()), "\n");
+  const std::string name = "text_auto_log_linear_units";
+  // The buckets cover [2, 8), the powers of two holding the values, in halves.
+  EXPECT_EQ(absl::StrCat("# HELP ", name, " \n",
+                         "# TYPE ", name, " histogram\n",
+                         name, "_count{foo=\"v1\"} 2", time,
+                         name, "_sum{foo=\"v1\"} 8", time,
+                         name, "_bucket{foo=\"v1\",le=\"2\"} 0", time,
+                         name, "_bucket{foo=\"v1\",le=\"3\"} 0", time,
+                         name, "_bucket{foo=\"v1\",le=\"4\"} 1", time,
+                         name, "_bucket{foo=\"v1\",le=\"6\"} 2", time,
+                         name, "_bucket{foo=\"v1\",le=\"8\"} 2", time,
+                         name, "_bucket{foo=\"v1\",le=\"+Inf\"} 2", time),
+            text);
+}
+
+TEST(PrometheusCollectorTest, WriteTextQuantiles) {
+  const auto measure = opencensus::stats::MeasureDouble::Register(
+      "measure_collector_text_quantiles", "", "units");
+  const auto view_descriptor =
+      opencensus::stats::ViewDescriptor()
+          .set_name("text_quantiles")
+          .set_measure(measure.GetDescriptor().name())
+          .set_aggregation(
+              opencensus::stats::Aggregation::Quantiles({0.5, 0.99}))
+          .add_column(opencensus::tags::TagKey::Register("foo"));
+  // Estimates are clamped to [min, max], so they are exact for equal values.
+  const opencensus::stats::ViewData data =
+      TestUtils::MakeViewData(view_descriptor, {{{"v1"}, 4.0}, {{"v1"}, 4.0}});
+  PrometheusCollector collector;
+  std::string text;
+  collector.WriteText({{view_descriptor, data}}, &text);
+  const std::string time =
+      absl::StrCat(" ", absl::ToUnixMillis(data.end_time()), "\n");
+  const std::string name = "text_quantiles_units";
+  EXPECT_EQ(absl::StrCat("# HELP ", name, " \n",
+                         "# TYPE ", name, " summary\n",
+                         name, "{foo=\"v1\",quantile=\"0.5\"} 4", time,
+                         name, "{foo=\"v1\",quantile=\"0.99\"} 4", time,
+                         name, "_sum{foo=\"v1\"} 8", time,
+                         name, "_count{foo=\"v1\"} 2", time),
+            text);
+
+  const auto families = collector.Collect({{view_descriptor, data}});
+  ASSERT_EQ(1, families.size());
+  EXPECT_EQ(prometheus::MetricType::Summary, families[0].type);
+  ASSERT_EQ(1, families[0].metric.size());
+  const auto& summary = families[0].metric[0].summary;
+  EXPECT_EQ(2, summary.sample_count);
+  EXPECT_EQ(8, summary.sample_sum);
+  ASSERT_EQ(2, summary.quantile.size());
+  EXPECT_EQ(0.99, summary.quantile[1].quantile);
+  EXPECT_EQ(4, summary.quantile[1].value);
+}
+
+TEST(PrometheusCollectorTest, WriteTextNoColumns) {
+  const auto measure = opencensus::stats::MeasureDouble::Register(
+      "measure_collector_text_no_columns", "", "units");
+  const auto view_descriptor =
+      opencensus::stats::ViewDescriptor()
+          .set_name("text_no_columns")
+          .set_measure(measure.GetDescriptor().name())
+          .set_aggregation(opencensus::stats::Aggregation::Sum());
+  const opencensus::stats::ViewData data =
+      TestUtils::MakeViewData(view_descriptor, {{{}, 0.1}});
+  PrometheusCollector collector;
+  std::string text;
+  collector.WriteText({{view_descriptor, data}}, &text);
+  EXPECT_EQ(absl::StrCat("# HELP text_no_columns_units \n"
+                         "# TYPE text_no_columns_units untyped\n"
+                         "text_no_columns_units 0.1 ",
+                         absl::ToUnixMillis(data.end_time()), "\n"),
+            text);
+}
+
 }  // namespace
 }  // namespace stats
 }  // namespace exporters
@@ -15,9 +15,13 @@
 #ifndef OPENCENSUS_EXPORTERS_STATS_PROMETHEUS_PROMETHEUS_EXPORTER_H_
 #define OPENCENSUS_EXPORTERS_STATS_PROMETHEUS_PROMETHEUS_EXPORTER_H_
 
+#include <memory>
+#include <string>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "opencensus/stats/stats.h"
 #include "prometheus/collectable.h"
 #include "prometheus/metric_family.h"
@@ -26,6 +30,8 @@ namespace opencensus {
 namespace exporters {
 namespace stats {
 
+class PrometheusCollector;
+
 // The PrometheusExporter is a Collectable that exposes all views registered
 // with the opencensus StatsExporter to the Prometheus cpp client library. To
 // use with the Prometheus client library:
@@ -36,12 +42,25 @@ namespace stats {
 //
 // Alternatively, client applications that do not use the default Exposer can
 // call Collect() directly and use the serializers in the Prometheus client
-// library to expose their own Prometheus endpoint.
+// library to expose their own Prometheus endpoint, or call WriteText().
 //
 // PrometheusExporter is thread-safe.
 class PrometheusExporter final : public ::prometheus::Collectable {
  public:
+  PrometheusExporter();
+  ~PrometheusExporter() override;
+
   std::vector<prometheus::MetricFamily> Collect() const override;
+
+  // Appends all views to *out in the Prometheus text exposition format. This
+  // is cheaper than serializing the result of Collect(); reuse *out between
+  // scrapes to keep its capacity.
+  void WriteText(std::string* out) const;
+
+ private:
+  mutable absl::Mutex mu_;
+  // Caches names derived from each view between collections.
+  const std::unique_ptr<PrometheusCollector> collector_ ABSL_PT_GUARDED_BY(mu_);
 };
 
 }  // namespace stats
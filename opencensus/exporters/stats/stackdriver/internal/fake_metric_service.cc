@@ -0,0 +1,99 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/exporters/stats/stackdriver/internal/fake_metric_service.h"
+
+#include <algorithm>
+
+namespace opencensus {
+namespace exporters {
+namespace stats {
+
+FakeMetricService::FakeMetricService() {
+  grpc::ServerBuilder builder;
+  builder.RegisterService(this);
+  server_ = builder.BuildAndStart();
+}
+
+FakeMetricService::~FakeMetricService() {
+  Release();
+  server_->Shutdown();
+}
+
+std::unique_ptr<google::monitoring::v3::MetricService::StubInterface>
+FakeMetricService::NewStub() {
+  return google::monitoring::v3::MetricService::NewStub(
+      server_->InProcessChannel(grpc::ChannelArguments()));
+}
+
+void FakeMetricService::Hold() {
+  absl::MutexLock l(&mu_);
+  held_ = true;
+}
+
+void FakeMetricService::Release() {
+  absl::MutexLock l(&mu_);
+  held_ = false;
+}
+
+void FakeMetricService::WaitForCalls(int n) {
+  absl::MutexLock l(&mu_);
+  struct Arg {
+    const int* num_calls;
+    int n;
+  } arg = {&num_calls_, n};
+  mu_.Await(absl::Condition(
+      +[](Arg* arg) { return *arg->num_calls >= arg->n; }, &arg));
+}
+
+int FakeMetricService::num_calls() {
+  absl::MutexLock l(&mu_);
+  return num_calls_;
+}
+
+int FakeMetricService::num_time_series() {
+  absl::MutexLock l(&mu_);
+  return num_time_series_;
+}
+
+int FakeMetricService::max_concurrent_calls() {
+  absl::MutexLock l(&mu_);
+  return max_running_;
+}
+
+grpc::Status FakeMetricService::CreateTimeSeries(
+    grpc::ServerContext* context,
+    const google::monitoring::v3::CreateTimeSeriesRequest* request,
+    google::protobuf::Empty* response) {
+  absl::MutexLock l(&mu_);
+  ++num_calls_;
+  num_time_series_ += request->time_series_size();
+  ++num_running_;
+  max_running_ = std::max(max_running_, num_running_);
+  mu_.Await(absl::Condition(+[](bool* held) { return !*held; }, &held_));
+  --num_running_;
+  return grpc::Status::OK;
+}
+
+grpc::Status FakeMetricService::CreateMetricDescriptor(
+    grpc::ServerContext* context,
+    const google::monitoring::v3::CreateMetricDescriptorRequest* request,
+    google::api::MetricDescriptor* response) {
+  *response = request->metric_descriptor();
+  return grpc::Status::OK;
+}
+
+}  // namespace stats
+}  // namespace exporters
+}  // namespace opencensus
@@ -0,0 +1,82 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPENCENSUS_EXPORTERS_STATS_STACKDRIVER_INTERNAL_FAKE_METRIC_SERVICE_H_
+#define OPENCENSUS_EXPORTERS_STATS_STACKDRIVER_INTERNAL_FAKE_METRIC_SERVICE_H_
+
+#include <grpcpp/grpcpp.h>
+
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "google/monitoring/v3/metric_service.grpc.pb.h"
+#include "google/monitoring/v3/metric_service.pb.h"
+#include "google/protobuf/empty.pb.h"
+
+namespace opencensus {
+namespace exporters {
+namespace stats {
+
+// FakeMetricService is an in-process MetricService server that counts the
+// CreateTimeSeries requests it receives. While held, it blocks them, so tests
+// can check how many are in flight at once.
+class FakeMetricService final
+    : public google::monitoring::v3::MetricService::Service {
+ public:
+  FakeMetricService();
+  ~FakeMetricService() override;
+
+  // Returns a stub connected to this server.
+  std::unique_ptr<google::monitoring::v3::MetricService::StubInterface>
+  NewStub();
+
+  // While held, CreateTimeSeries calls block until Release().
+  void Hold() ABSL_LOCKS_EXCLUDED(mu_);
+  void Release() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Blocks until 'n' CreateTimeSeries calls have started.
+  void WaitForCalls(int n) ABSL_LOCKS_EXCLUDED(mu_);
+
+  int num_calls() ABSL_LOCKS_EXCLUDED(mu_);
+  int num_time_series() ABSL_LOCKS_EXCLUDED(mu_);
+  // The most CreateTimeSeries calls that were running at once.
+  int max_concurrent_calls() ABSL_LOCKS_EXCLUDED(mu_);
+
+  grpc::Status CreateTimeSeries(
+      grpc::ServerContext* context,
+      const google::monitoring::v3::CreateTimeSeriesRequest* request,
+      google::protobuf::Empty* response) override ABSL_LOCKS_EXCLUDED(mu_);
+
+  grpc::Status CreateMetricDescriptor(
+      grpc::ServerContext* context,
+      const google::monitoring::v3::CreateMetricDescriptorRequest* request,
+      google::api::MetricDescriptor* response) override;
+
+ private:
+  absl::Mutex mu_;
+  bool held_ ABSL_GUARDED_BY(mu_) = false;
+  int num_calls_ ABSL_GUARDED_BY(mu_) = 0;
+  int num_time_series_ ABSL_GUARDED_BY(mu_) = 0;
+  int num_running_ ABSL_GUARDED_BY(mu_) = 0;
+  int max_running_ ABSL_GUARDED_BY(mu_) = 0;
+
+  std::unique_ptr<grpc::Server> server_;
+};
+
+}  // namespace stats
+}  // namespace exporters
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_EXPORTERS_STATS_STACKDRIVER_INTERNAL_FAKE_METRIC_SERVICE_H_
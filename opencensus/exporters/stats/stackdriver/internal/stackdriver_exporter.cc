@@ -16,9 +16,6 @@
 
 #include <grpcpp/grpcpp.h>
 
-#include <algorithm>
-#include <cmath>
-#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -28,11 +25,11 @@
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "google/monitoring/v3/metric_service.grpc.pb.h"
-#include "google/protobuf/empty.pb.h"
 #include "opencensus/common/internal/grpc/status.h"
 #include "opencensus/common/internal/grpc/with_user_agent.h"
 #include "opencensus/common/internal/hostname.h"
 #include "opencensus/exporters/stats/stackdriver/internal/stackdriver_utils.h"
+#include "opencensus/exporters/stats/stackdriver/internal/time_series_sender.h"
 #include "opencensus/stats/stats.h"
 
 namespace opencensus {
@@ -66,10 +63,35 @@ class Handler : public ::opencensus::stats::StatsExporter::Handler {
                          bool add_task_label)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // What is derived from a view's descriptor, kept across exports.
+  struct View {
+    opencensus::stats::ViewDescriptor descriptor;
+    bool is_known_custom_metric;
+    bool add_task_label;
+    // Whether MaybeRegisterView() succeeded for this descriptor.
+    bool registered = false;
+    // The fields shared by every TimeSeries of the view.
+    google::monitoring::v3::TimeSeries base_time_series;
+  };
+
+  // Returns the View for 'descriptor', rebuilding it if the descriptor
+  // changed.
+  View& GetView(const opencensus::stats::ViewDescriptor& descriptor)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Calls opts_.prepare_client_context, which is shared by the export thread
+  // and the sender's worker thread, one call at a time.
+  void PrepareClientContext(grpc::ClientContext* context)
+      ABSL_LOCKS_EXCLUDED(prepare_mu_);
+
   const StackdriverOptions opts_;
+  absl::Mutex prepare_mu_;
   mutable absl::Mutex mu_;
   std::unordered_map<std::string, opencensus::stats::ViewDescriptor>
       registered_descriptors_ ABSL_GUARDED_BY(mu_);
+  std::unordered_map<std::string, View> views_ ABSL_GUARDED_BY(mu_);
+  // Declared last so that it is destroyed, finishing its RPCs, first.
+  TimeSeriesSender sender_;
 };
 
 StackdriverOptions SetOptionDefaults(StackdriverOptions&& o) {
@@ -96,88 +118,101 @@ StackdriverOptions SetOptionDefaults(StackdriverOptions&& o) {
 }
 
 Handler::Handler(StackdriverOptions&& opts)
-    : opts_(SetOptionDefaults(std::move(opts))) {}
+    : opts_(SetOptionDefaults(std::move(opts))),
+      sender_(opts_.metric_service_stub.get(), opts_.rpc_deadline,
+              [this](grpc::ClientContext* context) {
+                PrepareClientContext(context);
+              },
+              opts_.max_concurrent_requests, opts_.max_queued_requests) {}
 
 void Handler::ExportViewData(
     const std::vector<std::pair<opencensus::stats::ViewDescriptor,
                                 opencensus::stats::ViewData>>& data) {
-  // TODO: refactor to avoid copying the timeseries.
+  // The previous export's requests may still be queued or in flight, and a
+  // new point must not reach Stackdriver before an older point of the same
+  // series. Queued requests hold points that this export supersedes, so drop
+  // them, then wait for the RPCs already started. This is done outside mu_,
+  // which only guards the View cache and registrations.
+  int num_dropped = sender_.DropQueued();
+  sender_.Flush();
+  // Within this export, each request is sent as soon as it is full, so the
+  // next request is built while earlier ones are in flight.
   absl::MutexLock l(&mu_);
-  std::vector<google::monitoring::v3::TimeSeries> time_series;
+  std::unique_ptr<TimeSeriesSender::Request> request;
+  const auto send = [this, &request, &num_dropped]() {
+    const int num_time_series = request->proto()->time_series_size();
+    if (!sender_.Send(std::move(request))) {
+      num_dropped += num_time_series;
+    }
+  };
+  const auto add_time_series = [this, &request, &send]() {
+    if (request != nullptr &&
+        request->proto()->time_series_size() == kTimeSeriesBatchSize) {
+      send();
+    }
+    if (request == nullptr) {
+      request = absl::make_unique<TimeSeriesSender::Request>();
+      request->proto()->set_name(opts_.project_id);
+    }
+    return request->proto()->add_time_series();
+  };
+
   for (const auto& datum : data) {
     const opencensus::stats::ViewDescriptor& descriptor = datum.first;
-    const std::string metric_type =
-        MakeType(opts_.metric_name_prefix, descriptor.name());
-    const google::api::MonitoredResource* monitored_resource_for_view =
-        MonitoredResourceForView(descriptor, opts_.monitored_resource,
-                                 opts_.per_metric_monitored_resource);
-
-    const bool is_known_custom_metric = IsKnownCustomMetric(metric_type);
-
-    // If this is a custom metric, add the opencensus_task label so that
-    // different processes produce different timeseries instead of colliding.
-    //
-    // However, if there is a non-default MonitoredResource for this view, it
-    // must already uniquely identify the timeseries, so don't add the
-    // opencensus_task label.
-    const bool add_task_label =
-        is_known_custom_metric && (monitored_resource_for_view == nullptr);
-
+    View& view = GetView(descriptor);
     // Builtin metrics are already defined, skip registration.
-    if (is_known_custom_metric) {
+    if (view.is_known_custom_metric && !view.registered) {
       // If the view can't be registered, skip it.
-      if (!MaybeRegisterView(descriptor, add_task_label)) {
+      if (!MaybeRegisterView(descriptor, view.add_task_label)) {
         continue;
       }
+      view.registered = true;
     }
-
-    const auto view_time_series = MakeTimeSeries(
-        opts_.metric_name_prefix, monitored_resource_for_view, descriptor,
-        /*data=*/datum.second, add_task_label, opts_.opencensus_task);
-    time_series.insert(time_series.end(), view_time_series.begin(),
-                       view_time_series.end());
+    AppendTimeSeries(descriptor, /*data=*/datum.second, view.base_time_series,
+                     add_time_series);
   }
-
-  const int num_rpcs =
-      ceil(static_cast<double>(time_series.size()) / kTimeSeriesBatchSize);
-
-  std::vector<grpc::Status> status(num_rpcs);
-  std::vector<grpc::ClientContext> ctx(num_rpcs);
-  // We can safely re-use an empty response--it is never updated.
-  google::protobuf::Empty response;
-  grpc::CompletionQueue cq;
-
-  for (int rpc_index = 0; rpc_index < num_rpcs; ++rpc_index) {
-    auto request = google::monitoring::v3::CreateTimeSeriesRequest();
-    request.set_name(opts_.project_id);
-    const int batch_end = std::min(static_cast<int>(time_series.size()),
-                                   (rpc_index + 1) * kTimeSeriesBatchSize);
-    for (int i = rpc_index * kTimeSeriesBatchSize; i < batch_end; ++i) {
-      *request.add_time_series() = time_series[i];
-    }
-    ctx[rpc_index].set_deadline(
-        absl::ToChronoTime(absl::Now() + opts_.rpc_deadline));
-    opts_.prepare_client_context(&ctx[rpc_index]);
-    auto rpc(opts_.metric_service_stub->AsyncCreateTimeSeries(&ctx[rpc_index],
-                                                              request, &cq));
-    rpc->Finish(&response, &status[rpc_index], (void*)(uintptr_t)rpc_index);
+  if (request != nullptr) {
+    send();
   }
+  if (num_dropped > 0) {
+    std::cerr << "Stackdriver stats exporter dropped " << num_dropped
+              << " timeseries: too many CreateTimeSeries requests queued.\n";
+  }
+}
 
-  cq.Shutdown();
-  void* tag;
-  bool ok;
-  while (cq.Next(&tag, &ok)) {
-    if (ok) {
-      const auto& s = status[(uintptr_t)tag];
-      if (!s.ok()) {
-        std::cerr << "CreateTimeSeries request failed (" << num_rpcs
-                  << " RPCs, " << data.size() << " views, "
-                  << time_series.size()
-                  << " timeseries): " << opencensus::common::ToString(s)
-                  << "\n";
-      }
-    }
+void Handler::PrepareClientContext(grpc::ClientContext* context) {
+  absl::MutexLock l(&prepare_mu_);
+  opts_.prepare_client_context(context);
+}
+
+Handler::View& Handler::GetView(
+    const opencensus::stats::ViewDescriptor& descriptor) {
+  auto it = views_.find(descriptor.name());
+  if (it != views_.end() && it->second.descriptor == descriptor) {
+    return it->second;
   }
+  View& view = views_[descriptor.name()];
+  view.descriptor = descriptor;
+  view.registered = false;
+  const google::api::MonitoredResource* monitored_resource_for_view =
+      MonitoredResourceForView(descriptor, opts_.monitored_resource,
+                               opts_.per_metric_monitored_resource);
+  view.is_known_custom_metric = IsKnownCustomMetric(
+      MakeType(opts_.metric_name_prefix, descriptor.name()));
+
+  // If this is a custom metric, add the opencensus_task label so that
+  // different processes produce different timeseries instead of colliding.
+  //
+  // However, if there is a non-default MonitoredResource for this view, it
+  // must already uniquely identify the timeseries, so don't add the
+  // opencensus_task label.
+  view.add_task_label =
+      view.is_known_custom_metric && (monitored_resource_for_view == nullptr);
+
+  SetBaseTimeSeries(opts_.metric_name_prefix, monitored_resource_for_view,
+                    descriptor, view.add_task_label, opts_.opencensus_task,
+                    &view.base_time_series);
+  return view;
 }
 
 bool Handler::MaybeRegisterView(
@@ -200,7 +235,7 @@ bool Handler::MaybeRegisterView(
   ::grpc::ClientContext context;
   context.set_deadline(absl::ToChronoTime(absl::Now() + opts_.rpc_deadline));
   google::api::MetricDescriptor response;
-  opts_.prepare_client_context(&context);
+  PrepareClientContext(&context);
   ::grpc::Status status = opts_.metric_service_stub->CreateMetricDescriptor(
       &context, request, &response);
   if (!status.ok()) {
@@ -228,6 +263,8 @@ void StackdriverExporter::Register(StackdriverOptions& opts) {
   copied_opts.project_id = opts.project_id;
   copied_opts.opencensus_task = opts.opencensus_task;
   copied_opts.rpc_deadline = opts.rpc_deadline;
+  copied_opts.max_concurrent_requests = opts.max_concurrent_requests;
+  copied_opts.max_queued_requests = opts.max_queued_requests;
   copied_opts.monitored_resource = opts.monitored_resource;
   copied_opts.per_metric_monitored_resource =
       opts.per_metric_monitored_resource;
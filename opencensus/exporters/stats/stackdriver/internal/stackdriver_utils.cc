@@ -14,7 +14,13 @@
 
 #include "opencensus/exporters/stats/stackdriver/internal/stackdriver_utils.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/base/internal/sysinfo.h"
 #include "absl/base/macros.h"
@@ -43,6 +49,18 @@ constexpr char kOpenCensusTaskKey[] = "opencensus_task";
 constexpr char kOpenCensusTaskDescription[] = "OpenCensus task identifier";
 constexpr char kDefaultResourceType[] = "global";
 
+// Stackdriver's limit on the number of buckets in a distribution, including
+// the underflow and overflow buckets.
+constexpr int kMaxBuckets = 200;
+// Sketches are exported with the same layout for every row and point, each
+// finite bucket merging 2^kSketchBucketShift sketch buckets. At the default
+// accuracy, buckets grow by ~38% and cover 1e-14 to 1e14.
+constexpr int kSketchBucketShift = 4;
+constexpr int kSketchFiniteBuckets = kMaxBuckets - 2;
+// The index of the sketch bucket just below the first finite bucket.
+constexpr int32_t kSketchScaleIndex =
+    -(kSketchFiniteBuckets / 2) * (1 << kSketchBucketShift);
+
 // Creates a name in the format described in
 // https://cloud.google.com/monitoring/api/ref_v3/rest/v3/projects.metricDescriptors/create
 std::string MakeName(absl::string_view project_name,
@@ -83,6 +101,7 @@ google::api::MetricDescriptor::ValueType GetValueType(
           return google::api::MetricDescriptor::DOUBLE;
       }
     case opencensus::stats::Aggregation::Type::kDistribution:
+    case opencensus::stats::Aggregation::Type::kQuantiles:
       return google::api::MetricDescriptor::DISTRIBUTION;
   }
   ABSL_ASSERT(false && "Bad descriptor type.");
@@ -106,7 +125,87 @@ void SetTypedValue(int64_t value, google::api::MetricDescriptor::ValueType type,
   ABSL_ASSERT(type == google::api::MetricDescriptor::INT64);
   proto->set_int64_value(value);
 }
+
+// Appends 'counts' to 'distribution_proto', which may omit trailing empty
+// buckets.
+void AddBucketCounts(std::vector<uint64_t> counts,
+                     google::api::Distribution* distribution_proto) {
+  while (!counts.empty() && counts.back() == 0) {
+    counts.pop_back();
+  }
+  for (const uint64_t count : counts) {
+    distribution_proto->add_bucket_counts(count);
+  }
+}
+
+// Sets the buckets of a distribution over 'boundaries', the view's LogLinear()
+// or AutoLogLinear() boundaries, with exponential buckets fixed for the view.
+// Each power of two in the range of 'boundaries' is split into up to
+// 2^sub_bucket_bits() buckets, as many as fit within kMaxBuckets, or buckets
+// span several powers of two if even one each does not fit. The range of
+// auto-ranging boundaries differs by row and over time, so the widest range
+// they can reach, centered on 1, is exported instead, with values outside it
+// counted as underflow or overflow. The sub-buckets of 'value' do not align
+// with coarser exported buckets, so each is counted by its midpoint.
+void SetLogLinearBuckets(const opencensus::stats::BucketBoundaries& boundaries,
+                         const opencensus::stats::Distribution& value,
+                         google::api::Distribution* distribution_proto) {
+  int min_exponent = boundaries.min_exponent();
+  int max_exponent = boundaries.max_exponent();
+  if (boundaries.auto_range()) {
+    min_exponent = -boundaries.max_exponent_span() / 2;
+    max_exponent = min_exponent + boundaries.max_exponent_span();
+  }
+  const int span = max_exponent - min_exponent;
+  // The number of finite buckets with 2^bits buckets per power of two, or for
+  // negative bits, one per 2^-bits powers of two.
+  const auto num_finite_buckets = [span](int bits) {
+    return bits >= 0 ? span << bits : (span + (1 << -bits) - 1) >> -bits;
+  };
+  int bits = boundaries.sub_bucket_bits();
+  while (num_finite_buckets(bits) > kMaxBuckets - 2) {
+    --bits;
+  }
+  const int num_finite = num_finite_buckets(bits);
+  auto* buckets = distribution_proto->mutable_bucket_options()
+                      ->mutable_exponential_buckets();
+  buckets->set_num_finite_buckets(num_finite);
+  buckets->set_growth_factor(std::exp2(std::ldexp(1, -bits)));
+  buckets->set_scale(std::ldexp(1, min_exponent));
+
+  const auto& range = value.bucket_boundaries();
+  const auto& counts = value.bucket_counts();
+  std::vector<uint64_t> merged(num_finite + 2);
+  merged.front() = counts.front();
+  if (counts.size() > 1) {
+    merged.back() = counts.back();
+  }
+  const int sub_buckets = 1 << range.sub_bucket_bits();
+  for (int i = 1; i + 1 < counts.size(); ++i) {
+    if (counts[i] == 0) {
+      continue;
+    }
+    // The midpoint of the bucket, in powers of two above the scale.
+    const int exponent =
+        range.min_exponent() + ((i - 1) >> range.sub_bucket_bits());
+    const int sub_bucket = (i - 1) & (sub_buckets - 1);
+    const double midpoint =
+        exponent - min_exponent +
+        std::log2(1 + (sub_bucket + 0.5) / sub_buckets);
+    const double position = std::ldexp(midpoint, bits);
+    const int bucket =
+        position < 0
+            ? 0
+            : std::min(static_cast<int>(position) + 1, num_finite + 1);
+    merged[bucket] += counts[i];
+  }
+  AddBucketCounts(std::move(merged), distribution_proto);
+}
+
+// 'boundaries' are the view's bucket boundaries, which for auto-ranging
+// boundaries differ from those of 'value'.
 void SetTypedValue(const opencensus::stats::Distribution& value,
+                   const opencensus::stats::BucketBoundaries& boundaries,
                    google::api::MetricDescriptor::ValueType type,
                    google::monitoring::v3::TypedValue* proto) {
   ABSL_ASSERT(type == google::api::MetricDescriptor::DISTRIBUTION);
@@ -116,10 +215,12 @@ void SetTypedValue(const opencensus::stats::Distribution& value,
   distribution_proto->set_sum_of_squared_deviation(
       value.sum_of_squared_deviation());
   // TODO: Set range when Stackdriver supports it.
-  if (value.bucket_boundaries().num_buckets() > 1) {
+  if (boundaries.log_linear()) {
+    SetLogLinearBuckets(boundaries, value, distribution_proto);
+  } else if (boundaries.num_buckets() > 1) {
     auto* buckets = distribution_proto->mutable_bucket_options()
                         ->mutable_explicit_buckets();
-    for (const auto boundary : value.bucket_boundaries().lower_boundaries()) {
+    for (const auto boundary : boundaries.lower_boundaries()) {
       buckets->add_bounds(boundary);
     }
     for (const auto bucket_count : value.bucket_counts()) {
@@ -128,39 +229,104 @@ void SetTypedValue(const opencensus::stats::Distribution& value,
   }
 }
 
+// Exports a sketch as a distribution with a fixed layout of exponential
+// buckets, each merging consecutive positive buckets of the sketch. Zero and
+// negative values go to the underflow bucket, and the squared deviation is
+// estimated from the sketch's buckets.
+void SetTypedValue(const opencensus::stats::QuantileSketch& value,
+                   google::api::MetricDescriptor::ValueType type,
+                   google::monitoring::v3::TypedValue* proto) {
+  ABSL_ASSERT(type == google::api::MetricDescriptor::DISTRIBUTION);
+  auto* distribution_proto = proto->mutable_distribution_value();
+  distribution_proto->set_count(value.count());
+  if (value.count() == 0) {
+    return;
+  }
+  const double mean = value.sum() / value.count();
+  distribution_proto->set_mean(mean);
+  const double gamma = opencensus::stats::QuantileSketch::growth_factor();
+  // The point within the relative accuracy of every value in bucket 'index'.
+  const auto estimate = [gamma](int32_t index) {
+    return 2 * std::pow(gamma, index) / (gamma + 1);
+  };
+  double sum_of_squared_deviation = value.zero_count() * mean * mean;
+  const auto& negative = value.negative_bucket_counts();
+  for (int i = 0; i < negative.size(); ++i) {
+    const double deviation = -estimate(value.negative_offset() + i) - mean;
+    sum_of_squared_deviation += negative[i] * deviation * deviation;
+  }
+  const auto& positive = value.positive_bucket_counts();
+  for (int i = 0; i < positive.size(); ++i) {
+    const double deviation = estimate(value.positive_offset() + i) - mean;
+    sum_of_squared_deviation += positive[i] * deviation * deviation;
+  }
+  distribution_proto->set_sum_of_squared_deviation(sum_of_squared_deviation);
+
+  auto* buckets = distribution_proto->mutable_bucket_options()
+                      ->mutable_exponential_buckets();
+  buckets->set_num_finite_buckets(kSketchFiniteBuckets);
+  buckets->set_growth_factor(std::pow(gamma, 1 << kSketchBucketShift));
+  buckets->set_scale(std::pow(gamma, kSketchScaleIndex));
+  std::vector<uint64_t> counts(kSketchFiniteBuckets + 2);
+  counts[0] = value.zero_count();
+  for (const uint64_t count : negative) {
+    counts[0] += count;
+  }
+  for (int i = 0; i < positive.size(); ++i) {
+    // Sketch bucket 'index' covers (gamma^(index-1), gamma^index].
+    const int32_t lower = value.positive_offset() + i - 1 - kSketchScaleIndex;
+    const int bucket =
+        lower < 0 ? 0
+                  : std::min((lower >> kSketchBucketShift) + 1,
+                             kSketchFiniteBuckets + 1);
+    counts[bucket] += positive[i];
+  }
+  AddBucketCounts(std::move(counts), distribution_proto);
+}
+
+// Other values do not depend on the view's bucket boundaries.
+template <typename T>
+void SetTypedValue(const T& value,
+                   const opencensus::stats::BucketBoundaries& /*boundaries*/,
+                   google::api::MetricDescriptor::ValueType type,
+                   google::monitoring::v3::TypedValue* proto) {
+  SetTypedValue(value, type, proto);
+}
+
 template <typename DataValueT>
-std::vector<google::monitoring::v3::TimeSeries> DataToTimeSeries(
+void DataToTimeSeries(
     const opencensus::stats::ViewDescriptor& view_descriptor,
     const opencensus::stats::ViewData::DataMap<DataValueT>& data,
     const opencensus::stats::ViewData::DataMap<absl::Time>& start_times,
-    const google::monitoring::v3::TimeSeries& base_time_series) {
+    absl::Time end_time,
+    const google::monitoring::v3::TimeSeries& base_time_series,
+    const std::function<google::monitoring::v3::TimeSeries*()>&
+        add_time_series) {
   const google::api::MetricDescriptor::ValueType type =
       GetValueType(view_descriptor);
-  std::vector<google::monitoring::v3::TimeSeries> vector;
+  // Stackdriver doesn't like start_time and end_time being different for
+  // GAUGE metrics. Don't set the start time for GAUGE.
+  const bool set_start_time = view_descriptor.aggregation().type() !=
+                              opencensus::stats::Aggregation::Type::kLastValue;
   for (const auto& row : data) {
-    vector.push_back(base_time_series);
-    auto& time_series = vector.back();
+    google::monitoring::v3::TimeSeries* time_series = add_time_series();
+    time_series->CopyFrom(base_time_series);
+    // The column labels are already in base_time_series; only set values.
+    auto* labels = time_series->mutable_metric()->mutable_labels();
     for (int i = 0; i < view_descriptor.columns().size(); ++i) {
-      (*time_series.mutable_metric()
-            ->mutable_labels())[view_descriptor.columns()[i].name()] =
-          row.first[i];
+      (*labels)[view_descriptor.columns()[i].name()] = row.first[i];
     }
-    // The point is already created in the base_time_series to set the times.
-    SetTypedValue(row.second, type,
-                  time_series.mutable_points(0)->mutable_value());
-
-    // Stackdriver doesn't like start_time and end_time being different for
-    // GAUGE metrics. Don't set the start time for GAUGE.
-    if (view_descriptor.aggregation().type() !=
-        opencensus::stats::Aggregation::Type::kLastValue) {
+    auto* point = time_series->add_points();
+    SetTypedValue(row.second, view_descriptor.aggregation().bucket_boundaries(),
+                  type, point->mutable_value());
+    auto* interval = point->mutable_interval();
+    opencensus::common::SetTimestamp(end_time, interval->mutable_end_time());
+    if (set_start_time) {
       // Use the start time stored for the specific row's tags.
-      auto* interval = time_series.mutable_points(0)->mutable_interval();
-      absl::Time start_time = start_times.at(row.first);
-      opencensus::common::SetTimestamp(start_time,
+      opencensus::common::SetTimestamp(start_times.at(row.first),
                                        interval->mutable_start_time());
     }
   }
-  return vector;
 }
 
 }  // namespace
@@ -218,42 +384,75 @@ void SetMetricDescriptor(
   metric_descriptor->set_description(view_descriptor.description());
 }
 
-std::vector<google::monitoring::v3::TimeSeries> MakeTimeSeries(
+void SetBaseTimeSeries(
     absl::string_view metric_name_prefix,
     const google::api::MonitoredResource* monitored_resource_for_view,
     const opencensus::stats::ViewDescriptor& view_descriptor,
-    const opencensus::stats::ViewData& data, bool add_task_label,
-    absl::string_view opencensus_task) {
-  // Set values that are common across all the rows.
-  auto base_time_series = google::monitoring::v3::TimeSeries();
-  const std::string metric_type =
-      MakeType(metric_name_prefix, view_descriptor.name());
-  base_time_series.mutable_metric()->set_type(metric_type);
+    bool add_task_label, absl::string_view opencensus_task,
+    google::monitoring::v3::TimeSeries* base_time_series) {
+  base_time_series->Clear();
+  base_time_series->mutable_metric()->set_type(
+      MakeType(metric_name_prefix, view_descriptor.name()));
   if (monitored_resource_for_view == nullptr) {
-    base_time_series.mutable_resource()->set_type(kDefaultResourceType);
+    base_time_series->mutable_resource()->set_type(kDefaultResourceType);
   } else {
-    *base_time_series.mutable_resource() = *monitored_resource_for_view;
+    *base_time_series->mutable_resource() = *monitored_resource_for_view;
   }
-  auto* interval = base_time_series.add_points()->mutable_interval();
-  opencensus::common::SetTimestamp(data.end_time(),
-                                   interval->mutable_end_time());
+  auto* labels = base_time_series->mutable_metric()->mutable_labels();
   if (add_task_label) {
-    (*base_time_series.mutable_metric()->mutable_labels())[kOpenCensusTaskKey] =
-        std::string(opencensus_task);
+    (*labels)[kOpenCensusTaskKey] = std::string(opencensus_task);
+  }
+  // Rows only fill in the values of these.
+  for (const auto& column : view_descriptor.columns()) {
+    (*labels)[column.name()];
   }
+}
+
+void AppendTimeSeries(
+    const opencensus::stats::ViewDescriptor& view_descriptor,
+    const opencensus::stats::ViewData& data,
+    const google::monitoring::v3::TimeSeries& base_time_series,
+    const std::function<google::monitoring::v3::TimeSeries*()>&
+        add_time_series) {
   switch (data.type()) {
     case opencensus::stats::ViewData::Type::kDouble:
-      return DataToTimeSeries(view_descriptor, data.double_data(),
-                              data.start_times(), base_time_series);
+      DataToTimeSeries(view_descriptor, data.double_data(), data.start_times(),
+                       data.end_time(), base_time_series, add_time_series);
+      return;
     case opencensus::stats::ViewData::Type::kInt64:
-      return DataToTimeSeries(view_descriptor, data.int_data(),
-                              data.start_times(), base_time_series);
+      DataToTimeSeries(view_descriptor, data.int_data(), data.start_times(),
+                       data.end_time(), base_time_series, add_time_series);
+      return;
     case opencensus::stats::ViewData::Type::kDistribution:
-      return DataToTimeSeries(view_descriptor, data.distribution_data(),
-                              data.start_times(), base_time_series);
+      DataToTimeSeries(view_descriptor, data.distribution_data(),
+                       data.start_times(), data.end_time(), base_time_series,
+                       add_time_series);
+      return;
+    case opencensus::stats::ViewData::Type::kQuantiles:
+      DataToTimeSeries(view_descriptor, data.quantile_data(),
+                       data.start_times(), data.end_time(), base_time_series,
+                       add_time_series);
+      return;
   }
   ABSL_ASSERT(false && "Bad ViewData.type().");
-  return {};
+}
+
+std::vector<google::monitoring::v3::TimeSeries> MakeTimeSeries(
+    absl::string_view metric_name_prefix,
+    const google::api::MonitoredResource* monitored_resource_for_view,
+    const opencensus::stats::ViewDescriptor& view_descriptor,
+    const opencensus::stats::ViewData& data, bool add_task_label,
+    absl::string_view opencensus_task) {
+  google::monitoring::v3::TimeSeries base_time_series;
+  SetBaseTimeSeries(metric_name_prefix, monitored_resource_for_view,
+                    view_descriptor, add_task_label, opencensus_task,
+                    &base_time_series);
+  std::vector<google::monitoring::v3::TimeSeries> vector;
+  AppendTimeSeries(view_descriptor, data, base_time_series, [&vector]() {
+    vector.emplace_back();
+    return &vector.back();
+  });
+  return vector;
 }
 
 }  // namespace stats
@@ -15,6 +15,7 @@
 #ifndef OPENCENSUS_EXPORTERS_STATS_INTERNAL_STACKDRIVER_UTILS_H_
 #define OPENCENSUS_EXPORTERS_STATS_INTERNAL_STACKDRIVER_UTILS_H_
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -54,6 +55,26 @@ void SetMetricDescriptor(
     const opencensus::stats::ViewDescriptor& view_descriptor,
     bool add_task_label, google::api::MetricDescriptor* metric_descriptor);
 
+// Populates base_time_series with the fields that are the same for every row
+// of the view: the metric type, monitored resource and opencensus_task label,
+// and a label with an empty value for each column.
+void SetBaseTimeSeries(
+    absl::string_view metric_name_prefix,
+    const google::api::MonitoredResource* monitored_resource_for_view,
+    const opencensus::stats::ViewDescriptor& view_descriptor,
+    bool add_task_label, absl::string_view opencensus_task,
+    google::monitoring::v3::TimeSeries* base_time_series);
+
+// Converts each row of 'data' into a TimeSeries. For each row, calls
+// 'add_time_series' for an empty TimeSeries to populate, starting with a copy
+// of base_time_series. This allows building rows directly into requests.
+void AppendTimeSeries(
+    const opencensus::stats::ViewDescriptor& view_descriptor,
+    const opencensus::stats::ViewData& data,
+    const google::monitoring::v3::TimeSeries& base_time_series,
+    const std::function<google::monitoring::v3::TimeSeries*()>&
+        add_time_series);
+
 // Converts each row of 'data' into a TimeSeries proto.
 std::vector<google::monitoring::v3::TimeSeries> MakeTimeSeries(
     absl::string_view metric_name_prefix,
@@ -14,6 +14,8 @@
 
 #include "opencensus/exporters/stats/stackdriver/internal/stackdriver_utils.h"
 
+#include <cmath>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -24,6 +26,8 @@
 #include "google/api/metric.pb.h"
 #include "google/api/monitored_resource.pb.h"
 #include "google/monitoring/v3/common.pb.h"
+#include "google/monitoring/v3/metric_service.pb.h"
+#include "google/protobuf/arena.h"
 #include "google/protobuf/timestamp.pb.h"
 #include "gtest/gtest.h"
 #include "opencensus/exporters/stats/stackdriver/internal/time_series_matcher.h"
@@ -359,6 +363,88 @@ TEST(StackdriverUtilsTest, MakeTimeSeriesCustomResource) {
       << ts.resource().DebugString();
 }
 
+TEST(StackdriverUtilsTest, AppendTimeSeriesIntoRequest) {
+  const auto measure = opencensus::stats::MeasureDouble::Register(
+      "measure_append_time_series", "", "");
+  const std::string task = "test_task";
+  const auto tag_key = opencensus::tags::TagKey::Register("foo");
+  const auto view_descriptor_1 =
+      opencensus::stats::ViewDescriptor()
+          .set_name("test_view_1")
+          .set_measure(measure.GetDescriptor().name())
+          .set_aggregation(opencensus::stats::Aggregation::Sum())
+          .add_column(tag_key);
+  const auto view_descriptor_2 =
+      opencensus::stats::ViewDescriptor(view_descriptor_1)
+          .set_name("test_view_2");
+  const opencensus::stats::ViewData data_1 =
+      TestUtils::MakeViewData(view_descriptor_1, {{{"v1"}, 1.0}});
+  const opencensus::stats::ViewData data_2 = TestUtils::MakeViewData(
+      view_descriptor_2, {{{"v1"}, 2.0}, {{"v2"}, 3.0}});
+
+  google::protobuf::Arena arena;
+  auto* request = google::protobuf::Arena::CreateMessage<
+      google::monitoring::v3::CreateTimeSeriesRequest>(&arena);
+  const auto add_time_series = [request]() {
+    return request->add_time_series();
+  };
+  google::monitoring::v3::TimeSeries base_time_series;
+  SetBaseTimeSeries(kMetricNamePrefix, kDefaultResource, view_descriptor_1,
+                    kAddTaskLabel, task, &base_time_series);
+  AppendTimeSeries(view_descriptor_1, data_1, base_time_series,
+                   add_time_series);
+  SetBaseTimeSeries(kMetricNamePrefix, kDefaultResource, view_descriptor_2,
+                    kAddTaskLabel, task, &base_time_series);
+  AppendTimeSeries(view_descriptor_2, data_2, base_time_series,
+                   add_time_series);
+
+  ASSERT_EQ(3, request->time_series_size());
+  EXPECT_EQ("custom.googleapis.com/test/test_view_1",
+            request->time_series(0).metric().type());
+  EXPECT_EQ("custom.googleapis.com/test/test_view_2",
+            request->time_series(1).metric().type());
+  EXPECT_EQ("custom.googleapis.com/test/test_view_2",
+            request->time_series(2).metric().type());
+  EXPECT_THAT(std::vector<google::monitoring::v3::TimeSeries>(
+                  request->time_series().begin() + 1,
+                  request->time_series().end()),
+              ::testing::UnorderedElementsAre(
+                  testing::TimeSeriesDouble(
+                      {{"opencensus_task", task}, {"foo", "v1"}}, 2.0),
+                  testing::TimeSeriesDouble(
+                      {{"opencensus_task", task}, {"foo", "v2"}}, 3.0)));
+  for (const auto& ts : request->time_series()) {
+    EXPECT_EQ("global", ts.resource().type());
+    ASSERT_EQ(1, ts.points_size());
+  }
+}
+
+TEST(StackdriverUtilsTest, SetBaseTimeSeriesLabels) {
+  const auto measure = opencensus::stats::MeasureDouble::Register(
+      "measure_base_time_series", "", "");
+  const auto tag_key_1 = opencensus::tags::TagKey::Register("foo");
+  const auto tag_key_2 = opencensus::tags::TagKey::Register("bar");
+  const auto view_descriptor =
+      opencensus::stats::ViewDescriptor()
+          .set_name("test_view")
+          .set_measure(measure.GetDescriptor().name())
+          .set_aggregation(opencensus::stats::Aggregation::Sum())
+          .add_column(tag_key_1)
+          .add_column(tag_key_2);
+
+  google::monitoring::v3::TimeSeries base_time_series;
+  SetBaseTimeSeries(kMetricNamePrefix, kDefaultResource, view_descriptor,
+                    kAddTaskLabel, "test_task", &base_time_series);
+  EXPECT_EQ("custom.googleapis.com/test/test_view",
+            base_time_series.metric().type());
+  EXPECT_EQ("global", base_time_series.resource().type());
+  const auto& labels = base_time_series.metric().labels();
+  EXPECT_EQ(3, labels.size());
+  EXPECT_EQ("test_task", labels.at("opencensus_task"));
+  EXPECT_EQ("", labels.at("foo"));
+  EXPECT_EQ("", labels.at("bar"));
+}
+
 TEST(StackdriverUtilsTest, MakeTimeSeriesSumDoubleAndTypes) {
   const auto measure =
       opencensus::stats::MeasureDouble::Register("measure_sum_double", "", "");
@@ -564,6 +650,174 @@ TEST(StackdriverUtilsTest, MakeTimeSeriesDistributionDouble) {
                                                   distribution2)));
 }
 
+TEST(StackdriverUtilsTest, MakeTimeSeriesQuantiles) {
+  const auto measure = opencensus::stats::MeasureDouble::Register(
+      "measure_quantiles_double", "", "");
+  const auto view_descriptor =
+      opencensus::stats::ViewDescriptor()
+          .set_name("test_view")
+          .set_measure(measure.GetDescriptor().name())
+          .set_aggregation(opencensus::stats::Aggregation::Quantiles());
+  const opencensus::stats::ViewData data = TestUtils::MakeViewData(
+      view_descriptor, {{{}, -1.0}, {{}, 1.0}, {{}, 1.0}});
+  const std::vector<google::monitoring::v3::TimeSeries> time_series =
+      MakeTimeSeries(kMetricNamePrefix, kDefaultResource, view_descriptor, data,
+                     kAddTaskLabel, "test_task");
+
+  ASSERT_EQ(1, time_series.size());
+  ASSERT_EQ(1, time_series[0].points_size());
+  const auto& distribution =
+      time_series[0].points(0).value().distribution_value();
+  EXPECT_EQ(3, distribution.count());
+  EXPECT_DOUBLE_EQ(1.0 / 3, distribution.mean());
+  // Each exported bucket merges 16 sketch buckets, with 99 of them below 1.
+  const double gamma = opencensus::stats::QuantileSketch::growth_factor();
+  const auto& buckets = distribution.bucket_options().exponential_buckets();
+  EXPECT_EQ(198, buckets.num_finite_buckets());
+  EXPECT_DOUBLE_EQ(std::pow(gamma, 16), buckets.growth_factor());
+  EXPECT_DOUBLE_EQ(std::pow(gamma, -99 * 16), buckets.scale());
+  // Both 1s are in the sketch bucket covering (gamma^-1, 1], merged into the
+  // finite bucket ending at 1, and -1 is in the underflow bucket. Trailing
+  // empty buckets are omitted.
+  ASSERT_EQ(100, distribution.bucket_counts_size());
+  EXPECT_EQ(1, distribution.bucket_counts(0));
+  EXPECT_EQ(2, distribution.bucket_counts(99));
+}
+
+TEST(StackdriverUtilsTest, MakeTimeSeriesQuantilesWideRange) {
+  const auto measure = opencensus::stats::MeasureDouble::Register(
+      "measure_quantiles_wide_range", "", "");
+  const auto tag_key = opencensus::tags::TagKey::Register("foo");
+  const auto view_descriptor =
+      opencensus::stats::ViewDescriptor()
+          .set_name("test_view")
+          .set_measure(measure.GetDescriptor().name())
+          .set_aggregation(opencensus::stats::Aggregation::Quantiles())
+          .add_column(tag_key);
+  // One row has values over 17 orders of magnitude, ~2000 sketch buckets, and
+  // the other a single value.
+  std::vector<TestViewValue> values = {{{"wide"}, -1.0, absl::UnixEpoch()},
+                                       {{"wide"}, 0.0, absl::UnixEpoch()},
+                                       {{"narrow"}, 5.0, absl::UnixEpoch()}};
+  for (int exponent = 3; exponent <= 20; ++exponent) {
+    values.push_back({{"wide"}, std::pow(10.0, exponent), absl::UnixEpoch()});
+  }
+  const opencensus::stats::ViewData data =
+      TestUtils::MakeViewDataWithStartTimes(view_descriptor, values);
+  const std::vector<google::monitoring::v3::TimeSeries> time_series =
+      MakeTimeSeries(kMetricNamePrefix, kDefaultResource, view_descriptor, data,
+                     kAddTaskLabel, "test_task");
+
+  ASSERT_EQ(2, time_series.size());
+  const auto& first = time_series[0].points(0).value().distribution_value();
+  const auto& second = time_series[1].points(0).value().distribution_value();
+  const auto& wide = first.count() == 20 ? first : second;
+  const auto& narrow = first.count() == 20 ? second : first;
+  ASSERT_EQ(20, wide.count());
+  // Both rows share one layout of at most 200 buckets.
+  EXPECT_EQ(wide.bucket_options().SerializeAsString(),
+            narrow.bucket_options().SerializeAsString());
+  EXPECT_EQ(198,
+            wide.bucket_options().exponential_buckets().num_finite_buckets());
+  ASSERT_EQ(200, wide.bucket_counts_size());
+  // -1 and 0 underflow, and 1e14 to 1e20 overflow.
+  EXPECT_EQ(2, wide.bucket_counts(0));
+  EXPECT_EQ(7, wide.bucket_counts(199));
+  int64_t total = 0;
+  for (const int64_t count : wide.bucket_counts()) {
+    total += count;
+  }
+  EXPECT_EQ(20, total);
+  ASSERT_EQ(1, narrow.count());
+  EXPECT_EQ(1, narrow.bucket_counts(narrow.bucket_counts_size() - 1));
+}
+
+TEST(StackdriverUtilsTest, MakeTimeSeriesAutoLogLinear) {
+  const auto measure = opencensus::stats::MeasureDouble::Register(
+      "measure_auto_log_linear_double", "", "");
+  const auto view_descriptor =
+      opencensus::stats::ViewDescriptor()
+          .set_name("test_view")
+          .set_measure(measure.GetDescriptor().name())
+          .set_aggregation(opencensus::stats::Aggregation::Distribution(
+              opencensus::stats::BucketBoundaries::AutoLogLinear(0)));
+  const opencensus::stats::ViewData data = TestUtils::MakeViewData(
+      view_descriptor, {{{}, 0.75}, {{}, 3.0}, {{}, 5.0}});
+  const std::vector<google::monitoring::v3::TimeSeries> time_series =
+      MakeTimeSeries(kMetricNamePrefix, kDefaultResource, view_descriptor, data,
+                     kAddTaskLabel, "test_task");
+
+  ASSERT_EQ(1, time_series.size());
+  ASSERT_EQ(1, time_series[0].points_size());
+  const auto& distribution =
+      time_series[0].points(0).value().distribution_value();
+  EXPECT_EQ(3, distribution.count());
+  // The buckets grew to the powers of two from 0.5 to 8, and are exported
+  // within the fixed layout of the 64 powers of two from 2^-32.
+  const auto& buckets = distribution.bucket_options().exponential_buckets();
+  EXPECT_EQ(64, buckets.num_finite_buckets());
+  EXPECT_EQ(2, buckets.growth_factor());
+  EXPECT_EQ(std::ldexp(1, -32), buckets.scale());
+  // Trailing empty buckets are omitted.
+  ASSERT_EQ(36, distribution.bucket_counts_size());
+  for (int i = 0; i < distribution.bucket_counts_size(); ++i) {
+    EXPECT_EQ(i == 32 || i == 34 || i == 35 ? 1 : 0,
+              distribution.bucket_counts(i))
+        << "bucket " << i;
+  }
+}
+
+TEST(StackdriverUtilsTest, MakeTimeSeriesAutoLogLinearWideRange) {
+  const auto measure = opencensus::stats::MeasureDouble::Register(
+      "measure_auto_log_linear_wide_range", "", "");
+  const auto tag_key = opencensus::tags::TagKey::Register("foo");
+  const auto view_descriptor =
+      opencensus::stats::ViewDescriptor()
+          .set_name("test_view")
+          .set_measure(measure.GetDescriptor().name())
+          .set_aggregation(opencensus::stats::Aggregation::Distribution(
+              opencensus::stats::BucketBoundaries::AutoLogLinear(4)))
+          .add_column(tag_key);
+  // One row has values over 2^-20 to 2^40, 61 powers of two with 16 buckets
+  // each, and the other a single value.
+  std::vector<TestViewValue> values = {{{"narrow"}, 3.0, absl::UnixEpoch()}};
+  for (int exponent = -20; exponent <= 40; ++exponent) {
+    values.push_back({{"wide"}, std::ldexp(1, exponent), absl::UnixEpoch()});
+  }
+  const opencensus::stats::ViewData data =
+      TestUtils::MakeViewDataWithStartTimes(view_descriptor, values);
+  const std::vector<google::monitoring::v3::TimeSeries> time_series =
+      MakeTimeSeries(kMetricNamePrefix, kDefaultResource, view_descriptor, data,
+                     kAddTaskLabel, "test_task");
+
+  ASSERT_EQ(2, time_series.size());
+  const auto& first = time_series[0].points(0).value().distribution_value();
+  const auto& second = time_series[1].points(0).value().distribution_value();
+  const auto& wide = first.count() == 61 ? first : second;
+  const auto& narrow = first.count() == 61 ? second : first;
+  ASSERT_EQ(61, wide.count());
+  // Both rows share one layout, of two buckets per power of two from 2^-32 to
+  // 2^32 to stay within 200 buckets.
+  EXPECT_EQ(wide.bucket_options().SerializeAsString(),
+            narrow.bucket_options().SerializeAsString());
+  const auto& buckets = wide.bucket_options().exponential_buckets();
+  EXPECT_EQ(128, buckets.num_finite_buckets());
+  EXPECT_DOUBLE_EQ(std::sqrt(2), buckets.growth_factor());
+  EXPECT_EQ(std::ldexp(1, -32), buckets.scale());
+  ASSERT_EQ(130, wide.bucket_counts_size());
+  for (int i = 0; i < wide.bucket_counts_size(); ++i) {
+    // Powers of two from 2^-20 to 2^31 start every other bucket, and 2^32 to
+    // 2^40 overflow.
+    const int expected =
+        i == 129 ? 9 : i >= 25 && i <= 127 && i % 2 == 1 ? 1 : 0;
+    EXPECT_EQ(expected, wide.bucket_counts(i)) << "bucket " << i;
+  }
+  // 3 is in the bucket covering [2^1.5, 4).
+  ASSERT_EQ(1, narrow.count());
+  ASSERT_EQ(69, narrow.bucket_counts_size());
+  EXPECT_EQ(1, narrow.bucket_counts(68));
+}
+
 TEST(StackdriverUtilsTest, MakeTimeSeriesLastValueInt) {
   const auto measure = opencensus::stats::MeasureInt64::Register(
       "measure_last_value_int", "", "");
@@ -0,0 +1,130 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/exporters/stats/stackdriver/internal/time_series_sender.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/time/clock.h"
+#include "google/protobuf/empty.pb.h"
+#include "opencensus/common/internal/grpc/status.h"
+
+namespace opencensus {
+namespace exporters {
+namespace stats {
+
+TimeSeriesSender::Request::Request()
+    : proto_(google::protobuf::Arena::CreateMessage<
+             google::monitoring::v3::CreateTimeSeriesRequest>(&arena_)) {}
+
+struct TimeSeriesSender::Call {
+  std::unique_ptr<Request> request;
+  grpc::ClientContext context;
+  google::protobuf::Empty response;
+  grpc::Status status;
+  std::unique_ptr<
+      grpc::ClientAsyncResponseReaderInterface<google::protobuf::Empty>>
+      reader;
+};
+
+TimeSeriesSender::TimeSeriesSender(
+    google::monitoring::v3::MetricService::StubInterface* stub,
+    absl::Duration rpc_deadline,
+    std::function<void(grpc::ClientContext*)> prepare_client_context,
+    int max_concurrent_requests, int max_queued_requests)
+    : stub_(stub),
+      rpc_deadline_(rpc_deadline),
+      prepare_client_context_(std::move(prepare_client_context)),
+      max_concurrent_requests_(std::max(1, max_concurrent_requests)),
+      max_queued_requests_(std::max(0, max_queued_requests)),
+      worker_(&TimeSeriesSender::RunWorker, this) {}
+
+TimeSeriesSender::~TimeSeriesSender() {
+  Flush();
+  cq_.Shutdown();
+  worker_.join();
+}
+
+bool TimeSeriesSender::Send(std::unique_ptr<Request> request) {
+  absl::MutexLock l(&mu_);
+  if (num_in_flight_ < max_concurrent_requests_) {
+    StartCall(std::move(request));
+    return true;
+  }
+  if (queue_.size() >= max_queued_requests_) {
+    return false;
+  }
+  queue_.push_back(std::move(request));
+  return true;
+}
+
+void TimeSeriesSender::Flush() {
+  absl::MutexLock l(&mu_);
+  mu_.Await(absl::Condition(this, &TimeSeriesSender::IsIdle));
+}
+
+int TimeSeriesSender::DropQueued() {
+  std::deque<std::unique_ptr<Request>> dropped;
+  {
+    absl::MutexLock l(&mu_);
+    dropped.swap(queue_);
+  }
+  int num_time_series = 0;
+  for (const auto& request : dropped) {
+    num_time_series += request->proto()->time_series_size();
+  }
+  return num_time_series;
+}
+
+void TimeSeriesSender::StartCall(std::unique_ptr<Request> request) {
+  auto call = absl::make_unique<Call>();
+  call->request = std::move(request);
+  call->context.set_deadline(absl::ToChronoTime(absl::Now() + rpc_deadline_));
+  prepare_client_context_(&call->context);
+  call->reader = stub_->AsyncCreateTimeSeries(
+      &call->context, *call->request->proto(), &cq_);
+  ++num_in_flight_;
+  // Ownership passes to the CompletionQueue until the RPC finishes.
+  Call* tag = call.release();
+  tag->reader->Finish(&tag->response, &tag->status, tag);
+}
+
+void TimeSeriesSender::RunWorker() {
+  void* tag;
+  bool ok;
+  while (cq_.Next(&tag, &ok)) {
+    std::unique_ptr<Call> call(static_cast<Call*>(tag));
+    if (!call->status.ok()) {
+      std::cerr << "CreateTimeSeries request failed ("
+                << call->request->proto()->time_series_size()
+                << " timeseries): "
+                << opencensus::common::ToString(call->status) << "\n";
+    }
+    // Free the request before taking the lock.
+    call.reset();
+    absl::MutexLock l(&mu_);
+    --num_in_flight_;
+    if (!queue_.empty()) {
+      StartCall(std::move(queue_.front()));
+      queue_.pop_front();
+    }
+  }
+}
+
+}  // namespace stats
+}  // namespace exporters
+}  // namespace opencensus
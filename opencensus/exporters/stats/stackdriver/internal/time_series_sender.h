@@ -0,0 +1,113 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPENCENSUS_EXPORTERS_STATS_STACKDRIVER_INTERNAL_TIME_SERIES_SENDER_H_
+#define OPENCENSUS_EXPORTERS_STATS_STACKDRIVER_INTERNAL_TIME_SERIES_SENDER_H_
+
+#include <grpcpp/grpcpp.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "google/monitoring/v3/metric_service.grpc.pb.h"
+#include "google/monitoring/v3/metric_service.pb.h"
+#include "google/protobuf/arena.h"
+
+namespace opencensus {
+namespace exporters {
+namespace stats {
+
+// TimeSeriesSender sends CreateTimeSeries RPCs asynchronously, on a
+// long-lived CompletionQueue served by its own thread, so that callers can
+// build the next request while earlier ones are being sent. At most
+// max_concurrent_requests RPCs are in flight; further requests wait in a queue
+// of up to max_queued_requests, and are dropped beyond that.
+//
+// TimeSeriesSender is thread-safe.
+class TimeSeriesSender final {
+ public:
+  // A CreateTimeSeriesRequest, allocated with everything in it on the
+  // Request's own arena.
+  class Request final {
+   public:
+    Request();
+
+    google::monitoring::v3::CreateTimeSeriesRequest* proto() { return proto_; }
+
+   private:
+    google::protobuf::Arena arena_;
+    google::monitoring::v3::CreateTimeSeriesRequest* const proto_;
+  };
+
+  // 'stub' must outlive the TimeSeriesSender. 'prepare_client_context' is
+  // called on each RPC's ClientContext before it starts.
+  TimeSeriesSender(
+      google::monitoring::v3::MetricService::StubInterface* stub,
+      absl::Duration rpc_deadline,
+      std::function<void(grpc::ClientContext*)> prepare_client_context,
+      int max_concurrent_requests, int max_queued_requests);
+  // Waits for queued and in-flight requests to finish.
+  ~TimeSeriesSender();
+
+  TimeSeriesSender(const TimeSeriesSender&) = delete;
+  TimeSeriesSender& operator=(const TimeSeriesSender&) = delete;
+
+  // Starts sending 'request', or queues it if max_concurrent_requests RPCs
+  // are in flight. Returns false, dropping the request, if the queue is full.
+  bool Send(std::unique_ptr<Request> request) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Blocks until every request sent so far has finished.
+  void Flush() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Drops the requests that are queued but not yet started, and returns the
+  // number of TimeSeries in them.
+  int DropQueued() ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Call;
+
+  void StartCall(std::unique_ptr<Request> request)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Handles completed RPCs until the CompletionQueue is shut down.
+  void RunWorker() ABSL_LOCKS_EXCLUDED(mu_);
+
+  bool IsIdle() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return num_in_flight_ == 0 && queue_.empty();
+  }
+
+  google::monitoring::v3::MetricService::StubInterface* const stub_;
+  const absl::Duration rpc_deadline_;
+  const std::function<void(grpc::ClientContext*)> prepare_client_context_;
+  const int max_concurrent_requests_;
+  const size_t max_queued_requests_;
+
+  grpc::CompletionQueue cq_;
+
+  absl::Mutex mu_;
+  int num_in_flight_ ABSL_GUARDED_BY(mu_) = 0;
+  std::deque<std::unique_ptr<Request>> queue_ ABSL_GUARDED_BY(mu_);
+
+  std::thread worker_;
+};
+
+}  // namespace stats
+}  // namespace exporters
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_EXPORTERS_STATS_STACKDRIVER_INTERNAL_TIME_SERIES_SENDER_H_
@@ -0,0 +1,85 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+
+#include "absl/memory/memory.h"
+#include "absl/time/time.h"
+#include "benchmark/benchmark.h"
+#include "opencensus/exporters/stats/stackdriver/internal/fake_metric_service.h"
+#include "opencensus/exporters/stats/stackdriver/internal/time_series_sender.h"
+
+namespace opencensus {
+namespace exporters {
+namespace stats {
+namespace {
+
+// Stackdriver's limit on TimeSeries per request.
+constexpr int kBatchSize = 200;
+
+std::unique_ptr<TimeSeriesSender::Request> MakeRequest() {
+  auto request = absl::make_unique<TimeSeriesSender::Request>();
+  request->proto()->set_name("projects/test");
+  for (int i = 0; i < kBatchSize; ++i) {
+    auto* time_series = request->proto()->add_time_series();
+    time_series->mutable_metric()->set_type(
+        "custom.googleapis.com/opencensus/benchmark");
+    (*time_series->mutable_metric()->mutable_labels())["key"] = "value";
+    time_series->add_points()->mutable_value()->set_int64_value(i);
+  }
+  return request;
+}
+
+// Sends each request synchronously, as one blocking RPC at a time.
+void BM_SendBlocking(benchmark::State& state) {
+  FakeMetricService service;
+  auto stub = service.NewStub();
+  for (auto _ : state) {
+    auto request = MakeRequest();
+    grpc::ClientContext context;
+    google::protobuf::Empty response;
+    stub->CreateTimeSeries(&context, *request->proto(), &response);
+  }
+  state.SetItemsProcessed(state.iterations() * kBatchSize);
+}
+BENCHMARK(BM_SendBlocking);
+
+// Sends through TimeSeriesSender, building each request while earlier ones
+// are in flight. Arg is max_concurrent_requests.
+void BM_SendPipelined(benchmark::State& state) {
+  FakeMetricService service;
+  auto stub = service.NewStub();
+  // Flushing every kFlushInterval requests bounds the queue without dropping.
+  constexpr int kFlushInterval = 64;
+  TimeSeriesSender sender(stub.get(), absl::Seconds(10),
+                          [](grpc::ClientContext*) {}, state.range(0),
+                          kFlushInterval);
+  int num_sent = 0;
+  for (auto _ : state) {
+    sender.Send(MakeRequest());
+    if (++num_sent % kFlushInterval == 0) {
+      sender.Flush();
+    }
+  }
+  sender.Flush();
+  state.SetItemsProcessed(state.iterations() * kBatchSize);
+}
+BENCHMARK(BM_SendPipelined)->Arg(1)->Arg(4)->Arg(8);
+
+}  // namespace
+}  // namespace stats
+}  // namespace exporters
+}  // namespace opencensus
+
+BENCHMARK_MAIN();
@@ -0,0 +1,153 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/exporters/stats/stackdriver/internal/time_series_sender.h"
+
+#include <memory>
+#include <thread>
+
+#include "absl/memory/memory.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+#include "opencensus/exporters/stats/stackdriver/internal/fake_metric_service.h"
+
+namespace opencensus {
+namespace exporters {
+namespace stats {
+namespace {
+
+std::unique_ptr<TimeSeriesSender::Request> MakeRequest(int num_time_series) {
+  auto request = absl::make_unique<TimeSeriesSender::Request>();
+  request->proto()->set_name("projects/test");
+  for (int i = 0; i < num_time_series; ++i) {
+    request->proto()->add_time_series()->mutable_metric()->set_type("test");
+  }
+  return request;
+}
+
+class TimeSeriesSenderTest : public ::testing::Test {
+ protected:
+  std::unique_ptr<TimeSeriesSender> MakeSender(int max_concurrent_requests,
+                                               int max_queued_requests) {
+    return absl::make_unique<TimeSeriesSender>(
+        stub_.get(), absl::Seconds(10), [](grpc::ClientContext*) {},
+        max_concurrent_requests, max_queued_requests);
+  }
+
+  FakeMetricService service_;
+  const std::unique_ptr<google::monitoring::v3::MetricService::StubInterface>
+      stub_ = service_.NewStub();
+};
+
+TEST_F(TimeSeriesSenderTest, SendsRequests) {
+  auto sender = MakeSender(2, 10);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(sender->Send(MakeRequest(3)));
+  }
+  sender->Flush();
+  EXPECT_EQ(5, service_.num_calls());
+  EXPECT_EQ(15, service_.num_time_series());
+}
+
+TEST_F(TimeSeriesSenderTest, SendReturnsWhileRequestsAreInFlight) {
+  auto sender = MakeSender(2, 10);
+  service_.Hold();
+  EXPECT_TRUE(sender->Send(MakeRequest(1)));
+  EXPECT_TRUE(sender->Send(MakeRequest(1)));
+  service_.WaitForCalls(2);
+  service_.Release();
+  sender->Flush();
+  EXPECT_EQ(2, service_.num_calls());
+}
+
+TEST_F(TimeSeriesSenderTest, LimitsConcurrentRequests) {
+  auto sender = MakeSender(2, 10);
+  service_.Hold();
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_TRUE(sender->Send(MakeRequest(1)));
+  }
+  service_.WaitForCalls(2);
+  // Give any excess requests time to arrive.
+  absl::SleepFor(absl::Milliseconds(50));
+  EXPECT_EQ(2, service_.num_calls());
+  service_.Release();
+  sender->Flush();
+  EXPECT_EQ(6, service_.num_calls());
+  EXPECT_EQ(2, service_.max_concurrent_calls());
+}
+
+TEST_F(TimeSeriesSenderTest, DropsRequestsWhenQueueIsFull) {
+  auto sender = MakeSender(1, 1);
+  service_.Hold();
+  EXPECT_TRUE(sender->Send(MakeRequest(1)));
+  service_.WaitForCalls(1);
+  EXPECT_TRUE(sender->Send(MakeRequest(1)));
+  EXPECT_FALSE(sender->Send(MakeRequest(1)));
+  service_.Release();
+  sender->Flush();
+  EXPECT_EQ(2, service_.num_calls());
+}
+
+TEST_F(TimeSeriesSenderTest, DropQueuedKeepsStartedRequests) {
+  auto sender = MakeSender(1, 10);
+  service_.Hold();
+  EXPECT_TRUE(sender->Send(MakeRequest(1)));
+  service_.WaitForCalls(1);
+  EXPECT_TRUE(sender->Send(MakeRequest(2)));
+  EXPECT_TRUE(sender->Send(MakeRequest(3)));
+  EXPECT_EQ(5, sender->DropQueued());
+  EXPECT_EQ(0, sender->DropQueued());
+  service_.Release();
+  sender->Flush();
+  EXPECT_EQ(1, service_.num_calls());
+  EXPECT_EQ(1, service_.num_time_series());
+}
+
+TEST_F(TimeSeriesSenderTest, FlushWaitsForStartedRequests) {
+  // This is how the exporter keeps one export's points from overtaking the
+  // previous export's: nothing new is sent until the old requests finish.
+  auto sender = MakeSender(2, 10);
+  service_.Hold();
+  EXPECT_TRUE(sender->Send(MakeRequest(1)));
+  EXPECT_TRUE(sender->Send(MakeRequest(1)));
+  service_.WaitForCalls(2);
+  absl::Notification flushed;
+  std::thread flusher([&sender, &flushed]() {
+    sender->Flush();
+    flushed.Notify();
+  });
+  EXPECT_FALSE(flushed.WaitForNotificationWithTimeout(absl::Milliseconds(50)));
+  service_.Release();
+  flusher.join();
+  EXPECT_TRUE(flushed.HasBeenNotified());
+  EXPECT_EQ(2, service_.num_calls());
+}
+
+TEST_F(TimeSeriesSenderTest, DestructorFinishesRequests) {
+  {
+    auto sender = MakeSender(1, 10);
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_TRUE(sender->Send(MakeRequest(2)));
+    }
+  }
+  EXPECT_EQ(3, service_.num_calls());
+  EXPECT_EQ(6, service_.num_time_series());
+}
+
+}  // namespace
+}  // namespace stats
+}  // namespace exporters
+}  // namespace opencensus
@@ -41,6 +41,12 @@ struct StackdriverOptions {
   // The RPC deadline to use when exporting to Stackdriver.
   absl::Duration rpc_deadline = absl::Seconds(60);
 
+  // The maximum number of CreateTimeSeries RPCs in flight at once. Exports
+  // return without waiting for their RPCs; requests beyond this limit wait in
+  // a queue of up to max_queued_requests, and are dropped when it is full.
+  int max_concurrent_requests = 8;
+  int max_queued_requests = 64;
+
   // Optional: the Stackdriver MonitoredResource to use.
   //
   // If not set (i.e. if monitored_resource.type is empty), the exporter will
@@ -47,6 +47,23 @@ std::string DataToString(const opencensus::stats::Distribution& data) {
   }
   return output;
 }
+// Quantile sketches print the quantiles requested by the aggregation.
+template <typename DataValueT>
+std::string DataToString(const opencensus::stats::Aggregation& aggregation,
+                         const DataValueT& data) {
+  return DataToString(data);
+}
+std::string DataToString(const opencensus::stats::Aggregation& aggregation,
+                         const opencensus::stats::QuantileSketch& data) {
+  std::string output =
+      absl::StrCat("\n    count: ", data.count(), " sum: ", data.sum(),
+                   " min: ", data.min(), " max: ", data.max(), "\n");
+  for (double quantile : aggregation.quantiles()) {
+    absl::StrAppend(&output, "    q", quantile, ": ", data.Quantile(quantile),
+                    "\n");
+  }
+  return output;
+}
 
 class Handler : public opencensus::stats::StatsExporter::Handler {
  public:
@@ -86,6 +103,10 @@ void Handler::ExportViewData(
         ExportViewDataImpl(datum.first, view_data.start_times(),
                            view_data.end_time(), view_data.distribution_data());
         break;
+      case opencensus::stats::ViewData::Type::kQuantiles:
+        ExportViewDataImpl(datum.first, view_data.start_times(),
+                           view_data.end_time(), view_data.quantile_data());
+        break;
     }
   }
   stream_->flush();
@@ -115,7 +136,8 @@ void Handler::ExportViewDataImpl(
       absl::StrAppend(&output, descriptor.columns()[i].name(), "=",
                       row.first[i], " ");
     }
-    absl::StrAppend(&output, DataToString(row.second));
+    absl::StrAppend(&output,
+                    DataToString(descriptor.aggregation(), row.second));
   }
   absl::StrAppend(&output, "\n");
   *stream_ << output;
@@ -19,10 +19,13 @@
 
 #include <cstdint>
 #include <iostream>
+#include <memory>
+#include <utility>
 
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "absl/time/clock.h"
+#include "opencensus/common/internal/grpc/export_stream.h"
 #include "opencensus/common/internal/grpc/status.h"
 #include "opencensus/common/internal/grpc/with_user_agent.h"
 #include "opencensus/common/internal/hostname.h"
@@ -164,6 +167,11 @@ void ConvertLinks(const ::opencensus::trace::exporter::SpanData &span,
   }
 }
 
+using ExportStream = ::opencensus::common::ExportStream<
+    ::opencensus::proto::agent::trace::v1::TraceService::StubInterface,
+    ::opencensus::proto::agent::trace::v1::ExportTraceServiceRequest,
+    ::opencensus::proto::agent::trace::v1::ExportTraceServiceResponse>;
+
 class Handler : public ::opencensus::trace::exporter::SpanExporter::Handler {
  public:
   Handler(OcAgentOptions &&opts);
@@ -174,10 +182,11 @@ class Handler : public ::opencensus::trace::exporter::SpanExporter::Handler {
  private:
   const OcAgentOptions opts_;
   ::opencensus::proto::agent::common::v1::Node nodeInfo_;
+  std::unique_ptr<ExportStream> stream_;
   void ConnectAgent();
   void InitNode();
   void ExportRpcRequest(
-      const ::opencensus::proto::agent::trace::v1::ExportTraceServiceRequest &);
+      ::opencensus::proto::agent::trace::v1::ExportTraceServiceRequest &&);
 };
 
 void ConvertSpans(
@@ -240,6 +249,11 @@ void ConvertSpans(
 
 Handler::Handler(OcAgentOptions &&opts) : opts_(std::move(opts)) {
   InitNode();
+  ::opencensus::proto::agent::trace::v1::ExportTraceServiceRequest header;
+  *header.mutable_node() = nodeInfo_;
+  stream_ = absl::make_unique<ExportStream>(
+      opts_.trace_service_stub.get(), header, "OcAgent trace exporter",
+      opts_.initial_backoff, opts_.max_backoff, opts_.max_queued_requests);
   ConnectAgent();
 }
 
@@ -247,32 +261,16 @@ void Handler::Export(
     const std::vector<::opencensus::trace::exporter::SpanData> &spans) {
   ::opencensus::proto::agent::trace::v1::ExportTraceServiceRequest request;
   ConvertSpans(spans, &request);
-  *request.mutable_node() = nodeInfo_;
-  ExportRpcRequest(request);
+  ExportRpcRequest(std::move(request));
 }
 
 void Handler::ExportRpcRequest(
-    const ::opencensus::proto::agent::trace::v1::ExportTraceServiceRequest
-        &request) {
-  // TODO: Re-work this to have a single long-running streaming RPC.
-  grpc::ClientContext context;
-  context.set_deadline(absl::ToChronoTime(absl::Now() + opts_.rpc_deadline));
-
-  auto stream = opts_.trace_service_stub->Export(&context);
-  if (stream == nullptr) {
-    std::cerr << "OcAgent trace exporter: Export() got a NULL stream.\n";
-    return;
-  }
-
-  if (!stream->Write(request)) {
-    std::cerr << "OcAgent trace exporter: Export() stream broken.\n";
-  }
-
-  stream->WritesDone();
-  grpc::Status status = stream->Finish();
-  if (!status.ok()) {
-    std::cerr << "OcAgent trace exporter: Export() failed: "
-              << opencensus::common::ToString(status) << "\n";
+    ::opencensus::proto::agent::trace::v1::ExportTraceServiceRequest
+        &&request) {
+  const int num_spans = request.spans_size();
+  if (!stream_->Send(std::move(request))) {
+    std::cerr << "OcAgent trace exporter: dropped " << num_spans
+              << " spans, too many requests waiting to be sent.\n";
   }
 }
 
@@ -297,9 +295,9 @@ void Handler::InitNode() {
 }
 
 void Handler::ConnectAgent() {
-  ::opencensus::proto::agent::trace::v1::ExportTraceServiceRequest request;
-  *request.mutable_node() = nodeInfo_;
-  ExportRpcRequest(request);
+  // Opens the stream, which sends the Node.
+  ExportRpcRequest(
+      ::opencensus::proto::agent::trace::v1::ExportTraceServiceRequest());
 
 #if 0
   // Config is unimplemented as of opencensus-service v0.1.9:
@@ -30,9 +30,19 @@ struct OcAgentOptions {
   // The OcAgent address to use.
   std::string address;
 
-  // The RPC deadline to use when exporting to OcAgent.
+  // The RPC deadline to use when exporting to OcAgent. Not used for spans,
+  // which are written to a single Export stream that stays open.
   absl::Duration rpc_deadline = absl::Seconds(5);
 
+  // If the Export stream breaks, it is reopened after initial_backoff, which
+  // doubles after each failed attempt up to max_backoff.
+  absl::Duration initial_backoff = absl::Milliseconds(100);
+  absl::Duration max_backoff = absl::Seconds(30);
+
+  // The maximum number of batches of spans waiting to be written to the
+  // stream. Batches exported while this many are waiting are dropped.
+  int max_queued_requests = 16;
+
   // (optional) If not empty, set the service name to this.
   std::string service_name;
 
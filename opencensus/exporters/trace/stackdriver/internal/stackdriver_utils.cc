@@ -0,0 +1,294 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/exporters/trace/stackdriver/internal/stackdriver_utils.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "google/devtools/cloudtrace/v2/tracing.pb.h"
+#include "google/protobuf/arena.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "opencensus/common/internal/timestamp.h"
+#include "opencensus/common/version.h"
+#include "opencensus/trace/exporter/span_data.h"
+
+namespace opencensus {
+namespace exporters {
+namespace trace {
+
+namespace {
+
+constexpr size_t kAttributeStringLen = 256;
+constexpr size_t kAnnotationStringLen = 256;
+constexpr size_t kDisplayNameStringLen = 128;
+
+constexpr char kAgentKey[] = "g.co/agent";
+constexpr char kAgentValue[] = "opencensus-cpp [" OPENCENSUS_VERSION "]";
+
+void SetTruncatableString(
+    absl::string_view str, size_t max_len,
+    ::google::devtools::cloudtrace::v2::TruncatableString* t_str) {
+  if (str.size() > max_len) {
+    t_str->set_value(std::string(str.substr(0, max_len)));
+    t_str->set_truncated_byte_count(str.size() - max_len);
+  } else {
+    t_str->set_value(std::string(str));
+    t_str->set_truncated_byte_count(0);
+  }
+}
+
+::google::devtools::cloudtrace::v2::Span_Link_Type ConvertLinkType(
+    ::opencensus::trace::exporter::Link::Type type) {
+  switch (type) {
+    case ::opencensus::trace::exporter::Link::Type::kChildLinkedSpan:
+      return ::google::devtools::cloudtrace::v2::
+          Span_Link_Type_CHILD_LINKED_SPAN;
+    case ::opencensus::trace::exporter::Link::Type::kParentLinkedSpan:
+      return ::google::devtools::cloudtrace::v2::
+          Span_Link_Type_PARENT_LINKED_SPAN;
+  }
+  return ::google::devtools::cloudtrace::v2::Span_Link_Type_TYPE_UNSPECIFIED;
+}
+
+::google::devtools::cloudtrace::v2::Span_TimeEvent_MessageEvent_Type
+ConvertMessageType(::opencensus::trace::exporter::MessageEvent::Type type) {
+  using Type = ::opencensus::trace::exporter::MessageEvent::Type;
+  switch (type) {
+    case Type::SENT:
+      return ::google::devtools::cloudtrace::v2::
+          Span_TimeEvent_MessageEvent_Type_SENT;
+    case Type::RECEIVED:
+      return ::google::devtools::cloudtrace::v2::
+          Span_TimeEvent_MessageEvent_Type_RECEIVED;
+  }
+  return ::google::devtools::cloudtrace::v2::
+      Span_TimeEvent_MessageEvent_Type_TYPE_UNSPECIFIED;
+}
+
+using AttributeMap =
+    ::google::protobuf::Map<std::string,
+                            ::google::devtools::cloudtrace::v2::AttributeValue>;
+void PopulateAttributes(
+    const std::unordered_map<
+        std::string, ::opencensus::trace::exporter::AttributeValue>& attributes,
+    AttributeMap* attribute_map) {
+  for (const auto& attr : attributes) {
+    using Type = ::opencensus::trace::exporter::AttributeValue::Type;
+    switch (attr.second.type()) {
+      case Type::kString:
+        SetTruncatableString(
+            attr.second.string_value(), kAttributeStringLen,
+            (*attribute_map)[attr.first].mutable_string_value());
+        break;
+      case Type::kBool:
+        (*attribute_map)[attr.first].set_bool_value(attr.second.bool_value());
+        break;
+      case Type::kInt:
+        (*attribute_map)[attr.first].set_int_value(attr.second.int_value());
+        break;
+    }
+  }
+}
+
+void ConvertAttributes(const ::opencensus::trace::exporter::SpanData& span,
+                       ::google::devtools::cloudtrace::v2::Span* proto_span) {
+  PopulateAttributes(span.attributes(),
+                     proto_span->mutable_attributes()->mutable_attribute_map());
+  proto_span->mutable_attributes()->set_dropped_attributes_count(
+      span.num_attributes_dropped());
+}
+
+void ConvertTimeEvents(const ::opencensus::trace::exporter::SpanData& span,
+                       ::google::devtools::cloudtrace::v2::Span* proto_span) {
+  for (const auto& annotation : span.annotations().events()) {
+    auto event = proto_span->mutable_time_events()->add_time_event();
+    opencensus::common::SetTimestamp(annotation.timestamp(),
+                                     event->mutable_time());
+
+    // Populate annotation.
+    SetTruncatableString(annotation.event().description(), kAnnotationStringLen,
+                         event->mutable_annotation()->mutable_description());
+    PopulateAttributes(annotation.event().attributes(),
+                       event->mutable_annotation()
+                           ->mutable_attributes()
+                           ->mutable_attribute_map());
+  }
+
+  for (const auto& message : span.message_events().events()) {
+    auto event = proto_span->mutable_time_events()->add_time_event();
+    opencensus::common::SetTimestamp(message.timestamp(),
+                                     event->mutable_time());
+
+    // Populate message event.
+    event->mutable_message_event()->set_type(
+        ConvertMessageType(message.event().type()));
+    event->mutable_message_event()->set_id(message.event().id());
+    event->mutable_message_event()->set_uncompressed_size_bytes(
+        message.event().uncompressed_size());
+    event->mutable_message_event()->set_compressed_size_bytes(
+        message.event().compressed_size());
+  }
+
+  proto_span->mutable_time_events()->set_dropped_annotations_count(
+      span.annotations().dropped_events_count());
+  proto_span->mutable_time_events()->set_dropped_message_events_count(
+      span.message_events().dropped_events_count());
+}
+
+void ConvertLinks(const ::opencensus::trace::exporter::SpanData& span,
+                  ::google::devtools::cloudtrace::v2::Span* proto_span) {
+  proto_span->mutable_links()->set_dropped_links_count(
+      span.num_links_dropped());
+  for (const auto& span_link : span.links()) {
+    auto link = proto_span->mutable_links()->add_link();
+    link->set_trace_id(span_link.trace_id().ToHex());
+    link->set_span_id(span_link.span_id().ToHex());
+    link->set_type(ConvertLinkType(span_link.type()));
+    PopulateAttributes(
+        span_link.attributes(),
+        proto_span->mutable_attributes()->mutable_attribute_map());
+  }
+}
+
+// Converts 'spans' into BatchWriteSpansRequests allocated on 'arena', and
+// appends them to 'requests'. Each span is converted on its own and then
+// added to the current request, or to a new one if it would take the current
+// request over max_request_bytes, so nothing is encoded twice.
+void ConvertSlice(
+    absl::Span<const ::opencensus::trace::exporter::SpanData> spans,
+    absl::string_view project_id, absl::string_view project_name,
+    size_t max_request_bytes, google::protobuf::Arena* arena,
+    std::vector<::google::devtools::cloudtrace::v2::BatchWriteSpansRequest*>*
+        requests) {
+  ::google::devtools::cloudtrace::v2::BatchWriteSpansRequest* request =
+      nullptr;
+  size_t request_bytes = 0;
+  for (const auto& from_span : spans) {
+    auto* to_span = google::protobuf::Arena::CreateMessage<
+        ::google::devtools::cloudtrace::v2::Span>(arena);
+    ConvertSpan(from_span, project_id, to_span);
+    // The span's field tag, length prefix and contents.
+    const size_t span_size = to_span->ByteSizeLong();
+    const size_t span_bytes =
+        1 + google::protobuf::io::CodedOutputStream::VarintSize64(span_size) +
+        span_size;
+    if (request == nullptr ||
+        (request->spans_size() > 0 &&
+         request_bytes + span_bytes > max_request_bytes)) {
+      request = google::protobuf::Arena::CreateMessage<
+          ::google::devtools::cloudtrace::v2::BatchWriteSpansRequest>(arena);
+      request->set_name(std::string(project_name));
+      request_bytes = request->ByteSizeLong();
+      requests->push_back(request);
+    }
+    // Both are on 'arena', so this doesn't copy the span.
+    request->mutable_spans()->AddAllocated(to_span);
+    request_bytes += span_bytes;
+  }
+}
+}  // namespace
+
+void ConvertSpan(const ::opencensus::trace::exporter::SpanData& from_span,
+                 absl::string_view project_id,
+                 ::google::devtools::cloudtrace::v2::Span* to_span) {
+  SetTruncatableString(from_span.name(), kDisplayNameStringLen,
+                       to_span->mutable_display_name());
+  to_span->set_name(absl::StrCat(
+      "projects/", project_id, "/traces/",
+      from_span.context().trace_id().ToHex(), "/spans/",
+      from_span.context().span_id().ToHex()));
+  to_span->set_span_id(from_span.context().span_id().ToHex());
+  to_span->set_parent_span_id(from_span.parent_span_id().ToHex());
+
+  // The start time of the span.
+  opencensus::common::SetTimestamp(from_span.start_time(),
+                                   to_span->mutable_start_time());
+
+  // The end time of the span.
+  opencensus::common::SetTimestamp(from_span.end_time(),
+                                   to_span->mutable_end_time());
+
+  // Export Attributes
+  ConvertAttributes(from_span, to_span);
+
+  // Export Time Events.
+  ConvertTimeEvents(from_span, to_span);
+
+  // Export Links.
+  ConvertLinks(from_span, to_span);
+
+  // True if the parent is on a different process.
+  to_span->mutable_same_process_as_parent_span()->set_value(
+      !from_span.has_remote_parent());
+
+  // The status of the span.
+  to_span->mutable_status()->set_code(
+      static_cast<int32_t>(from_span.status().CanonicalCode()));
+  to_span->mutable_status()->set_message(from_span.status().error_message());
+
+  // Add agent attribute.
+  SetTruncatableString(
+      kAgentValue, kAttributeStringLen,
+      (*to_span->mutable_attributes()->mutable_attribute_map())[kAgentKey]
+          .mutable_string_value());
+}
+
+std::vector<::google::devtools::cloudtrace::v2::BatchWriteSpansRequest*>
+ConvertSpans(absl::Span<const ::opencensus::trace::exporter::SpanData> spans,
+             absl::string_view project_id, int max_threads,
+             size_t max_request_bytes, google::protobuf::Arena* arena) {
+  const std::string project_name = absl::StrCat("projects/", project_id);
+  // The arena is safe to allocate from on several threads at once.
+  const size_t num_slices = std::max<size_t>(
+      1, std::min<size_t>(std::max(max_threads, 1),
+                          spans.size() / kMinSpansPerThread));
+  std::vector<
+      std::vector<::google::devtools::cloudtrace::v2::BatchWriteSpansRequest*>>
+      slice_requests(num_slices);
+  const auto convert_slice = [&](size_t i) {
+    const size_t begin = spans.size() * i / num_slices;
+    const size_t end = spans.size() * (i + 1) / num_slices;
+    ConvertSlice(spans.subspan(begin, end - begin), project_id, project_name,
+                 max_request_bytes, arena, &slice_requests[i]);
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(num_slices - 1);
+  for (size_t i = 1; i < num_slices; ++i) {
+    threads.emplace_back(convert_slice, i);
+  }
+  convert_slice(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<::google::devtools::cloudtrace::v2::BatchWriteSpansRequest*>
+      requests = std::move(slice_requests[0]);
+  for (size_t i = 1; i < num_slices; ++i) {
+    requests.insert(requests.end(), slice_requests[i].begin(),
+                    slice_requests[i].end());
+  }
+  return requests;
+}
+
+}  // namespace trace
+}  // namespace exporters
+}  // namespace opencensus
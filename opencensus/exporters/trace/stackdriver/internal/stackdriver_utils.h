@@ -0,0 +1,56 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPENCENSUS_EXPORTERS_TRACE_STACKDRIVER_INTERNAL_STACKDRIVER_UTILS_H_
+#define OPENCENSUS_EXPORTERS_TRACE_STACKDRIVER_INTERNAL_STACKDRIVER_UTILS_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "google/devtools/cloudtrace/v2/tracing.pb.h"
+#include "google/protobuf/arena.h"
+#include "opencensus/trace/exporter/span_data.h"
+
+namespace opencensus {
+namespace exporters {
+namespace trace {
+
+// Requests are split to stay under gRPC's default 4MiB message size limit.
+constexpr size_t kMaxRequestBytes = 4 << 20;
+
+// Batches are only split across threads into slices of at least this many
+// spans, so that conversion outweighs starting a thread.
+constexpr size_t kMinSpansPerThread = 512;
+
+// Populates 'to_span' from 'from_span'.
+void ConvertSpan(const ::opencensus::trace::exporter::SpanData& from_span,
+                 absl::string_view project_id,
+                 ::google::devtools::cloudtrace::v2::Span* to_span);
+
+// Converts 'spans' into BatchWriteSpansRequests for 'project_id', allocated on
+// 'arena', and returns them in the order of 'spans'. A request only exceeds
+// 'max_request_bytes' if it holds a single span that does on its own. Large
+// batches are converted in slices on up to 'max_threads' threads.
+std::vector<::google::devtools::cloudtrace::v2::BatchWriteSpansRequest*>
+ConvertSpans(absl::Span<const ::opencensus::trace::exporter::SpanData> spans,
+             absl::string_view project_id, int max_threads,
+             size_t max_request_bytes, google::protobuf::Arena* arena);
+
+}  // namespace trace
+}  // namespace exporters
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_EXPORTERS_TRACE_STACKDRIVER_INTERNAL_STACKDRIVER_UTILS_H_
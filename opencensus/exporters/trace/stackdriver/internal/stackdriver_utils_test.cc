@@ -0,0 +1,198 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/exporters/trace/stackdriver/internal/stackdriver_utils.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "google/devtools/cloudtrace/v2/tracing.pb.h"
+#include "google/protobuf/arena.h"
+#include "gtest/gtest.h"
+#include "opencensus/trace/attribute_value_ref.h"
+#include "opencensus/trace/exporter/annotation.h"
+#include "opencensus/trace/exporter/attribute_value.h"
+#include "opencensus/trace/exporter/message_event.h"
+#include "opencensus/trace/exporter/span_data.h"
+#include "opencensus/trace/exporter/status.h"
+#include "opencensus/trace/span_context.h"
+#include "opencensus/trace/span_id.h"
+#include "opencensus/trace/trace_id.h"
+#include "opencensus/trace/trace_options.h"
+
+namespace opencensus {
+namespace exporters {
+namespace trace {
+namespace {
+
+using ::google::devtools::cloudtrace::v2::BatchWriteSpansRequest;
+using ::opencensus::trace::exporter::SpanData;
+
+constexpr char kProjectId[] = "test-project";
+
+// Returns a span whose SpanId encodes 'n', with 'num_attributes' string
+// attributes of 'attribute_len' bytes each.
+SpanData MakeSpan(uint32_t n, int num_attributes = 0,
+                  size_t attribute_len = 0) {
+  const uint8_t trace_id[16] = {1};
+  uint8_t span_id[8] = {0};
+  for (int i = 0; i < 4; ++i) {
+    span_id[7 - i] = static_cast<uint8_t>(n >> (8 * i));
+  }
+  std::unordered_map<std::string, ::opencensus::trace::exporter::AttributeValue>
+      attributes;
+  const std::string value(attribute_len, 'v');
+  for (int i = 0; i < num_attributes; ++i) {
+    attributes.emplace(absl::StrCat("key", i),
+                       ::opencensus::trace::exporter::AttributeValue(
+                           ::opencensus::trace::AttributeValueRef(value)));
+  }
+  const absl::Time start = absl::FromUnixSeconds(1000);
+  return SpanData(
+      "Span",
+      ::opencensus::trace::SpanContext(
+          ::opencensus::trace::TraceId(trace_id),
+          ::opencensus::trace::SpanId(span_id),
+          ::opencensus::trace::TraceOptions()),
+      ::opencensus::trace::SpanId(),
+      SpanData::TimeEvents<::opencensus::trace::exporter::Annotation>({}, 0),
+      SpanData::TimeEvents<::opencensus::trace::exporter::MessageEvent>({}, 0),
+      /*links=*/{}, /*num_links_dropped=*/0, std::move(attributes),
+      /*num_attributes_dropped=*/0, /*has_ended=*/true, start,
+      start + absl::Milliseconds(1), ::opencensus::trace::exporter::Status(),
+      /*has_remote_parent=*/false);
+}
+
+std::vector<SpanData> MakeSpans(uint32_t n) {
+  std::vector<SpanData> spans;
+  spans.reserve(n);
+  for (uint32_t i = 0; i < n; ++i) {
+    spans.push_back(MakeSpan(i));
+  }
+  return spans;
+}
+
+// Returns the span IDs in 'requests', in order.
+std::vector<std::string> SpanIds(
+    const std::vector<BatchWriteSpansRequest*>& requests) {
+  std::vector<std::string> ids;
+  for (const auto* request : requests) {
+    for (const auto& span : request->spans()) {
+      ids.push_back(span.span_id());
+    }
+  }
+  return ids;
+}
+
+TEST(ConvertSpansTest, ConvertsSpan) {
+  google::protobuf::Arena arena;
+  const std::vector<SpanData> spans = {MakeSpan(1, 1, 3)};
+  const auto requests =
+      ConvertSpans(spans, kProjectId, 1, kMaxRequestBytes, &arena);
+  ASSERT_EQ(1, requests.size());
+  EXPECT_EQ("projects/test-project", requests[0]->name());
+  ASSERT_EQ(1, requests[0]->spans_size());
+  const auto& span = requests[0]->spans(0);
+  EXPECT_EQ(
+      "projects/test-project/traces/01000000000000000000000000000000/spans/"
+      "0000000000000001",
+      span.name());
+  EXPECT_EQ("0000000000000001", span.span_id());
+  EXPECT_EQ("Span", span.display_name().value());
+  const auto& attributes = span.attributes().attribute_map();
+  EXPECT_EQ("vvv", attributes.at("key0").string_value().value());
+  EXPECT_EQ(1, attributes.count("g.co/agent"));
+}
+
+TEST(ConvertSpansTest, SplitsAtMaxRequestBytes) {
+  // About 2.5KiB per span, so that a few thousand spans need several requests.
+  std::vector<SpanData> spans;
+  for (uint32_t i = 0; i < 5000; ++i) {
+    spans.push_back(MakeSpan(i, 10, 200));
+  }
+  google::protobuf::Arena arena;
+  const auto requests =
+      ConvertSpans(spans, kProjectId, 1, kMaxRequestBytes, &arena);
+  ASSERT_GT(requests.size(), 1);
+  int num_spans = 0;
+  for (const auto* request : requests) {
+    EXPECT_LE(request->ByteSizeLong(), kMaxRequestBytes);
+    num_spans += request->spans_size();
+  }
+  EXPECT_EQ(spans.size(), num_spans);
+  // Each request but the last is full: the next span wouldn't have fit.
+  for (size_t i = 0; i + 1 < requests.size(); ++i) {
+    BatchWriteSpansRequest with_next(*requests[i]);
+    *with_next.add_spans() = requests[i + 1]->spans(0);
+    EXPECT_GT(with_next.ByteSizeLong(), kMaxRequestBytes);
+  }
+}
+
+TEST(ConvertSpansTest, OversizedSpanGetsItsOwnRequest) {
+  const std::vector<SpanData> spans = {MakeSpan(0), MakeSpan(1, 100, 200),
+                                       MakeSpan(2), MakeSpan(3)};
+  google::protobuf::Arena arena;
+  const size_t max_request_bytes = 1000;
+  const auto requests =
+      ConvertSpans(spans, kProjectId, 1, max_request_bytes, &arena);
+  ASSERT_EQ(3, requests.size());
+  EXPECT_EQ(1, requests[0]->spans_size());
+  ASSERT_EQ(1, requests[1]->spans_size());
+  EXPECT_GT(requests[1]->ByteSizeLong(), max_request_bytes);
+  EXPECT_EQ("0000000000000001", requests[1]->spans(0).span_id());
+  EXPECT_EQ(2, requests[2]->spans_size());
+  EXPECT_LE(requests[2]->ByteSizeLong(), max_request_bytes);
+}
+
+TEST(ConvertSpansTest, KeepsOrderAcrossSlices) {
+  const std::vector<SpanData> spans = MakeSpans(4 * kMinSpansPerThread + 3);
+  google::protobuf::Arena arena;
+  // Small requests, so that every slice makes several.
+  const auto requests = ConvertSpans(spans, kProjectId, 4, 10000, &arena);
+  const std::vector<std::string> ids = SpanIds(requests);
+  ASSERT_EQ(spans.size(), ids.size());
+  for (size_t i = 0; i < spans.size(); ++i) {
+    EXPECT_EQ(spans[i].context().span_id().ToHex(), ids[i]);
+  }
+}
+
+TEST(ConvertSpansTest, SingleThreadMatchesSlices) {
+  const std::vector<SpanData> spans = MakeSpans(3 * kMinSpansPerThread);
+  google::protobuf::Arena arena;
+  const auto one_thread = ConvertSpans(spans, kProjectId, 1, 10000, &arena);
+  const auto three_threads = ConvertSpans(spans, kProjectId, 3, 10000, &arena);
+  EXPECT_EQ(SpanIds(one_thread), SpanIds(three_threads));
+  // One thread packs requests across the slice boundaries, so it never needs
+  // more requests.
+  EXPECT_LE(one_thread.size(), three_threads.size());
+  for (const auto* request : one_thread) {
+    EXPECT_LE(request->ByteSizeLong(), 10000);
+  }
+}
+
+TEST(ConvertSpansTest, EmptyBatchHasNoRequests) {
+  google::protobuf::Arena arena;
+  EXPECT_TRUE(
+      ConvertSpans({}, kProjectId, 4, kMaxRequestBytes, &arena).empty());
+}
+
+}  // namespace
+}  // namespace trace
+}  // namespace exporters
+}  // namespace opencensus
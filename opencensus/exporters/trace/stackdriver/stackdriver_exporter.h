@@ -35,6 +35,12 @@ struct StackdriverOptions {
   // The RPC deadline to use when exporting to Stackdriver.
   absl::Duration rpc_deadline = absl::Seconds(10);
 
+  // The most threads to convert one export's spans to protos with. Large
+  // batches are split into slices of at least a few hundred spans, each
+  // converted on its own thread; 1 converts every batch on the exporting
+  // thread.
+  int max_conversion_threads = 4;
+
   // (optional) By default, the exporter connects to Stackdriver using gRPC. If
   // this stub is non-null, the exporter will use this stub to send gRPC calls
   // instead. Useful for testing.
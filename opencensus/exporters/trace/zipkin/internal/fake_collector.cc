@@ -0,0 +1,192 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/exporters/trace/zipkin/internal/fake_collector.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace opencensus {
+namespace exporters {
+namespace trace {
+
+namespace {
+
+bool SendAll(int fd, absl::string_view data) {
+  while (!data.empty()) {
+    const ssize_t n = send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    if (n <= 0) return false;
+    data.remove_prefix(n);
+  }
+  return true;
+}
+
+}  // namespace
+
+FakeCollector::FakeCollector() {
+  listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  socklen_t addr_len = sizeof(addr);
+  if (listen_fd_ < 0 ||
+      bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), addr_len) != 0 ||
+      listen(listen_fd_, 64) != 0 ||
+      getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr),
+                  &addr_len) != 0) {
+    abort();
+  }
+  port_ = ntohs(addr.sin_port);
+  accept_thread_ = std::thread(&FakeCollector::AcceptLoop, this);
+}
+
+FakeCollector::~FakeCollector() {
+  // Unblocks accept() and recv().
+  shutdown(listen_fd_, SHUT_RDWR);
+  accept_thread_.join();
+  close(listen_fd_);
+  std::vector<std::thread> threads;
+  {
+    absl::MutexLock l(&mu_);
+    for (int fd : connection_fds_) {
+      shutdown(fd, SHUT_RDWR);
+    }
+    threads.swap(connection_threads_);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+std::string FakeCollector::url() const {
+  return absl::StrCat("http://127.0.0.1:", port_, "/api/v2/spans");
+}
+
+void FakeCollector::SetStatuses(std::deque<int> statuses) {
+  absl::MutexLock l(&mu_);
+  statuses_ = std::move(statuses);
+}
+
+void FakeCollector::WaitForRequests(int n) {
+  absl::MutexLock l(&mu_);
+  struct Arg {
+    const std::vector<std::string>* bodies;
+    size_t n;
+  } arg = {&bodies_, static_cast<size_t>(n)};
+  mu_.Await(absl::Condition(
+      +[](Arg* arg) { return arg->bodies->size() >= arg->n; }, &arg));
+}
+
+int FakeCollector::num_connections() const {
+  absl::MutexLock l(&mu_);
+  return connection_fds_.size();
+}
+
+int FakeCollector::num_requests() const {
+  absl::MutexLock l(&mu_);
+  return bodies_.size();
+}
+
+std::vector<std::string> FakeCollector::bodies() const {
+  absl::MutexLock l(&mu_);
+  return bodies_;
+}
+
+void FakeCollector::AcceptLoop() {
+  while (true) {
+    const int fd = accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) return;
+    absl::MutexLock l(&mu_);
+    connection_fds_.push_back(fd);
+    connection_threads_.emplace_back(&FakeCollector::ServeConnection, this,
+                                     fd);
+  }
+}
+
+void FakeCollector::ServeConnection(int fd) {
+  std::string input;
+  char buf[16 * 1024];
+  while (true) {
+    // Read the request headers.
+    size_t header_end;
+    while ((header_end = input.find("\r\n\r\n")) == std::string::npos) {
+      const ssize_t n = recv(fd, buf, sizeof(buf), 0);
+      if (n <= 0) {
+        close(fd);
+        return;
+      }
+      input.append(buf, n);
+    }
+    size_t content_length = 0;
+    bool expect_continue = false;
+    for (absl::string_view line : absl::StrSplit(
+             absl::string_view(input).substr(0, header_end), "\r\n")) {
+      const std::string lower = absl::AsciiStrToLower(line);
+      if (absl::StartsWith(lower, "content-length:")) {
+        absl::SimpleAtoi(absl::StripAsciiWhitespace(
+                             absl::string_view(lower).substr(15)),
+                         &content_length);
+      } else if (absl::StartsWith(lower, "expect: 100-continue")) {
+        expect_continue = true;
+      }
+    }
+    input.erase(0, header_end + 4);
+    if (expect_continue && !SendAll(fd, "HTTP/1.1 100 Continue\r\n\r\n")) {
+      break;
+    }
+    // Read the body.
+    while (input.size() < content_length) {
+      const ssize_t n = recv(fd, buf, sizeof(buf), 0);
+      if (n <= 0) {
+        close(fd);
+        return;
+      }
+      input.append(buf, n);
+    }
+    int status = 202;
+    {
+      absl::MutexLock l(&mu_);
+      if (!statuses_.empty()) {
+        status = statuses_.front();
+        statuses_.pop_front();
+      }
+      bodies_.push_back(input.substr(0, content_length));
+    }
+    input.erase(0, content_length);
+    if (!SendAll(fd, absl::StrCat("HTTP/1.1 ", status,
+                                  " Status\r\nContent-Length: 0\r\n\r\n"))) {
+      break;
+    }
+  }
+  close(fd);
+}
+
+}  // namespace trace
+}  // namespace exporters
+}  // namespace opencensus
@@ -0,0 +1,75 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPENCENSUS_EXPORTERS_TRACE_ZIPKIN_INTERNAL_FAKE_COLLECTOR_H_
+#define OPENCENSUS_EXPORTERS_TRACE_ZIPKIN_INTERNAL_FAKE_COLLECTOR_H_
+
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace opencensus {
+namespace exporters {
+namespace trace {
+
+// FakeCollector is a minimal HTTP/1.1 server on 127.0.0.1 that stands in for a
+// Zipkin collector in tests and benchmarks. It accepts requests with a
+// Content-Length, on kept-alive connections, and records their bodies.
+//
+// FakeCollector is thread-safe.
+class FakeCollector {
+ public:
+  // Listens on an unused port.
+  FakeCollector();
+  ~FakeCollector();
+
+  FakeCollector(const FakeCollector&) = delete;
+  FakeCollector& operator=(const FakeCollector&) = delete;
+
+  // The URL to POST spans to.
+  std::string url() const;
+
+  // Answers the next requests with 'statuses', in order, then with 202.
+  void SetStatuses(std::deque<int> statuses) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Blocks until at least 'n' requests have been received.
+  void WaitForRequests(int n) ABSL_LOCKS_EXCLUDED(mu_);
+
+  int num_connections() const ABSL_LOCKS_EXCLUDED(mu_);
+  int num_requests() const ABSL_LOCKS_EXCLUDED(mu_);
+  std::vector<std::string> bodies() const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  void AcceptLoop();
+  void ServeConnection(int fd);
+
+  int listen_fd_;
+  int port_;
+  mutable absl::Mutex mu_;
+  std::deque<int> statuses_ ABSL_GUARDED_BY(mu_);
+  std::vector<std::string> bodies_ ABSL_GUARDED_BY(mu_);
+  std::vector<int> connection_fds_ ABSL_GUARDED_BY(mu_);
+  std::vector<std::thread> connection_threads_ ABSL_GUARDED_BY(mu_);
+  std::thread accept_thread_;
+};
+
+}  // namespace trace
+}  // namespace exporters
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_EXPORTERS_TRACE_ZIPKIN_INTERNAL_FAKE_COLLECTOR_H_
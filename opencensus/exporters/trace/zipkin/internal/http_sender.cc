@@ -0,0 +1,307 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/exporters/trace/zipkin/internal/http_sender.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <utility>
+
+#include <curl/curl.h>
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "opencensus/exporters/trace/zipkin/internal/output_buffer.h"
+
+namespace opencensus {
+namespace exporters {
+namespace trace {
+
+namespace {
+
+constexpr char kZipkinLib[] = "zipkin/2.0";
+
+class CurlEnv {
+ public:
+  static CurlEnv* Get();
+
+ private:
+  CurlEnv() { curl_global_init(CURL_GLOBAL_DEFAULT); }
+  ~CurlEnv() { curl_global_cleanup(); }
+};
+
+// static
+CurlEnv* CurlEnv::Get() {
+  static auto* const g_curl_env = new CurlEnv;
+  return g_curl_env;
+}
+
+// A CURLOPT_SEEKFUNCTION callback, which libcurl uses to resend the body, for
+// example after a redirect.
+int SeekCallback(void* userdata, curl_off_t offset, int origin) {
+  if (offset != 0 || origin != SEEK_SET) {
+    return CURL_SEEKFUNC_CANTSEEK;
+  }
+  static_cast<OutputBuffer*>(userdata)->Rewind();
+  return CURL_SEEKFUNC_OK;
+}
+
+// A CURLOPT_WRITEFUNCTION callback that discards the response body.
+size_t DiscardCallback(char* /*data*/, size_t size, size_t nmemb,
+                       void* /*userdata*/) {
+  return size * nmemb;
+}
+
+// Sets the options that are the same for every request sent through 'curl'.
+CURLcode ConfigureHandle(const ZipkinExporterOptions& options, CURL* curl,
+                         char* err_msg) {
+  CURLcode res;
+
+  if ((res = curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, err_msg)) !=
+      CURLE_OK) {
+    // Failed to set curl error buffer.
+    return res;
+  }
+  if ((res = curl_easy_setopt(curl, CURLOPT_URL, options.url.c_str())) !=
+      CURLE_OK) {
+    // Failed to set url.
+    return res;
+  }
+  if ((res = curl_easy_setopt(curl, CURLOPT_USERAGENT, kZipkinLib)) !=
+      CURLE_OK) {
+    // Failed to set http user agent.
+    return res;
+  }
+  if ((res = curl_easy_setopt(curl, CURLOPT_POST, 1)) != CURLE_OK) {
+    // Failed to set http method.
+    return res;
+  }
+  if ((res = curl_easy_setopt(curl, CURLOPT_READFUNCTION,
+                              &OutputBuffer::ReadCallback)) != CURLE_OK) {
+    // Failed to set http body callback.
+    return res;
+  }
+  if ((res = curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, &SeekCallback)) !=
+      CURLE_OK) {
+    // Failed to set http body rewinding.
+    return res;
+  }
+  if ((res = curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION,
+                              &DiscardCallback)) != CURLE_OK) {
+    // Failed to set http response callback.
+    return res;
+  }
+  if ((res = curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1)) != CURLE_OK) {
+    // Failed to enable TCP keep-alive.
+    return res;
+  }
+  if ((res = curl_easy_setopt(
+           curl, CURLOPT_CONNECTTIMEOUT_MS,
+           absl::ToInt64Milliseconds(options.connect_timeout))) != CURLE_OK) {
+    // Failed to set connect timeout.
+    return res;
+  }
+  if ((res = curl_easy_setopt(
+           curl, CURLOPT_TIMEOUT_MS,
+           absl::ToInt64Milliseconds(options.request_timeout))) != CURLE_OK) {
+    // Failed to set request timeout.
+    return res;
+  }
+  if ((res = curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1)) != CURLE_OK) {
+    // Failed to disable signals.
+    return res;
+  }
+
+  if (!options.proxy.empty()) {
+    if ((res = curl_easy_setopt(curl, CURLOPT_PROXY, options.proxy.c_str())) !=
+        CURLE_OK) {
+      // Failed to set proxy.
+      return res;
+    }
+
+    if (options.http_proxy_tunnel) {
+      if ((res = curl_easy_setopt(curl, CURLOPT_PROXYTYPE, CURLPROXY_HTTP)) !=
+          CURLE_OK) {
+        // Failed to set HTTP proxy type.
+        return res;
+      }
+      if ((res = curl_easy_setopt(curl, CURLOPT_HTTPPROXYTUNNEL, 1)) !=
+          CURLE_OK) {
+        // Failed to set HTTP proxy tunnel.
+        return res;
+      }
+    }
+  }
+
+  if (options.max_redirect_times > 0) {
+    if ((res = curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1)) != CURLE_OK) {
+      // Failed to enable follow location.
+      return res;
+    }
+    if ((res = curl_easy_setopt(curl, CURLOPT_MAXREDIRS,
+                                options.max_redirect_times)) != CURLE_OK) {
+      // Failed to set max redirect times.
+      return res;
+    }
+  }
+  return CURLE_OK;
+}
+
+struct curl_slist* MakeHeaders(bool gzip) {
+  // This is required for the server to recognize that it is a json encoded
+  // message.
+  struct curl_slist* headers =
+      curl_slist_append(nullptr, "Content-Type: application/json");
+  if (gzip) {
+    headers = curl_slist_append(headers, "Content-Encoding: gzip");
+  }
+  // Don't wait for "100 Continue" before sending large bodies.
+  return curl_slist_append(headers, "Expect:");
+}
+
+}  // namespace
+
+HttpSender::HttpSender(const ZipkinExporterOptions& options)
+    : options_(options) {
+  // Initialize libcurl. This MUST only be done once per process.
+  CurlEnv::Get();
+  headers_ = MakeHeaders(/*gzip=*/false);
+  gzip_headers_ = MakeHeaders(/*gzip=*/true);
+  const int num_workers = std::max(1, options_.max_concurrent_requests);
+  for (int i = 0; i < num_workers; ++i) {
+    workers_.emplace_back(&HttpSender::RunWorker, this);
+  }
+}
+
+HttpSender::~HttpSender() {
+  {
+    absl::MutexLock l(&mu_);
+    shutdown_ = true;
+  }
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  curl_slist_free_all(headers_);
+  curl_slist_free_all(gzip_headers_);
+}
+
+std::unique_ptr<OutputBuffer> HttpSender::NewBody() {
+  {
+    absl::MutexLock l(&mu_);
+    if (!free_.empty()) {
+      std::unique_ptr<OutputBuffer> body = std::move(free_.back());
+      free_.pop_back();
+      return body;
+    }
+  }
+  return absl::make_unique<OutputBuffer>(options_.gzip);
+}
+
+bool HttpSender::Send(std::unique_ptr<OutputBuffer> body) {
+  absl::MutexLock l(&mu_);
+  if (static_cast<int>(queue_.size()) >=
+      std::max(1, options_.max_queued_requests)) {
+    free_.push_back(std::move(body));
+    return false;
+  }
+  queue_.push_back(std::move(body));
+  return true;
+}
+
+void HttpSender::RunWorker() {
+  char err_msg[CURL_ERROR_SIZE] = {0};
+  CURL* curl = curl_easy_init();
+  if (!curl) {
+    std::cerr << "ZipkinExporter: failed to create curl handle.\n";
+  } else {
+    CURLcode res = ConfigureHandle(options_, curl, err_msg);
+    if (res != CURLE_OK) {
+      std::cerr << "ZipkinExporter: curl error: " << curl_easy_strerror(res)
+                << " (configuring handle for \"" << options_.url << "\")\n";
+      curl_easy_cleanup(curl);
+      curl = nullptr;
+    }
+  }
+  while (true) {
+    std::unique_ptr<OutputBuffer> body;
+    {
+      absl::MutexLock l(&mu_);
+      mu_.Await(absl::Condition(this, &HttpSender::HasWork));
+      if (queue_.empty()) {
+        break;
+      }
+      body = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    if (curl != nullptr) {
+      SendWithRetries(curl, body.get());
+    }
+    absl::MutexLock l(&mu_);
+    free_.push_back(std::move(body));
+  }
+  if (curl != nullptr) {
+    curl_easy_cleanup(curl);
+  }
+}
+
+void HttpSender::SendWithRetries(CURL* curl, OutputBuffer* body) {
+  absl::Duration backoff = options_.initial_backoff;
+  for (int retries = 0;
+       SendOnce(curl, body) && retries < options_.max_retries; ++retries) {
+    absl::SleepFor(backoff);
+    backoff *= 2;
+  }
+}
+
+bool HttpSender::SendOnce(CURL* curl, OutputBuffer* body) {
+  body->Rewind();
+  CURLcode res;
+  if ((res = curl_easy_setopt(curl, CURLOPT_HTTPHEADER,
+                              body->gzip() ? gzip_headers_ : headers_)) !=
+          CURLE_OK ||
+      (res = curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE,
+                              static_cast<curl_off_t>(body->size()))) !=
+          CURLE_OK ||
+      (res = curl_easy_setopt(curl, CURLOPT_READDATA, body)) != CURLE_OK ||
+      (res = curl_easy_setopt(curl, CURLOPT_SEEKDATA, body)) != CURLE_OK) {
+    std::cerr << "ZipkinExporter: curl error: " << curl_easy_strerror(res)
+              << " (sending to \"" << options_.url << "\")\n";
+    return false;
+  }
+
+  // Sending HTTP request to url, reusing the handle's connection if it is
+  // still open.
+  res = curl_easy_perform(curl);
+  if (res != CURLE_OK) {
+    std::cerr << "ZipkinExporter: curl error: " << curl_easy_strerror(res)
+              << " (sending to \"" << options_.url << "\")\n";
+    return true;
+  }
+  long status = 0;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+  if (status >= 300) {
+    std::cerr << "ZipkinExporter: HTTP status " << status << " (sending to \""
+              << options_.url << "\")\n";
+    // Retry if the collector is overloaded or failed.
+    return status == 429 || status >= 500;
+  }
+  return false;
+}
+
+}  // namespace trace
+}  // namespace exporters
+}  // namespace opencensus
@@ -0,0 +1,85 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPENCENSUS_EXPORTERS_TRACE_ZIPKIN_INTERNAL_HTTP_SENDER_H_
+#define OPENCENSUS_EXPORTERS_TRACE_ZIPKIN_INTERNAL_HTTP_SENDER_H_
+
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <curl/curl.h>
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "opencensus/exporters/trace/zipkin/internal/output_buffer.h"
+#include "opencensus/exporters/trace/zipkin/zipkin_exporter.h"
+
+namespace opencensus {
+namespace exporters {
+namespace trace {
+
+// HttpSender POSTs request bodies to the Zipkin collector from
+// options.max_concurrent_requests worker threads. Each worker sends all its
+// requests through one CURL handle, so its connection is kept alive between
+// requests. Send() only queues the body. Failed requests are retried with
+// exponential backoff.
+//
+// HttpSender is thread-safe.
+class HttpSender {
+ public:
+  explicit HttpSender(const ZipkinExporterOptions& options);
+  // Sends the queued bodies, then stops the workers.
+  ~HttpSender();
+
+  HttpSender(const HttpSender&) = delete;
+  HttpSender& operator=(const HttpSender&) = delete;
+
+  // Returns an empty body, reusing the buffer of a sent one if possible.
+  std::unique_ptr<OutputBuffer> NewBody() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Queues a finished body to be sent. Returns false, dropping the body, if
+  // options.max_queued_requests bodies are already waiting.
+  bool Send(std::unique_ptr<OutputBuffer> body) ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  void RunWorker() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Sends 'body' through 'curl', retrying failures.
+  void SendWithRetries(CURL* curl, OutputBuffer* body);
+
+  // Makes one attempt at sending 'body'. Returns true if it should be retried.
+  bool SendOnce(CURL* curl, OutputBuffer* body);
+
+  bool HasWork() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return !queue_.empty() || shutdown_;
+  }
+
+  const ZipkinExporterOptions options_;
+  struct curl_slist* headers_ = nullptr;
+  struct curl_slist* gzip_headers_ = nullptr;
+
+  absl::Mutex mu_;
+  std::deque<std::unique_ptr<OutputBuffer>> queue_ ABSL_GUARDED_BY(mu_);
+  // Buffers of sent bodies.
+  std::vector<std::unique_ptr<OutputBuffer>> free_ ABSL_GUARDED_BY(mu_);
+  bool shutdown_ ABSL_GUARDED_BY(mu_) = false;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace trace
+}  // namespace exporters
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_EXPORTERS_TRACE_ZIPKIN_INTERNAL_HTTP_SENDER_H_
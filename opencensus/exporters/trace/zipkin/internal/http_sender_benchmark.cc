@@ -0,0 +1,85 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+
+#include <curl/curl.h>
+#include "benchmark/benchmark.h"
+#include "opencensus/exporters/trace/zipkin/internal/fake_collector.h"
+#include "opencensus/exporters/trace/zipkin/internal/http_sender.h"
+#include "opencensus/exporters/trace/zipkin/internal/output_buffer.h"
+#include "opencensus/exporters/trace/zipkin/zipkin_exporter.h"
+
+namespace opencensus {
+namespace exporters {
+namespace trace {
+namespace {
+
+// A body about the size of a batch of a few dozen spans.
+const std::string& Payload() {
+  static const std::string* payload = new std::string(16 * 1024, 'x');
+  return *payload;
+}
+
+size_t Discard(char* /*data*/, size_t size, size_t nmemb, void* /*userdata*/) {
+  return size * nmemb;
+}
+
+// Sends each request on a new CURL handle, and so a new connection.
+void BM_SendNewConnectionPerRequest(benchmark::State& state) {
+  curl_global_init(CURL_GLOBAL_DEFAULT);
+  FakeCollector collector;
+  const std::string url = collector.url();
+  for (auto _ : state) {
+    CURL* curl = curl_easy_init();
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, Payload().size());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, Payload().data());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &Discard);
+    curl_easy_perform(curl);
+    curl_easy_cleanup(curl);
+  }
+  state.SetBytesProcessed(state.iterations() * Payload().size());
+}
+BENCHMARK(BM_SendNewConnectionPerRequest);
+
+// Sends through HttpSender. Arg is max_concurrent_requests.
+void BM_SendPersistent(benchmark::State& state) {
+  FakeCollector collector;
+  ZipkinExporterOptions options(collector.url());
+  options.max_concurrent_requests = state.range(0);
+  options.max_queued_requests = 1 << 30;
+  {
+    HttpSender sender(options);
+    for (auto _ : state) {
+      std::unique_ptr<OutputBuffer> body = sender.NewBody();
+      for (char c : Payload()) {
+        body->Put(c);
+      }
+      body->Finish();
+      sender.Send(std::move(body));
+    }
+    // The destructor waits for the queued requests.
+  }
+  state.SetBytesProcessed(state.iterations() * Payload().size());
+}
+BENCHMARK(BM_SendPersistent)->Arg(1)->Arg(4)->UseRealTime();
+
+}  // namespace
+}  // namespace trace
+}  // namespace exporters
+}  // namespace opencensus
+
+BENCHMARK_MAIN();
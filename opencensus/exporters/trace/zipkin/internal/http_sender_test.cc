@@ -0,0 +1,142 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/exporters/trace/zipkin/internal/http_sender.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "opencensus/exporters/trace/zipkin/internal/fake_collector.h"
+#include "opencensus/exporters/trace/zipkin/internal/output_buffer.h"
+#include "opencensus/exporters/trace/zipkin/zipkin_exporter.h"
+
+namespace opencensus {
+namespace exporters {
+namespace trace {
+namespace {
+
+std::unique_ptr<OutputBuffer> Body(HttpSender* sender, const std::string& s) {
+  std::unique_ptr<OutputBuffer> body = sender->NewBody();
+  for (char c : s) {
+    body->Put(c);
+  }
+  body->Finish();
+  return body;
+}
+
+ZipkinExporterOptions Options(const FakeCollector& collector) {
+  ZipkinExporterOptions options(collector.url());
+  options.max_queued_requests = 100;
+  options.initial_backoff = absl::Milliseconds(1);
+  return options;
+}
+
+TEST(HttpSenderTest, SendsBodiesOnOneConnection) {
+  FakeCollector collector;
+  {
+    HttpSender sender(Options(collector));
+    for (int i = 0; i < 10; ++i) {
+      ASSERT_TRUE(sender.Send(Body(&sender, absl::StrCat("[", i, "]"))));
+    }
+  }
+  EXPECT_EQ(10, collector.num_requests());
+  EXPECT_EQ("[0]", collector.bodies()[0]);
+  EXPECT_EQ("[9]", collector.bodies()[9]);
+  EXPECT_EQ(1, collector.num_connections());
+}
+
+TEST(HttpSenderTest, SendsLargeBody) {
+  FakeCollector collector;
+  const std::string large(3 * OutputBuffer::kChunkSize + 17, 'x');
+  {
+    HttpSender sender(Options(collector));
+    ASSERT_TRUE(sender.Send(Body(&sender, large)));
+  }
+  ASSERT_EQ(1, collector.num_requests());
+  EXPECT_EQ(large, collector.bodies()[0]);
+}
+
+TEST(HttpSenderTest, ConcurrentRequests) {
+  FakeCollector collector;
+  ZipkinExporterOptions options = Options(collector);
+  options.max_concurrent_requests = 4;
+  {
+    HttpSender sender(options);
+    for (int i = 0; i < 100; ++i) {
+      ASSERT_TRUE(sender.Send(Body(&sender, "[]")));
+    }
+  }
+  EXPECT_EQ(100, collector.num_requests());
+  EXPECT_LE(collector.num_connections(), 4);
+}
+
+TEST(HttpSenderTest, RetriesServerErrors) {
+  FakeCollector collector;
+  collector.SetStatuses({503, 429});
+  {
+    HttpSender sender(Options(collector));
+    ASSERT_TRUE(sender.Send(Body(&sender, "[]")));
+  }
+  EXPECT_EQ(3, collector.num_requests());
+}
+
+TEST(HttpSenderTest, GivesUpAfterMaxRetries) {
+  FakeCollector collector;
+  collector.SetStatuses({500, 500, 500, 500});
+  ZipkinExporterOptions options = Options(collector);
+  options.max_retries = 1;
+  {
+    HttpSender sender(options);
+    ASSERT_TRUE(sender.Send(Body(&sender, "[]")));
+  }
+  EXPECT_EQ(2, collector.num_requests());
+}
+
+TEST(HttpSenderTest, DoesNotRetryClientErrors) {
+  FakeCollector collector;
+  collector.SetStatuses({400});
+  {
+    HttpSender sender(Options(collector));
+    ASSERT_TRUE(sender.Send(Body(&sender, "[]")));
+  }
+  EXPECT_EQ(1, collector.num_requests());
+}
+
+TEST(HttpSenderTest, DropsWhenQueueIsFull) {
+  FakeCollector collector;
+  // Hold up the first request with retries while more are queued.
+  collector.SetStatuses({503});
+  ZipkinExporterOptions options = Options(collector);
+  options.max_queued_requests = 2;
+  options.initial_backoff = absl::Milliseconds(500);
+  {
+    HttpSender sender(options);
+    ASSERT_TRUE(sender.Send(Body(&sender, "[0]")));
+    collector.WaitForRequests(1);
+    EXPECT_TRUE(sender.Send(Body(&sender, "[1]")));
+    EXPECT_TRUE(sender.Send(Body(&sender, "[2]")));
+    EXPECT_FALSE(sender.Send(Body(&sender, "[3]")));
+  }
+  EXPECT_THAT(collector.bodies(),
+              ::testing::ElementsAre("[0]", "[0]", "[1]", "[2]"));
+}
+
+}  // namespace
+}  // namespace trace
+}  // namespace exporters
+}  // namespace opencensus
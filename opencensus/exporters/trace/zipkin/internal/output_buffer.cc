@@ -0,0 +1,143 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/exporters/trace/zipkin/internal/output_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include <zlib.h>
+
+namespace opencensus {
+namespace exporters {
+namespace trace {
+
+namespace {
+
+// Adding 16 to the default window bits makes zlib write a gzip header and
+// trailer instead of a zlib one.
+constexpr int kGzipWindowBits = 15 + 16;
+constexpr int kMemLevel = 8;
+
+}  // namespace
+
+constexpr size_t OutputBuffer::kChunkSize;
+
+OutputBuffer::OutputBuffer(bool gzip) : gzip_(gzip) {
+  if (gzip_) {
+    zstream_.zalloc = Z_NULL;
+    zstream_.zfree = Z_NULL;
+    zstream_.opaque = Z_NULL;
+    if (deflateInit2(&zstream_, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                     kGzipWindowBits, kMemLevel, Z_DEFAULT_STRATEGY) != Z_OK) {
+      std::cerr << "ZipkinExporter: failed to initialize zlib, sending "
+                   "uncompressed spans.\n";
+      gzip_ = false;
+    } else {
+      staging_.reset(new char[kChunkSize]);
+    }
+  }
+  Clear();
+}
+
+OutputBuffer::~OutputBuffer() {
+  if (gzip_) {
+    deflateEnd(&zstream_);
+  }
+}
+
+void OutputBuffer::Finish() {
+  size_t last_chunk_size;
+  if (gzip_) {
+    Deflate(staging_.get(), put_ - staging_.get(), Z_FINISH);
+    last_chunk_size = kChunkSize - zstream_.avail_out;
+  } else {
+    last_chunk_size = put_ - chunks_[num_chunks_ - 1].get();
+  }
+  // Every chunk but the last is full.
+  size_ = (num_chunks_ - 1) * kChunkSize + last_chunk_size;
+}
+
+void OutputBuffer::Clear() {
+  num_chunks_ = 0;
+  size_ = 0;
+  read_offset_ = 0;
+  if (gzip_) {
+    deflateReset(&zstream_);
+    zstream_.next_out = Z_NULL;
+    zstream_.avail_out = 0;
+    put_ = staging_.get();
+  } else {
+    put_ = NextChunk();
+  }
+  put_end_ = put_ + kChunkSize;
+}
+
+size_t OutputBuffer::Read(char* dest, size_t max_size) {
+  size_t copied = 0;
+  while (copied < max_size && read_offset_ < size_) {
+    const size_t offset_in_chunk = read_offset_ % kChunkSize;
+    const size_t n = std::min({max_size - copied, size_ - read_offset_,
+                               kChunkSize - offset_in_chunk});
+    memcpy(dest + copied,
+           chunks_[read_offset_ / kChunkSize].get() + offset_in_chunk, n);
+    copied += n;
+    read_offset_ += n;
+  }
+  return copied;
+}
+
+// static
+size_t OutputBuffer::ReadCallback(char* dest, size_t size, size_t nmemb,
+                                  void* userdata) {
+  return static_cast<OutputBuffer*>(userdata)->Read(dest, size * nmemb);
+}
+
+char* OutputBuffer::NextChunk() {
+  if (num_chunks_ == chunks_.size()) {
+    chunks_.emplace_back(new char[kChunkSize]);
+  }
+  return chunks_[num_chunks_++].get();
+}
+
+void OutputBuffer::Spill() {
+  if (gzip_) {
+    Deflate(staging_.get(), kChunkSize, Z_NO_FLUSH);
+    put_ = staging_.get();
+  } else {
+    put_ = NextChunk();
+  }
+  put_end_ = put_ + kChunkSize;
+}
+
+void OutputBuffer::Deflate(char* data, size_t size, int flush) {
+  zstream_.next_in = reinterpret_cast<Bytef*>(data);
+  zstream_.avail_in = static_cast<uInt>(size);
+  int result;
+  do {
+    // A new chunk is only started once the last one is full.
+    if (zstream_.avail_out == 0) {
+      zstream_.next_out = reinterpret_cast<Bytef*>(NextChunk());
+      zstream_.avail_out = kChunkSize;
+    }
+    result = deflate(&zstream_, flush);
+  } while (result != Z_STREAM_ERROR &&
+           (zstream_.avail_out == 0 ||
+            (flush == Z_FINISH && result != Z_STREAM_END)));
+}
+
+}  // namespace trace
+}  // namespace exporters
+}  // namespace opencensus
@@ -0,0 +1,109 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPENCENSUS_EXPORTERS_TRACE_ZIPKIN_INTERNAL_OUTPUT_BUFFER_H_
+#define OPENCENSUS_EXPORTERS_TRACE_ZIPKIN_INTERNAL_OUTPUT_BUFFER_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <zlib.h>
+
+namespace opencensus {
+namespace exporters {
+namespace trace {
+
+// OutputBuffer holds an HTTP request body in fixed-size chunks, so that it
+// grows without copying what has already been written, optionally
+// gzip-compressing it as it is written. It is written as a rapidjson output
+// stream (Put() and Flush()), then read back by libcurl through ReadCallback().
+// Clear() keeps the chunks for the next request.
+//
+// OutputBuffer is thread-compatible.
+class OutputBuffer {
+ public:
+  // For rapidjson.
+  typedef char Ch;
+
+  static constexpr size_t kChunkSize = 64 * 1024;
+
+  explicit OutputBuffer(bool gzip);
+  ~OutputBuffer();
+
+  OutputBuffer(const OutputBuffer&) = delete;
+  OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+  // Whether the body is gzip-compressed. This may be false even if requested,
+  // if zlib failed to initialize.
+  bool gzip() const { return gzip_; }
+
+  // Appends a byte to the body.
+  void Put(char c) {
+    if (put_ == put_end_) Spill();
+    *put_++ = c;
+  }
+  // Required by rapidjson; does nothing, since the body is complete only after
+  // Finish().
+  void Flush() {}
+
+  // Completes the body, after which it may be read. Put() must not be called
+  // again until Clear().
+  void Finish();
+
+  // Empties the buffer for a new body.
+  void Clear();
+
+  // The size of the body. Only valid after Finish().
+  size_t size() const { return size_; }
+
+  // Copies up to 'max_size' bytes from the current read position to 'dest'
+  // and advances it, returning the number of bytes copied.
+  size_t Read(char* dest, size_t max_size);
+  // Moves the read position back to the start of the body.
+  void Rewind() { read_offset_ = 0; }
+
+  // A CURLOPT_READFUNCTION callback for which 'userdata' is an OutputBuffer.
+  static size_t ReadCallback(char* dest, size_t size, size_t nmemb,
+                             void* userdata);
+
+ private:
+  // Returns the next unused chunk, allocating it if needed.
+  char* NextChunk();
+
+  // Makes room for Put(), compressing the staged input if gzip_.
+  void Spill();
+
+  // Compresses 'size' bytes from 'data' into the chunks.
+  void Deflate(char* data, size_t size, int flush);
+
+  bool gzip_;
+  z_stream zstream_;
+  // Chunks are never freed; the first num_chunks_ hold the body.
+  std::vector<std::unique_ptr<char[]>> chunks_;
+  size_t num_chunks_ = 0;
+  // Uncompressed input waiting to be deflated. Only used if gzip_.
+  std::unique_ptr<char[]> staging_;
+  // Where Put() writes: the last chunk, or staging_ if gzip_.
+  char* put_ = nullptr;
+  char* put_end_ = nullptr;
+  size_t size_ = 0;
+  size_t read_offset_ = 0;
+};
+
+}  // namespace trace
+}  // namespace exporters
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_EXPORTERS_TRACE_ZIPKIN_INTERNAL_OUTPUT_BUFFER_H_
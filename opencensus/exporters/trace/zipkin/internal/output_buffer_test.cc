@@ -0,0 +1,141 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/exporters/trace/zipkin/internal/output_buffer.h"
+
+#include <string>
+
+#include <zlib.h>
+
+#include "gtest/gtest.h"
+
+namespace opencensus {
+namespace exporters {
+namespace trace {
+namespace {
+
+// Returns a string spanning several chunks that doesn't compress to nothing.
+std::string LongString() {
+  std::string s;
+  for (int i = 0; s.size() < 3 * OutputBuffer::kChunkSize; ++i) {
+    s += std::to_string(i * 7919);
+  }
+  return s;
+}
+
+void Write(const std::string& s, OutputBuffer* buffer) {
+  for (char c : s) {
+    buffer->Put(c);
+  }
+  buffer->Flush();
+  buffer->Finish();
+}
+
+// Reads the whole body through ReadCallback(), in small pieces.
+std::string ReadAll(OutputBuffer* buffer) {
+  std::string out;
+  char piece[1000];
+  size_t n;
+  while ((n = OutputBuffer::ReadCallback(piece, 1, sizeof(piece), buffer)) >
+         0) {
+    out.append(piece, n);
+  }
+  return out;
+}
+
+std::string Gunzip(const std::string& compressed) {
+  z_stream zstream = {};
+  // Adding 32 to the window bits detects the gzip header.
+  EXPECT_EQ(Z_OK, inflateInit2(&zstream, 15 + 32));
+  zstream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+  zstream.avail_in = compressed.size();
+  std::string out;
+  char piece[4096];
+  int result;
+  do {
+    zstream.next_out = reinterpret_cast<Bytef*>(piece);
+    zstream.avail_out = sizeof(piece);
+    result = inflate(&zstream, Z_NO_FLUSH);
+    out.append(piece, sizeof(piece) - zstream.avail_out);
+  } while (result == Z_OK);
+  EXPECT_EQ(Z_STREAM_END, result);
+  inflateEnd(&zstream);
+  return out;
+}
+
+TEST(OutputBufferTest, Empty) {
+  OutputBuffer buffer(/*gzip=*/false);
+  buffer.Finish();
+  EXPECT_EQ(0, buffer.size());
+  EXPECT_EQ("", ReadAll(&buffer));
+}
+
+TEST(OutputBufferTest, Uncompressed) {
+  OutputBuffer buffer(/*gzip=*/false);
+  const std::string body = LongString();
+  Write(body, &buffer);
+  EXPECT_EQ(body.size(), buffer.size());
+  EXPECT_EQ(body, ReadAll(&buffer));
+}
+
+TEST(OutputBufferTest, ExactlyOneChunk) {
+  OutputBuffer buffer(/*gzip=*/false);
+  const std::string body(OutputBuffer::kChunkSize, 'x');
+  Write(body, &buffer);
+  EXPECT_EQ(body, ReadAll(&buffer));
+}
+
+TEST(OutputBufferTest, Gzip) {
+  OutputBuffer buffer(/*gzip=*/true);
+  ASSERT_TRUE(buffer.gzip());
+  const std::string body = LongString();
+  Write(body, &buffer);
+  const std::string compressed = ReadAll(&buffer);
+  EXPECT_EQ(buffer.size(), compressed.size());
+  EXPECT_LT(compressed.size(), body.size());
+  EXPECT_EQ(body, Gunzip(compressed));
+}
+
+TEST(OutputBufferTest, GzipEmpty) {
+  OutputBuffer buffer(/*gzip=*/true);
+  buffer.Finish();
+  EXPECT_EQ("", Gunzip(ReadAll(&buffer)));
+}
+
+TEST(OutputBufferTest, Rewind) {
+  OutputBuffer buffer(/*gzip=*/false);
+  const std::string body = LongString();
+  Write(body, &buffer);
+  char piece[10];
+  EXPECT_EQ(sizeof(piece), buffer.Read(piece, sizeof(piece)));
+  buffer.Rewind();
+  EXPECT_EQ(body, ReadAll(&buffer));
+}
+
+TEST(OutputBufferTest, ClearReusesBuffer) {
+  for (bool gzip : {false, true}) {
+    OutputBuffer buffer(gzip);
+    Write(LongString(), &buffer);
+    buffer.Clear();
+    Write("[]", &buffer);
+    const std::string body = ReadAll(&buffer);
+    EXPECT_EQ("[]", gzip ? Gunzip(body) : body);
+  }
+}
+
+}  // namespace
+}  // namespace trace
+}  // namespace exporters
+}  // namespace opencensus
@@ -17,14 +17,19 @@
 #include <arpa/inet.h>
 #include <ifaddrs.h>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 
-#include <curl/curl.h>
 #undef RAPIDJSON_HAS_STDSTRING
 #define RAPIDJSON_HAS_STDSTRING 1
-#include <rapidjson/prettywriter.h>
-#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
 #include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "opencensus/exporters/trace/zipkin/internal/http_sender.h"
+#include "opencensus/exporters/trace/zipkin/internal/output_buffer.h"
 #include "opencensus/trace/exporter/attribute_value.h"
 #include "opencensus/trace/exporter/span_exporter.h"
 
@@ -34,73 +39,99 @@ namespace trace {
 
 namespace {
 
-constexpr char kZipkinLib[] = "zipkin/2.0";
 constexpr char ipv4_loopback[] = "127.0.0.1";
 constexpr char ipv6_loopback[] = "::1";
 
-std::string SerializeMessageEvent(
-    const ::opencensus::trace::exporter::MessageEvent& event) {
-  return absl::StrCat(
+using JsonWriter = rapidjson::Writer<OutputBuffer>;
+
+// Writes the lowercase hex encoding of a TraceId or SpanId as a string.
+template <typename Id>
+void WriteHexId(const Id& id, JsonWriter* writer) {
+  static constexpr char kHexDigits[] = "0123456789abcdef";
+  const uint8_t* bytes = static_cast<const uint8_t*>(id.Value());
+  char hex[2 * Id::kSize];
+  for (size_t i = 0; i < Id::kSize; ++i) {
+    hex[2 * i] = kHexDigits[bytes[i] >> 4];
+    hex[2 * i + 1] = kHexDigits[bytes[i] & 0xf];
+  }
+  writer->String(hex, sizeof(hex));
+}
+
+void WriteString(absl::string_view s, JsonWriter* writer) {
+  writer->String(s.data(), s.size());
+}
+
+void AppendMessageEvent(
+    const ::opencensus::trace::exporter::MessageEvent& event,
+    std::string* out) {
+  absl::StrAppend(
+      out,
       event.type() == ::opencensus::trace::exporter::MessageEvent::Type::SENT
           ? "SENT"
           : "RECEIVED",
       "/", event.id(), "/", event.compressed_size());
 }
 
-std::string AttributeValueToString(
-    const ::opencensus::trace::exporter::AttributeValue& value) {
+// Returns the string form of 'value', which may use 'buffer' and is only valid
+// as long as both are.
+absl::string_view AttributeValueToString(
+    const ::opencensus::trace::exporter::AttributeValue& value,
+    char buffer[absl::numbers_internal::kFastToBufferSize]) {
   switch (value.type()) {
     case ::opencensus::trace::AttributeValueRef::Type::kString:
       return value.string_value();
-      break;
     case ::opencensus::trace::AttributeValueRef::Type::kBool:
       return value.bool_value() ? "true" : "false";
-      break;
     case ::opencensus::trace::AttributeValueRef::Type::kInt:
-      return std::to_string(value.int_value());
-      break;
+      return absl::string_view(
+          buffer,
+          absl::numbers_internal::FastIntToBuffer(value.int_value(), buffer) -
+              buffer);
   }
   ABSL_ASSERT(false && "Unknown AttributeValue type");
   return "";
 }
 
-std::string SerializeAnnotation(
-    const ::opencensus::trace::exporter::Annotation& annotation) {
-  std::string annotation_str(annotation.description());
+void AppendAnnotation(
+    const ::opencensus::trace::exporter::Annotation& annotation,
+    std::string* out) {
+  absl::StrAppend(out, annotation.description());
   if (!annotation.attributes().empty()) {
-    absl::StrAppend(&annotation_str, " (");
+    char buffer[absl::numbers_internal::kFastToBufferSize];
+    absl::StrAppend(out, " (");
     size_t count = 0;
     for (const auto& attribute : annotation.attributes()) {
-      absl::StrAppend(&annotation_str, attribute.first, ":",
-                      AttributeValueToString(attribute.second));
+      absl::StrAppend(out, attribute.first, ":",
+                      AttributeValueToString(attribute.second, buffer));
 
       if (++count < annotation.attributes().size()) {
-        absl::StrAppend(&annotation_str, ", ");
+        absl::StrAppend(out, ", ");
       }
     }
-    absl::StrAppend(&annotation_str, ")");
+    absl::StrAppend(out, ")");
   }
-  return annotation_str;
 }
 
+// Serializes 'span', using 'scratch' to build annotation values so that they
+// don't each allocate.
 void SerializeJson(const ::opencensus::trace::exporter::SpanData& span,
                    const ZipkinExporterOptions::Service& service,
-                   rapidjson::Writer<rapidjson::StringBuffer>* writer) {
+                   std::string* scratch, JsonWriter* writer) {
   writer->StartObject();
 
   writer->Key("name");
-  writer->String(std::string(span.name()));
+  WriteString(span.name(), writer);
 
   writer->Key("traceId");
-  writer->String(span.context().trace_id().ToHex());
+  WriteHexId(span.context().trace_id(), writer);
 
   if (span.parent_span_id().IsValid()) {
     writer->Key("parentId");
-    writer->String(span.parent_span_id().ToHex());
+    WriteHexId(span.parent_span_id(), writer);
   }
 
   writer->Key("id");
-  writer->String(span.context().span_id().ToHex());
+  WriteHexId(span.context().span_id(), writer);
 
   // Write localEndpoint. OpenCensus does not support this by default.
   writer->Key("localEndpoint");
@@ -123,7 +154,9 @@ void SerializeJson(const ::opencensus::trace::exporter::SpanData& span,
       writer->Key("timestamp");
       writer->Int64(absl::ToUnixMicros(annotation.timestamp()));
       writer->Key("value");
-      writer->String(SerializeAnnotation(annotation.event()));
+      scratch->clear();
+      AppendAnnotation(annotation.event(), scratch);
+      writer->String(*scratch);
       writer->EndObject();
     }
     writer->EndArray(span.annotations().events().size());
@@ -137,18 +170,21 @@ void SerializeJson(const ::opencensus::trace::exporter::SpanData& span,
       writer->Key("timestamp");
       writer->Int64(absl::ToUnixMicros(event.timestamp()));
       writer->Key("value");
-      writer->String(SerializeMessageEvent(event.event()));
+      scratch->clear();
+      AppendMessageEvent(event.event(), scratch);
+      writer->String(*scratch);
       writer->EndObject();
     }
     writer->EndArray(span.message_events().events().size());
   }
 
   if (!span.attributes().empty()) {
+    char buffer[absl::numbers_internal::kFastToBufferSize];
     writer->Key("tags");
     writer->StartObject();
     for (const auto& attribute : span.attributes()) {
       writer->String(attribute.first);
-      writer->String(AttributeValueToString(attribute.second));
+      WriteString(AttributeValueToString(attribute.second, buffer), writer);
     }
     writer->EndObject();
   }
@@ -162,18 +198,20 @@ void SerializeJson(const ::opencensus::trace::exporter::SpanData& span,
   writer->EndObject();
 }
 
-std::string EncodeJson(
+// Encodes 'spans' into 'body', which is cleared first.
+void EncodeJson(
     const std::vector<::opencensus::trace::exporter::SpanData>& spans,
-    const ZipkinExporterOptions::Service& service) {
-  rapidjson::StringBuffer buffer;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    const ZipkinExporterOptions::Service& service, std::string* scratch,
+    OutputBuffer* body) {
+  body->Clear();
+  JsonWriter writer(*body);
 
   writer.StartArray();
   for (const auto& span : spans) {
-    SerializeJson(span, service, &writer);
+    SerializeJson(span, service, scratch, &writer);
   }
   writer.EndArray();
-  return buffer.GetString();
+  body->Finish();
 }
 
 std::string GetIpAddressHelper(ZipkinExporterOptions::AddressFamily af_type,
@@ -218,165 +256,39 @@ std::string GetIpAddress(ZipkinExporterOptions::AddressFamily af_type) {
   return out;
 }
 
-class CurlEnv {
- public:
-  static CurlEnv* Get();
-
- private:
-  CurlEnv() { curl_global_init(CURL_GLOBAL_DEFAULT); }
-  ~CurlEnv() { curl_global_cleanup(); }
-};
-
-// static
-CurlEnv* CurlEnv::Get() {
-  static auto* const g_curl_env = new CurlEnv;
-  return g_curl_env;
-}
-
-CURLcode CurlSendMessage(const uint8_t* data,
-                         const ZipkinExporterOptions& options, size_t size,
-                         const struct curl_slist* headers, CURL* curl,
-                         char* err_msg) {
-  CURLcode res;
-
-  if ((res = curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers)) != CURLE_OK) {
-    // Failed to set curl header.
-    return res;
-  }
-  if ((res = curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, err_msg)) !=
-      CURLE_OK) {
-    // Failed to set curl error buffer.
-    return res;
-  }
-  if ((res = curl_easy_setopt(curl, CURLOPT_URL, options.url.c_str())) !=
-      CURLE_OK) {
-    // Failed to set url.
-    return res;
-  }
-  if ((res = curl_easy_setopt(curl, CURLOPT_USERAGENT, kZipkinLib)) !=
-      CURLE_OK) {
-    // Failed to set http user agent.
-    return res;
-  }
-  if ((res = curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, size)) != CURLE_OK) {
-    // Failed to set http body size.
-    return res;
-  }
-  if ((res = curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data)) != CURLE_OK) {
-    // Failed to set http body data.
-    return res;
-  }
-  if ((res = curl_easy_setopt(
-           curl, CURLOPT_CONNECTTIMEOUT,
-           absl::ToInt64Milliseconds(options.connect_timeout))) != CURLE_OK) {
-    // Failed to set connect timeout.
-    return res;
-  }
-  if ((res = curl_easy_setopt(
-           curl, CURLOPT_TIMEOUT_MS,
-           absl::ToInt64Milliseconds(options.request_timeout))) != CURLE_OK) {
-    // Failed to set request timeout.
-    return res;
-  }
-  if ((res = curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1)) != CURLE_OK) {
-    // Failed to disable signals.
-    return res;
-  }
-
-  if (options.proxy.empty()) {
-    if ((res = curl_easy_setopt(curl, CURLOPT_PROXY, options.proxy.c_str())) !=
-        CURLE_OK) {
-      // Failed to set proxy.
-      return res;
-    }
-
-    if (options.http_proxy_tunnel) {
-      if ((res = curl_easy_setopt(curl, CURLOPT_PROXYTYPE, CURLPROXY_HTTP)) !=
-          CURLE_OK) {
-        // Failed to set HTTP proxy type.
-        return res;
-      }
-      if ((res = curl_easy_setopt(curl, CURLOPT_HTTPPROXYTUNNEL, 1)) !=
-          CURLE_OK) {
-        // Failed to set HTTP proxy tunnel.
-        return res;
-      }
-    }
-  }
-
-  if (options.max_redirect_times > 0) {
-    if ((res = curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1)) != CURLE_OK) {
-      // Failed to enable follow location.
-      return res;
-    }
-    if ((res = curl_easy_setopt(curl, CURLOPT_MAXREDIRS,
-                                options.max_redirect_times)) != CURLE_OK) {
-      // Failed to set max redirect times.
-      return res;
-    }
-  }
-
-  // Sending HTTP request to url.
-  res = curl_easy_perform(curl);
-
-  return res;
-}
-
 class ZipkinExportHandler
     : public ::opencensus::trace::exporter::SpanExporter::Handler {
  public:
   explicit ZipkinExportHandler(const ZipkinExporterOptions& options)
-      : options_(options) {}
+      : options_(options), sender_(options) {}
 
   void Export(const std::vector<::opencensus::trace::exporter::SpanData>& spans)
       override;
 
-  // Send HTTP message to zipkin endpoint using libcurl.
-  void SendMessage(const std::string& msg, size_t size) const;
-
   ZipkinExporterOptions options_;
   ZipkinExporterOptions::Service service_;
+  HttpSender sender_;
+  // Reused between exports, which the SpanExporter makes one at a time.
+  std::string scratch_;
 };
 
-void ZipkinExportHandler::SendMessage(const std::string& msg,
-                                      size_t size) const {
-  char err_msg[CURL_ERROR_SIZE] = {0};
-  CURL* curl = curl_easy_init();
-  struct curl_slist* headers = nullptr;
-
-  if (!curl) {
-    std::cerr << "ZipkinExporter: failed to create curl handle.\n";
-    return;
-  }
-
-  // This is required for the server to recognize that it is a json encoded
-  // message.
-  headers = curl_slist_append(headers, "Content-Type: application/json");
-  CURLcode res = CurlSendMessage(reinterpret_cast<const uint8_t*>(msg.data()),
-                                 options_, size, headers, curl, err_msg);
-  if (res != CURLE_OK) {
-    std::cerr << "ZipkinExporter: curl error: " << curl_easy_strerror(res)
-              << " (sending to \"" << options_.url << "\")\n";
-  }
-
-  curl_slist_free_all(headers);
-  curl_easy_cleanup(curl);
-}
-
 void ZipkinExportHandler::Export(
     const std::vector<::opencensus::trace::exporter::SpanData>& spans) {
-  if (!spans.empty()) {
-    std::string msg = EncodeJson(spans, service_);
-    SendMessage(msg, msg.size());
+  if (spans.empty()) {
+    return;
+  }
+  std::unique_ptr<OutputBuffer> body = sender_.NewBody();
+  EncodeJson(spans, service_, &scratch_, body.get());
+  if (!sender_.Send(std::move(body))) {
+    std::cerr << "ZipkinExporter: dropped " << spans.size()
+              << " spans, too many requests waiting to be sent to \""
+              << options_.url << "\".\n";
   }
 }
 
 }  // namespace
 
 void ZipkinExporter::Register(const ZipkinExporterOptions& options) {
-  // Initialize libcurl. This MUST only be done once per process.
-  CurlEnv::Get();
-
   // Create new exporter.
   ZipkinExportHandler* handler = new ZipkinExportHandler(options);
   handler->service_.service_name = options.service_name;
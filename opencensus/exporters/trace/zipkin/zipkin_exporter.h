@@ -42,6 +42,20 @@ struct ZipkinExporterOptions {
   // The maximum timeout for HTTP request. The default request timeout is 15
   // seconds.
   absl::Duration request_timeout = absl::Seconds(15);
+  // The number of requests sent at once, each on its own persistent
+  // connection.
+  int max_concurrent_requests = 1;
+  // The maximum number of batches of spans waiting to be sent. Batches
+  // exported while this many are waiting are dropped.
+  int max_queued_requests = 4;
+  // Requests that fail to connect, or get an HTTP 429 or 5xx response, are
+  // retried up to max_retries times. The first retry is after
+  // initial_backoff, which doubles after each retry.
+  int max_retries = 2;
+  absl::Duration initial_backoff = absl::Milliseconds(100);
+  // Whether to gzip-compress request bodies. The collector must accept
+  // "Content-Encoding: gzip".
+  bool gzip = false;
   // Service name used by zipkin collector.
   std::string service_name;
   // Address family to be reported to zipkin collector.
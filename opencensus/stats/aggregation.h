@@ -20,6 +20,7 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "opencensus/stats/bucket_boundaries.h"
 
@@ -55,33 +56,51 @@ class Aggregation final {
     return Aggregation(Type::kLastValue, BucketBoundaries::Explicit({}));
   }
 
+  // Quantiles aggregation keeps a QuantileSketch of recorded values, from
+  // which any quantile can be estimated within a relative error of
+  // QuantileSketch::kRelativeAccuracy, without choosing bucket boundaries in
+  // advance. Exporters report the listed 'quantiles' (each in [0, 1]).
+  static Aggregation Quantiles(
+      std::vector<double> quantiles = {0.5, 0.9, 0.99, 0.999}) {
+    return Aggregation(Type::kQuantiles, BucketBoundaries::Explicit({}),
+                       std::move(quantiles));
+  }
+
   enum class Type {
     kCount,
     kSum,
     kDistribution,
     kLastValue,
+    kQuantiles,
   };
 
   Type type() const { return type_; }
   const BucketBoundaries& bucket_boundaries() const {
     return bucket_boundaries_;
   }
+  const std::vector<double>& quantiles() const { return quantiles_; }
 
   std::string DebugString() const;
 
   bool operator==(const Aggregation& other) const {
     return type_ == other.type_ &&
-           bucket_boundaries_ == other.bucket_boundaries_;
+           bucket_boundaries_ == other.bucket_boundaries_ &&
+           quantiles_ == other.quantiles_;
   }
   bool operator!=(const Aggregation& other) const { return !(*this == other); }
 
  private:
-  Aggregation(Type type, BucketBoundaries buckets)
-      : type_(type), bucket_boundaries_(std::move(buckets)) {}
+  Aggregation(Type type, BucketBoundaries buckets,
+              std::vector<double> quantiles = {})
+      : type_(type),
+        bucket_boundaries_(std::move(buckets)),
+        quantiles_(std::move(quantiles)) {}
 
   Type type_;
   // Ignored except if type_ == kDistribution.
   BucketBoundaries bucket_boundaries_;
+  // Empty except if type_ == kQuantiles.
+  std::vector<double> quantiles_;
 };
 
 }  // namespace stats
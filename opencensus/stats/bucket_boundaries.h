@@ -55,11 +55,54 @@ class BucketBoundaries final {
   // [boundaries[boundaries.size()-1], inf].
   static BucketBoundaries Explicit(std::vector<double> boundaries);
 
-  // The number of buckets in a Distribution using this bucketer.
+  // Creates a log-linear BucketBoundaries, which splits each power of two in
+  // [2^min_exponent, 2^max_exponent) into 2^sub_bucket_bits equal-width
+  // buckets, giving a relative bucket width of at most 2^-sub_bucket_bits. The
+  // underflow bucket covers [-inf, 2^min_exponent) and the overflow bucket
+  // [2^max_exponent, inf]. BucketForValue() reads the bucket directly from the
+  // exponent and mantissa bits of the value, in constant time.
+  // -1022 <= min_exponent <= max_exponent <= 1024, and 0 <= sub_bucket_bits <=
+  // kMaxSubBucketBits.
+  static BucketBoundaries LogLinear(int min_exponent, int max_exponent,
+                                    int sub_bucket_bits);
+
+  // Creates an auto-ranging log-linear BucketBoundaries: each Distribution
+  // using it starts with no finite buckets and extends its own range of
+  // LogLinear(min_exponent, max_exponent, sub_bucket_bits) buckets by whole
+  // powers of two to cover every positive, finite value it is given, so that
+  // the range need not be guessed up front. Non-positive values, and positive
+  // values below 2^-1022, are counted in the underflow bucket. Distributions
+  // report their current range through Distribution::bucket_boundaries().
+  // The range spans at most max_exponent_span powers of two (so at most
+  // max_exponent_span * 2^sub_bucket_bits finite buckets); once it does, it
+  // stops extending and values outside it are counted in the underflow or
+  // overflow bucket. 1 <= max_exponent_span <= 2046.
+  // Auto-ranging boundaries are not supported for interval views.
+  static BucketBoundaries AutoLogLinear(
+      int sub_bucket_bits, int max_exponent_span = kDefaultMaxExponentSpan);
+
+  // The largest supported sub_bucket_bits for log-linear boundaries.
+  static constexpr int kMaxSubBucketBits = 10;
+  // The default range limit of auto-ranging boundaries, enough for values
+  // from nanoseconds to centuries in one unit.
+  static constexpr int kDefaultMaxExponentSpan = 64;
+
+  // The number of buckets in a Distribution using this bucketer. Auto-ranging
+  // boundaries have a single bucket until a Distribution extends them.
   int num_buckets() const { return lower_boundaries_.size() + 1; }
   // The index of the bucket for a given value, in [0, num_buckets() - 1].
   int BucketForValue(double value) const;
 
+  // Whether these boundaries come from LogLinear() or AutoLogLinear(), and if
+  // so their parameters. min_exponent() and max_exponent() are 0 for
+  // auto-ranging boundaries, and max_exponent_span() is 0 for others.
+  bool log_linear() const { return sub_bucket_bits_ >= 0; }
+  bool auto_range() const { return auto_range_; }
+  int min_exponent() const { return min_exponent_; }
+  int max_exponent() const { return max_exponent_; }
+  int sub_bucket_bits() const { return sub_bucket_bits_; }
+  int max_exponent_span() const { return max_exponent_span_; }
+
   const std::vector<double>& lower_boundaries() const {
     return lower_boundaries_;
   }
@@ -67,7 +110,10 @@ class BucketBoundaries final {
   std::string DebugString() const;
 
   bool operator==(const BucketBoundaries& other) const {
-    return lower_boundaries_ == other.lower_boundaries_;
+    return lower_boundaries_ == other.lower_boundaries_ &&
+           sub_bucket_bits_ == other.sub_bucket_bits_ &&
+           auto_range_ == other.auto_range_ &&
+           max_exponent_span_ == other.max_exponent_span_;
   }
   bool operator!=(const BucketBoundaries& other) const {
     return !(*this == other);
@@ -77,9 +123,19 @@ class BucketBoundaries final {
   BucketBoundaries(std::vector<double> lower_boundaries)
       : lower_boundaries_(std::move(lower_boundaries)) {}
 
+  // Computes BucketForValue() for log-linear boundaries.
+  int LogLinearBucketForValue(double value) const;
+
   // The lower bound of each bucket, excluding the underflow bucket but
   // including the overflow bucket.
   std::vector<double> lower_boundaries_;
+  // The log-linear parameters, with sub_bucket_bits_ = -1 for other
+  // boundaries.
+  int min_exponent_ = 0;
+  int max_exponent_ = 0;
+  int sub_bucket_bits_ = -1;
+  bool auto_range_ = false;
+  int max_exponent_span_ = 0;
 };
 
 }  // namespace stats
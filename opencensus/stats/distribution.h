@@ -20,6 +20,7 @@
 
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -36,7 +37,10 @@ class TestUtils;
 // A Distribution object holds a summary of a stream of double values (e.g. all
 // values for one measure and set of tags). It stores both a statistical summary
 // (mean, sum of squared deviation, and range) and a histogram recording the
-// number of values in each bucket (as defined by a BucketBoundaries).
+// number of values in each bucket (as defined by a BucketBoundaries). With
+// auto-ranging boundaries (see BucketBoundaries::AutoLogLinear()), the
+// histogram grows to cover the values added, and bucket_boundaries() describes
+// its current range.
 // This corresponds to a Stackdriver Distribution metric
 // (https://cloud.google.com/monitoring/api/ref_v3/rest/v3/TypedValue#Distribution).
 // Distribution is thread-compatible.
@@ -50,7 +54,9 @@ class Distribution final {
   double min() const { return min_; }
   double max() const { return max_; }
 
-  const BucketBoundaries& bucket_boundaries() const { return *buckets_; }
+  const BucketBoundaries& bucket_boundaries() const {
+    return ranged_buckets_ == nullptr ? *buckets_ : *ranged_buckets_;
+  }
 
   // A string representation of the Distribution's data suitable for human
   // consumption.
@@ -68,7 +74,25 @@ class Distribution final {
   // non-finite values may make statistics meaningless.
   void Add(double value);
 
+  // Counts 'value' in its bucket, first extending the range of auto-ranging
+  // boundaries to cover it.
+  void AddToBucket(double value);
+
+  // Adds the bucket counts of 'other', which must have been constructed with
+  // the same buckets.
+  void AddBucketCounts(const Distribution& other);
+
+  // Extends the range of auto-ranging boundaries to log-linear buckets over
+  // [2^min_exponent, 2^max_exponent), which must include the current range,
+  // or as far toward it as BucketBoundaries::max_exponent_span() allows.
+  void ExtendRange(int min_exponent, int max_exponent);
+
   const BucketBoundaries* const buckets_;  // Never null; not owned.
+  // If buckets_ is auto-ranging, the log-linear boundaries of the range
+  // covered so far, or null while no value has extended it. Shared between
+  // copies and distributions with the same range, since it is never
+  // modified.
+  std::shared_ptr<const BucketBoundaries> ranged_buckets_;
 
   uint64_t count_ = 0;
   double mean_ = 0;
@@ -76,8 +100,8 @@ class Distribution final {
   double min_ = std::numeric_limits<double>::infinity();
   double max_ = -std::numeric_limits<double>::infinity();
 
-  // The counts of values in the buckets listed in buckets_. Size is
-  // buckets_->num_buckets().
+  // The counts of values in the buckets listed in bucket_boundaries(). Size is
+  // bucket_boundaries().num_buckets().
   std::vector<uint64_t> bucket_counts_;
 };
 
@@ -17,6 +17,7 @@
 #include <cassert>
 
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 
 namespace opencensus {
 namespace stats {
@@ -32,6 +33,8 @@ std::string Aggregation::DebugString() const {
                           bucket_boundaries_.DebugString());
     case Type::kLastValue:
       return "Last Value";
+    case Type::kQuantiles:
+      return absl::StrCat("Quantiles ", absl::StrJoin(quantiles_, ", "));
   }
   assert(false && "Invalid Aggregation type.");
   return "BAD TYPE";
@@ -15,7 +15,11 @@
 #include "opencensus/stats/bucket_boundaries.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <vector>
 
 #include "absl/base/macros.h"
@@ -25,6 +29,9 @@
 namespace opencensus {
 namespace stats {
 
+constexpr int BucketBoundaries::kMaxSubBucketBits;
+constexpr int BucketBoundaries::kDefaultMaxExponentSpan;
+
 // Class-level todos:
 // TODO: Consider lazy generation of storage buckets, to save memory
 // when few buckets are populated.
@@ -67,13 +74,95 @@ BucketBoundaries BucketBoundaries::Explicit(std::vector<double> boundaries) {
   return BucketBoundaries(std::move(boundaries));
 }
 
+// static
+BucketBoundaries BucketBoundaries::LogLinear(int min_exponent, int max_exponent,
+                                             int sub_bucket_bits) {
+  if (min_exponent < -1022 || max_exponent > 1024 ||
+      min_exponent > max_exponent || sub_bucket_bits < 0 ||
+      sub_bucket_bits > kMaxSubBucketBits) {
+    std::cerr << "BucketBoundaries::LogLinear called with invalid exponents "
+                 "or sub_bucket_bits.\n";
+    ABSL_ASSERT(0);
+    return BucketBoundaries({});
+  }
+  const int sub_buckets = 1 << sub_bucket_bits;
+  std::vector<double> boundaries;
+  boundaries.reserve((max_exponent - min_exponent) * sub_buckets + 1);
+  for (int exponent = min_exponent; exponent < max_exponent; ++exponent) {
+    for (int i = 0; i < sub_buckets; ++i) {
+      // Exact, since the mantissa has more than kMaxSubBucketBits bits.
+      boundaries.push_back(
+          std::ldexp(1 + static_cast<double>(i) / sub_buckets, exponent));
+    }
+  }
+  // 2^1024 is not representable; the overflow bucket then holds only inf.
+  boundaries.push_back(max_exponent == 1024
+                           ? std::numeric_limits<double>::infinity()
+                           : std::ldexp(1, max_exponent));
+  BucketBoundaries bucket_boundaries(std::move(boundaries));
+  bucket_boundaries.min_exponent_ = min_exponent;
+  bucket_boundaries.max_exponent_ = max_exponent;
+  bucket_boundaries.sub_bucket_bits_ = sub_bucket_bits;
+  return bucket_boundaries;
+}
+
+// static
+BucketBoundaries BucketBoundaries::AutoLogLinear(int sub_bucket_bits,
+                                                 int max_exponent_span) {
+  if (sub_bucket_bits < 0 || sub_bucket_bits > kMaxSubBucketBits ||
+      max_exponent_span < 1 || max_exponent_span > 2046) {
+    std::cerr << "BucketBoundaries::AutoLogLinear called with invalid "
+                 "sub_bucket_bits or max_exponent_span.\n";
+    ABSL_ASSERT(0);
+    return BucketBoundaries({});
+  }
+  BucketBoundaries bucket_boundaries({});
+  bucket_boundaries.sub_bucket_bits_ = sub_bucket_bits;
+  bucket_boundaries.auto_range_ = true;
+  bucket_boundaries.max_exponent_span_ = max_exponent_span;
+  return bucket_boundaries;
+}
+
 int BucketBoundaries::BucketForValue(double value) const {
+  if (sub_bucket_bits_ >= 0 && !auto_range_) {
+    return LogLinearBucketForValue(value);
+  }
   return std::upper_bound(lower_boundaries_.begin(), lower_boundaries_.end(),
                           value) -
          lower_boundaries_.begin();
 }
 
+int BucketBoundaries::LogLinearBucketForValue(double value) const {
+  const int overflow_bucket = lower_boundaries_.size();
+  // Matches the binary search over lower_boundaries_, which puts NaN in the
+  // overflow bucket.
+  if (!(value >= lower_boundaries_.front())) {
+    return std::isnan(value) ? overflow_bucket : 0;
+  }
+  if (value >= lower_boundaries_.back()) {
+    return overflow_bucket;
+  }
+  // value is now a normal, positive double, so its biased exponent field holds
+  // exponent + 1023 and the top mantissa bits select the sub-bucket.
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const int exponent = static_cast<int>(bits >> 52) - 1023;
+  const int sub_bucket = static_cast<int>(
+      (bits & ((uint64_t{1} << 52) - 1)) >> (52 - sub_bucket_bits_));
+  return ((exponent - min_exponent_) << sub_bucket_bits_) + sub_bucket + 1;
+}
+
 std::string BucketBoundaries::DebugString() const {
+  if (auto_range_) {
+    return absl::StrCat("Buckets: auto-ranging log-linear, ",
+                        1 << sub_bucket_bits_, " per power of 2, up to ",
+                        max_exponent_span_, " powers of 2");
+  }
+  if (sub_bucket_bits_ >= 0) {
+    return absl::StrCat("Buckets: log-linear [2^", min_exponent_, ", 2^",
+                        max_exponent_, "), ", 1 << sub_bucket_bits_,
+                        " per power of 2");
+  }
   return absl::StrCat("Buckets: ", absl::StrJoin(lower_boundaries_, ","));
 }
 
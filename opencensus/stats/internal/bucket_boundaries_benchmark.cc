@@ -0,0 +1,65 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "opencensus/stats/bucket_boundaries.h"
+
+namespace opencensus {
+namespace stats {
+namespace {
+
+// Values spread over the range of the boundaries below.
+std::vector<double> TestValues() {
+  std::vector<double> values;
+  for (double value = 0.001; value < 1e6; value *= 1.01) {
+    values.push_back(value);
+  }
+  return values;
+}
+
+void RunBucketForValue(const BucketBoundaries& buckets,
+                       benchmark::State& state) {
+  const std::vector<double> values = TestValues();
+  int i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(buckets.BucketForValue(values[i]));
+    if (++i == values.size()) {
+      i = 0;
+    }
+  }
+}
+
+// Binary search over the same boundaries as BM_LogLinearBucketForValue.
+void BM_ExplicitBucketForValue(benchmark::State& state) {
+  RunBucketForValue(
+      BucketBoundaries::Explicit(
+          BucketBoundaries::LogLinear(-10, 20, state.range(0))
+              .lower_boundaries()),
+      state);
+}
+BENCHMARK(BM_ExplicitBucketForValue)->Arg(0)->Arg(3)->Arg(6);
+
+void BM_LogLinearBucketForValue(benchmark::State& state) {
+  RunBucketForValue(BucketBoundaries::LogLinear(-10, 20, state.range(0)),
+                    state);
+}
+BENCHMARK(BM_LogLinearBucketForValue)->Arg(0)->Arg(3)->Arg(6);
+
+}  // namespace
+}  // namespace stats
+}  // namespace opencensus
+
+BENCHMARK_MAIN();
@@ -14,6 +14,9 @@
 
 #include "opencensus/stats/bucket_boundaries.h"
 
+#include <cmath>
+#include <limits>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -68,6 +71,106 @@ TEST(BucketBoundariesTest, BucketForValueEmptyBuckets) {
   EXPECT_EQ(0, bucket_boundaries.BucketForValue(1000));
 }
 
+TEST(BucketBoundariesTest, LogLinear) {
+  const BucketBoundaries bucket_boundaries =
+      BucketBoundaries::LogLinear(-1, 2, 2);
+  EXPECT_EQ(3 * 4 + 2, bucket_boundaries.num_buckets());
+  EXPECT_THAT(bucket_boundaries.lower_boundaries(),
+              ::testing::ElementsAre(0.5, 0.625, 0.75, 0.875, 1, 1.25, 1.5,
+                                     1.75, 2, 2.5, 3, 3.5, 4));
+  EXPECT_TRUE(bucket_boundaries.log_linear());
+  EXPECT_FALSE(bucket_boundaries.auto_range());
+  EXPECT_NE(bucket_boundaries,
+            BucketBoundaries::Explicit(bucket_boundaries.lower_boundaries()));
+}
+
+TEST(BucketBoundariesTest, LogLinearBucketForValue) {
+  // Matches a binary search over the same boundaries.
+  for (const int sub_bucket_bits :
+       {0, 1, 3, BucketBoundaries::kMaxSubBucketBits}) {
+    const BucketBoundaries log_linear =
+        BucketBoundaries::LogLinear(-3, 5, sub_bucket_bits);
+    const BucketBoundaries explicit_boundaries =
+        BucketBoundaries::Explicit(log_linear.lower_boundaries());
+    for (double value = -1; value < 40; value += 0.0078125 * 1.37) {
+      ASSERT_EQ(explicit_boundaries.BucketForValue(value),
+                log_linear.BucketForValue(value))
+          << value;
+    }
+    for (const double boundary : log_linear.lower_boundaries()) {
+      ASSERT_EQ(explicit_boundaries.BucketForValue(boundary),
+                log_linear.BucketForValue(boundary));
+      const double below = std::nextafter(boundary, 0);
+      ASSERT_EQ(explicit_boundaries.BucketForValue(below),
+                log_linear.BucketForValue(below));
+    }
+    for (const double value : {0.0, std::numeric_limits<double>::infinity(),
+                               -std::numeric_limits<double>::infinity(),
+                               std::numeric_limits<double>::quiet_NaN()}) {
+      EXPECT_EQ(explicit_boundaries.BucketForValue(value),
+                log_linear.BucketForValue(value));
+    }
+  }
+}
+
+TEST(BucketBoundariesTest, LogLinearFullRange) {
+  const BucketBoundaries bucket_boundaries =
+      BucketBoundaries::LogLinear(-1022, 1024, 0);
+  EXPECT_EQ(2048, bucket_boundaries.num_buckets());
+  EXPECT_EQ(0, bucket_boundaries.BucketForValue(
+                   std::numeric_limits<double>::denorm_min()));
+  EXPECT_EQ(1, bucket_boundaries.BucketForValue(
+                   std::numeric_limits<double>::min()));
+  EXPECT_EQ(1023, bucket_boundaries.BucketForValue(1));
+  EXPECT_EQ(2046, bucket_boundaries.BucketForValue(
+                      std::numeric_limits<double>::max()));
+  EXPECT_EQ(2047, bucket_boundaries.BucketForValue(
+                      std::numeric_limits<double>::infinity()));
+}
+
+TEST(BucketBoundariesTest, AutoLogLinear) {
+  const BucketBoundaries bucket_boundaries = BucketBoundaries::AutoLogLinear(3);
+  EXPECT_TRUE(bucket_boundaries.auto_range());
+  EXPECT_EQ(3, bucket_boundaries.sub_bucket_bits());
+  EXPECT_EQ(1, bucket_boundaries.num_buckets());
+  EXPECT_EQ(0, bucket_boundaries.BucketForValue(5));
+  EXPECT_NE(bucket_boundaries, BucketBoundaries::Explicit({}));
+  EXPECT_NE(bucket_boundaries, BucketBoundaries::AutoLogLinear(2));
+  EXPECT_EQ(bucket_boundaries, BucketBoundaries::AutoLogLinear(3));
+  EXPECT_EQ(BucketBoundaries::kDefaultMaxExponentSpan,
+            bucket_boundaries.max_exponent_span());
+  EXPECT_NE(bucket_boundaries, BucketBoundaries::AutoLogLinear(3, 8));
+  EXPECT_EQ(8, BucketBoundaries::AutoLogLinear(3, 8).max_exponent_span());
+}
+
+TEST(BucketBoundariesDeathTest, InvalidLogLinear) {
+  EXPECT_DEBUG_DEATH(
+      {
+        EXPECT_TRUE(BucketBoundaries::LogLinear(2, 1, 0)
+                        .lower_boundaries()
+                        .empty());
+      },
+      "");
+  EXPECT_DEBUG_DEATH(
+      {
+        EXPECT_TRUE(
+            BucketBoundaries::LogLinear(0, 1,
+                                        BucketBoundaries::kMaxSubBucketBits + 1)
+                .lower_boundaries()
+                .empty());
+      },
+      "");
+}
+
+TEST(BucketBoundariesDeathTest, InvalidAutoLogLinear) {
+  EXPECT_DEBUG_DEATH(
+      { EXPECT_FALSE(BucketBoundaries::AutoLogLinear(0, 0).auto_range()); },
+      "");
+  EXPECT_DEBUG_DEATH(
+      { EXPECT_FALSE(BucketBoundaries::AutoLogLinear(0, 2047).auto_range()); },
+      "");
+}
+
 TEST(BucketBoundariesDeathTest, NonMonotonicExplicit) {
   const std::initializer_list<double> boundaries = {0, -1, 1};
   EXPECT_DEBUG_DEATH(
@@ -16,9 +16,14 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <map>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/hash/hash.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
@@ -26,31 +31,44 @@
 #include "opencensus/stats/internal/measure_data.h"
 #include "opencensus/stats/internal/measure_registry_impl.h"
 #include "opencensus/stats/internal/stats_manager.h"
+#include "opencensus/tags/tag_key.h"
 
 namespace opencensus {
 namespace stats {
 
 void Delta::Record(std::initializer_list<Measurement> measurements,
                    opencensus::tags::TagMap tags) {
+  std::vector<MeasureData>* data;
   auto it = delta_.find(tags);
-  if (it == delta_.end()) {
+  if (it != delta_.end()) {
+    data = &it->second;
+  } else if (max_rows_ != 0 &&
+             (delta_.size() >= 2 * max_rows_ || !AddRows(tags))) {
+    // Stop buffering tag sets for new rows, so that adversarial tag values
+    // can't grow the delta without bound between harvests.
+    if (overflow_.empty()) {
+      InitMeasureData(&overflow_);
+    }
+    data = &overflow_;
+  } else {
+    if (max_rows_ != 0) {
+      tags = Project(std::move(tags));
+    }
     it = delta_.emplace_hint(it, std::piecewise_construct,
                              std::make_tuple(std::move(tags)),
                              std::make_tuple(std::vector<MeasureData>()));
-    it->second.reserve(registered_boundaries_.size());
-    for (const auto& boundaries_for_measure : registered_boundaries_) {
-      it->second.emplace_back(boundaries_for_measure);
-    }
+    data = &it->second;
+    InitMeasureData(data);
   }
   for (const auto& measurement : measurements) {
     const uint64_t index = MeasureRegistryImpl::IdToIndex(measurement.id_);
     ABSL_ASSERT(index < registered_boundaries_.size());
     switch (MeasureRegistryImpl::IdToType(measurement.id_)) {
       case MeasureDescriptor::Type::kDouble:
-        it->second[index].Add(measurement.value_double_);
+        (*data)[index].Add(measurement.value_double_);
         break;
       case MeasureDescriptor::Type::kInt64:
-        it->second[index].Add(measurement.value_int_);
+        (*data)[index].Add(measurement.value_int_);
         break;
     }
   }
@@ -58,16 +76,150 @@ void Delta::Record(std::initializer_list<Measurement> measurements,
 
 void Delta::clear() {
   registered_boundaries_.clear();
+  registered_sketches_.clear();
+  registered_columns_.clear();
+  column_keys_.reset();
   delta_.clear();
+  overflow_.clear();
+  buffered_rows_.clear();
+  num_buffered_rows_ = 0;
 }
 
 void Delta::SwapAndReset(
     std::vector<std::vector<BucketBoundaries>>& registered_boundaries,
-    Delta* other) {
+    const std::vector<bool>& registered_sketches,
+    const std::map<std::vector<opencensus::tags::TagKey>, int>&
+        registered_columns,
+    size_t max_rows, Delta* other) {
   registered_boundaries_.swap(other->registered_boundaries_);
+  registered_sketches_.swap(other->registered_sketches_);
   delta_.swap(other->delta_);
+  overflow_.swap(other->overflow_);
   delta_.clear();
+  overflow_.clear();
   registered_boundaries_ = registered_boundaries;
+  registered_sketches_ = registered_sketches;
+  registered_columns_.clear();
+  auto column_keys = std::make_shared<std::vector<opencensus::tags::TagKey>>();
+  for (const auto& columns : registered_columns) {
+    registered_columns_.push_back(columns.first);
+    column_keys->insert(column_keys->end(), columns.first.begin(),
+                        columns.first.end());
+  }
+  std::sort(column_keys->begin(), column_keys->end());
+  column_keys->erase(std::unique(column_keys->begin(), column_keys->end()),
+                     column_keys->end());
+  column_keys_ = std::move(column_keys);
+  max_rows_ = max_rows;
+  // delta_ is empty, so its hash function can change.
+  const auto keys = max_rows_ == 0 ? nullptr : column_keys_;
+  delta_ = DataMap(0, ProjectedHash{keys}, ProjectedEqual{keys});
+  buffered_rows_.clear();
+  if (max_rows_ != 0) {
+    buffered_rows_.resize(registered_columns_.size());
+  }
+  num_buffered_rows_ = 0;
+}
+
+void Delta::InitMeasureData(std::vector<MeasureData>* data) const {
+  data->reserve(registered_boundaries_.size());
+  for (int i = 0; i < registered_boundaries_.size(); ++i) {
+    data->emplace_back(registered_boundaries_[i], registered_sketches_[i]);
+  }
+}
+
+namespace {
+
+bool HasKey(const std::vector<opencensus::tags::TagKey>& keys,
+            opencensus::tags::TagKey key) {
+  return std::binary_search(keys.begin(), keys.end(), key);
+}
+
+}  // namespace
+
+std::size_t Delta::ProjectedHash::operator()(
+    const opencensus::tags::TagMap& tags) const {
+  if (keys == nullptr) {
+    return opencensus::tags::TagMap::Hash()(tags);
+  }
+  std::size_t hash = 0;
+  for (const auto& tag : tags.tags()) {
+    if (HasKey(*keys, tag.first)) {
+      hash = hash * 31 + absl::Hash<std::pair<opencensus::tags::TagKey,
+                                              absl::string_view>>()(tag);
+    }
+  }
+  return hash;
+}
+
+bool Delta::ProjectedEqual::operator()(
+    const opencensus::tags::TagMap& a,
+    const opencensus::tags::TagMap& b) const {
+  if (keys == nullptr) {
+    return a == b;
+  }
+  // Both are sorted by key, so compare the kept tags in order.
+  auto a_it = a.tags().begin();
+  auto b_it = b.tags().begin();
+  while (true) {
+    while (a_it != a.tags().end() && !HasKey(*keys, a_it->first)) {
+      ++a_it;
+    }
+    while (b_it != b.tags().end() && !HasKey(*keys, b_it->first)) {
+      ++b_it;
+    }
+    if (a_it == a.tags().end() || b_it == b.tags().end()) {
+      return a_it == a.tags().end() && b_it == b.tags().end();
+    }
+    if (*a_it != *b_it) {
+      return false;
+    }
+    ++a_it;
+    ++b_it;
+  }
+}
+
+opencensus::tags::TagMap Delta::Project(opencensus::tags::TagMap tags) const {
+  std::vector<std::pair<opencensus::tags::TagKey, std::string>> projected;
+  for (const auto& tag : tags.tags()) {
+    if (HasKey(*column_keys_, tag.first)) {
+      projected.push_back(tag);
+    }
+  }
+  if (projected.size() == tags.tags().size()) {
+    return tags;
+  }
+  return opencensus::tags::TagMap(std::move(projected));
+}
+
+bool Delta::AddRows(const opencensus::tags::TagMap& tags) {
+  std::vector<std::pair<size_t, std::vector<std::string>>> new_rows;
+  for (size_t i = 0; i < registered_columns_.size(); ++i) {
+    const auto& columns = registered_columns_[i];
+    std::vector<std::string> row(columns.size());
+    for (size_t j = 0; j < columns.size(); ++j) {
+      for (const auto& tag : tags.tags()) {
+        if (tag.first == columns[j]) {
+          row[j] = tag.second;
+          break;
+        }
+      }
+    }
+    if (buffered_rows_[i].find(row) == buffered_rows_[i].end()) {
+      new_rows.emplace_back(i, std::move(row));
+    }
+  }
+  // The first tag set is always buffered, even if it maps to more rows than
+  // the limit.
+  if (num_buffered_rows_ != 0 &&
+      num_buffered_rows_ + new_rows.size() > max_rows_) {
+    return false;
+  }
+  for (auto& row : new_rows) {
+    buffered_rows_[row.first].insert(std::move(row.second));
+  }
+  num_buffered_rows_ += new_rows.size();
+  return true;
 }
 
 DeltaProducer* DeltaProducer::Get() {
@@ -79,6 +231,7 @@ void DeltaProducer::AddMeasure() {
   delta_mu_.Lock();
   absl::MutexLock harvester_lock(&harvester_mu_);
   registered_boundaries_.push_back({});
+  registered_sketches_.push_back(false);
   SwapDeltas();
   delta_mu_.Unlock();
   ConsumeLastDelta();
@@ -100,6 +253,55 @@ void DeltaProducer::AddBoundaries(uint64_t index,
   }
 }
 
+void DeltaProducer::AddSketch(uint64_t index) {
+  delta_mu_.Lock();
+  if (!registered_sketches_[index]) {
+    absl::MutexLock harvester_lock(&harvester_mu_);
+    registered_sketches_[index] = true;
+    SwapDeltas();
+    delta_mu_.Unlock();
+    ConsumeLastDelta();
+  } else {
+    delta_mu_.Unlock();
+  }
+}
+
+void DeltaProducer::AddColumns(
+    const std::vector<opencensus::tags::TagKey>& columns) {
+  if (columns.empty()) {
+    return;
+  }
+  delta_mu_.Lock();
+  if (++registered_columns_[columns] == 1) {
+    // Tag sets in the active delta may have been projected without these
+    // columns.
+    absl::MutexLock harvester_lock(&harvester_mu_);
+    SwapDeltas();
+    delta_mu_.Unlock();
+    ConsumeLastDelta();
+  } else {
+    delta_mu_.Unlock();
+  }
+}
+
+void DeltaProducer::RemoveColumns(
+    const std::vector<opencensus::tags::TagKey>& columns) {
+  if (columns.empty()) {
+    return;
+  }
+  absl::MutexLock l(&delta_mu_);
+  auto it = registered_columns_.find(columns);
+  ABSL_ASSERT(it != registered_columns_.end());
+  if (it != registered_columns_.end() && --it->second == 0) {
+    registered_columns_.erase(it);
+  }
+}
+
+void DeltaProducer::SetMaxRows(size_t max_rows) {
+  absl::MutexLock l(&delta_mu_);
+  max_rows_ = max_rows;
+}
+
 void DeltaProducer::Record(std::initializer_list<Measurement> measurements,
                            opencensus::tags::TagMap tags) {
   absl::MutexLock l(&delta_mu_);
@@ -119,7 +321,14 @@ DeltaProducer::DeltaProducer()
 
 void DeltaProducer::SwapDeltas() {
   ABSL_ASSERT(last_delta_.delta().empty() && "Last delta was not consumed.");
-  active_delta_.SwapAndReset(registered_boundaries_, &last_delta_);
+  // Report rows dropped by earlier merges with the data being harvested.
+  const int64_t dropped_rows = StatsManager::Get()->TakeDroppedRows();
+  if (dropped_rows != 0) {
+    active_delta_.Record({{StatsManager::DroppedRowsMeasure(), dropped_rows}},
+                         opencensus::tags::TagMap({}));
+  }
+  active_delta_.SwapAndReset(registered_boundaries_, registered_sketches_,
+                             registered_columns_, max_rows_, &last_delta_);
 }
 
 void DeltaProducer::ConsumeLastDelta() {
@@ -15,18 +15,24 @@
 #ifndef OPENCENSUS_STATS_INTERNAL_DELTA_PRODUCER_H_
 #define OPENCENSUS_STATS_INTERNAL_DELTA_PRODUCER_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <map>
 #include <memory>
+#include <string>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
+#include "opencensus/common/internal/string_vector_hash.h"
 #include "opencensus/stats/bucket_boundaries.h"
 #include "opencensus/stats/distribution.h"
 #include "opencensus/stats/internal/measure_data.h"
 #include "opencensus/stats/measure.h"
+#include "opencensus/tags/tag_key.h"
 #include "opencensus/tags/tag_map.h"
 
 namespace opencensus {
@@ -34,35 +40,92 @@ namespace stats {
 
 // Delta is thread-compatible.
 class Delta final {
+ private:
+  // Hash and compare TagMaps by only their tags with '*keys' (which is
+  // sorted), or by every tag if 'keys' is null. This lets Record() look up the
+  // entry for a tag set's projection without building the projected TagMap.
+  struct ProjectedHash {
+    std::size_t operator()(const opencensus::tags::TagMap& tags) const;
+    std::shared_ptr<const std::vector<opencensus::tags::TagKey>> keys;
+  };
+  struct ProjectedEqual {
+    bool operator()(const opencensus::tags::TagMap& a,
+                    const opencensus::tags::TagMap& b) const;
+    std::shared_ptr<const std::vector<opencensus::tags::TagKey>> keys;
+  };
+
  public:
+  using DataMap =
+      std::unordered_map<opencensus::tags::TagMap, std::vector<MeasureData>,
+                         ProjectedHash, ProjectedEqual>;
+
   void Record(std::initializer_list<Measurement> measurements,
               opencensus::tags::TagMap tags);
 
-  // Swaps registered_boundaries_ and delta_ with *other, clears delta_, and
-  // updates registered_boundaries_.
+  // Swaps registered_boundaries_, registered_sketches_, delta_, and overflow_
+  // with *other, clears delta_ and overflow_, and updates
+  // registered_boundaries_, registered_sketches_, registered_columns_, and
+  // max_rows_. 'registered_columns' holds the columns of registered views as
+  // keys.
   void SwapAndReset(
       std::vector<std::vector<BucketBoundaries>>& registered_boundaries,
-      Delta* other);
+      const std::vector<bool>& registered_sketches,
+      const std::map<std::vector<opencensus::tags::TagKey>, int>&
+          registered_columns,
+      size_t max_rows, Delta* other);
 
-  // Clears registered_boundaries_ and delta_.
+  // Clears registered_boundaries_, registered_sketches_, registered_columns_,
+  // delta_, and overflow_.
   void clear();
 
-  const std::unordered_map<opencensus::tags::TagMap, std::vector<MeasureData>,
-                           opencensus::tags::TagMap::Hash>&
-  delta() const {
-    return delta_;
-  }
+  const DataMap& delta() const { return delta_; }
+
+  // Data recorded under tag sets that did not fit in delta_, with one
+  // MeasureData for each registered measure, or empty if there was none.
+  const std::vector<MeasureData>& overflow() const { return overflow_; }
 
  private:
+  // Sets *data to an empty MeasureData for each registered measure.
+  void InitMeasureData(std::vector<MeasureData>* data) const;
+
+  // Returns 'tags' without the tags that no registered view has as a column.
+  opencensus::tags::TagMap Project(opencensus::tags::TagMap tags) const;
+
+  // Returns whether the rows that 'tags' maps to fit within max_rows_, adding
+  // them to buffered_rows_ if so.
+  bool AddRows(const opencensus::tags::TagMap& tags);
+
   // A copy of registered_boundaries_ in the DeltaProducer as of when the
   // delta was started.
   std::vector<std::vector<BucketBoundaries>> registered_boundaries_;
+  // Likewise, whether each measure keeps a QuantileSketch.
+  std::vector<bool> registered_sketches_;
 
   // The actual data. Each MeasureData[] contains one element for each
   // registered measure.
-  std::unordered_map<opencensus::tags::TagMap, std::vector<MeasureData>,
-                     opencensus::tags::TagMap::Hash>
-      delta_;
+  DataMap delta_;
+
+  // The columns of registered views, leaving out duplicates and views without
+  // columns.
+  std::vector<std::vector<opencensus::tags::TagKey>> registered_columns_;
+  // Every key in registered_columns_, sorted.
+  std::shared_ptr<const std::vector<opencensus::tags::TagKey>> column_keys_;
+
+  // The most view rows delta_ may map to, or 0 for no limit. While there is a
+  // limit, delta_ is keyed by tag sets projected onto *column_keys_, so that
+  // tags no view uses (e.g. request IDs) don't take up room; tag sets are only
+  // projected when they add an entry. Once delta_ is full, data for tag
+  // sets that would add rows is recorded into overflow_ instead. Tag sets that
+  // only map to rows delta_ already has are still buffered, up to twice
+  // max_rows_ tag sets in all.
+  size_t max_rows_ = 0;
+  std::vector<MeasureData> overflow_;
+  // While there is a limit, the rows delta_ maps to for each of
+  // registered_columns_, and their total number.
+  std::vector<std::unordered_set<std::vector<std::string>,
+                                 common::StringVectorHash>>
+      buffered_rows_;
+  size_t num_buffered_rows_ = 0;
 };
 
 // DeltaProducer is thread-safe.
@@ -78,6 +141,23 @@ class DeltaProducer final {
   // exist.
   void AddBoundaries(uint64_t index, const BucketBoundaries& boundaries);
 
+  // Keeps a QuantileSketch for the measure 'index' if it does not already.
+  void AddSketch(uint64_t index);
+
+  // Registers and unregisters the columns of a view, so that tags no view
+  // uses can be left out of buffered tag sets. Columns registered for the
+  // first time take effect immediately; unregistering takes effect from the
+  // next delta on.
+  void AddColumns(const std::vector<opencensus::tags::TagKey>& columns)
+      ABSL_LOCKS_EXCLUDED(delta_mu_, harvester_mu_);
+  void RemoveColumns(const std::vector<opencensus::tags::TagKey>& columns)
+      ABSL_LOCKS_EXCLUDED(delta_mu_);
+
+  // Limits the number of distinct view rows buffered between harvests, from
+  // the next delta on; 0 means no limit. Data for tag sets that would add
+  // further rows is merged into the overflow row of every view.
+  void SetMaxRows(size_t max_rows) ABSL_LOCKS_EXCLUDED(delta_mu_);
+
   void Record(std::initializer_list<Measurement> measurements,
               opencensus::tags::TagMap tags) ABSL_LOCKS_EXCLUDED(delta_mu_);
 
@@ -113,6 +193,13 @@ class DeltaProducer final {
   // by measure. Array indices in the outer array correspond to measure indices.
   std::vector<std::vector<BucketBoundaries>> registered_boundaries_
       ABSL_GUARDED_BY(delta_mu_);
+  // Whether each measure has a registered view with Quantiles aggregation.
+  std::vector<bool> registered_sketches_ ABSL_GUARDED_BY(delta_mu_);
+  // The columns of registered views that have any, with the number of views
+  // that have them.
+  std::map<std::vector<opencensus::tags::TagKey>, int> registered_columns_
+      ABSL_GUARDED_BY(delta_mu_);
+  size_t max_rows_ ABSL_GUARDED_BY(delta_mu_) = 0;
   Delta active_delta_ ABSL_GUARDED_BY(delta_mu_);
 
   // Guards the last_delta_; acquired by the main thread when triggering a
@@ -15,13 +15,84 @@
 #include "opencensus/stats/distribution.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 
 namespace opencensus {
 namespace stats {
 
+namespace {
+
+using RangeKey = std::tuple<int, int, int>;
+
+// Returns LogLinear(min_exponent, max_exponent, sub_bucket_bits) for 'key'.
+// Ranges are built once and shared, since distributions with the same
+// auto-ranging boundaries tend to reach the same few ranges, and each delta's
+// distributions extend through them again.
+std::shared_ptr<const BucketBoundaries> SharedRangedBoundaries(
+    const RangeKey& key) {
+  // The most boundaries kept for sharing, to bound memory if ranges vary.
+  constexpr size_t kMaxCachedBoundaries = 1 << 20;
+  static absl::Mutex* mu = new absl::Mutex;
+  static auto* cache =
+      new std::map<RangeKey, std::shared_ptr<const BucketBoundaries>>;
+  static size_t num_cached_boundaries = 0;
+
+  {
+    absl::MutexLock l(mu);
+    const auto it = cache->find(key);
+    if (it != cache->end()) {
+      return it->second;
+    }
+  }
+  auto boundaries =
+      std::make_shared<const BucketBoundaries>(BucketBoundaries::LogLinear(
+          std::get<0>(key), std::get<1>(key), std::get<2>(key)));
+  absl::MutexLock l(mu);
+  const size_t size = boundaries->lower_boundaries().size();
+  if (num_cached_boundaries + size <= kMaxCachedBoundaries &&
+      cache->emplace(key, boundaries).second) {
+    num_cached_boundaries += size;
+  }
+  return boundaries;
+}
+
+// The ranges each thread used last, in slots by a hash of their key, so that
+// distributions retracing them skip the shared cache and its lock.
+struct RecentRange {
+  RangeKey key;
+  std::shared_ptr<const BucketBoundaries> boundaries;
+};
+constexpr int kNumRecentRanges = 16;
+thread_local RecentRange recent_ranges[kNumRecentRanges];
+
+// Returns LogLinear(min_exponent, max_exponent, sub_bucket_bits).
+std::shared_ptr<const BucketBoundaries> RangedBoundaries(int min_exponent,
+                                                         int max_exponent,
+                                                         int sub_bucket_bits) {
+  const RangeKey key(min_exponent, max_exponent, sub_bucket_bits);
+  const unsigned hash =
+      static_cast<unsigned>(min_exponent) * 31 + max_exponent + sub_bucket_bits;
+  RecentRange& recent = recent_ranges[hash % kNumRecentRanges];
+  if (recent.boundaries == nullptr || recent.key != key) {
+    recent.boundaries = SharedRangedBoundaries(key);
+    recent.key = key;
+  }
+  return recent.boundaries;
+}
+
+}  // namespace
+
 Distribution::Distribution(const BucketBoundaries* buckets)
     : buckets_(buckets), bucket_counts_(buckets->num_buckets()) {}
 
@@ -37,7 +108,97 @@ void Distribution::Add(double value) {
   min_ = std::min(value, min_);
   max_ = std::max(value, max_);
 
-  ++bucket_counts_[buckets_->BucketForValue(value)];
+  AddToBucket(value);
+}
+
+void Distribution::AddToBucket(double value) {
+  // Subnormal values, without an exponent of their own, stay in the underflow
+  // bucket.
+  if (buckets_->auto_range() && value >= std::numeric_limits<double>::min() &&
+      value <= std::numeric_limits<double>::max()) {
+    const int exponent = std::ilogb(value);
+    if (ranged_buckets_ == nullptr) {
+      ExtendRange(exponent, exponent + 1);
+    } else if (exponent < ranged_buckets_->min_exponent()) {
+      ExtendRange(exponent, ranged_buckets_->max_exponent());
+    } else if (exponent >= ranged_buckets_->max_exponent()) {
+      ExtendRange(ranged_buckets_->min_exponent(), exponent + 1);
+    }
+  }
+  // Values outside a range that has reached its maximum span fall in the
+  // underflow or overflow bucket.
+  ++bucket_counts_[bucket_boundaries().BucketForValue(value)];
+}
+
+void Distribution::AddBucketCounts(const Distribution& other) {
+  if (!buckets_->auto_range()) {
+    for (int i = 0; i < bucket_counts_.size(); ++i) {
+      bucket_counts_[i] += other.bucket_counts_[i];
+    }
+    return;
+  }
+  bucket_counts_.front() += other.bucket_counts_.front();
+  if (other.ranged_buckets_ == nullptr) {
+    return;
+  }
+  const BucketBoundaries& other_range = *other.ranged_buckets_;
+  if (ranged_buckets_ == nullptr) {
+    ExtendRange(other_range.min_exponent(), other_range.max_exponent());
+  } else if (other_range.min_exponent() < ranged_buckets_->min_exponent() ||
+             other_range.max_exponent() > ranged_buckets_->max_exponent()) {
+    ExtendRange(
+        std::min(other_range.min_exponent(), ranged_buckets_->min_exponent()),
+        std::max(other_range.max_exponent(), ranged_buckets_->max_exponent()));
+  }
+  // The range may not have been able to extend over all of other_range, in
+  // which case the finite buckets outside it count as underflow or overflow.
+  const int offset =
+      (other_range.min_exponent() - ranged_buckets_->min_exponent()) *
+      (1 << buckets_->sub_bucket_bits());
+  const int overflow_bucket = bucket_counts_.size() - 1;
+  // The finite buckets, then the overflow bucket.
+  for (int i = 1; i + 1 < other.bucket_counts_.size(); ++i) {
+    const int bucket = std::min(std::max(offset + i, 0), overflow_bucket);
+    bucket_counts_[bucket] += other.bucket_counts_[i];
+  }
+  bucket_counts_.back() += other.bucket_counts_.back();
+}
+
+void Distribution::ExtendRange(int min_exponent, int max_exponent) {
+  const int max_span = buckets_->max_exponent_span();
+  if (max_exponent - min_exponent > max_span) {
+    if (ranged_buckets_ == nullptr) {
+      max_exponent = min_exponent + max_span;
+    } else {
+      // Keep the current range, and extend it as far as the span allows,
+      // downward first.
+      const int current_min = ranged_buckets_->min_exponent();
+      const int current_max = ranged_buckets_->max_exponent();
+      const int room = max_span - (current_max - current_min);
+      const int below = std::min(current_min - min_exponent, room);
+      min_exponent = current_min - below;
+      max_exponent =
+          current_max + std::min(max_exponent - current_max, room - below);
+      if (min_exponent == current_min && max_exponent == current_max) {
+        return;
+      }
+    }
+  }
+  const int sub_bucket_bits = buckets_->sub_bucket_bits();
+  auto extended =
+      RangedBoundaries(min_exponent, max_exponent, sub_bucket_bits);
+  std::vector<uint64_t> counts(extended->num_buckets());
+  counts.front() = bucket_counts_.front();
+  if (ranged_buckets_ != nullptr) {
+    const int offset = (ranged_buckets_->min_exponent() - min_exponent)
+                       << sub_bucket_bits;
+    for (int i = 1; i + 1 < bucket_counts_.size(); ++i) {
+      counts[offset + i] = bucket_counts_[i];
+    }
+    counts.back() = bucket_counts_.back();
+  }
+  bucket_counts_ = std::move(counts);
+  ranged_buckets_ = std::move(extended);
 }
 
 std::string Distribution::DebugString() const {
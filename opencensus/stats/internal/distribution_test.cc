@@ -156,6 +156,71 @@ TEST(DistributionTest, NegativeInfinity) {
   EXPECT_EQ(distribution.max(), 1);
 }
 
+TEST(DistributionTest, AutoRangingBuckets) {
+  BucketBoundaries buckets = BucketBoundaries::AutoLogLinear(1);
+  Distribution distribution = testing::TestUtils::MakeDistribution(&buckets);
+  EXPECT_EQ(buckets, distribution.bucket_boundaries());
+  EXPECT_THAT(distribution.bucket_counts(), ::testing::ElementsAre(0));
+
+  testing::TestUtils::AddToDistribution(&distribution, 0);
+  testing::TestUtils::AddToDistribution(&distribution, 5);
+  EXPECT_EQ(BucketBoundaries::LogLinear(2, 3, 1),
+            distribution.bucket_boundaries());
+  EXPECT_THAT(distribution.bucket_boundaries().lower_boundaries(),
+              ::testing::ElementsAre(4, 6, 8));
+  EXPECT_THAT(distribution.bucket_counts(),
+              ::testing::ElementsAre(1, 1, 0, 0));
+
+  // Extends downward and then upward, keeping the counts so far.
+  testing::TestUtils::AddToDistribution(&distribution, 1.5);
+  testing::TestUtils::AddToDistribution(&distribution, 20);
+  testing::TestUtils::AddToDistribution(&distribution, -3);
+  testing::TestUtils::AddToDistribution(
+      &distribution, std::numeric_limits<double>::infinity());
+  EXPECT_EQ(BucketBoundaries::LogLinear(0, 5, 1),
+            distribution.bucket_boundaries());
+  EXPECT_THAT(distribution.bucket_counts(),
+              ::testing::ElementsAre(2, 0, 1, 0, 0, 1, 0, 0, 0, 1, 0, 1));
+  EXPECT_EQ(6, distribution.count());
+
+  // Copies keep their own range.
+  Distribution copy = distribution;
+  testing::TestUtils::AddToDistribution(&copy, 1000);
+  EXPECT_EQ(BucketBoundaries::LogLinear(0, 5, 1),
+            distribution.bucket_boundaries());
+  EXPECT_EQ(BucketBoundaries::LogLinear(0, 10, 1), copy.bucket_boundaries());
+}
+
+TEST(DistributionTest, AutoRangingBucketsMaxSpan) {
+  BucketBoundaries buckets = BucketBoundaries::AutoLogLinear(0, 3);
+  Distribution distribution = testing::TestUtils::MakeDistribution(&buckets);
+  testing::TestUtils::AddToDistribution(&distribution, 1);
+  // Extends upward only as far as the span allows, and then no further.
+  testing::TestUtils::AddToDistribution(&distribution, 100);
+  testing::TestUtils::AddToDistribution(&distribution, 0.1);
+  testing::TestUtils::AddToDistribution(&distribution, 5);
+  EXPECT_EQ(BucketBoundaries::LogLinear(0, 3, 0),
+            distribution.bucket_boundaries());
+  EXPECT_THAT(distribution.bucket_counts(),
+              ::testing::ElementsAre(1, 1, 0, 1, 1));
+  EXPECT_EQ(4, distribution.count());
+}
+
+TEST(DistributionTest, AutoRangingBucketsShareRanges) {
+  BucketBoundaries buckets = BucketBoundaries::AutoLogLinear(2);
+  Distribution distribution1 = testing::TestUtils::MakeDistribution(&buckets);
+  Distribution distribution2 = testing::TestUtils::MakeDistribution(&buckets);
+  testing::TestUtils::AddToDistribution(&distribution1, 3);
+  testing::TestUtils::AddToDistribution(&distribution1, 10);
+  testing::TestUtils::AddToDistribution(&distribution2, 12);
+  testing::TestUtils::AddToDistribution(&distribution2, 2.5);
+  // The same range is only built once.
+  EXPECT_EQ(BucketBoundaries::LogLinear(1, 4, 2),
+            distribution1.bucket_boundaries());
+  EXPECT_EQ(&distribution1.bucket_boundaries(),
+            &distribution2.bucket_boundaries());
+}
+
 TEST(DistributionTest, DebugString) {
   BucketBoundaries buckets = BucketBoundaries::Explicit({0});
   Distribution distribution = testing::TestUtils::MakeDistribution(&buckets);
@@ -0,0 +1,110 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPENCENSUS_STATS_INTERNAL_INTERVAL_QUANTILE_SKETCH_H_
+#define OPENCENSUS_STATS_INTERNAL_INTERVAL_QUANTILE_SKETCH_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "opencensus/common/internal/sliding_window.h"
+#include "opencensus/stats/quantile_sketch.h"
+
+namespace opencensus {
+namespace stats {
+
+// IntervalQuantileSketch keeps a QuantileSketch over a sliding window of time,
+// with the same bucketing and interpolation of the oldest bucket as
+// common::StatsObject<N> (see opencensus/common/internal/stats_object.h). It
+// holds one sketch per bucket, so its memory is bounded by N + 1 times that of
+// a QuantileSketch.
+//
+// Thread-compatible.
+template <uint16_t N>
+class IntervalQuantileSketch {
+ public:
+  // 'interval' will be rounded to 1 second if it is smaller.
+  IntervalQuantileSketch(absl::Duration interval, absl::Time now)
+      : window_(interval, now),
+        sketches_(common::SlidingWindow<N>::NumBuckets(), QuantileSketch()) {}
+
+  // No copy or assign, as for StatsObject.
+  IntervalQuantileSketch(const IntervalQuantileSketch<N>&) = delete;
+  IntervalQuantileSketch& operator=(const IntervalQuantileSketch<N>&) = delete;
+
+  // Fast-forwards this object's current time to 'now' and returns the current
+  // bucket's sketch. The returned pointer is valid only until you call a
+  // non-const function on this object.
+  QuantileSketch* MutableCurrentBucket(absl::Time now) {
+    Shift(now);
+    return &sketches_[window_.cur_bucket()];
+  }
+
+  // Merges the values in the window as of 'now' into *sketch.
+  void SketchInto(QuantileSketch* sketch, absl::Time now) const {
+    const uint32_t buckets_ahead = window_.BucketsAhead(now);
+    if (buckets_ahead >= NumBuckets()) {
+      return;
+    }
+    const uint32_t last_bucket = NumBuckets() - 1 - buckets_ahead;
+    for (uint32_t b = 0; b < last_bucket; ++b) {
+      sketch->Merge(sketches_[window_.NthBucketIndex(b)]);
+    }
+    // Now add (possibly only a part of) the last bucket.
+    sketch->MergePortion(sketches_[window_.NthBucketIndex(last_bucket)],
+                         window_.LastBucketPortion(now));
+  }
+
+  // Has nothing been added in the window as of 'now'?
+  bool IsEmpty(absl::Time now) const {
+    const uint32_t buckets_ahead = window_.BucketsAhead(now);
+    for (uint32_t i = 0; i + buckets_ahead < NumBuckets(); ++i) {
+      if (sketches_[window_.NthBucketIndex(i)].count() != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  static constexpr uint16_t NumBuckets() {
+    return common::SlidingWindow<N>::NumBuckets();
+  }
+
+  // Shifts our data forward in time so that next_bucket_start_time > now.
+  void Shift(absl::Time now) {
+    if (now < window_.next_bucket_start_time()) {
+      return;
+    }
+    const uint32_t num_shifts = window_.BucketsAhead(now);
+    const uint32_t num_buckets_to_clear =
+        std::min<uint32_t>(NumBuckets(), num_shifts);
+    for (uint32_t i = 0; i < num_buckets_to_clear; ++i) {
+      sketches_[window_.NthBucketIndex(NumBuckets() - i - 1)] =
+          QuantileSketch();
+    }
+    window_.Advance(now, num_shifts);
+  }
+
+  common::SlidingWindow<N> window_;
+  // The sketch of each bucket, indexed by slot.
+  std::vector<QuantileSketch> sketches_;
+};
+
+}  // namespace stats
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_STATS_INTERNAL_INTERVAL_QUANTILE_SKETCH_H_
@@ -18,21 +18,39 @@
 #include <cmath>
 #include <cstdint>
 #include <iostream>
+#include <limits>
 #include <vector>
 
 #include "absl/base/macros.h"
 #include "absl/types/span.h"
 #include "opencensus/stats/bucket_boundaries.h"
 #include "opencensus/stats/distribution.h"
+#include "opencensus/stats/quantile_sketch.h"
 
 namespace opencensus {
 namespace stats {
 
-MeasureData::MeasureData(absl::Span<const BucketBoundaries> boundaries)
+namespace {
+
+// Adds 'n' to '*count', saturating rather than wrapping for the 32-bit
+// histogram counts of interval distributions.
+template <typename BucketCountT>
+void SaturatingAdd(uint64_t n, BucketCountT* count) {
+  *count = static_cast<BucketCountT>(std::min<uint64_t>(
+      *count + n, std::numeric_limits<BucketCountT>::max()));
+}
+
+}  // namespace
+
+MeasureData::MeasureData(absl::Span<const BucketBoundaries> boundaries,
+                         bool keep_sketch)
     : boundaries_(boundaries) {
   histograms_.reserve(boundaries_.size());
   for (const auto& b : boundaries_) {
-    histograms_.emplace_back(b.num_buckets());
+    histograms_.push_back(Distribution(&b));
+  }
+  if (keep_sketch) {
+    sketch_ = QuantileSketch();
   }
 }
 
@@ -49,25 +67,53 @@ void MeasureData::Add(double value) {
   min_ = std::min(value, min_);
   max_ = std::max(value, max_);
 
-  for (int i = 0; i < boundaries_.size(); ++i) {
-    ++histograms_[i][boundaries_[i].BucketForValue(value)];
+  for (auto& histogram : histograms_) {
+    histogram.AddToBucket(value);
+  }
+  if (sketch_.has_value()) {
+    sketch_->Add(value);
   }
 }
 
 void MeasureData::AddToDistribution(Distribution* distribution) const {
-  AddToDistribution(distribution->bucket_boundaries(), &distribution->count_,
-                    &distribution->mean_,
-                    &distribution->sum_of_squared_deviation_,
-                    &distribution->min_, &distribution->max_,
-                    absl::Span<uint64_t>(distribution->bucket_counts_));
+  AddStats(&distribution->count_, &distribution->mean_,
+           &distribution->sum_of_squared_deviation_, &distribution->min_,
+           &distribution->max_);
+  const Distribution* histogram = HistogramFor(*distribution->buckets_);
+  if (histogram == nullptr) {
+    // Add to the underflow bucket, to avoid downstream errors from the sum of
+    // bucket counts not matching the total count.
+    distribution->bucket_counts_[0] += count_;
+  } else {
+    distribution->AddBucketCounts(*histogram);
+  }
+}
+
+template <typename CountT, typename BucketCountT>
+void MeasureData::AddToDistribution(
+    const BucketBoundaries& boundaries, CountT* count, double* mean,
+    double* sum_of_squared_deviation, double* min, double* max,
+    absl::Span<BucketCountT> histogram_buckets) const {
+  AddStats(count, mean, sum_of_squared_deviation, min, max);
+  const Distribution* histogram = HistogramFor(boundaries);
+  if (histogram != nullptr && boundaries.auto_range()) {
+    std::cerr << "Auto-ranging BucketBoundaries in AddToDistribution\n";
+    ABSL_ASSERT(false);
+    histogram = nullptr;
+  }
+  if (histogram == nullptr) {
+    SaturatingAdd(count_, &histogram_buckets[0]);
+  } else {
+    for (int i = 0; i < histogram->bucket_counts_.size(); ++i) {
+      SaturatingAdd(histogram->bucket_counts_[i], &histogram_buckets[i]);
+    }
+  }
 }
 
-template <typename T>
-void MeasureData::AddToDistribution(const BucketBoundaries& boundaries,
-                                    T* count, double* mean,
-                                    double* sum_of_squared_deviation,
-                                    double* min, double* max,
-                                    absl::Span<T> histogram_buckets) const {
+template <typename CountT>
+void MeasureData::AddStats(CountT* count, double* mean,
+                           double* sum_of_squared_deviation, double* min,
+                           double* max) const {
   // This uses the method of provisional means generalized for multiple values
   // in both datasets.
   const double new_count = *count + count_;
@@ -86,26 +132,34 @@ void MeasureData::AddToDistribution(const BucketBoundaries& boundaries,
     *min = std::min(*min, min_);
     *max = std::max(*max, max_);
   }
+}
 
-  int histogram_index =
+const Distribution* MeasureData::HistogramFor(
+    const BucketBoundaries& boundaries) const {
+  const int histogram_index =
       std::find(boundaries_.begin(), boundaries_.end(), boundaries) -
       boundaries_.begin();
   if (histogram_index >= histograms_.size()) {
     std::cerr << "No matching BucketBoundaries in AddToDistribution\n";
     ABSL_ASSERT(false);
-    // Add to the underflow bucket, to avoid downstream errors from the sum of
-    // bucket counts not matching the total count.
-    histogram_buckets[0] += count_;
-  } else {
-    for (int i = 0; i < histograms_[histogram_index].size(); ++i) {
-      histogram_buckets[i] += histograms_[histogram_index][i];
-    }
+    return nullptr;
+  }
+  return &histograms_[histogram_index];
+}
+
+void MeasureData::AddToQuantileSketch(QuantileSketch* sketch) const {
+  if (!sketch_.has_value()) {
+    std::cerr << "No QuantileSketch kept in AddToQuantileSketch\n";
+    ABSL_ASSERT(false);
+    return;
   }
+  sketch->Merge(*sketch_);
 }
 
-template void MeasureData::AddToDistribution(const BucketBoundaries&, double*,
-                                             double*, double*, double*, double*,
-                                             absl::Span<double>) const;
+template void MeasureData::AddToDistribution(const BucketBoundaries&,
+                                             uint64_t*, double*, double*,
+                                             double*, double*,
+                                             absl::Span<uint32_t>) const;
 
 }  // namespace stats
 }  // namespace opencensus
@@ -19,20 +19,24 @@
 #include <limits>
 #include <vector>
 
+#include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "opencensus/stats/bucket_boundaries.h"
 #include "opencensus/stats/distribution.h"
+#include "opencensus/stats/quantile_sketch.h"
 
 namespace opencensus {
 namespace stats {
 
 // MeasureData tracks all aggregations for a single measure, including
-// histograms for a number of different BucketBoundaries.
+// histograms for a number of different BucketBoundaries and, if 'keep_sketch',
+// a QuantileSketch.
 //
 // MeasureData is thread-compatible.
 class MeasureData final {
  public:
-  MeasureData(absl::Span<const BucketBoundaries> boundaries);
+  MeasureData(absl::Span<const BucketBoundaries> boundaries,
+              bool keep_sketch = false);
 
   void Add(double value);
 
@@ -40,19 +44,33 @@ class MeasureData final {
   uint64_t count() const { return count_; }
   double sum() const { return count_ * mean_; }
 
-  // Adds this to 'distribution'. Requires that
-  // distribution->bucket_boundaries() be in the set of boundaries passed to
-  // this on construction.
+  // Adds this to 'distribution'. Requires that 'distribution' was constructed
+  // with one of the boundaries passed to this on construction.
   void AddToDistribution(Distribution* distribution) const;
 
   // Adds this to a distribution by pointers to individual elements.
-  template <typename T>
-  void AddToDistribution(const BucketBoundaries& boundaries, T* count,
+  // 'boundaries' may not be auto-ranging.
+  template <typename CountT, typename BucketCountT>
+  void AddToDistribution(const BucketBoundaries& boundaries, CountT* count,
                          double* mean, double* sum_of_squared_deviation,
                          double* min, double* max,
-                         absl::Span<T> histogram_buckets) const;
+                         absl::Span<BucketCountT> histogram_buckets) const;
+
+  // Merges this into 'sketch'. Requires that this was constructed with
+  // 'keep_sketch'.
+  void AddToQuantileSketch(QuantileSketch* sketch) const;
 
  private:
+  // Merges the statistics of this, other than the histogram, into those
+  // pointed to.
+  template <typename CountT>
+  void AddStats(CountT* count, double* mean, double* sum_of_squared_deviation,
+                double* min, double* max) const;
+
+  // Returns the histogram for 'boundaries', or nullptr if they were not passed
+  // on construction.
+  const Distribution* HistogramFor(const BucketBoundaries& boundaries) const;
+
   const absl::Span<const BucketBoundaries> boundaries_;
 
   double last_value_ = std::numeric_limits<double>::quiet_NaN();
@@ -61,13 +79,15 @@ class MeasureData final {
   double sum_of_squared_deviation_ = 0;
   double min_ = std::numeric_limits<double>::infinity();
   double max_ = -std::numeric_limits<double>::infinity();
-  std::vector<std::vector<int64_t>> histograms_;
+  // A histogram for each of boundaries_, which auto-ranges along with
+  // them. Only the bucket counts are kept.
+  std::vector<Distribution> histograms_;
+  absl::optional<QuantileSketch> sketch_;
 };
 
-extern template void MeasureData::AddToDistribution(const BucketBoundaries&,
-                                                    double*, double*, double*,
-                                                    double*, double*,
-                                                    absl::Span<double>) const;
+extern template void MeasureData::AddToDistribution(
+    const BucketBoundaries&, uint64_t*, double*, double*, double*, double*,
+    absl::Span<uint32_t>) const;
 
 }  // namespace stats
 }  // namespace opencensus
@@ -122,6 +122,47 @@ TEST(MeasureDataTest, BatchedAddToDistribution) {
   }
 }
 
+TEST(MeasureDataTest, AutoRangingAddToDistribution) {
+  BucketBoundaries buckets = BucketBoundaries::AutoLogLinear(2);
+  MeasureData data(absl::MakeSpan(&buckets, 1));
+  Distribution distribution = testing::TestUtils::MakeDistribution(&buckets);
+  // The distribution and the batch cover different, overlapping ranges.
+  testing::TestUtils::AddToDistribution(&distribution, 0.3);
+  testing::TestUtils::AddToDistribution(&distribution, 5);
+  Distribution expected_distribution = distribution;
+  for (const double value : {-1.0, 3.0, 40.0, 7.0}) {
+    data.Add(value);
+    testing::TestUtils::AddToDistribution(&expected_distribution, value);
+  }
+
+  data.AddToDistribution(&distribution);
+  EXPECT_EQ(expected_distribution.bucket_boundaries(),
+            distribution.bucket_boundaries());
+  EXPECT_EQ(BucketBoundaries::LogLinear(-2, 6, 2),
+            distribution.bucket_boundaries());
+  EXPECT_THAT(
+      distribution.bucket_counts(),
+      ::testing::ElementsAreArray(expected_distribution.bucket_counts()));
+}
+
+TEST(MeasureDataTest, AutoRangingAddToDistributionMaxSpan) {
+  BucketBoundaries buckets = BucketBoundaries::AutoLogLinear(0, 2);
+  MeasureData data(absl::MakeSpan(&buckets, 1));
+  Distribution distribution = testing::TestUtils::MakeDistribution(&buckets);
+  testing::TestUtils::AddToDistribution(&distribution, 1);
+  // The batch covers [2, 8), and counts 40 as overflow.
+  data.Add(3);
+  data.Add(5);
+  data.Add(40);
+
+  // The combined range can only extend to [1, 4), so the bucket for 5 also
+  // counts as overflow.
+  data.AddToDistribution(&distribution);
+  EXPECT_EQ(BucketBoundaries::LogLinear(0, 2, 0),
+            distribution.bucket_boundaries());
+  EXPECT_THAT(distribution.bucket_counts(), ::testing::ElementsAre(0, 1, 1, 2));
+}
+
 TEST(MeasureDataDeathTest, AddToDistributionWithUnknownBuckets) {
   BucketBoundaries buckets = BucketBoundaries::Explicit({0, 10});
   MeasureData data(absl::MakeSpan(&buckets, 1));
@@ -0,0 +1,82 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "opencensus/stats/measure.h"
+#include "opencensus/stats/measure_descriptor.h"
+#include "opencensus/stats/measure_registry.h"
+
+namespace opencensus {
+namespace stats {
+namespace {
+
+// Generates unique measure names. Since the registry does not support
+// unregistering, all measure names must be different across benchmarks.
+std::string MakeUniqueName() {
+  static int counter;
+  return absl::StrCat("name", counter++);
+}
+
+MeasureDouble TestMeasure() {
+  static const MeasureDouble measure =
+      MeasureDouble::Register("benchmark_measure", "", "");
+  return measure;
+}
+
+void BM_GetDescriptor(benchmark::State& state) {
+  const MeasureDouble measure = TestMeasure();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(measure.GetDescriptor());
+  }
+}
+BENCHMARK(BM_GetDescriptor)->ThreadRange(1, 16);
+
+void BM_GetDescriptorByName(benchmark::State& state) {
+  TestMeasure();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        MeasureRegistry::GetDescriptorByName("benchmark_measure"));
+  }
+}
+BENCHMARK(BM_GetDescriptorByName)->ThreadRange(1, 16);
+
+// Looks descriptors up while a background thread registers new measures.
+void BM_GetDescriptorDuringRegistration(benchmark::State& state) {
+  const MeasureDouble measure = TestMeasure();
+  std::atomic<bool> done(false);
+  std::thread registerer([&done]() {
+    while (!done.load(std::memory_order_relaxed)) {
+      MeasureInt64::Register(MakeUniqueName(), "", "");
+    }
+  });
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(measure.GetDescriptor());
+    benchmark::DoNotOptimize(
+        MeasureRegistry::GetDescriptorByName("benchmark_measure"));
+  }
+  done = true;
+  registerer.join();
+}
+BENCHMARK(BM_GetDescriptorDuringRegistration);
+
+}  // namespace
+}  // namespace stats
+}  // namespace opencensus
+
+BENCHMARK_MAIN();
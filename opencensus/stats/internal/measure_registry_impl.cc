@@ -14,9 +14,14 @@
 
 #include "opencensus/stats/internal/measure_registry_impl.h"
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <memory>
 
-#include "absl/memory/memory.h"
+#include "absl/hash/hash.h"
+#include "absl/strings/string_view.h"
 #include "opencensus/stats/internal/delta_producer.h"
 #include "opencensus/stats/internal/stats_manager.h"
 #include "opencensus/stats/measure_descriptor.h"
@@ -34,8 +39,31 @@ constexpr uint64_t kTypeMask = 0x4000000000000000ull;
 constexpr uint64_t kDoubleType = 0x0000000000000000ull;
 constexpr uint64_t kIntType = 0x4000000000000000ull;
 
+constexpr uint64_t kInitialNameTableCapacity = 64;
+
 }  // namespace
 
+// An open-addressed, linearly probed hash table of measure ids, hashed by
+// name. Readers probe it without locking. The registering thread fills empty
+// slots in place; once the table is half full it publishes a copy with twice
+// the capacity instead. Superseded tables stay reachable through 'previous'
+// because readers may still be probing them; together they take less memory
+// than the current table.
+struct MeasureRegistryImpl::NameTable {
+  explicit NameTable(uint64_t capacity)
+      : mask(capacity - 1), slots(new std::atomic<uint64_t>[capacity]()) {}
+
+  const uint64_t mask;
+  // Measure ids, or 0 for an empty slot. Valid ids are never 0.
+  const std::unique_ptr<std::atomic<uint64_t>[]> slots;
+  // The number of occupied slots. Only accessed under the registry's mu_.
+  uint64_t size = 0;
+  std::unique_ptr<NameTable> previous;
+};
+
+MeasureRegistryImpl::MeasureRegistryImpl()
+    : name_table_(new NameTable(kInitialNameTableCapacity)) {}
+
 // static
 MeasureRegistryImpl* MeasureRegistryImpl::Get() {
   static MeasureRegistryImpl* global_measure_registry_impl =
@@ -75,65 +103,84 @@ uint64_t MeasureRegistryImpl::RegisterImpl(MeasureDescriptor descriptor) {
     std::cerr << "Attempt to register measure with empty name\n";
     return CreateMeasureId(0, false, descriptor.type());
   }
-  const auto it = id_map_.find(descriptor.name());
-  if (it != id_map_.end()) {
+  if (IdValid(FindId(descriptor.name()))) {
     std::cerr << "Attempt to register measure with already-registered name: "
               << descriptor.DebugString() << "\n";
     return CreateMeasureId(0, false, descriptor.type());
   }
-  const uint64_t id =
-      CreateMeasureId(registered_descriptors_.size(), true, descriptor.type());
-  id_map_.emplace_hint(it, descriptor.name(), id);
-  registered_descriptors_.push_back(
-      absl::make_unique<MeasureDescriptor>(std::move(descriptor)));
+  const MeasureDescriptor::Type type = descriptor.type();
+  const uint64_t index =
+      descriptors_.Append(new MeasureDescriptor(std::move(descriptor)));
+  const uint64_t id = CreateMeasureId(index, true, type);
+  InsertId(id);
   return id;
 }
 
+uint64_t MeasureRegistryImpl::FindId(absl::string_view name) const {
+  const NameTable* table = name_table_.load(std::memory_order_acquire);
+  for (uint64_t i = absl::Hash<absl::string_view>()(name) & table->mask;;
+       i = (i + 1) & table->mask) {
+    const uint64_t id = table->slots[i].load(std::memory_order_acquire);
+    if (id == 0) {
+      return CreateMeasureId(0, false, MeasureDescriptor::Type::kDouble);
+    }
+    if (descriptors_[IdToIndex(id)]->name() == name) {
+      return id;
+    }
+  }
+}
+
+void MeasureRegistryImpl::InsertId(uint64_t id) {
+  auto insert = [this](NameTable* table, uint64_t id) {
+    const absl::string_view name = descriptors_[IdToIndex(id)]->name();
+    uint64_t i = absl::Hash<absl::string_view>()(name) & table->mask;
+    while (table->slots[i].load(std::memory_order_relaxed) != 0) {
+      i = (i + 1) & table->mask;
+    }
+    table->slots[i].store(id, std::memory_order_release);
+    ++table->size;
+  };
+
+  NameTable* table = name_table_.load(std::memory_order_relaxed);
+  if (2 * (table->size + 1) > table->mask + 1) {
+    NameTable* grown = new NameTable(2 * (table->mask + 1));
+    for (uint64_t i = 0; i <= table->mask; ++i) {
+      const uint64_t old_id = table->slots[i].load(std::memory_order_relaxed);
+      if (old_id != 0) {
+        insert(grown, old_id);
+      }
+    }
+    grown->previous.reset(table);
+    name_table_.store(grown, std::memory_order_release);
+    table = grown;
+  }
+  insert(table, id);
+}
+
 const MeasureDescriptor& MeasureRegistryImpl::GetDescriptorByName(
     absl::string_view name) const {
-  absl::ReaderMutexLock l(&mu_);
-  const auto it = id_map_.find(std::string(name));
-  if (it == id_map_.end()) {
+  const uint64_t id = FindId(name);
+  if (!IdValid(id)) {
     static const MeasureDescriptor default_descriptor =
         MeasureDescriptor("", "", "", MeasureDescriptor::Type::kDouble);
     return default_descriptor;
   } else {
-    return *registered_descriptors_[IdToIndex(it->second)];
+    return *descriptors_[IdToIndex(id)];
   }
 }
 
 MeasureDouble MeasureRegistryImpl::GetMeasureDoubleByName(
     absl::string_view name) const {
-  absl::ReaderMutexLock l(&mu_);
-  const auto it = id_map_.find(std::string(name));
-  if (it == id_map_.end()) {
-    return MeasureDouble(
-        CreateMeasureId(0, false, MeasureDescriptor::Type::kDouble));
-  } else {
-    return MeasureDouble(it->second);
-  }
+  return MeasureDouble(FindId(name));
 }
 
 MeasureInt64 MeasureRegistryImpl::GetMeasureInt64ByName(
     absl::string_view name) const {
-  absl::ReaderMutexLock l(&mu_);
-  const auto it = id_map_.find(std::string(name));
-  if (it == id_map_.end()) {
-    return MeasureInt64(
-        CreateMeasureId(0, false, MeasureDescriptor::Type::kDouble));
-  } else {
-    return MeasureInt64(it->second);
-  }
+  return MeasureInt64(FindId(name));
 }
 
 uint64_t MeasureRegistryImpl::GetIdByName(absl::string_view name) const {
-  absl::ReaderMutexLock l(&mu_);
-  const auto it = id_map_.find(std::string(name));
-  if (it == id_map_.end()) {
-    return CreateMeasureId(0, false, MeasureDescriptor::Type::kDouble);
-  } else {
-    return it->second;
-  }
+  return FindId(name);
 }
 
 // static
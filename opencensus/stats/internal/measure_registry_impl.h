@@ -15,14 +15,13 @@
 #ifndef OPENCENSUS_STATS_INTERNAL_MEASURE_REGISTRY_IMPL_H_
 #define OPENCENSUS_STATS_INTERNAL_MEASURE_REGISTRY_IMPL_H_
 
+#include <atomic>
 #include <cstdint>
-#include <memory>
-#include <string>
-#include <unordered_map>
-#include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "opencensus/common/internal/append_only_table.h"
 #include "opencensus/stats/measure.h"
 #include "opencensus/stats/measure_descriptor.h"
 
@@ -41,21 +40,17 @@ class MeasureRegistryImpl {
                              absl::string_view description,
                              absl::string_view units) ABSL_LOCKS_EXCLUDED(mu_);
 
-  const MeasureDescriptor& GetDescriptorByName(absl::string_view name) const
-      ABSL_LOCKS_EXCLUDED(mu_);
+  const MeasureDescriptor& GetDescriptorByName(absl::string_view name) const;
 
-  MeasureDouble GetMeasureDoubleByName(absl::string_view name) const
-      ABSL_LOCKS_EXCLUDED(mu_);
-  MeasureInt64 GetMeasureInt64ByName(absl::string_view name) const
-      ABSL_LOCKS_EXCLUDED(mu_);
+  MeasureDouble GetMeasureDoubleByName(absl::string_view name) const;
+  MeasureInt64 GetMeasureInt64ByName(absl::string_view name) const;
 
   // The following methods are for internal use by the library, and not exposed
   // in the public MeasureRegistry.
-  uint64_t GetIdByName(absl::string_view name) const ABSL_LOCKS_EXCLUDED(mu_);
+  uint64_t GetIdByName(absl::string_view name) const;
 
   template <typename MeasureT>
-  const MeasureDescriptor& GetDescriptor(Measure<MeasureT> measure) const
-      ABSL_LOCKS_EXCLUDED(mu_);
+  const MeasureDescriptor& GetDescriptor(Measure<MeasureT> measure) const;
 
   // Measure ids contain a sequential index, a validity bit, and a
   // type bit; these functions access the individual parts.
@@ -67,22 +62,28 @@ class MeasureRegistryImpl {
   static uint64_t MeasureToIndex(Measure<MeasureT> measure);
 
  private:
-  MeasureRegistryImpl() = default;
+  // A hash index from measure names to ids; see measure_registry_impl.cc.
+  struct NameTable;
+
+  MeasureRegistryImpl();
 
   uint64_t RegisterImpl(MeasureDescriptor descriptor) ABSL_LOCKS_EXCLUDED(mu_);
 
+  // Returns the id of the measure registered as 'name', or an invalid id.
+  uint64_t FindId(absl::string_view name) const;
+  void InsertId(uint64_t id) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   static uint64_t CreateMeasureId(uint64_t index, bool is_valid,
                                   MeasureDescriptor::Type type);
 
-  mutable absl::Mutex mu_;
-  // The registered MeasureDescriptors. Measure ids are indexes into this
-  // vector plus some flags in the high bits. Heap allocated so that the
-  // descriptors themselves don't move around when the vector storage moves due
-  // to resize.
-  std::vector<std::unique_ptr<MeasureDescriptor>> registered_descriptors_
-      ABSL_GUARDED_BY(mu_);
-  // A map from measure names to IDs.
-  std::unordered_map<std::string, uint64_t> id_map_ ABSL_GUARDED_BY(mu_);
+  // Serializes registration.
+  absl::Mutex mu_;
+  // The registered MeasureDescriptors. Measure ids are indexes into this table
+  // plus some flags in the high bits. Descriptors never move and are never
+  // freed, so readers need no lock.
+  common::AppendOnlyTable<const MeasureDescriptor> descriptors_;
+  // The current name index. Written under mu_, read without locking.
+  std::atomic<NameTable*> name_table_;
 };
 
 template <>
@@ -98,13 +99,12 @@ MeasureInt64 MeasureRegistryImpl::Register(absl::string_view name,
 template <typename MeasureT>
 const MeasureDescriptor& MeasureRegistryImpl::GetDescriptor(
     Measure<MeasureT> measure) const {
-  absl::ReaderMutexLock l(&mu_);
   if (!measure.IsValid()) {
     static const MeasureDescriptor default_descriptor =
         MeasureDescriptor("", "", "", MeasureDescriptor::Type::kDouble);
     return default_descriptor;
   }
-  return *registered_descriptors_[IdToIndex(measure.id_)];
+  return *descriptors_[IdToIndex(measure.id_)];
 }
 
 // static
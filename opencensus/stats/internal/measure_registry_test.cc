@@ -14,6 +14,11 @@
 
 #include "opencensus/stats/measure_registry.h"
 
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "absl/strings/str_cat.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -161,6 +166,33 @@ TEST(MeasureRegistryTest, GrowDescriptorVector) {
   }
 }
 
+TEST(MeasureRegistryTest, LookupsDuringRegistration) {
+  const std::string name = MakeUniqueName();
+  MeasureDouble measure = MeasureDouble::Register(name, "desc", "units");
+  ASSERT_TRUE(measure.IsValid());
+  std::vector<std::string> names;
+  for (int i = 0; i < 2000; ++i) {
+    names.push_back(MakeUniqueName());
+  }
+
+  std::atomic<bool> done(false);
+  std::thread reader([&]() {
+    while (!done.load()) {
+      ASSERT_EQ(measure, MeasureRegistry::GetMeasureDoubleByName(name));
+      ASSERT_EQ("units", measure.GetDescriptor().units());
+    }
+  });
+  for (const auto& new_name : names) {
+    ASSERT_TRUE(MeasureInt64::Register(new_name, "", "").IsValid());
+  }
+  done = true;
+  reader.join();
+
+  for (const auto& new_name : names) {
+    EXPECT_EQ(new_name, MeasureRegistry::GetDescriptorByName(new_name).name());
+  }
+}
+
 }  // namespace
 }  // namespace stats
 }  // namespace opencensus
@@ -0,0 +1,197 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/stats/quantile_sketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+
+namespace opencensus {
+namespace stats {
+
+namespace {
+
+// Values of smaller magnitude are counted as zero.
+constexpr double kMinMagnitude = 1e-9;
+
+const double kGamma = (1 + QuantileSketch::kRelativeAccuracy) /
+                      (1 - QuantileSketch::kRelativeAccuracy);
+const double kInverseLogGamma = 1 / std::log(kGamma);
+
+}  // namespace
+
+constexpr double QuantileSketch::kRelativeAccuracy;
+constexpr int QuantileSketch::kMaxBuckets;
+
+// static
+double QuantileSketch::growth_factor() { return kGamma; }
+
+double QuantileSketch::Quantile(double q) const {
+  if (count_ == 0) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  // The extremes are known exactly.
+  if (q <= 0) {
+    return min_;
+  }
+  if (q >= 1) {
+    return max_;
+  }
+  const double rank = q * (count_ - 1);
+  const auto clamp = [this](double value) {
+    return std::min(std::max(value, min_), max_);
+  };
+  uint64_t seen = 0;
+  // Negative buckets go from the largest magnitude, i.e. the lowest value.
+  const auto negative = negative_.counts();
+  for (int i = negative.size() - 1; i >= 0; --i) {
+    seen += negative[i];
+    if (seen > rank) {
+      return clamp(-MagnitudeForIndex(negative_.offset() + i));
+    }
+  }
+  seen += zero_count_;
+  if (seen > rank) {
+    return clamp(0);
+  }
+  const auto positive = positive_.counts();
+  for (int i = 0; i < positive.size(); ++i) {
+    seen += positive[i];
+    if (seen > rank) {
+      return clamp(MagnitudeForIndex(positive_.offset() + i));
+    }
+  }
+  return max_;
+}
+
+std::string QuantileSketch::DebugString() const {
+  return absl::StrCat("count: ", count_, " sum: ", sum_, " min: ", min_,
+                      " max: ", max_, " p50: ", Quantile(0.5),
+                      " p90: ", Quantile(0.9), " p99: ", Quantile(0.99));
+}
+
+void QuantileSketch::Add(double value) {
+  ++count_;
+  sum_ += value;
+  min_ = std::min(value, min_);
+  max_ = std::max(value, max_);
+
+  const double magnitude = std::abs(value);
+  // This also catches NaN.
+  if (!(magnitude >= kMinMagnitude)) {
+    ++zero_count_;
+    return;
+  }
+  Store& store = value > 0 ? positive_ : negative_;
+  if (std::isinf(magnitude)) {
+    // Count infinities with the largest values seen rather than in a bucket of
+    // their own, which would collapse every finite bucket.
+    store.Add(store.begin == store.end ? 0 : store.base + store.end - 1, 1);
+    return;
+  }
+  store.Add(IndexForMagnitude(magnitude), 1);
+}
+
+void QuantileSketch::Merge(const QuantileSketch& other) {
+  MergePortion(other, 1);
+}
+
+void QuantileSketch::MergePortion(const QuantileSketch& other,
+                                  double portion) {
+  const auto scale = [portion](uint64_t n) {
+    return static_cast<uint64_t>(n * portion);
+  };
+  uint64_t merged = scale(other.zero_count_);
+  zero_count_ += merged;
+  for (const auto& stores :
+       {std::make_pair(&positive_, &other.positive_),
+        std::make_pair(&negative_, &other.negative_)}) {
+    const Store& from = *stores.second;
+    const auto counts = from.counts();
+    for (int i = 0; i < counts.size(); ++i) {
+      const uint64_t n = scale(counts[i]);
+      if (n != 0) {
+        stores.first->Add(from.offset() + i, n);
+        merged += n;
+      }
+    }
+  }
+  if (merged == 0) {
+    return;
+  }
+  count_ += merged;
+  sum_ += other.sum_ * portion;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+}
+
+void QuantileSketch::Store::Add(int32_t index, uint64_t n) {
+  if (begin == end) {
+    Resize(index, index);
+  } else if (index < offset()) {
+    // Below a full range of buckets, values go to the lowest one.
+    index = std::max(index, base + end - kMaxBuckets);
+    Resize(index, base + end - 1);
+  } else if (index >= base + end) {
+    // Collapse the lowest buckets beyond kMaxBuckets into the lowest one that
+    // remains.
+    const int32_t low = std::max(offset(), index + 1 - kMaxBuckets);
+    uint64_t collapsed = 0;
+    for (int32_t i = begin; i < std::min(low - base, end); ++i) {
+      collapsed += buckets[i];
+      buckets[i] = 0;
+    }
+    Resize(low, index);
+    buckets[low - base] += collapsed;
+  }
+  buckets[index - base] += n;
+}
+
+void QuantileSketch::Store::Resize(int32_t low, int32_t high) {
+  if (low < base || high >= base + static_cast<int32_t>(buckets.size())) {
+    const int32_t size = high - low + 1;
+    std::vector<uint64_t> grown(2 * size);
+    const int32_t grown_base = low - size / 2;
+    const int32_t kept_end = std::min(high + 1, base + end);
+    for (int32_t i = std::max(low, offset()); i < kept_end; ++i) {
+      grown[i - grown_base] = buckets[i - base];
+    }
+    buckets.swap(grown);
+    base = grown_base;
+  }
+  begin = low - base;
+  end = high - base + 1;
+}
+
+// static
+int32_t QuantileSketch::IndexForMagnitude(double magnitude) {
+  return static_cast<int32_t>(
+      std::ceil(std::log(magnitude) * kInverseLogGamma));
+}
+
+// static
+double QuantileSketch::MagnitudeForIndex(int32_t index) {
+  // The point with the same relative distance from both bucket bounds.
+  return 2 * std::pow(kGamma, index) / (kGamma + 1);
+}
+
+}  // namespace stats
+}  // namespace opencensus
@@ -0,0 +1,166 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/stats/quantile_sketch.h"
+
+#include <cmath>
+#include <limits>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "opencensus/stats/testing/test_utils.h"
+
+namespace opencensus {
+namespace stats {
+namespace {
+
+using testing::TestUtils;
+
+// Expects 'actual' to be within the sketch's relative accuracy of 'expected'.
+void ExpectNear(double expected, double actual) {
+  EXPECT_NEAR(expected, actual,
+              std::abs(expected) * QuantileSketch::kRelativeAccuracy)
+      << "expected " << expected;
+}
+
+TEST(QuantileSketchTest, Empty) {
+  const QuantileSketch sketch = TestUtils::MakeQuantileSketch();
+  EXPECT_EQ(0, sketch.count());
+  EXPECT_EQ(0, sketch.sum());
+  EXPECT_TRUE(std::isnan(sketch.Quantile(0.5)));
+  EXPECT_TRUE(sketch.positive_bucket_counts().empty());
+}
+
+TEST(QuantileSketchTest, Stats) {
+  QuantileSketch sketch = TestUtils::MakeQuantileSketch();
+  TestUtils::AddToQuantileSketch(&sketch, 3);
+  TestUtils::AddToQuantileSketch(&sketch, -2);
+  TestUtils::AddToQuantileSketch(&sketch, 0);
+  EXPECT_EQ(3, sketch.count());
+  EXPECT_DOUBLE_EQ(1, sketch.sum());
+  EXPECT_EQ(-2, sketch.min());
+  EXPECT_EQ(3, sketch.max());
+  EXPECT_EQ(1, sketch.zero_count());
+  EXPECT_THAT(sketch.negative_bucket_counts(), ::testing::ElementsAre(1));
+  EXPECT_THAT(sketch.positive_bucket_counts(), ::testing::ElementsAre(1));
+  // The extremes are exact.
+  EXPECT_EQ(-2, sketch.Quantile(0));
+  EXPECT_EQ(0, sketch.Quantile(0.5));
+  EXPECT_EQ(3, sketch.Quantile(1));
+}
+
+TEST(QuantileSketchTest, RelativeAccuracy) {
+  QuantileSketch sketch = TestUtils::MakeQuantileSketch();
+  for (int i = 1; i <= 10000; ++i) {
+    TestUtils::AddToQuantileSketch(&sketch, i);
+  }
+  // Values span 4 orders of magnitude, at a ~2% bucket width.
+  EXPECT_LT(sketch.positive_bucket_counts().size(), 500);
+  for (const double q : {0.01, 0.25, 0.5, 0.9, 0.99, 0.999}) {
+    ExpectNear(1 + q * 9999, sketch.Quantile(q));
+  }
+}
+
+TEST(QuantileSketchTest, NegativeValues) {
+  QuantileSketch sketch = TestUtils::MakeQuantileSketch();
+  for (int i = -1000; i <= 1000; ++i) {
+    TestUtils::AddToQuantileSketch(&sketch, i);
+  }
+  EXPECT_EQ(1, sketch.zero_count());
+  ExpectNear(-990, sketch.Quantile(0.005));
+  ExpectNear(-500, sketch.Quantile(0.25));
+  EXPECT_EQ(0, sketch.Quantile(0.5));
+  ExpectNear(500, sketch.Quantile(0.75));
+}
+
+TEST(QuantileSketchTest, Merge) {
+  QuantileSketch low = TestUtils::MakeQuantileSketch();
+  QuantileSketch high = TestUtils::MakeQuantileSketch();
+  QuantileSketch all = TestUtils::MakeQuantileSketch();
+  for (int i = 1; i <= 1000; ++i) {
+    TestUtils::AddToQuantileSketch(i <= 500 ? &low : &high, i * 0.5);
+    TestUtils::AddToQuantileSketch(&all, i * 0.5);
+  }
+  TestUtils::MergeQuantileSketch(&low, high);
+  // Merging is exact.
+  EXPECT_EQ(all.count(), low.count());
+  EXPECT_DOUBLE_EQ(all.sum(), low.sum());
+  EXPECT_EQ(all.min(), low.min());
+  EXPECT_EQ(all.max(), low.max());
+  EXPECT_EQ(all.positive_offset(), low.positive_offset());
+  EXPECT_EQ(all.positive_bucket_counts(), low.positive_bucket_counts());
+}
+
+TEST(QuantileSketchTest, CollapsesLowestBuckets) {
+  QuantileSketch sketch = TestUtils::MakeQuantileSketch();
+  // Values spanning far more than kMaxBuckets buckets.
+  for (int exponent = -6; exponent < 30; ++exponent) {
+    TestUtils::AddToQuantileSketch(&sketch, std::pow(10.0, exponent));
+  }
+  EXPECT_EQ(QuantileSketch::kMaxBuckets,
+            sketch.positive_bucket_counts().size());
+  EXPECT_EQ(36, sketch.count());
+  // The largest values keep their accuracy.
+  ExpectNear(1e28, sketch.Quantile(34.0 / 35));
+  ExpectNear(1e25, sketch.Quantile(31.0 / 35));
+}
+
+TEST(QuantileSketchTest, GrowsDownward) {
+  QuantileSketch increasing = TestUtils::MakeQuantileSketch();
+  QuantileSketch decreasing = TestUtils::MakeQuantileSketch();
+  // Each value below the last extends the range of buckets downward.
+  for (int exponent = -6; exponent < 30; ++exponent) {
+    TestUtils::AddToQuantileSketch(&increasing, std::pow(10.0, exponent));
+    TestUtils::AddToQuantileSketch(&decreasing, std::pow(10.0, 23 - exponent));
+  }
+  EXPECT_EQ(increasing.count(), decreasing.count());
+  // Past kMaxBuckets, lower values join the lowest bucket instead.
+  EXPECT_EQ(QuantileSketch::kMaxBuckets,
+            decreasing.positive_bucket_counts().size());
+  EXPECT_EQ(increasing.positive_offset(), decreasing.positive_offset());
+  EXPECT_EQ(increasing.positive_bucket_counts(),
+            decreasing.positive_bucket_counts());
+}
+
+TEST(QuantileSketchTest, NaN) {
+  QuantileSketch sketch = TestUtils::MakeQuantileSketch();
+  TestUtils::AddToQuantileSketch(&sketch, 1);
+  TestUtils::AddToQuantileSketch(&sketch,
+                                 std::numeric_limits<double>::quiet_NaN());
+  EXPECT_EQ(2, sketch.count());
+  EXPECT_EQ(1, sketch.zero_count());
+  EXPECT_TRUE(std::isnan(sketch.sum()));
+}
+
+TEST(QuantileSketchTest, Infinity) {
+  QuantileSketch sketch = TestUtils::MakeQuantileSketch();
+  TestUtils::AddToQuantileSketch(&sketch, 1);
+  TestUtils::AddToQuantileSketch(&sketch,
+                                 std::numeric_limits<double>::infinity());
+  TestUtils::AddToQuantileSketch(&sketch,
+                                 -std::numeric_limits<double>::infinity());
+  EXPECT_EQ(3, sketch.count());
+  EXPECT_EQ(0, sketch.zero_count());
+  EXPECT_EQ(-std::numeric_limits<double>::infinity(), sketch.min());
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), sketch.max());
+  EXPECT_EQ(-std::numeric_limits<double>::infinity(), sketch.Quantile(0));
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), sketch.Quantile(1));
+  // Infinities do not collapse the finite buckets.
+  ExpectNear(1, sketch.Quantile(0.5));
+  EXPECT_THAT(sketch.positive_bucket_counts(), ::testing::ElementsAre(2));
+}
+
+}  // namespace
+}  // namespace stats
+}  // namespace opencensus
@@ -0,0 +1,29 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/stats/row_limits.h"
+
+#include <cstdint>
+
+#include "opencensus/stats/internal/stats_manager.h"
+
+namespace opencensus {
+namespace stats {
+
+void SetMaxTotalViewRows(int64_t max_rows) {
+  StatsManager::Get()->SetMaxTotalRows(max_rows);
+}
+
+}  // namespace stats
+}  // namespace opencensus
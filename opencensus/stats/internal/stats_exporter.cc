@@ -23,6 +23,7 @@
 #include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "absl/types/optional.h"
 #include "opencensus/stats/internal/aggregation_window.h"
 #include "opencensus/stats/view_data.h"
 #include "opencensus/stats/view_descriptor.h"
@@ -49,7 +50,9 @@ absl::Time StatsExporterImpl::GetNextExportTime() const {
 
 void StatsExporterImpl::AddView(const ViewDescriptor& view) {
   absl::MutexLock l(&mu_);
-  views_[view.name()] = absl::make_unique<opencensus::stats::View>(view);
+  ExportedView& exported_view = views_[view.name()];
+  exported_view.view = absl::make_unique<opencensus::stats::View>(view);
+  exported_view.changed_rows_generation = 0;
 }
 
 void StatsExporterImpl::RemoveView(absl::string_view name) {
@@ -59,7 +62,14 @@ void StatsExporterImpl::RemoveView(absl::string_view name) {
 
 void StatsExporterImpl::RegisterPushHandler(
     std::unique_ptr<StatsExporter::Handler> handler) {
+  absl::MutexLock export_lock(&export_mu_);
   absl::MutexLock l(&mu_);
+  if (handler->ExportChangedRowsOnly()) {
+    // The new handler hasn't seen any rows yet.
+    for (auto& view : views_) {
+      view.second.changed_rows_generation = 0;
+    }
+  }
   handlers_.push_back(std::move(handler));
   if (!thread_started_) {
     StartExportThread();
@@ -72,20 +82,63 @@ StatsExporterImpl::GetViewData() {
   std::vector<std::pair<ViewDescriptor, ViewData>> data;
   data.reserve(views_.size());
   for (const auto& view : views_) {
-    data.emplace_back(view.second->descriptor(), view.second->GetData());
+    data.emplace_back(view.second.view->descriptor(),
+                      view.second.view->GetData());
   }
   return data;
 }
 
 void StatsExporterImpl::Export() {
+  absl::MutexLock export_lock(&export_mu_);
   absl::ReaderMutexLock l(&mu_);
+  bool export_all_rows = false;
+  bool export_changed_rows = false;
+  bool export_all_changed_rows = false;
+  for (const auto& handler : handlers_) {
+    if (handler->ExportChangedRowsOnly()) {
+      export_changed_rows = true;
+      // Asks every handler, since they may reset their state when asked.
+      if (handler->NeedsAllRows()) {
+        export_all_changed_rows = true;
+      }
+    } else {
+      export_all_rows = true;
+    }
+  }
   std::vector<std::pair<ViewDescriptor, ViewData>> data;
-  data.reserve(views_.size());
-  for (const auto& view : views_) {
-    data.emplace_back(view.second->descriptor(), view.second->GetData());
+  std::vector<std::pair<ViewDescriptor, ViewData>> changed_data;
+  if (export_all_rows) {
+    data.reserve(views_.size());
+  }
+  for (auto& entry : views_) {
+    ExportedView& view = entry.second;
+    const ViewDescriptor& descriptor = view.view->descriptor();
+    if (export_all_rows) {
+      data.emplace_back(descriptor, view.view->GetData());
+    }
+    if (!export_changed_rows) {
+      continue;
+    }
+    if (export_all_changed_rows) {
+      view.changed_rows_generation = 0;
+    }
+    const absl::optional<ViewData> changed =
+        view.view->GetChangedData(&view.changed_rows_generation);
+    if (!changed.has_value()) {
+      // Only cumulative views track changes. Reuse the full data, which for
+      // delta views must only be taken once.
+      if (export_all_rows) {
+        changed_data.emplace_back(descriptor, data.back().second);
+      } else {
+        changed_data.emplace_back(descriptor, view.view->GetData());
+      }
+    } else if (!changed->start_times().empty()) {
+      changed_data.emplace_back(descriptor, *changed);
+    }
   }
   for (auto& handler : handlers_) {
-    handler->ExportViewData(data);
+    handler->ExportViewData(handler->ExportChangedRowsOnly() ? changed_data
+                                                             : data);
   }
 }
 
@@ -15,6 +15,7 @@
 #ifndef OPENCENSUS_STATS_INTERNAL_STATS_EXPORTER_IMPL_H_
 #define OPENCENSUS_STATS_INTERNAL_STATS_EXPORTER_IMPL_H_
 
+#include <cstdint>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -52,15 +53,25 @@ class StatsExporterImpl {
 
   void StartExportThread() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // A view registered for export.
+  struct ExportedView {
+    std::unique_ptr<View> view;
+    // The generation of the rows last passed to handlers that export changed
+    // rows only (see View::GetChangedData()); 0 to pass every row.
+    uint64_t changed_rows_generation = 0;
+  };
+
   // Loops forever, calling Export() every export_interval_.
   void RunWorkerLoop();
 
+  // Serializes exports, which update ExportedView::changed_rows_generation
+  // while holding a reader lock on mu_.
+  absl::Mutex export_mu_ ABSL_ACQUIRED_BEFORE(mu_);
   mutable absl::Mutex mu_;
   absl::Duration export_interval_ ABSL_GUARDED_BY(mu_) = absl::Seconds(10);
   std::vector<std::unique_ptr<StatsExporter::Handler>> handlers_
       ABSL_GUARDED_BY(mu_);
-  std::unordered_map<std::string, std::unique_ptr<View>> views_
-      ABSL_GUARDED_BY(mu_);
+  std::unordered_map<std::string, ExportedView> views_ ABSL_GUARDED_BY(mu_);
   bool thread_started_ ABSL_GUARDED_BY(mu_) = false;
   std::thread t_ ABSL_GUARDED_BY(mu_);
 };
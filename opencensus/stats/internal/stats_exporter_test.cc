@@ -14,6 +14,7 @@
 
 #include "opencensus/stats/stats_exporter.h"
 
+#include <atomic>
 #include <cstdint>
 #include <utility>
 #include <vector>
@@ -26,7 +27,10 @@
 #include "opencensus/stats/internal/set_aggregation_window.h"
 #include "opencensus/stats/measure.h"
 #include "opencensus/stats/measure_descriptor.h"
+#include "opencensus/stats/recording.h"
+#include "opencensus/stats/testing/test_utils.h"
 #include "opencensus/stats/view_descriptor.h"
+#include "opencensus/tags/tag_key.h"
 
 namespace opencensus {
 namespace stats {
@@ -37,6 +41,11 @@ struct ExportedData {
     return data;
   }
 
+  void Clear() {
+    absl::MutexLock l(&mu);
+    data.clear();
+  }
+
   mutable absl::Mutex mu;
   std::vector<std::pair<ViewDescriptor, ViewData>> data ABSL_GUARDED_BY(mu);
 };
@@ -65,6 +74,29 @@ class MockExporter : public StatsExporter::Handler {
   ExportedData* output_;
 };
 
+// A mock exporter that only asks for changed rows, and asks for every row in
+// the next export while '*needs_all_rows' is set.
+class ChangedRowsExporter : public MockExporter {
+ public:
+  static void Register(ExportedData* output,
+                       std::atomic<bool>* needs_all_rows = nullptr) {
+    opencensus::stats::StatsExporter::RegisterPushHandler(
+        absl::make_unique<ChangedRowsExporter>(output, needs_all_rows));
+  }
+
+  ChangedRowsExporter(ExportedData* output, std::atomic<bool>* needs_all_rows)
+      : MockExporter(output), needs_all_rows_(needs_all_rows) {}
+
+  bool ExportChangedRowsOnly() const override { return true; }
+
+  bool NeedsAllRows() override {
+    return needs_all_rows_ != nullptr && needs_all_rows_->exchange(false);
+  }
+
+ private:
+  std::atomic<bool>* needs_all_rows_;
+};
+
 constexpr char kMeasureId[] = "test_measure_id";
 
 MeasureDouble TestMeasure() {
@@ -172,6 +204,77 @@ TEST_F(StatsExporterTest, IntervalViewRejected) {
   EXPECT_TRUE(exported_data.Get().empty());
 }
 
+TEST_F(StatsExporterTest, ChangedRowsOnly) {
+  ExportedData all_rows;
+  MockExporter::Register(&all_rows);
+  ExportedData changed_rows;
+  ChangedRowsExporter::Register(&changed_rows);
+  const auto key = opencensus::tags::TagKey::Register("changed_rows_key");
+  const ViewDescriptor descriptor = ViewDescriptor()
+                                        .set_name("changed_rows")
+                                        .set_measure(kMeasureId)
+                                        .set_aggregation(Aggregation::Count())
+                                        .add_column(key);
+  descriptor.RegisterForExport();
+  const std::vector<std::string> row_a({"a"});
+  const std::vector<std::string> row_b({"b"});
+
+  Record({{TestMeasure(), 1.0}}, {{key, "a"}});
+  Record({{TestMeasure(), 1.0}}, {{key, "b"}});
+  testing::TestUtils::Flush();
+  Export();
+  ASSERT_EQ(1, changed_rows.Get().size());
+  EXPECT_THAT(changed_rows.Get()[0].second.int_data(),
+              ::testing::UnorderedElementsAre(::testing::Pair(row_a, 1),
+                                              ::testing::Pair(row_b, 1)));
+
+  changed_rows.Clear();
+  all_rows.Clear();
+  Record({{TestMeasure(), 1.0}}, {{key, "a"}});
+  testing::TestUtils::Flush();
+  Export();
+  ASSERT_EQ(1, changed_rows.Get().size());
+  EXPECT_THAT(changed_rows.Get()[0].second.int_data(),
+              ::testing::UnorderedElementsAre(::testing::Pair(row_a, 2)));
+  ASSERT_EQ(1, all_rows.Get().size());
+  EXPECT_THAT(all_rows.Get()[0].second.int_data(),
+              ::testing::UnorderedElementsAre(::testing::Pair(row_a, 2),
+                                              ::testing::Pair(row_b, 1)));
+
+  // Views without changes are left out.
+  changed_rows.Clear();
+  all_rows.Clear();
+  Export();
+  EXPECT_TRUE(changed_rows.Get().empty());
+  EXPECT_EQ(1, all_rows.Get().size());
+
+  // A new handler sees every row in its first export.
+  ExportedData new_changed_rows;
+  std::atomic<bool> needs_all_rows(false);
+  ChangedRowsExporter::Register(&new_changed_rows, &needs_all_rows);
+  Export();
+  ASSERT_EQ(1, new_changed_rows.Get().size());
+  EXPECT_THAT(new_changed_rows.Get()[0].second.int_data(),
+              ::testing::UnorderedElementsAre(::testing::Pair(row_a, 2),
+                                              ::testing::Pair(row_b, 1)));
+
+  // As does every changed-rows handler when one needs all rows, but only once.
+  changed_rows.Clear();
+  new_changed_rows.Clear();
+  needs_all_rows = true;
+  Export();
+  ASSERT_EQ(1, changed_rows.Get().size());
+  EXPECT_THAT(changed_rows.Get()[0].second.int_data(),
+              ::testing::UnorderedElementsAre(::testing::Pair(row_a, 2),
+                                              ::testing::Pair(row_b, 1)));
+  changed_rows.Clear();
+  new_changed_rows.Clear();
+  Export();
+  EXPECT_TRUE(changed_rows.Get().empty());
+  EXPECT_TRUE(new_changed_rows.Get().empty());
+  StatsExporter::RemoveView(descriptor.name());
+}
+
 TEST_F(StatsExporterTest, TimedExport) {
   ExportedData exported_data;
   MockExporter::Register(&exported_data);
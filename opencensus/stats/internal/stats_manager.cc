@@ -14,13 +14,16 @@
 
 #include "opencensus/stats/internal/stats_manager.h"
 
+#include <atomic>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 #include "absl/base/macros.h"
 #include "absl/memory/memory.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "opencensus/common/internal/clock.h"
 #include "opencensus/stats/aggregation.h"
 #include "opencensus/stats/bucket_boundaries.h"
 #include "opencensus/stats/internal/delta_producer.h"
@@ -33,6 +36,14 @@
 namespace opencensus {
 namespace stats {
 
+namespace {
+
+// The most rows evicted from each view per merge, so that a burst of rows
+// going stale at once is evicted over several merges rather than stalling one.
+constexpr int64_t kMaxRowsEvictedPerMerge = 1000;
+
+}  // namespace
+
 // TODO: See if it is possible to replace AssertHeld() with function
 // annotations.
 // TODO: Optimize selecting/sorting tag values for each view.
@@ -41,14 +52,25 @@ namespace stats {
 // StatsManager::ViewInformation
 
 StatsManager::ViewInformation::ViewInformation(const ViewDescriptor& descriptor,
-                                               absl::Mutex* mu)
-    : descriptor_(descriptor), mu_(mu), data_(absl::Now(), descriptor) {}
+                                               absl::Mutex* mu,
+                                               RowCounts* row_counts)
+    : descriptor_(descriptor),
+      mu_(mu),
+      row_counts_(row_counts),
+      data_(std::make_shared<ViewDataImpl>(absl::Now(), descriptor)) {}
+
+StatsManager::ViewInformation::~ViewInformation() {
+  mu_->AssertHeld();
+  row_counts_->total_rows -= data_->start_times().size();
+}
 
 bool StatsManager::ViewInformation::Matches(
     const ViewDescriptor& descriptor) const {
   return descriptor.aggregation() == descriptor_.aggregation() &&
          descriptor.aggregation_window_ == descriptor_.aggregation_window_ &&
-         descriptor.columns() == descriptor_.columns();
+         descriptor.columns() == descriptor_.columns() &&
+         descriptor.max_rows() == descriptor_.max_rows() &&
+         descriptor.row_ttl() == descriptor_.row_ttl();
 }
 
 int StatsManager::ViewInformation::num_consumers() const {
@@ -66,7 +88,7 @@ int StatsManager::ViewInformation::RemoveConsumer() {
   return --num_consumers_;
 }
 
-void StatsManager::ViewInformation::MergeMeasureData(
+bool StatsManager::ViewInformation::MergeMeasureData(
     const opencensus::tags::TagMap& tags, const MeasureData& data,
     absl::Time now) {
   mu_->AssertHeld();
@@ -80,30 +102,150 @@ void StatsManager::ViewInformation::MergeMeasureData(
       }
     }
   }
-  data_.Merge(tag_values, data, now);
+  const int64_t max_rows = descriptor_.max_rows();
+  const int64_t max_total_rows = row_counts_->max_total_rows;
+  const auto& rows = data_->start_times();
+  if ((max_rows != 0 || max_total_rows != 0) &&
+      rows.find(tag_values) == rows.end() &&
+      ((max_rows != 0 && static_cast<int64_t>(rows.size()) >= max_rows) ||
+       (max_total_rows != 0 && row_counts_->total_rows >= max_total_rows))) {
+    return MergeOverflowData(data, now);
+  }
+  MergeRow(tag_values, data, now);
+  return false;
+}
+
+bool StatsManager::ViewInformation::MergeOverflowData(const MeasureData& data,
+                                                      absl::Time now) {
+  mu_->AssertHeld();
+  // The overflow row may itself exceed the limits, but only by one row.
+  MergeRow(std::vector<std::string>(descriptor_.columns().size(),
+                                    ViewDescriptor::kOverflowTagValue),
+           data, now);
+  return !descriptor_.columns().empty();
+}
+
+void StatsManager::ViewInformation::EvictStaleRows(absl::Time now) {
+  mu_->AssertHeld();
+  // Check first, to avoid copying data shared with snapshots for nothing.
+  if (data_->HasStaleRows(now)) {
+    row_counts_->total_rows -=
+        MutableData()->EvictStaleRows(now, kMaxRowsEvictedPerMerge);
+  }
+}
+
+void StatsManager::ViewInformation::MergeRow(
+    const std::vector<std::string>& tag_values, const MeasureData& data,
+    absl::Time now) {
+  mu_->AssertHeld();
+  if (MutableData()->Merge(tag_values, data, now)) {
+    ++row_counts_->total_rows;
+  }
 }
 
-std::unique_ptr<ViewDataImpl> StatsManager::ViewInformation::GetData() {
-  absl::ReaderMutexLock l(mu_);
-  if (data_.type() == ViewDataImpl::Type::kStatsObject) {
-    return absl::make_unique<ViewDataImpl>(data_, absl::Now());
-  } else if (descriptor_.aggregation_window_.type() ==
-             AggregationWindow::Type::kDelta) {
-    return data_.GetDeltaAndReset(absl::Now());
+ViewDataImpl* StatsManager::ViewInformation::MutableData() {
+  mu_->AssertHeld();
+  // Snapshots are only taken while holding *mu_, so the count can't grow
+  // concurrently; at worst a snapshot released meanwhile causes a needless
+  // copy.
+  if (data_.use_count() > 1) {
+    data_ = std::make_shared<ViewDataImpl>(*data_);
   } else {
-    return absl::make_unique<ViewDataImpl>(data_);
+    // use_count() is a relaxed load. Snapshots are released without *mu_, by
+    // a release decrement of the count; this fence pairs with it, so that the
+    // last snapshot's reads of data_ happen before the caller's writes.
+    std::atomic_thread_fence(std::memory_order_acquire);
+  }
+  return data_.get();
+}
+
+std::shared_ptr<const ViewDataImpl> StatsManager::ViewInformation::GetData() {
+  switch (descriptor_.aggregation_window_.type()) {
+    case AggregationWindow::Type::kCumulative: {
+      absl::ReaderMutexLock l(mu_);
+      return data_;
+    }
+    case AggregationWindow::Type::kDelta: {
+      absl::MutexLock l(mu_);
+      return MutableData()->GetDeltaAndReset(absl::Now());
+    }
+    case AggregationWindow::Type::kInterval: {
+      absl::ReaderMutexLock l(mu_);
+      return std::make_shared<ViewDataImpl>(*data_, absl::Now());
+    }
+  }
+  ABSL_ASSERT(false && "Bad AggregationWindow type.");
+  return nullptr;
+}
+
+std::unique_ptr<ViewDataImpl> StatsManager::ViewInformation::GetChangedData(
+    uint64_t* generation) {
+  if (descriptor_.aggregation_window_.type() !=
+      AggregationWindow::Type::kCumulative) {
+    return nullptr;
+  }
+  absl::MutexLock l(mu_);
+  // This only advances the generation, which snapshots sharing data_ don't
+  // read, so it doesn't need a copy.
+  return data_->GetChangedRows(generation);
+}
+
+void StatsManager::ViewInformation::AddChangedRowsConsumer() {
+  absl::MutexLock l(mu_);
+  ++num_changed_rows_consumers_;
+  UpdateTrackChanges();
+}
+
+void StatsManager::ViewInformation::RemoveChangedRowsConsumer() {
+  absl::MutexLock l(mu_);
+  --num_changed_rows_consumers_;
+  UpdateTrackChanges();
+}
+
+void StatsManager::ViewInformation::UpdateTrackChanges() {
+  mu_->AssertHeld();
+  // Only cumulative views have changed rows to consume. Eviction needs them
+  // for views with a row TTL, and interval views, whose rows are evicted once
+  // they hold no data within the interval.
+  const AggregationWindow::Type window = descriptor_.aggregation_window_.type();
+  const bool track_changes =
+      (num_changed_rows_consumers_ > 0 &&
+       window == AggregationWindow::Type::kCumulative) ||
+      descriptor_.row_ttl() != absl::InfiniteDuration() ||
+      window == AggregationWindow::Type::kInterval;
+  if (data_->tracks_changes() != track_changes) {
+    MutableData()->TrackChanges(track_changes, absl::Now());
   }
 }
 
 // ==========================================================================
 // // StatsManager::MeasureInformation
 
-void StatsManager::MeasureInformation::MergeMeasureData(
+int64_t StatsManager::MeasureInformation::MergeMeasureData(
     const opencensus::tags::TagMap& tags, const MeasureData& data,
     absl::Time now) {
   mu_->AssertHeld();
+  int64_t num_overflowed = 0;
+  for (auto& view : views_) {
+    num_overflowed += view->MergeMeasureData(tags, data, now);
+  }
+  return num_overflowed;
+}
+
+int64_t StatsManager::MeasureInformation::MergeOverflowData(
+    const MeasureData& data, absl::Time now) {
+  mu_->AssertHeld();
+  int64_t num_overflowed = 0;
+  for (auto& view : views_) {
+    num_overflowed += view->MergeOverflowData(data, now);
+  }
+  return num_overflowed;
+}
+
+void StatsManager::MeasureInformation::EvictStaleRows(absl::Time now) {
+  mu_->AssertHeld();
   for (auto& view : views_) {
-    view->MergeMeasureData(tags, data, now);
+    view->EvictStaleRows(now);
   }
 }
 
@@ -116,7 +258,7 @@ StatsManager::ViewInformation* StatsManager::MeasureInformation::AddConsumer(
       return view.get();
     }
   }
-  views_.emplace_back(new ViewInformation(descriptor, mu_));
+  views_.emplace_back(new ViewInformation(descriptor, mu_, row_counts_));
   return views_.back().get();
 }
 
@@ -146,7 +288,8 @@ StatsManager* StatsManager::Get() {
 
 void StatsManager::MergeDelta(const Delta& delta) {
   absl::MutexLock l(&mu_);
-  absl::Time now = absl::Now();
+  absl::Time now = common::Clock::Now();
+  int64_t dropped_rows = 0;
   // Measures are added to the StatsManager before the DeltaProducer, so there
   // should never be measures in the delta missing from measures_.
   for (const auto& data_for_tagset : delta.delta()) {
@@ -154,17 +297,47 @@ void StatsManager::MergeDelta(const Delta& delta) {
       // Only add data if there is data for this tagset/measure combination, to
       // avoid creating spurious empty rows.
       if (data_for_tagset.second[i].count() != 0) {
-        measures_[i].MergeMeasureData(data_for_tagset.first,
-                                      data_for_tagset.second[i], now);
+        dropped_rows += measures_[i].MergeMeasureData(
+            data_for_tagset.first, data_for_tagset.second[i], now);
       }
     }
   }
+  // Data the delta had no room to keep by tag set goes to overflow rows.
+  for (int i = 0; i < delta.overflow().size(); ++i) {
+    if (delta.overflow()[i].count() != 0) {
+      dropped_rows += measures_[i].MergeOverflowData(delta.overflow()[i], now);
+    }
+  }
+  if (dropped_rows != 0) {
+    dropped_rows_.fetch_add(dropped_rows);
+  }
+  for (auto& measure : measures_) {
+    measure.EvictStaleRows(now);
+  }
+}
+
+void StatsManager::SetMaxTotalRows(int64_t max_rows) {
+  DroppedRowsMeasure();
+  // The delta can't usefully hold more rows than views may have.
+  DeltaProducer::Get()->SetMaxRows(max_rows);
+  absl::MutexLock l(&mu_);
+  row_counts_.max_total_rows = max_rows;
+}
+
+// static
+MeasureInt64 StatsManager::DroppedRowsMeasure() {
+  static const MeasureInt64 measure = MeasureInt64::Register(
+      "opencensus.io/stats/dropped_rows",
+      "Number of times data for a new row was merged into a view's overflow "
+      "row because of a row limit.",
+      "1");
+  return measure;
 }
 
 template <typename MeasureT>
 void StatsManager::AddMeasure(Measure<MeasureT> measure) {
   absl::MutexLock l(&mu_);
-  measures_.emplace_back(MeasureInformation(&mu_));
+  measures_.emplace_back(MeasureInformation(&mu_, &row_counts_));
   ABSL_ASSERT(measures_.size() ==
               MeasureRegistryImpl::MeasureToIndex(measure) + 1);
 }
@@ -180,6 +353,16 @@ StatsManager::ViewInformation* StatsManager::AddConsumer(
               << descriptor.DebugString() << "\n";
     return nullptr;
   }
+  // Interval views keep a fixed number of buckets per row.
+  if (descriptor.aggregation_window_.type() ==
+          AggregationWindow::Type::kInterval &&
+      descriptor.aggregation().type() == Aggregation::Type::kDistribution &&
+      descriptor.aggregation().bucket_boundaries().auto_range()) {
+    std::cerr << "Attempting to register an interval ViewDescriptor with "
+                 "auto-ranging bucket boundaries:\n"
+              << descriptor.DebugString() << "\n";
+    return nullptr;
+  }
   const uint64_t index = MeasureRegistryImpl::IdToIndex(descriptor.measure_id_);
   // We need to call this outside of the locked portion to avoid a deadlock when
   // the DeltaProducer flushes the old delta. We call it before adding the view
@@ -187,21 +370,35 @@ StatsManager::ViewInformation* StatsManager::AddConsumer(
   if (descriptor.aggregation().type() == Aggregation::Type::kDistribution) {
     DeltaProducer::Get()->AddBoundaries(
         index, descriptor.aggregation().bucket_boundaries());
+  } else if (descriptor.aggregation().type() ==
+             Aggregation::Type::kQuantiles) {
+    DeltaProducer::Get()->AddSketch(index);
+  }
+  DeltaProducer::Get()->AddColumns(descriptor.columns());
+  // Likewise, this may register a measure.
+  if (descriptor.max_rows() != 0) {
+    DroppedRowsMeasure();
   }
   absl::MutexLock l(&mu_);
   return measures_[index].AddConsumer(descriptor);
 }
 
 void StatsManager::RemoveConsumer(ViewInformation* handle) {
-  absl::MutexLock l(&mu_);
-  const int num_consumers_remaining = handle->RemoveConsumer();
-  ABSL_ASSERT(num_consumers_remaining >= 0);
-  if (num_consumers_remaining == 0) {
-    const auto& descriptor = handle->view_descriptor();
-    const uint64_t index =
-        MeasureRegistryImpl::IdToIndex(descriptor.measure_id_);
-    measures_[index].RemoveView(handle);
+  std::vector<opencensus::tags::TagKey> columns;
+  {
+    absl::MutexLock l(&mu_);
+    columns = handle->view_descriptor().columns();
+    const int num_consumers_remaining = handle->RemoveConsumer();
+    ABSL_ASSERT(num_consumers_remaining >= 0);
+    if (num_consumers_remaining == 0) {
+      const auto& descriptor = handle->view_descriptor();
+      const uint64_t index =
+          MeasureRegistryImpl::IdToIndex(descriptor.measure_id_);
+      measures_[index].RemoveView(handle);
+    }
   }
+  // The DeltaProducer's locks are acquired before mu_.
+  DeltaProducer::Get()->RemoveColumns(columns);
 }
 
 }  // namespace stats
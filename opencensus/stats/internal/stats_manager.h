@@ -15,7 +15,11 @@
 #ifndef OPENCENSUS_STATS_INTERNAL_STATS_MANAGER_H_
 #define OPENCENSUS_STATS_INTERNAL_STATS_MANAGER_H_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
@@ -37,13 +41,23 @@ namespace stats {
 // values from Record() events.
 class StatsManager final {
  public:
+  // Counts rows across all views, to enforce the limit set by
+  // SetMaxTotalRows(). Guarded by the StatsManager's mutex.
+  struct RowCounts {
+    int64_t max_total_rows = 0;  // 0 means no limit.
+    int64_t total_rows = 0;
+  };
+
   // ViewInformation stores part of the data of a ViewDescriptor
   // (measure, aggregation, and columns), along with the data for the view.
   // ViewInformation is thread-compatible; its non-const data is protected by an
   // external mutex, which most non-const member functions require holding.
   class ViewInformation {
    public:
-    ViewInformation(const ViewDescriptor& descriptor, absl::Mutex* mu);
+    ViewInformation(const ViewDescriptor& descriptor, absl::Mutex* mu,
+                    RowCounts* row_counts);
+    // Removes the view's rows from *row_counts. Requires holding *mu_.
+    ~ViewInformation();
 
     // Returns true if this ViewInformation can be used to provide data for
     // 'descriptor' (i.e. shares measure, aggregation, aggregation window, and
@@ -57,12 +71,37 @@ class StatsManager final {
     // holding *mu_.
     int RemoveConsumer();
 
-    // Adds 'data' under 'tags' as of 'now'. Requires holding *mu_;
-    void MergeMeasureData(const opencensus::tags::TagMap& tags,
+    // Adds 'data' under 'tags' as of 'now', or to the overflow row if 'tags'
+    // would add a row beyond the view's or the global row limit. Returns true
+    // if the data went to an overflow row other than its own. Requires holding
+    // *mu_;
+    bool MergeMeasureData(const opencensus::tags::TagMap& tags,
                           const MeasureData& data, absl::Time now);
 
-    // Retrieves a copy of the data.
-    std::unique_ptr<ViewDataImpl> GetData() ABSL_LOCKS_EXCLUDED(*mu_);
+    // Evicts rows that are stale as of 'now' (see
+    // ViewDataImpl::EvictStaleRows()), up to a fixed number per call. Requires
+    // holding *mu_.
+    void EvictStaleRows(absl::Time now);
+
+    // Adds 'data' to the overflow row as of 'now', returning false if the view
+    // has no columns (so that its only row was the right one). Requires
+    // holding *mu_.
+    bool MergeOverflowData(const MeasureData& data, absl::Time now);
+
+    // Retrieves a snapshot of the data. For cumulative views, the snapshot
+    // shares data_ until data_ next changes.
+    std::shared_ptr<const ViewDataImpl> GetData() ABSL_LOCKS_EXCLUDED(*mu_);
+
+    // Retrieves a copy of the rows changed since '*generation' (see
+    // ViewDataImpl::GetChangedRows()), or nullptr if the view is not
+    // cumulative.
+    std::unique_ptr<ViewDataImpl> GetChangedData(uint64_t* generation)
+        ABSL_LOCKS_EXCLUDED(*mu_);
+
+    // Registers and unregisters a consumer of GetChangedData(). Changed rows
+    // are only tracked while the view has such a consumer or a row TTL.
+    void AddChangedRowsConsumer() ABSL_LOCKS_EXCLUDED(*mu_);
+    void RemoveChangedRowsConsumer() ABSL_LOCKS_EXCLUDED(*mu_);
 
     const ViewDescriptor& view_descriptor() const { return descriptor_; }
 
@@ -70,23 +109,52 @@ class StatsManager final {
     const ViewDescriptor descriptor_;
 
     absl::Mutex* const mu_;  // Not owned.
+    RowCounts* const row_counts_;  // Not owned; guarded by *mu_.
     // The number of View objects backed by this ViewInformation, for
     // reference-counted GC.
     int num_consumers_ ABSL_GUARDED_BY(*mu_) = 1;
+    // The number of consumers of GetChangedData().
+    int num_changed_rows_consumers_ ABSL_GUARDED_BY(*mu_) = 0;
 
     // Possible types of stored data.
     enum class DataType { kDouble, kUint64, kDistribution, kInterval };
     static DataType DataTypeForDescriptor(const ViewDescriptor& descriptor);
 
-    ViewDataImpl data_ ABSL_GUARDED_BY(*mu_);
+    // Returns data_ for modification, first copying it if snapshots returned
+    // by GetData() still share it. Requires holding *mu_.
+    ViewDataImpl* MutableData();
+
+    // Starts or stops tracking changed rows in data_ to match the consumers
+    // and row TTL. Requires holding *mu_.
+    void UpdateTrackChanges();
+
+    // Merges 'data' under 'tag_values', counting the row if it is new.
+    // Requires holding *mu_.
+    void MergeRow(const std::vector<std::string>& tag_values,
+                  const MeasureData& data, absl::Time now);
+
+    // Copy-on-write: snapshots share this until it is next modified.
+    std::shared_ptr<ViewDataImpl> data_ ABSL_GUARDED_BY(*mu_);
   };
 
  public:
   static StatsManager* Get();
 
-  // Merges all data from 'delta' at the present time.
+  // Merges all data from 'delta' at the present time, then evicts stale rows.
   void MergeDelta(const Delta& delta) ABSL_LOCKS_EXCLUDED(mu_);
 
+  // Limits the number of rows across all views (see SetMaxTotalViewRows()).
+  void SetMaxTotalRows(int64_t max_rows) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of merges folded into overflow rows since the last
+  // call.
+  int64_t TakeDroppedRows() { return dropped_rows_.exchange(0); }
+
+  // The measure that the DeltaProducer records TakeDroppedRows() under. Must
+  // be called once before any row limit is set, without holding any stats
+  // locks, since that registers the measure.
+  static MeasureInt64 DroppedRowsMeasure();
+
   // Adds a measure--this is necessary for views to be added under that measure.
   template <typename MeasureT>
   void AddMeasure(Measure<MeasureT> measure) ABSL_LOCKS_EXCLUDED(mu_);
@@ -104,18 +172,30 @@ class StatsManager final {
   // MeasureInformation stores all ViewInformation objects for a given measure.
   class MeasureInformation {
    public:
-    explicit MeasureInformation(absl::Mutex* mu) : mu_(mu) {}
+    MeasureInformation(absl::Mutex* mu, RowCounts* row_counts)
+        : mu_(mu), row_counts_(row_counts) {}
 
-    // Merges measure_data into all views under this measure. Requires holding
+    // Merges measure_data into all views under this measure, returning the
+    // number of views that merged it into their overflow row. Requires holding
     // *mu_;
-    void MergeMeasureData(const opencensus::tags::TagMap& tags,
-                          const MeasureData& data, absl::Time now);
+    int64_t MergeMeasureData(const opencensus::tags::TagMap& tags,
+                             const MeasureData& data, absl::Time now);
+
+    // Merges measure_data into the overflow row of all views under this
+    // measure, returning the number of views with columns. Requires holding
+    // *mu_.
+    int64_t MergeOverflowData(const MeasureData& data, absl::Time now);
+
+    // Evicts stale rows from all views under this measure. Requires holding
+    // *mu_.
+    void EvictStaleRows(absl::Time now);
 
     ViewInformation* AddConsumer(const ViewDescriptor& descriptor);
     void RemoveView(const ViewInformation* handle);
 
    private:
-    absl::Mutex* const mu_;  // Not owned.
+    absl::Mutex* const mu_;        // Not owned.
+    RowCounts* const row_counts_;  // Not owned.
     // View objects hold a pointer to ViewInformation directly, so we do not
     // need fast lookup--lookup is only needed for view removal.
     std::vector<std::unique_ptr<ViewInformation>> views_ ABSL_GUARDED_BY(*mu_);
@@ -128,6 +208,13 @@ class StatsManager final {
 
   // All registered measures.
   std::vector<MeasureInformation> measures_ ABSL_GUARDED_BY(mu_);
+
+  RowCounts row_counts_ ABSL_GUARDED_BY(mu_);
+
+  // Merges folded into overflow rows and not yet taken by TakeDroppedRows().
+  // This is atomic so that the DeltaProducer can take it without waiting for
+  // mu_ while blocking Record().
+  std::atomic<int64_t> dropped_rows_{0};
 };
 
 extern template void StatsManager::AddMeasure(MeasureDouble measure);
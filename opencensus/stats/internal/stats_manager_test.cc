@@ -12,11 +12,19 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "opencensus/stats/internal/delta_producer.h"
 #include "opencensus/stats/measure.h"
 #include "opencensus/stats/recording.h"
+#include "opencensus/stats/row_limits.h"
 #include "opencensus/stats/testing/test_utils.h"
 #include "opencensus/stats/view.h"
 #include "opencensus/tags/tag_key.h"
@@ -89,6 +97,66 @@ TEST_F(StatsManagerTest, Count) {
           ::testing::Pair(::testing::ElementsAre("value1", "value2"), 1.0)));
 }
 
+TEST_F(StatsManagerTest, SnapshotsAreUnaffectedByLaterRecords) {
+  ViewDescriptor view_descriptor = ViewDescriptor()
+                                       .set_measure(kFirstMeasureId)
+                                       .set_name("snapshots")
+                                       .set_aggregation(Aggregation::Count())
+                                       .add_column(key1_);
+  View view(view_descriptor);
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "value1"}});
+  testing::TestUtils::Flush();
+  const ViewData data1 = view.GetData();
+  const ViewData data1_copy = data1;
+  // Snapshots share data until it changes.
+  EXPECT_EQ(&data1.int_data(), &view.GetData().int_data());
+  EXPECT_EQ(&data1.int_data(), &data1_copy.int_data());
+
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "value1"}});
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "value2"}});
+  testing::TestUtils::Flush();
+  const ViewData data2 = view.GetData();
+  EXPECT_THAT(data1.int_data(),
+              ::testing::UnorderedElementsAre(
+                  ::testing::Pair(::testing::ElementsAre("value1"), 1)));
+  EXPECT_THAT(data2.int_data(),
+              ::testing::UnorderedElementsAre(
+                  ::testing::Pair(::testing::ElementsAre("value1"), 2),
+                  ::testing::Pair(::testing::ElementsAre("value2"), 1)));
+}
+
+// Snapshots are released without holding the view's lock, while records write
+// to data that the last snapshot may have shared. Best run under TSAN.
+TEST_F(StatsManagerTest, SnapshotsReleasedOnAnotherThread) {
+  ViewDescriptor view_descriptor = ViewDescriptor()
+                                       .set_measure(kFirstMeasureId)
+                                       .set_name("snapshots_released")
+                                       .set_aggregation(Aggregation::Count())
+                                       .add_column(key1_);
+  View view(view_descriptor);
+  std::atomic<bool> done(false);
+  std::thread reader([&view, &done]() {
+    while (!done) {
+      const ViewData data = view.GetData();
+      int64_t total = 0;
+      for (const auto& row : data.int_data()) {
+        total += row.second;
+      }
+      EXPECT_GE(total, 0);
+    }
+  });
+  for (int i = 0; i < 1000; ++i) {
+    Record({{FirstMeasure(), 1.0}}, {{key1_, i % 2 == 0 ? "a" : "b"}});
+    testing::TestUtils::Flush();
+  }
+  done = true;
+  reader.join();
+  EXPECT_THAT(view.GetData().int_data(),
+              ::testing::UnorderedElementsAre(
+                  ::testing::Pair(::testing::ElementsAre("a"), 500),
+                  ::testing::Pair(::testing::ElementsAre("b"), 500)));
+}
+
 TEST_F(StatsManagerTest, CountTagsFromContext) {
   ViewDescriptor view_descriptor = ViewDescriptor()
                                        .set_measure(kFirstMeasureId)
@@ -262,6 +330,60 @@ TEST_F(StatsManagerTest, Distribution) {
               ::testing::ElementsAre(1, 0));
 }
 
+TEST_F(StatsManagerTest, AutoRangingDistribution) {
+  ViewDescriptor view_descriptor =
+      ViewDescriptor()
+          .set_measure(kSecondMeasureId)
+          .set_name("distribution-auto")
+          .set_aggregation(
+              Aggregation::Distribution(BucketBoundaries::AutoLogLinear(0)))
+          .add_column(key1_);
+  View view(view_descriptor);
+  ASSERT_EQ(ViewData::Type::kDistribution, view.GetData().type());
+
+  Record({{SecondMeasure(), 5}, {SecondMeasure(), 15}});
+  testing::TestUtils::Flush();
+  Record({{SecondMeasure(), 1}});
+  Record({{SecondMeasure(), 7}}, {{key1_, "value1"}});
+  testing::TestUtils::Flush();
+  const opencensus::stats::ViewData data = view.GetData();
+  EXPECT_EQ(2, data.distribution_data().size());
+  // Each row covers the powers of two it has seen.
+  const Distribution& all = data.distribution_data().at({""});
+  EXPECT_EQ(BucketBoundaries::LogLinear(0, 4, 0), all.bucket_boundaries());
+  EXPECT_THAT(all.bucket_counts(), ::testing::ElementsAre(0, 1, 0, 1, 1, 0));
+  const Distribution& value1 = data.distribution_data().at({"value1"});
+  EXPECT_EQ(BucketBoundaries::LogLinear(2, 3, 0), value1.bucket_boundaries());
+  EXPECT_THAT(value1.bucket_counts(), ::testing::ElementsAre(0, 1, 0));
+}
+
+TEST_F(StatsManagerTest, Quantiles) {
+  ViewDescriptor view_descriptor =
+      ViewDescriptor()
+          .set_measure(kSecondMeasureId)
+          .set_name("quantiles")
+          .set_aggregation(Aggregation::Quantiles({0.5, 0.99}))
+          .add_column(key1_);
+  View view(view_descriptor);
+  ASSERT_EQ(ViewData::Type::kQuantiles, view.GetData().type());
+  EXPECT_TRUE(view.GetData().quantile_data().empty());
+
+  for (int i = 1; i <= 1000; ++i) {
+    Record({{SecondMeasure(), i}});
+  }
+  Record({{SecondMeasure(), 7}}, {{key1_, "value1"}});
+  testing::TestUtils::Flush();
+  const opencensus::stats::ViewData data = view.GetData();
+  EXPECT_EQ(2, data.quantile_data().size());
+  const QuantileSketch& sketch = data.quantile_data().at({""});
+  EXPECT_EQ(1000, sketch.count());
+  EXPECT_NEAR(500, sketch.Quantile(0.5),
+              500 * QuantileSketch::kRelativeAccuracy);
+  EXPECT_NEAR(990, sketch.Quantile(0.99),
+              990 * QuantileSketch::kRelativeAccuracy);
+  EXPECT_EQ(7, data.quantile_data().at({"value1"}).Quantile(0.5));
+}
+
 TEST_F(StatsManagerTest, Delta) {
   ViewDescriptor view_descriptor = ViewDescriptor()
                                        .set_measure(kFirstMeasureId)
@@ -434,6 +556,164 @@ TEST_F(StatsManagerTest, IdenticalViews) {
   EXPECT_TRUE(view.GetData().int_data().empty());
 }
 
+TEST_F(StatsManagerTest, MaxRows) {
+  View view(ViewDescriptor()
+                .set_measure(kFirstMeasureId)
+                .set_name("max_rows")
+                .set_aggregation(Aggregation::Count())
+                .add_column(key1_)
+                .add_column(key2_)
+                .set_max_rows(2));
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "value1"}, {key2_, "value"}});
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "value2"}, {key2_, "value"}});
+  testing::TestUtils::Flush();
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "value1"}, {key2_, "value"}});
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "value3"}, {key2_, "value"}});
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "value4"}, {key2_, "value"}});
+  testing::TestUtils::Flush();
+  const std::string overflow = ViewDescriptor::kOverflowTagValue;
+  EXPECT_THAT(view.GetData().int_data(),
+              ::testing::UnorderedElementsAre(
+                  ::testing::Pair(::testing::ElementsAre("value1", "value"), 2),
+                  ::testing::Pair(::testing::ElementsAre("value2", "value"), 1),
+                  ::testing::Pair(::testing::ElementsAre(overflow, overflow),
+                                  2)));
+}
+
+TEST_F(StatsManagerTest, MaxTotalViewRows) {
+  // This registers the dropped rows measure.
+  SetMaxTotalViewRows(3);
+  View dropped_rows_view(
+      ViewDescriptor()
+          .set_measure("opencensus.io/stats/dropped_rows")
+          .set_name("dropped_rows")
+          .set_aggregation(Aggregation::Sum()));
+  View view1(ViewDescriptor()
+                 .set_measure(kFirstMeasureId)
+                 .set_name("max_total_rows1")
+                 .set_aggregation(Aggregation::Count())
+                 .add_column(key1_));
+  View view2(ViewDescriptor()
+                 .set_measure(kFirstMeasureId)
+                 .set_name("max_total_rows2")
+                 .set_aggregation(Aggregation::Count())
+                 .add_column(key2_));
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "a"}, {key2_, "a"}});
+  testing::TestUtils::Flush();
+  // The third row, in view1, reaches the limit, so view2 overflows.
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "b"}, {key2_, "b"}});
+  testing::TestUtils::Flush();
+  // The delta keeps tag sets for at most 3 rows across both views ("c" and
+  // "d" in view1, "" in view2), and the rest overflow together before being
+  // merged into views.
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "c"}});
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "d"}});
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "e"}});
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "f"}});
+  testing::TestUtils::Flush();
+  const std::string overflow = ViewDescriptor::kOverflowTagValue;
+  EXPECT_THAT(view1.GetData().int_data(),
+              ::testing::UnorderedElementsAre(
+                  ::testing::Pair(::testing::ElementsAre("a"), 1),
+                  ::testing::Pair(::testing::ElementsAre("b"), 1),
+                  ::testing::Pair(::testing::ElementsAre(overflow), 4)));
+  EXPECT_THAT(view2.GetData().int_data(),
+              ::testing::UnorderedElementsAre(
+                  ::testing::Pair(::testing::ElementsAre("a"), 1),
+                  ::testing::Pair(::testing::ElementsAre(overflow), 5)));
+
+  // Drops are recorded with the next delta.
+  testing::TestUtils::Flush();
+  EXPECT_THAT(dropped_rows_view.GetData().int_data(),
+              ::testing::UnorderedElementsAre(
+                  ::testing::Pair(::testing::ElementsAre(), 7)));
+  SetMaxTotalViewRows(0);
+}
+
+TEST_F(StatsManagerTest, MaxTotalViewRowsIgnoresUnusedTags) {
+  SetMaxTotalViewRows(10);
+  View view(ViewDescriptor()
+                .set_measure(kFirstMeasureId)
+                .set_name("max_total_rows_unused_tags")
+                .set_aggregation(Aggregation::Count())
+                .add_column(key1_));
+  // Each record has a distinct tag map, but all map to the same row.
+  for (int i = 0; i < 50; ++i) {
+    Record({{FirstMeasure(), 1.0}},
+           {{key1_, "a"}, {key2_, absl::StrCat("request", i)}});
+  }
+  testing::TestUtils::Flush();
+  EXPECT_THAT(view.GetData().int_data(),
+              ::testing::UnorderedElementsAre(
+                  ::testing::Pair(::testing::ElementsAre("a"), 50)));
+  SetMaxTotalViewRows(0);
+}
+
+TEST_F(StatsManagerTest, MaxTotalViewRowsBuffersKnownRows) {
+  SetMaxTotalViewRows(4);
+  View view1(ViewDescriptor()
+                 .set_measure(kFirstMeasureId)
+                 .set_name("max_total_rows_known1")
+                 .set_aggregation(Aggregation::Count())
+                 .add_column(key1_));
+  View view2(ViewDescriptor()
+                 .set_measure(kFirstMeasureId)
+                 .set_name("max_total_rows_known2")
+                 .set_aggregation(Aggregation::Count())
+                 .add_column(key2_));
+  // The first two tag maps fill the delta with rows. The other combinations
+  // of their values only map to those rows, so they are buffered too.
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "a"}, {key2_, "a"}});
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "b"}, {key2_, "b"}});
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "a"}, {key2_, "b"}});
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "b"}, {key2_, "a"}});
+  // This would add a row to view1.
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "c"}, {key2_, "a"}});
+  testing::TestUtils::Flush();
+  const std::string overflow = ViewDescriptor::kOverflowTagValue;
+  EXPECT_THAT(view1.GetData().int_data(),
+              ::testing::UnorderedElementsAre(
+                  ::testing::Pair(::testing::ElementsAre("a"), 2),
+                  ::testing::Pair(::testing::ElementsAre("b"), 2),
+                  ::testing::Pair(::testing::ElementsAre(overflow), 1)));
+  EXPECT_THAT(view2.GetData().int_data(),
+              ::testing::UnorderedElementsAre(
+                  ::testing::Pair(::testing::ElementsAre("a"), 2),
+                  ::testing::Pair(::testing::ElementsAre("b"), 2),
+                  ::testing::Pair(::testing::ElementsAre(overflow), 1)));
+  SetMaxTotalViewRows(0);
+}
+
+TEST_F(StatsManagerTest, RowTtl) {
+  View view(ViewDescriptor()
+                .set_measure(kFirstMeasureId)
+                .set_name("row_ttl")
+                .set_aggregation(Aggregation::Count())
+                .add_column(key1_)
+                .set_row_ttl(absl::Milliseconds(50)));
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "value1"}});
+  testing::TestUtils::Flush();
+  absl::SleepFor(absl::Milliseconds(100));
+  Record({{FirstMeasure(), 1.0}}, {{key1_, "value2"}});
+  testing::TestUtils::Flush();
+  EXPECT_THAT(view.GetData().int_data(),
+              ::testing::UnorderedElementsAre(
+                  ::testing::Pair(::testing::ElementsAre("value2"), 1)));
+}
+
+TEST_F(StatsManagerTest, IntervalAutoRangingDistribution) {
+  ViewDescriptor view_descriptor =
+      ViewDescriptor()
+          .set_measure(kSecondMeasureId)
+          .set_name("distribution-interval-auto")
+          .set_aggregation(
+              Aggregation::Distribution(BucketBoundaries::AutoLogLinear(0)));
+  SetAggregationWindow(AggregationWindow::Interval(absl::Hours(1)),
+                       &view_descriptor);
+  View view(view_descriptor);
+  EXPECT_FALSE(view.IsValid());
+}
+
 TEST(StatsManagerDeathTest, UnregisteredMeasure) {
   const std::string measure_name = "new_measure_name";
   ViewDescriptor view_descriptor = ViewDescriptor()
@@ -32,6 +32,9 @@ View::View(const ViewDescriptor& descriptor)
 
 View::~View() {
   if (IsValid()) {
+    if (changed_rows_consumer_.load(std::memory_order_relaxed)) {
+      handle_->RemoveChangedRowsConsumer();
+    }
     StatsManager::Get()->RemoveConsumer(handle_);
   }
 }
@@ -47,5 +50,19 @@ const ViewData View::GetData() {
   return ViewData(handle_->GetData());
 }
 
+absl::optional<ViewData> View::GetChangedData(uint64_t* generation) {
+  if (!IsValid()) {
+    return absl::nullopt;
+  }
+  if (!changed_rows_consumer_.exchange(true)) {
+    handle_->AddChangedRowsConsumer();
+  }
+  std::unique_ptr<ViewDataImpl> data = handle_->GetChangedData(generation);
+  if (data == nullptr) {
+    return absl::nullopt;
+  }
+  return ViewData(std::move(data));
+}
+
 }  // namespace stats
 }  // namespace opencensus
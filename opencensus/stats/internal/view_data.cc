@@ -36,7 +36,11 @@ ViewData::Type ViewData::type() const {
       return Type::kInt64;
     case ViewDataImpl::Type::kDistribution:
       return Type::kDistribution;
+    case ViewDataImpl::Type::kQuantiles:
+      return Type::kQuantiles;
     case ViewDataImpl::Type::kStatsObject:
+    case ViewDataImpl::Type::kIntervalDistribution:
+    case ViewDataImpl::Type::kIntervalQuantiles:
       // This DCHECKs in the constructor. Returning kDouble here is
       // safe, albeit incorrect--the double_data() accessor will return an empty
       // map.
@@ -80,6 +84,17 @@ const ViewData::DataMap<Distribution>& ViewData::distribution_data() const {
   }
 }
 
+const ViewData::DataMap<QuantileSketch>& ViewData::quantile_data() const {
+  if (impl_->type() == ViewDataImpl::Type::kQuantiles) {
+    return impl_->quantile_data();
+  } else {
+    std::cerr << "Accessing quantile_data from a non-quantiles ViewData.\n";
+    ABSL_ASSERT(0);
+    static DataMap<QuantileSketch> empty_map;
+    return empty_map;
+  }
+}
+
 absl::Time ViewData::start_time() const { return impl_->start_time(); }
 
 const ViewData::DataMap<absl::Time>& ViewData::start_times() const {
@@ -89,12 +104,13 @@ const ViewData::DataMap<absl::Time>& ViewData::start_times() const {
 absl::Time ViewData::end_time() const { return end_time_; }
 
 ViewData::ViewData(const ViewData& other)
-    : impl_(absl::make_unique<ViewDataImpl>(*other.impl_)),
-      end_time_(absl::Now()) {}
+    : impl_(other.impl_), end_time_(other.end_time_) {}
 
-ViewData::ViewData(std::unique_ptr<ViewDataImpl> data)
+ViewData::ViewData(std::shared_ptr<const ViewDataImpl> data)
     : impl_(std::move(data)), end_time_(absl::Now()) {
-  ABSL_ASSERT(impl_->type() != ViewDataImpl::Type::kStatsObject);
+  ABSL_ASSERT(impl_->type() != ViewDataImpl::Type::kStatsObject &&
+              impl_->type() != ViewDataImpl::Type::kIntervalDistribution &&
+              impl_->type() != ViewDataImpl::Type::kIntervalQuantiles);
 }
 
 }  // namespace stats
@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <iostream>
+#include <iterator>
 #include <memory>
 
 #include "absl/base/macros.h"
@@ -48,12 +49,21 @@ ViewDataImpl::Type ViewDataImpl::TypeForDescriptor(
           return ViewDataImpl::Type::kInt64;
         case Aggregation::Type::kDistribution:
           return ViewDataImpl::Type::kDistribution;
+        case Aggregation::Type::kQuantiles:
+          return ViewDataImpl::Type::kQuantiles;
         default:
           ABSL_ASSERT(false && "Unknown aggregation type.");
           return ViewDataImpl::Type::kDouble;
       }
     case AggregationWindow::Type::kInterval:
-      return ViewDataImpl::Type::kStatsObject;
+      switch (descriptor.aggregation().type()) {
+        case Aggregation::Type::kDistribution:
+          return ViewDataImpl::Type::kIntervalDistribution;
+        case Aggregation::Type::kQuantiles:
+          return ViewDataImpl::Type::kIntervalQuantiles;
+        default:
+          return ViewDataImpl::Type::kStatsObject;
+      }
   }
   ABSL_ASSERT(false && "Bad ViewDataImpl type.");
   return ViewDataImpl::Type::kDouble;
@@ -65,7 +75,13 @@ ViewDataImpl::ViewDataImpl(absl::Time start_time,
       aggregation_window_(descriptor.aggregation_window_),
       type_(TypeForDescriptor(descriptor)),
       start_times_(),
-      start_time_(start_time) {
+      start_time_(start_time),
+      row_ttl_(descriptor.row_ttl()),
+      // Interval views always track changes, to evict rows once they hold
+      // no data within the interval.
+      track_changes_(row_ttl_ != absl::InfiniteDuration() ||
+                     aggregation_window_.type() ==
+                         AggregationWindow::Type::kInterval) {
   switch (type_) {
     case Type::kDouble: {
       new (&double_data_) DataMap<double>();
@@ -79,19 +95,32 @@ ViewDataImpl::ViewDataImpl(absl::Time start_time,
       new (&distribution_data_) DataMap<Distribution>();
       break;
     }
+    case Type::kQuantiles: {
+      new (&quantile_data_) DataMap<QuantileSketch>();
+      break;
+    }
     case Type::kStatsObject: {
       new (&interval_data_) DataMap<IntervalStatsObject>();
       break;
     }
+    case Type::kIntervalDistribution: {
+      new (&interval_distribution_data_) DataMap<IntervalDistribution>();
+      break;
+    }
+    case Type::kIntervalQuantiles: {
+      new (&interval_quantile_data_) DataMap<IntervalQuantiles>();
+      break;
+    }
   }
 }
 
 ViewDataImpl::ViewDataImpl(const ViewDataImpl& other, absl::Time now)
     : aggregation_(other.aggregation()),
       aggregation_window_(other.aggregation_window()),
-      type_(other.aggregation().type() == Aggregation::Type::kDistribution
+      type_(other.type() == Type::kIntervalDistribution
                 ? Type::kDistribution
-                : Type::kDouble),
+                : other.type() == Type::kIntervalQuantiles ? Type::kQuantiles
+                                                            : Type::kDouble),
       start_times_(),
       start_time_(std::max(other.start_time(),
                            now - other.aggregation_window().duration())) {
@@ -116,7 +145,7 @@ ViewDataImpl::ViewDataImpl(const ViewDataImpl& other, absl::Time now)
     }
     case Aggregation::Type::kDistribution: {
       new (&distribution_data_) DataMap<Distribution>();
-      for (const auto& row : other.interval_data()) {
+      for (const auto& row : other.interval_distribution_data()) {
         const std::pair<DataMap<Distribution>::iterator, bool>& it =
             distribution_data_.emplace(
                 row.first, Distribution(&aggregation_.bucket_boundaries()));
@@ -129,6 +158,15 @@ ViewDataImpl::ViewDataImpl(const ViewDataImpl& other, absl::Time now)
       }
       break;
     }
+    case Aggregation::Type::kQuantiles: {
+      new (&quantile_data_) DataMap<QuantileSketch>();
+      for (const auto& row : other.interval_quantile_data()) {
+        row.second.SketchInto(
+            &quantile_data_.emplace(row.first, QuantileSketch()).first->second,
+            now);
+      }
+      break;
+    }
     case Aggregation::Type::kLastValue:
       std::cerr << "Interval/LastValue is not supported.\n";
       ABSL_ASSERT(0 && "Interval/LastValue is not supported.\n");
@@ -150,10 +188,22 @@ ViewDataImpl::~ViewDataImpl() {
       distribution_data_.~DataMap<Distribution>();
       break;
     }
+    case Type::kQuantiles: {
+      quantile_data_.~DataMap<QuantileSketch>();
+      break;
+    }
     case Type::kStatsObject: {
       interval_data_.~DataMap<IntervalStatsObject>();
       break;
     }
+    case Type::kIntervalDistribution: {
+      interval_distribution_data_.~DataMap<IntervalDistribution>();
+      break;
+    }
+    case Type::kIntervalQuantiles: {
+      interval_quantile_data_.~DataMap<IntervalQuantiles>();
+      break;
+    }
   }
 }
 
@@ -162,12 +212,48 @@ std::unique_ptr<ViewDataImpl> ViewDataImpl::GetDeltaAndReset(absl::Time now) {
   return absl::WrapUnique(new ViewDataImpl(this, now));
 }
 
+std::unique_ptr<ViewDataImpl> ViewDataImpl::GetChangedRows(
+    uint64_t* generation) {
+  ABSL_ASSERT(track_changes_);
+  // Need to use WrapUnique because this is a private constructor.
+  auto changed = absl::WrapUnique(new ViewDataImpl(*this, *generation));
+  // Rows merged from now on are newer than every row in 'changed'.
+  *generation = ++generation_;
+  return changed;
+}
+
+void ViewDataImpl::TrackChanges(bool track_changes, absl::Time now) {
+  if (track_changes == track_changes_) {
+    return;
+  }
+  track_changes_ = track_changes;
+  if (!track_changes) {
+    changes_.clear();
+    change_positions_.clear();
+    return;
+  }
+  for (const auto& row : start_times_) {
+    changes_.push_front({&row.first, generation_, now});
+    change_positions_.emplace(&row.first, changes_.begin());
+  }
+}
+
 ViewDataImpl::ViewDataImpl(const ViewDataImpl& other)
     : aggregation_(other.aggregation_),
       aggregation_window_(other.aggregation_window_),
       type_(other.type()),
       start_times_(other.start_times_),
-      start_time_(other.start_time_) {
+      start_time_(other.start_time_),
+      row_ttl_(other.row_ttl_),
+      track_changes_(other.track_changes_),
+      generation_(other.generation_) {
+  // Point the copied changes at the keys of the copied start_times_.
+  for (const RowChange& change : other.changes_) {
+    const std::vector<std::string>* key =
+        &start_times_.find(*change.tag_values)->first;
+    changes_.push_back({key, change.generation, change.last_updated});
+    change_positions_.emplace(key, std::prev(changes_.end()));
+  }
   switch (type_) {
     case Type::kDouble: {
       new (&double_data_) DataMap<double>(other.double_data_);
@@ -181,7 +267,13 @@ ViewDataImpl::ViewDataImpl(const ViewDataImpl& other)
       new (&distribution_data_) DataMap<Distribution>(other.distribution_data_);
       break;
     }
-    case Type::kStatsObject: {
+    case Type::kQuantiles: {
+      new (&quantile_data_) DataMap<QuantileSketch>(other.quantile_data_);
+      break;
+    }
+    case Type::kStatsObject:
+    case Type::kIntervalDistribution:
+    case Type::kIntervalQuantiles: {
       std::cerr
           << "StatsObject ViewDataImpl cannot (and should not) be copied. "
              "(Possibly failed to convert to export data type?)";
@@ -191,10 +283,10 @@ ViewDataImpl::ViewDataImpl(const ViewDataImpl& other)
   }
 }
 
-void ViewDataImpl::Merge(const std::vector<std::string>& tag_values,
+bool ViewDataImpl::Merge(const std::vector<std::string>& tag_values,
                          const MeasureData& data, absl::Time now) {
   // A value is set here. Set a start time if it is unset.
-  SetStartTimeIfUnset(tag_values, now);
+  const bool new_row = RowUpdated(tag_values, now);
   switch (type_) {
     case Type::kDouble: {
       if (aggregation_.type() == Aggregation::Type::kSum) {
@@ -233,36 +325,203 @@ void ViewDataImpl::Merge(const std::vector<std::string>& tag_values,
       data.AddToDistribution(&it->second);
       break;
     }
+    case Type::kQuantiles: {
+      DataMap<QuantileSketch>::iterator it = quantile_data_.find(tag_values);
+      if (it == quantile_data_.end()) {
+        it = quantile_data_.emplace_hint(it, tag_values, QuantileSketch());
+      }
+      data.AddToQuantileSketch(&it->second);
+      break;
+    }
     case Type::kStatsObject: {
       DataMap<IntervalStatsObject>::iterator it =
           interval_data_.find(tag_values);
-      if (aggregation_.type() == Aggregation::Type::kDistribution) {
-        const auto& buckets = aggregation_.bucket_boundaries();
-        if (it == interval_data_.end()) {
-          it = interval_data_.emplace_hint(
-              it, std::piecewise_construct, std::make_tuple(tag_values),
-              std::make_tuple(buckets.num_buckets() + 5,
-                              aggregation_window_.duration(), now));
-        }
-        auto window = it->second.MutableCurrentBucket(now);
-        data.AddToDistribution(
-            buckets, &window[0], &window[1], &window[2], &window[3], &window[4],
-            absl::Span<double>(&window[5], buckets.num_buckets()));
+      if (it == interval_data_.end()) {
+        it = interval_data_.emplace_hint(
+            it, std::piecewise_construct, std::make_tuple(tag_values),
+            std::make_tuple(1, aggregation_window_.duration(), now));
+      }
+      if (aggregation_ == Aggregation::Count()) {
+        it->second.MutableCurrentBucket(now)[0] += data.count();
       } else {
-        if (it == interval_data_.end()) {
-          it = interval_data_.emplace_hint(
-              it, std::piecewise_construct, std::make_tuple(tag_values),
-              std::make_tuple(1, aggregation_window_.duration(), now));
-        }
-        if (aggregation_ == Aggregation::Count()) {
-          it->second.MutableCurrentBucket(now)[0] += data.count();
-        } else {
-          it->second.MutableCurrentBucket(now)[0] += data.sum();
-        }
+        it->second.MutableCurrentBucket(now)[0] += data.sum();
+      }
+      break;
+    }
+    case Type::kIntervalDistribution: {
+      DataMap<IntervalDistribution>::iterator it =
+          interval_distribution_data_.find(tag_values);
+      const auto& buckets = aggregation_.bucket_boundaries();
+      if (it == interval_distribution_data_.end()) {
+        it = interval_distribution_data_.emplace_hint(
+            it, std::piecewise_construct, std::make_tuple(tag_values),
+            std::make_tuple(buckets.num_buckets(),
+                            aggregation_window_.duration(), now));
       }
+      IntervalDistribution::MutableBucket bucket =
+          it->second.MutableCurrentBucket(now);
+      IntervalDistribution::Moments* moments = bucket.moments;
+      data.AddToDistribution(buckets, &moments->count, &moments->mean,
+                             &moments->sum_of_squared_deviation, &moments->min,
+                             &moments->max, bucket.histogram_buckets);
+      break;
+    }
+    case Type::kIntervalQuantiles: {
+      DataMap<IntervalQuantiles>::iterator it =
+          interval_quantile_data_.find(tag_values);
+      if (it == interval_quantile_data_.end()) {
+        it = interval_quantile_data_.emplace_hint(
+            it, std::piecewise_construct, std::make_tuple(tag_values),
+            std::make_tuple(aggregation_window_.duration(), now));
+      }
+      data.AddToQuantileSketch(it->second.MutableCurrentBucket(now));
       break;
     }
   }
+  return new_row;
+}
+
+ViewDataImpl::ViewDataImpl(const ViewDataImpl& other,
+                           uint64_t since_generation)
+    : aggregation_(other.aggregation_),
+      aggregation_window_(other.aggregation_window_),
+      type_(other.type_),
+      start_times_(),
+      start_time_(other.start_time_) {
+  switch (type_) {
+    case Type::kDouble: {
+      new (&double_data_) DataMap<double>();
+      break;
+    }
+    case Type::kInt64: {
+      new (&int_data_) DataMap<int64_t>();
+      break;
+    }
+    case Type::kDistribution: {
+      new (&distribution_data_) DataMap<Distribution>();
+      break;
+    }
+    case Type::kQuantiles: {
+      new (&quantile_data_) DataMap<QuantileSketch>();
+      break;
+    }
+    case Type::kStatsObject:
+    case Type::kIntervalDistribution:
+    case Type::kIntervalQuantiles: {
+      std::cerr << "GetChangedRows should not be called on ViewDataImpl for "
+                   "interval stats.";
+      ABSL_ASSERT(0);
+      return;
+    }
+  }
+  for (const RowChange& change : other.changes_) {
+    if (change.generation < since_generation) {
+      break;
+    }
+    const std::vector<std::string>& tag_values = *change.tag_values;
+    start_times_.emplace(tag_values, other.start_times_.at(tag_values));
+    switch (type_) {
+      case Type::kDouble:
+        double_data_.emplace(tag_values, other.double_data_.at(tag_values));
+        break;
+      case Type::kInt64:
+        int_data_.emplace(tag_values, other.int_data_.at(tag_values));
+        break;
+      case Type::kDistribution:
+        distribution_data_.emplace(tag_values,
+                                   other.distribution_data_.at(tag_values));
+        break;
+      case Type::kQuantiles:
+        quantile_data_.emplace(tag_values, other.quantile_data_.at(tag_values));
+        break;
+      case Type::kStatsObject:
+      case Type::kIntervalDistribution:
+      case Type::kIntervalQuantiles:
+        break;
+    }
+  }
+}
+
+bool ViewDataImpl::RowUpdated(const std::vector<std::string>& tag_values,
+                              absl::Time now) {
+  DataMap<absl::Time>::iterator it = start_times_.find(tag_values);
+  const bool new_row = it == start_times_.end();
+  if (new_row) {
+    it = start_times_.emplace_hint(it, tag_values, now);
+  }
+  if (!track_changes_) {
+    return new_row;
+  }
+  const std::vector<std::string>* key = &it->first;
+  const auto position = change_positions_.find(key);
+  if (position == change_positions_.end()) {
+    changes_.push_front({key, generation_, now});
+    change_positions_.emplace(key, changes_.begin());
+  } else {
+    position->second->generation = generation_;
+    position->second->last_updated = now;
+    changes_.splice(changes_.begin(), changes_, position->second);
+  }
+  return new_row;
+}
+
+bool ViewDataImpl::IsStale(const RowChange& change, absl::Time now) const {
+  if (now - change.last_updated >= row_ttl_) {
+    return true;
+  }
+  switch (type_) {
+    case Type::kStatsObject:
+      return interval_data_.at(*change.tag_values).IsEmpty(now);
+    case Type::kIntervalDistribution:
+      return interval_distribution_data_.at(*change.tag_values).IsEmpty(now);
+    case Type::kIntervalQuantiles:
+      return interval_quantile_data_.at(*change.tag_values).IsEmpty(now);
+    default:
+      return false;
+  }
+}
+
+bool ViewDataImpl::HasStaleRows(absl::Time now) const {
+  return !changes_.empty() && IsStale(changes_.back(), now);
+}
+
+int64_t ViewDataImpl::EvictStaleRows(absl::Time now, int64_t max_rows) {
+  int64_t num_evicted = 0;
+  // Rows are ordered by last change, so this stops at the first fresh row.
+  // Interval rows holding only zeros may be kept behind a fresh row until it
+  // is evicted itself.
+  while (num_evicted < max_rows && HasStaleRows(now)) {
+    const std::vector<std::string>* key = changes_.back().tag_values;
+    switch (type_) {
+      case Type::kDouble:
+        double_data_.erase(*key);
+        break;
+      case Type::kInt64:
+        int_data_.erase(*key);
+        break;
+      case Type::kDistribution:
+        distribution_data_.erase(*key);
+        break;
+      case Type::kQuantiles:
+        quantile_data_.erase(*key);
+        break;
+      case Type::kStatsObject:
+        interval_data_.erase(*key);
+        break;
+      case Type::kIntervalDistribution:
+        interval_distribution_data_.erase(*key);
+        break;
+      case Type::kIntervalQuantiles:
+        interval_quantile_data_.erase(*key);
+        break;
+    }
+    change_positions_.erase(key);
+    changes_.pop_back();
+    // Erase by iterator, since 'key' points into the erased element.
+    start_times_.erase(start_times_.find(*key));
+    ++num_evicted;
+  }
+  return num_evicted;
 }
 
 ViewDataImpl::ViewDataImpl(ViewDataImpl* source, absl::Time now)
@@ -287,7 +546,14 @@ ViewDataImpl::ViewDataImpl(ViewDataImpl* source, absl::Time now)
       distribution_data_.swap(source->distribution_data_);
       break;
     }
-    case Type::kStatsObject: {
+    case Type::kQuantiles: {
+      new (&quantile_data_) DataMap<QuantileSketch>();
+      quantile_data_.swap(source->quantile_data_);
+      break;
+    }
+    case Type::kStatsObject:
+    case Type::kIntervalDistribution:
+    case Type::kIntervalQuantiles: {
       std::cerr << "GetDeltaAndReset should not be called on ViewDataImpl for "
                    "interval stats.";
       ABSL_ASSERT(0);
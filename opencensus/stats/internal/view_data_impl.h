@@ -15,6 +15,8 @@
 #ifndef OPENCENSUS_STATS_INTERNAL_VIEW_DATA_IMPL_H_
 #define OPENCENSUS_STATS_INTERNAL_VIEW_DATA_IMPL_H_
 
+#include <cstdint>
+#include <list>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -23,12 +25,15 @@
 #include "absl/base/macros.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "opencensus/common/internal/interval_distribution.h"
 #include "opencensus/common/internal/stats_object.h"
 #include "opencensus/common/internal/string_vector_hash.h"
 #include "opencensus/stats/aggregation.h"
 #include "opencensus/stats/distribution.h"
 #include "opencensus/stats/internal/aggregation_window.h"
+#include "opencensus/stats/internal/interval_quantile_sketch.h"
 #include "opencensus/stats/internal/measure_data.h"
+#include "opencensus/stats/quantile_sketch.h"
 #include "opencensus/stats/view_descriptor.h"
 
 namespace opencensus {
@@ -50,6 +55,8 @@ class ViewDataImpl {
   // opencensus/common/internal/stats_object.h for details)--this balances the
   // precision of estimates against resource use.
   typedef common::StatsObject<4> IntervalStatsObject;
+  typedef common::IntervalDistribution<4> IntervalDistribution;
+  typedef IntervalQuantileSketch<4> IntervalQuantiles;
 
   // Constructs an empty ViewDataImpl for internal use from the descriptor. A
   // ViewData can be constructed directly from such a ViewDataImpl for
@@ -58,9 +65,10 @@ class ViewDataImpl {
   ViewDataImpl(absl::Time start_time, const ViewDescriptor& descriptor);
   // Constructs a ViewDataImpl capturing the state of 'other' at 'now'. Requires
   // 'other' to have an interval aggregation window (and thus type()
-  // kStatsObject).
+  // kStatsObject, kIntervalDistribution, or kIntervalQuantiles).
   ViewDataImpl(const ViewDataImpl& other, absl::Time now);
 
+  // Copies 'other', including the changes tracked for GetChangedRows().
   ViewDataImpl(const ViewDataImpl& other);
   ~ViewDataImpl();
 
@@ -68,6 +76,31 @@ class ViewDataImpl {
   // start_time().
   std::unique_ptr<ViewDataImpl> GetDeltaAndReset(absl::Time now);
 
+  // Returns a copy of only the rows merged into since the call that returned
+  // '*generation' (or of every row, if '*generation' is 0), and sets
+  // '*generation' to pass to the next call. Each caller keeps its own
+  // generation. The work done is proportional to the number of rows returned.
+  // Requires a cumulative aggregation window and tracks_changes().
+  std::unique_ptr<ViewDataImpl> GetChangedRows(uint64_t* generation);
+
+  // Starts or stops tracking which rows change, for GetChangedRows() and
+  // EvictStaleRows(). Rows present when tracking starts count as changed at
+  // 'now'. Tracking costs a list entry per row and work on every merge, so it
+  // is on only while needed: from construction for views with a row TTL and
+  // interval views, and otherwise while GetChangedRows() has a consumer.
+  void TrackChanges(bool track_changes, absl::Time now);
+  bool tracks_changes() const { return track_changes_; }
+
+  // Returns true if EvictStaleRows() would evict any rows at 'now'.
+  bool HasStaleRows(absl::Time now) const;
+
+  // Removes up to 'max_rows' of the least recently merged rows that have not
+  // been merged into for the view's row TTL (see ViewDescriptor::set_row_ttl())
+  // or, for interval views, that hold no data within the interval. Returns the
+  // number of rows removed. The work done is proportional to that number. Only
+  // evicts rows while tracks_changes().
+  int64_t EvictStaleRows(absl::Time now, int64_t max_rows);
+
   const Aggregation& aggregation() const { return aggregation_; }
   const AggregationWindow& aggregation_window() const {
     return aggregation_window_;
@@ -77,7 +110,10 @@ class ViewDataImpl {
     kDouble,
     kInt64,
     kDistribution,
+    kQuantiles,
     kStatsObject,  // Used for aggregating data, should not be exported.
+    kIntervalDistribution,  // Likewise, for interval distributions.
+    kIntervalQuantiles,     // Likewise, for interval quantiles.
   };
   Type type() const { return type_; }
 
@@ -98,10 +134,22 @@ class ViewDataImpl {
     ABSL_ASSERT(type_ == Type::kDistribution);
     return distribution_data_;
   }
+  const DataMap<QuantileSketch>& quantile_data() const {
+    ABSL_ASSERT(type_ == Type::kQuantiles);
+    return quantile_data_;
+  }
   const DataMap<IntervalStatsObject>& interval_data() const {
     ABSL_ASSERT(type_ == Type::kStatsObject);
     return interval_data_;
   }
+  const DataMap<IntervalDistribution>& interval_distribution_data() const {
+    ABSL_ASSERT(type_ == Type::kIntervalDistribution);
+    return interval_distribution_data_;
+  }
+  const DataMap<IntervalQuantiles>& interval_quantile_data() const {
+    ABSL_ASSERT(type_ == Type::kIntervalQuantiles);
+    return interval_quantile_data_;
+  }
 
   // Returns a start time for each timeseries/tag map.
   const DataMap<absl::Time>& start_times() const { return start_times_; }
@@ -111,11 +159,12 @@ class ViewDataImpl {
   // use start_times_ and stop depending on this field.
   absl::Time start_time() const { return start_time_; }
 
-  // Merges bulk data for the given tag values at 'now'. tag_values must be
-  // ordered according to the order of keys in the ViewDescriptor.
+  // Merges bulk data for the given tag values at 'now', returning true if this
+  // added a new row. tag_values must be ordered according to the order of keys
+  // in the ViewDescriptor.
   // TODO: Change to take Span<string_view> when heterogenous lookup is
   // supported.
-  void Merge(const std::vector<std::string>& tag_values,
+  bool Merge(const std::vector<std::string>& tag_values,
              const MeasureData& data, absl::Time now);
 
  private:
@@ -124,15 +173,27 @@ class ViewDataImpl {
   // name in the public API.
   ViewDataImpl(ViewDataImpl* source, absl::Time now);
 
+  // Implements GetChangedRows(), copying the rows of 'other' changed in or
+  // after 'since_generation'.
+  ViewDataImpl(const ViewDataImpl& other, uint64_t since_generation);
+
   Type TypeForDescriptor(const ViewDescriptor& descriptor);
 
-  void SetStartTimeIfUnset(const std::vector<std::string>& tag_values,
-                           absl::Time now) {
-    // If the time is not set.
-    if (start_times_.find(tag_values) == start_times_.end()) {
-      start_times_[tag_values] = now;
-    }
-  }
+  // Sets the start time of the row under 'tag_values' if it is unset, and
+  // records that the row changed in the current generation. Returns true if
+  // the row is new.
+  bool RowUpdated(const std::vector<std::string>& tag_values, absl::Time now);
+
+  // A row, and the generation and time at which it last changed.
+  struct RowChange {
+    // Points to the row's key in start_times_, which is never moved.
+    const std::vector<std::string>* tag_values;
+    uint64_t generation;
+    absl::Time last_updated;
+  };
+
+  // Whether the row of 'change' should be evicted at 'now'.
+  bool IsStale(const RowChange& change, absl::Time now) const;
 
   const Aggregation aggregation_;
   const AggregationWindow aggregation_window_;
@@ -141,7 +202,10 @@ class ViewDataImpl {
     DataMap<double> double_data_;
     DataMap<int64_t> int_data_;
     DataMap<Distribution> distribution_data_;
+    DataMap<QuantileSketch> quantile_data_;
     DataMap<IntervalStatsObject> interval_data_;
+    DataMap<IntervalDistribution> interval_distribution_data_;
+    DataMap<IntervalQuantiles> interval_quantile_data_;
   };
 
   // A start time for each timeseries/tag map.
@@ -151,6 +215,19 @@ class ViewDataImpl {
   // This should be deleted if custom exporters are updated to
   // use start_times_ and stop depending on this field
   absl::Time start_time_;
+
+  const absl::Duration row_ttl_ = absl::InfiniteDuration();
+
+  // Whether changes are tracked for GetChangedRows() and EvictStaleRows() (see
+  // TrackChanges()).
+  bool track_changes_ = false;
+  uint64_t generation_ = 0;
+  // Every row, most recently changed first, so that the rows changed since a
+  // generation are a prefix and the stalest rows are at the end.
+  std::list<RowChange> changes_;
+  std::unordered_map<const std::vector<std::string>*,
+                     std::list<RowChange>::iterator>
+      change_positions_;
 };
 
 }  // namespace stats
@@ -40,6 +40,14 @@ void AddToViewDataImpl(double value, const std::vector<std::string>& tags,
   data->Merge(tags, measure_data, time);
 }
 
+void AddToQuantileViewDataImpl(double value,
+                               const std::vector<std::string>& tags,
+                               absl::Time time, ViewDataImpl* data) {
+  MeasureData measure_data = MeasureData({}, /*keep_sketch=*/true);
+  measure_data.Add(value);
+  data->Merge(tags, measure_data, time);
+}
+
 TEST(ViewDataImplTest, Sum) {
   const absl::Time start_time = absl::UnixEpoch();
   const absl::Time end_time = absl::UnixEpoch() + absl::Seconds(1);
@@ -111,6 +119,33 @@ TEST(ViewDataImplTest, Distribution) {
               ::testing::ElementsAre(0, 1));
 }
 
+TEST(ViewDataImplTest, Quantiles) {
+  const absl::Time start_time = absl::UnixEpoch();
+  const auto descriptor =
+      ViewDescriptor().set_aggregation(Aggregation::Quantiles({0.5}));
+  ViewDataImpl data(start_time, descriptor);
+  const std::vector<std::string> tags1({"value1", "value2a"});
+  const std::vector<std::string> tags2({"value1", "value2b"});
+
+  for (int i = 1; i <= 100; ++i) {
+    AddToQuantileViewDataImpl(i, tags1, start_time, &data);
+  }
+  AddToQuantileViewDataImpl(-5, tags2, start_time, &data);
+
+  ASSERT_EQ(ViewDataImpl::Type::kQuantiles, data.type());
+  EXPECT_EQ(2, data.quantile_data().size());
+  const QuantileSketch& sketch1 = data.quantile_data().at(tags1);
+  EXPECT_EQ(100, sketch1.count());
+  EXPECT_EQ(5050, sketch1.sum());
+  EXPECT_NEAR(50, sketch1.Quantile(0.5),
+              50 * QuantileSketch::kRelativeAccuracy);
+  EXPECT_EQ(-5, data.quantile_data().at(tags2).Quantile(0.5));
+
+  // Copies keep the sketches.
+  const ViewDataImpl copy(data);
+  EXPECT_EQ(100, copy.quantile_data().at(tags1).count());
+}
+
 TEST(ViewDataImplTest, LastValueDouble) {
   const absl::Time start_time = absl::UnixEpoch();
   const absl::Time end_time = absl::UnixEpoch() + absl::Seconds(1);
@@ -163,6 +198,159 @@ TEST(ViewDataImplTest, LastValueInt64) {
                                               ::testing::Pair(tags2, 15)));
 }
 
+TEST(ViewDataImplTest, GetChangedRows) {
+  const absl::Time start_time = absl::UnixEpoch();
+  const absl::Time time = start_time + absl::Seconds(1);
+  const auto descriptor = ViewDescriptor().set_aggregation(Aggregation::Sum());
+  ViewDataImpl data(start_time, descriptor);
+  EXPECT_FALSE(data.tracks_changes());
+  data.TrackChanges(true, start_time);
+  const std::vector<std::string> tags1({"value1"});
+  const std::vector<std::string> tags2({"value2"});
+  const std::vector<std::string> tags3({"value3"});
+
+  AddToViewDataImpl(1, tags1, start_time, {}, &data);
+  AddToViewDataImpl(2, tags2, start_time, {}, &data);
+  uint64_t generation_a = 0;
+  const auto changed_a1 = data.GetChangedRows(&generation_a);
+  EXPECT_THAT(changed_a1->double_data(),
+              ::testing::UnorderedElementsAre(::testing::Pair(tags1, 1),
+                                              ::testing::Pair(tags2, 2)));
+
+  AddToViewDataImpl(3, tags1, time, {}, &data);
+  AddToViewDataImpl(4, tags3, time, {}, &data);
+  uint64_t generation_b = 0;
+  const auto changed_a2 = data.GetChangedRows(&generation_a);
+  const auto changed_b1 = data.GetChangedRows(&generation_b);
+  EXPECT_EQ(start_time, changed_a2->start_time());
+  EXPECT_EQ(start_time, changed_a2->start_times().at(tags1));
+  EXPECT_EQ(time, changed_a2->start_times().at(tags3));
+  EXPECT_EQ(2, changed_a2->start_times().size());
+  EXPECT_THAT(changed_a2->double_data(),
+              ::testing::UnorderedElementsAre(::testing::Pair(tags1, 4),
+                                              ::testing::Pair(tags3, 4)));
+  // Each caller tracks its own generation.
+  EXPECT_THAT(changed_b1->double_data(),
+              ::testing::UnorderedElementsAre(::testing::Pair(tags1, 4),
+                                              ::testing::Pair(tags2, 2),
+                                              ::testing::Pair(tags3, 4)));
+
+  EXPECT_TRUE(data.GetChangedRows(&generation_a)->double_data().empty());
+  AddToViewDataImpl(1, tags2, time, {}, &data);
+  EXPECT_THAT(data.GetChangedRows(&generation_b)->double_data(),
+              ::testing::UnorderedElementsAre(::testing::Pair(tags2, 3)));
+}
+
+TEST(ViewDataImplTest, TrackChangesStartsWithEveryRow) {
+  const absl::Time start_time = absl::UnixEpoch();
+  const auto descriptor = ViewDescriptor().set_aggregation(Aggregation::Sum());
+  ViewDataImpl data(start_time, descriptor);
+  const std::vector<std::string> tags1({"value1"});
+  const std::vector<std::string> tags2({"value2"});
+
+  AddToViewDataImpl(1, tags1, start_time, {}, &data);
+  AddToViewDataImpl(2, tags2, start_time, {}, &data);
+  data.TrackChanges(true, start_time);
+  uint64_t generation = 0;
+  EXPECT_THAT(data.GetChangedRows(&generation)->double_data(),
+              ::testing::UnorderedElementsAre(::testing::Pair(tags1, 1),
+                                              ::testing::Pair(tags2, 2)));
+  AddToViewDataImpl(3, tags1, start_time, {}, &data);
+  EXPECT_THAT(data.GetChangedRows(&generation)->double_data(),
+              ::testing::UnorderedElementsAre(::testing::Pair(tags1, 4)));
+
+  data.TrackChanges(false, start_time);
+  EXPECT_FALSE(data.tracks_changes());
+  AddToViewDataImpl(1, tags2, start_time, {}, &data);
+  // Restarting counts every row as changed again.
+  data.TrackChanges(true, start_time);
+  EXPECT_THAT(data.GetChangedRows(&generation)->double_data(),
+              ::testing::UnorderedElementsAre(::testing::Pair(tags1, 4),
+                                              ::testing::Pair(tags2, 3)));
+}
+
+TEST(ViewDataImplTest, CopyKeepsChangedRows) {
+  const absl::Time start_time = absl::UnixEpoch();
+  const auto descriptor = ViewDescriptor().set_aggregation(Aggregation::Sum());
+  ViewDataImpl data(start_time, descriptor);
+  data.TrackChanges(true, start_time);
+  const std::vector<std::string> tags1({"value1"});
+  const std::vector<std::string> tags2({"value2"});
+
+  AddToViewDataImpl(1, tags1, start_time, {}, &data);
+  uint64_t generation = 0;
+  data.GetChangedRows(&generation);
+  AddToViewDataImpl(2, tags2, start_time, {}, &data);
+
+  ViewDataImpl copy(data);
+  AddToViewDataImpl(3, tags1, start_time, {}, &copy);
+  uint64_t generation_copy = generation;
+  EXPECT_THAT(copy.GetChangedRows(&generation_copy)->double_data(),
+              ::testing::UnorderedElementsAre(::testing::Pair(tags1, 4),
+                                              ::testing::Pair(tags2, 2)));
+  // The original is unaffected.
+  EXPECT_THAT(data.GetChangedRows(&generation)->double_data(),
+              ::testing::UnorderedElementsAre(::testing::Pair(tags2, 2)));
+}
+
+TEST(ViewDataImplTest, EvictStaleRows) {
+  const absl::Time start_time = absl::UnixEpoch();
+  const auto descriptor = ViewDescriptor()
+                              .set_aggregation(Aggregation::Sum())
+                              .set_row_ttl(absl::Seconds(10));
+  ViewDataImpl data(start_time, descriptor);
+  const std::vector<std::string> tags1({"value1"});
+  const std::vector<std::string> tags2({"value2"});
+  const std::vector<std::string> tags3({"value3"});
+
+  AddToViewDataImpl(1, tags1, start_time, {}, &data);
+  AddToViewDataImpl(2, tags2, start_time + absl::Seconds(5), {}, &data);
+  AddToViewDataImpl(3, tags1, start_time + absl::Seconds(8), {}, &data);
+  EXPECT_FALSE(data.HasStaleRows(start_time + absl::Seconds(12)));
+  EXPECT_EQ(0, data.EvictStaleRows(start_time + absl::Seconds(12), 10));
+
+  EXPECT_EQ(1, data.EvictStaleRows(start_time + absl::Seconds(16), 10));
+  EXPECT_THAT(data.double_data(),
+              ::testing::UnorderedElementsAre(::testing::Pair(tags1, 4)));
+  EXPECT_EQ(1, data.start_times().size());
+
+  AddToViewDataImpl(4, tags3, start_time + absl::Seconds(16), {}, &data);
+  const absl::Time time = start_time + absl::Seconds(30);
+  EXPECT_EQ(1, data.EvictStaleRows(time, 1));
+  EXPECT_THAT(data.double_data(),
+              ::testing::UnorderedElementsAre(::testing::Pair(tags3, 4)));
+  EXPECT_TRUE(data.HasStaleRows(time));
+  EXPECT_EQ(1, data.EvictStaleRows(time, 1));
+  EXPECT_TRUE(data.double_data().empty());
+  EXPECT_TRUE(data.start_times().empty());
+
+  // Evicted rows start over when recorded to again.
+  AddToViewDataImpl(5, tags1, time, {}, &data);
+  EXPECT_EQ(time, data.start_times().at(tags1));
+  uint64_t generation = 0;
+  EXPECT_THAT(data.GetChangedRows(&generation)->double_data(),
+              ::testing::UnorderedElementsAre(::testing::Pair(tags1, 5)));
+}
+
+// Interval views evict empty rows even without a row TTL.
+TEST(ViewDataImplTest, EvictEmptyIntervalRows) {
+  const absl::Duration interval = absl::Minutes(1);
+  const absl::Time start_time = absl::UnixEpoch();
+  auto descriptor = ViewDescriptor().set_aggregation(Aggregation::Count());
+  SetAggregationWindow(AggregationWindow::Interval(interval), &descriptor);
+  ViewDataImpl data(start_time, descriptor);
+  const std::vector<std::string> tags1({"value1"});
+  const std::vector<std::string> tags2({"value2"});
+
+  AddToViewDataImpl(1, tags1, start_time, {}, &data);
+  AddToViewDataImpl(1, tags2, start_time + 1.5 * interval, {}, &data);
+  EXPECT_EQ(0, data.EvictStaleRows(start_time + interval / 2, 10));
+  EXPECT_EQ(1, data.EvictStaleRows(start_time + 2 * interval, 10));
+  EXPECT_THAT(data.interval_data(),
+              ::testing::ElementsAre(::testing::Key(tags2)));
+  EXPECT_EQ(1, data.start_times().size());
+}
+
 TEST(ViewDataImplTest, StatsObjectToCount) {
   const absl::Duration interval = absl::Minutes(1);
   const absl::Time start_time = absl::UnixEpoch();
@@ -301,6 +489,41 @@ TEST(ViewDataImplTest, StatsObjectToDistribution) {
   EXPECT_THAT(distribution_2_2.bucket_counts(), ::testing::ElementsAre(0, 0));
 }
 
+TEST(ViewDataImplTest, IntervalQuantiles) {
+  const absl::Duration interval = absl::Minutes(1);
+  const absl::Time start_time = absl::UnixEpoch();
+  absl::Time time = start_time;
+  auto descriptor = ViewDescriptor().set_aggregation(Aggregation::Quantiles());
+  SetAggregationWindow(AggregationWindow::Interval(interval), &descriptor);
+  ViewDataImpl data(start_time, descriptor);
+  ASSERT_EQ(ViewDataImpl::Type::kIntervalQuantiles, data.type());
+  const std::vector<std::string> tags({"value1"});
+
+  AddToQuantileViewDataImpl(5, tags, time, &data);
+  time += interval / 2;
+  AddToQuantileViewDataImpl(15, tags, time, &data);
+
+  const ViewDataImpl export_data1(data, time);
+  ASSERT_EQ(ViewDataImpl::Type::kQuantiles, export_data1.type());
+  const QuantileSketch& sketch1 = export_data1.quantile_data().at(tags);
+  EXPECT_EQ(2, sketch1.count());
+  EXPECT_EQ(20, sketch1.sum());
+  EXPECT_EQ(5, sketch1.min());
+  EXPECT_EQ(15, sketch1.max());
+
+  // The first value leaves the window.
+  time += interval;
+  const ViewDataImpl export_data2(data, time);
+  const QuantileSketch& sketch2 = export_data2.quantile_data().at(tags);
+  EXPECT_EQ(1, sketch2.count());
+  EXPECT_EQ(15, sketch2.Quantile(0.5));
+
+  // Both leave it, and the row is evicted.
+  time += interval;
+  EXPECT_EQ(0, ViewDataImpl(data, time).quantile_data().at(tags).count());
+  EXPECT_EQ(1, data.EvictStaleRows(time, 10));
+}
+
 }  // namespace
 }  // namespace stats
 }  // namespace opencensus
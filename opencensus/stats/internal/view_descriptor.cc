@@ -34,6 +34,8 @@
 namespace opencensus {
 namespace stats {
 
+constexpr char ViewDescriptor::kOverflowTagValue[];
+
 // TODO: NICETH: Allow inserting views without an id (autogenerating one
 // based on measure/aggregation/columns).
 // TODO: FIXME: Distinguish never-set values, and add an IsValid()
@@ -74,6 +76,16 @@ ViewDescriptor& ViewDescriptor::set_description(absl::string_view description) {
   return *this;
 }
 
+ViewDescriptor& ViewDescriptor::set_max_rows(int64_t max_rows) {
+  max_rows_ = max_rows;
+  return *this;
+}
+
+ViewDescriptor& ViewDescriptor::set_row_ttl(absl::Duration row_ttl) {
+  row_ttl_ = row_ttl;
+  return *this;
+}
+
 void ViewDescriptor::RegisterForExport() const {
   if (aggregation_window_.type() == AggregationWindow::Type::kCumulative) {
     StatsExporterImpl::Get()->AddView(*this);
@@ -93,14 +105,19 @@ std::string ViewDescriptor::DebugString() const {
                     [](std::string* out, opencensus::tags::TagKey key) {
                       return out->append(key.name());
                     }),
-      "\n  description: \"", description_, "\"");
+      "\n  description: \"", description_, "\"",
+      max_rows_ == 0 ? "" : absl::StrCat("\n  max rows: ", max_rows_),
+      row_ttl_ == absl::InfiniteDuration()
+          ? ""
+          : absl::StrCat("\n  row TTL: ", absl::FormatDuration(row_ttl_)));
 }
 
 bool ViewDescriptor::operator==(const ViewDescriptor& other) const {
   return name_ == other.name_ && measure_id_ == other.measure_id_ &&
          aggregation_ == other.aggregation_ &&
          aggregation_window_ == other.aggregation_window_ &&
-         columns_ == other.columns_ && description_ == other.description_;
+         columns_ == other.columns_ && description_ == other.description_ &&
+         max_rows_ == other.max_rows_ && row_ttl_ == other.row_ttl_;
 }
 
 }  // namespace stats
@@ -0,0 +1,153 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// IWYU pragma: private, include "opencensus/stats/stats.h"
+// IWYU pragma: friend opencensus/stats/.*
+
+#ifndef OPENCENSUS_STATS_QUANTILE_SKETCH_H_
+#define OPENCENSUS_STATS_QUANTILE_SKETCH_H_
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
+
+namespace opencensus {
+namespace stats {
+
+// Forward declarations of friends.
+template <uint16_t N>
+class IntervalQuantileSketch;
+namespace testing {
+class TestUtils;
+}
+
+// A QuantileSketch summarizes a stream of double values for estimating their
+// quantiles within a bounded relative error, in the manner of DDSketch
+// (https://arxiv.org/abs/1908.10693). Each value v is counted in a
+// logarithmically sized bucket, index ceil(log_gamma(|v|)) for the constant
+// growth_factor() gamma, and is estimated by a point within
+// kRelativeAccuracy of every value in that bucket. Negative values are counted
+// in mirrored buckets, and values too close to zero in a single zero bucket.
+//
+// Adding a value takes constant time, and sketches merge exactly. Memory is
+// bounded: once the buckets of one sign span more than kMaxBuckets, those of
+// the smallest magnitudes collapse together, losing accuracy only for the
+// values of those magnitudes.
+//
+// QuantileSketch is thread-compatible.
+class QuantileSketch final {
+ public:
+  // The maximum relative error of Quantile() for values that have not been
+  // collapsed.
+  static constexpr double kRelativeAccuracy = 0.01;
+  // The maximum number of buckets kept for each sign. At the default accuracy,
+  // this covers magnitudes over 17 orders of magnitude.
+  static constexpr int kMaxBuckets = 2048;
+
+  uint64_t count() const { return count_; }
+  double sum() const { return sum_; }
+  double min() const { return min_; }
+  double max() const { return max_; }
+
+  // Returns an estimate of the 'q'-quantile (0 <= q <= 1) of the values, or NaN
+  // if there are none. The estimate is within [min(), max()], and is exact for
+  // q = 0 and q = 1.
+  double Quantile(double q) const;
+
+  // The bucket layout, for exporting the sketch as a histogram. Positive bucket
+  // 'i', counted in positive_bucket_counts()[i - positive_offset()], covers
+  // (growth_factor()^(i-1), growth_factor()^i]. Negative buckets mirror these.
+  static double growth_factor();
+  int32_t positive_offset() const { return positive_.offset(); }
+  absl::Span<const uint64_t> positive_bucket_counts() const {
+    return positive_.counts();
+  }
+  int32_t negative_offset() const { return negative_.offset(); }
+  absl::Span<const uint64_t> negative_bucket_counts() const {
+    return negative_.counts();
+  }
+  // The count of values of magnitude below the smallest bucket, and of NaNs.
+  uint64_t zero_count() const { return zero_count_; }
+
+  // A string representation of the sketch suitable for human consumption.
+  std::string DebugString() const;
+
+ private:
+  friend class ViewDataImpl;  // ViewDataImpl populates data directly.
+  friend class MeasureData;
+  template <uint16_t N>
+  friend class IntervalQuantileSketch;
+  friend class testing::TestUtils;
+
+  QuantileSketch() = default;
+
+  // Adds 'value'. Infinite values are counted in the outermost bucket of their
+  // sign so far, and NaNs as zero.
+  void Add(double value);
+
+  // Adds the values of 'other'.
+  void Merge(const QuantileSketch& other);
+
+  // Adds 'portion' (in [0, 1]) of each bucket count of 'other', rounded down,
+  // as if that portion of its values had been added. This is used to
+  // interpolate the oldest bucket of interval windows.
+  void MergePortion(const QuantileSketch& other, double portion);
+
+  // The bucket counts of one sign, indexed from offset().
+  struct Store {
+    // Adds 'n' to bucket 'index', extending the range of buckets as needed
+    // and collapsing the lowest buckets beyond kMaxBuckets.
+    void Add(int32_t index, uint64_t n);
+
+    int32_t offset() const { return base + begin; }
+    absl::Span<const uint64_t> counts() const {
+      return absl::MakeConstSpan(buckets.data() + begin, end - begin);
+    }
+
+    // Makes buckets 'low' through 'high' the range in use. Buckets entering
+    // the range must be zero. When they do not fit, the range is reallocated
+    // with as much slack again, split between both ends, so that extending
+    // it in either direction takes amortized constant time.
+    void Resize(int32_t low, int32_t high);
+
+    // buckets[i] counts bucket 'base + i'. Only [begin, end) is in use; the
+    // rest is zeroed slack.
+    int32_t base = 0;
+    int32_t begin = 0;
+    int32_t end = 0;
+    std::vector<uint64_t> buckets;
+  };
+
+  // The index of the bucket for 'magnitude', which must be positive and
+  // finite.
+  static int32_t IndexForMagnitude(double magnitude);
+  // The estimate of values in bucket 'index'.
+  static double MagnitudeForIndex(int32_t index);
+
+  uint64_t count_ = 0;
+  double sum_ = 0;
+  double min_ = std::numeric_limits<double>::infinity();
+  double max_ = -std::numeric_limits<double>::infinity();
+  uint64_t zero_count_ = 0;
+  Store positive_;
+  Store negative_;
+};
+
+}  // namespace stats
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_STATS_QUANTILE_SKETCH_H_
@@ -0,0 +1,41 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// IWYU pragma: private, include "opencensus/stats/stats.h"
+// IWYU pragma: friend opencensus/stats/.*
+
+#ifndef OPENCENSUS_STATS_ROW_LIMITS_H_
+#define OPENCENSUS_STATS_ROW_LIMITS_H_
+
+#include <cstdint>
+
+namespace opencensus {
+namespace stats {
+
+// Limits the total number of rows across the data of all views; 0 (the
+// default) means no limit. Once the limit is reached, data for any new row is
+// merged into its view's overflow row (see ViewDescriptor::set_max_rows()).
+// This also limits the number of distinct rows buffered between the periodic
+// merges of recorded data into views; data for tag maps that would add further
+// rows goes to the overflow rows. Tags that no view uses don't count.
+//
+// Every merge into an overflow row instead of a new row is counted under the
+// "opencensus.io/stats/dropped_rows" measure, which can be viewed like any
+// other measure. Counts are recorded one merge (about 5 seconds) late.
+void SetMaxTotalViewRows(int64_t max_rows);
+
+}  // namespace stats
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_STATS_ROW_LIMITS_H_
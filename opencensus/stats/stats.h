@@ -23,7 +23,9 @@
 #include "opencensus/stats/measure.h"             // IWYU pragma: export
 #include "opencensus/stats/measure_descriptor.h"  // IWYU pragma: export
 #include "opencensus/stats/measure_registry.h"    // IWYU pragma: export
+#include "opencensus/stats/quantile_sketch.h"     // IWYU pragma: export
 #include "opencensus/stats/recording.h"           // IWYU pragma: export
+#include "opencensus/stats/row_limits.h"          // IWYU pragma: export
 #include "opencensus/stats/stats_exporter.h"      // IWYU pragma: export
 #include "opencensus/stats/tag_key.h"             // IWYU pragma: export
 #include "opencensus/stats/tag_set.h"             // IWYU pragma: export
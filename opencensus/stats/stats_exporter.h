@@ -54,6 +54,19 @@ class StatsExporter final {
     virtual ~Handler() = default;
     virtual void ExportViewData(
         const std::vector<std::pair<ViewDescriptor, ViewData>>& data) = 0;
+
+    // Handlers that override this to return true are passed, for each
+    // cumulative view, only the rows recorded to since the previous export,
+    // with their cumulative values; views with no such rows are left out.
+    // Views with other aggregation windows are passed in full. The first
+    // export after such a handler is registered, and after a view is
+    // registered, passes every row.
+    virtual bool ExportChangedRowsOnly() const { return false; }
+
+    // Called before each export on handlers that export changed rows only.
+    // Returning true passes every row in that export, e.g. to resend rows after
+    // earlier exports may have been lost.
+    virtual bool NeedsAllRows() { return false; }
   };
 
   // Registers a new handler. Every few seconds, each registered handler will be
@@ -52,11 +52,15 @@ ViewData TestUtils::MakeViewDataWithStartTimes(
   std::vector<BucketBoundaries> boundaries = {
       descriptor.aggregation().bucket_boundaries()};
   for (const auto& view_value : view_values) {
-    MeasureData measure_data = MeasureData(boundaries);
+    MeasureData measure_data = MeasureData(
+        boundaries,
+        descriptor.aggregation().type() == Aggregation::Type::kQuantiles);
     measure_data.Add(view_value.value);
     impl->Merge(view_value.tag_values, measure_data, view_value.start_time);
   }
-  if (impl->type() == ViewDataImpl::Type::kStatsObject) {
+  if (impl->type() == ViewDataImpl::Type::kStatsObject ||
+      impl->type() == ViewDataImpl::Type::kIntervalDistribution ||
+      impl->type() == ViewDataImpl::Type::kIntervalQuantiles) {
     return ViewData(absl::make_unique<ViewDataImpl>(*impl, absl::UnixEpoch()));
   } else {
     return ViewData(std::move(impl));
@@ -73,6 +77,20 @@ void TestUtils::AddToDistribution(Distribution* distribution, double value) {
   distribution->Add(value);
 }
 
+// static
+QuantileSketch TestUtils::MakeQuantileSketch() { return QuantileSketch(); }
+
+// static
+void TestUtils::AddToQuantileSketch(QuantileSketch* sketch, double value) {
+  sketch->Add(value);
+}
+
+// static
+void TestUtils::MergeQuantileSketch(QuantileSketch* sketch,
+                                    const QuantileSketch& other) {
+  sketch->Merge(other);
+}
+
 // static
 void TestUtils::Flush() { DeltaProducer::Get()->Flush(); }
 
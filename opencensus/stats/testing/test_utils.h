@@ -23,6 +23,7 @@
 #include "opencensus/stats/bucket_boundaries.h"
 #include "opencensus/stats/distribution.h"
 #include "opencensus/stats/internal/view_data_impl.h"
+#include "opencensus/stats/quantile_sketch.h"
 #include "opencensus/stats/view_data.h"
 
 namespace opencensus {
@@ -53,6 +54,13 @@ class TestUtils final {
 
   static void AddToDistribution(Distribution* distribution, double value);
 
+  static QuantileSketch MakeQuantileSketch();
+
+  static void AddToQuantileSketch(QuantileSketch* sketch, double value);
+
+  static void MergeQuantileSketch(QuantileSketch* sketch,
+                                  const QuantileSketch& other);
+
   // Flushes the DeltaProducer, propagating recorded stats to views.
   static void Flush();
 
@@ -18,6 +18,10 @@
 #ifndef OPENCENSUS_STATS_VIEW_H_
 #define OPENCENSUS_STATS_VIEW_H_
 
+#include <atomic>
+#include <cstdint>
+
+#include "absl/types/optional.h"
 #include "opencensus/stats/internal/stats_manager.h"
 #include "opencensus/stats/view_data.h"
 #include "opencensus/stats/view_descriptor.h"
@@ -56,8 +60,19 @@ class View {
   const ViewDescriptor& descriptor() { return descriptor_; }
 
  private:
+  friend class StatsExporterImpl;  // Allowed to call GetChangedData().
+
+  // Returns a snapshot of only the rows recorded to since the call that set
+  // '*generation' (or of every row, if '*generation' is 0), and updates
+  // '*generation' for the next call. Returns absl::nullopt if the view is not
+  // cumulative; use GetData() instead. Changed rows are tracked from the
+  // first call until the View is destroyed.
+  absl::optional<ViewData> GetChangedData(uint64_t* generation);
+
   const ViewDescriptor descriptor_;
   StatsManager::ViewInformation* const handle_;
+  // Whether this View is registered as a consumer of changed rows.
+  std::atomic<bool> changed_rows_consumer_{false};
 };
 
 }  // namespace stats
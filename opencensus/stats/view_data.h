@@ -30,6 +30,7 @@
 #include "opencensus/common/internal/string_vector_hash.h"
 #include "opencensus/stats/aggregation.h"
 #include "opencensus/stats/distribution.h"
+#include "opencensus/stats/quantile_sketch.h"
 
 namespace opencensus {
 namespace stats {
@@ -41,7 +42,8 @@ class TestUtils;
 }
 
 // ViewData is an immutable snapshot of data for a particular View, aggregated
-// according to the View's Aggregation and AggregationWindow.
+// according to the View's Aggregation and AggregationWindow. Copies share the
+// same underlying data, so copying a ViewData is cheap.
 class ViewData {
  public:
   // Maps a vector of tag values (corresponding to the columns of the
@@ -57,6 +59,7 @@ class ViewData {
     kDouble,
     kInt64,
     kDistribution,
+    kQuantiles,
   };
   Type type() const;
 
@@ -68,6 +71,7 @@ class ViewData {
   const DataMap<double>& double_data() const;
   const DataMap<int64_t>& int_data() const;
   const DataMap<Distribution>& distribution_data() const;
+  const DataMap<QuantileSketch>& quantile_data() const;
 
   // DEPRECATED: Returns a start time for the view data.
   absl::Time start_time() const;
@@ -85,9 +89,9 @@ class ViewData {
  private:
   friend class View;  // Allowed to call the private constructor.
   friend class testing::TestUtils;
-  explicit ViewData(std::unique_ptr<ViewDataImpl> data);
+  explicit ViewData(std::shared_ptr<const ViewDataImpl> data);
 
-  const std::unique_ptr<ViewDataImpl> impl_;
+  const std::shared_ptr<const ViewDataImpl> impl_;
   const absl::Time end_time_;
 };
 
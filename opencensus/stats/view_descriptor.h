@@ -24,6 +24,7 @@
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "opencensus/stats/aggregation.h"
 #include "opencensus/stats/internal/aggregation_window.h"
 #include "opencensus/stats/measure_descriptor.h"
@@ -82,6 +83,26 @@ class ViewDescriptor final {
   ViewDescriptor& set_description(absl::string_view description);
   const std::string& description() const { return description_; }
 
+  // Limits the number of rows (distinct combinations of column values) in the
+  // view's data. Once the view has 'max_rows' rows, data for any new row is
+  // merged into a single overflow row whose column values are all
+  // kOverflowTagValue. 0 (the default) means no limit. See also
+  // SetMaxTotalViewRows() in row_limits.h.
+  ViewDescriptor& set_max_rows(int64_t max_rows);
+  int64_t max_rows() const { return max_rows_; }
+
+  // Evicts rows that have not been recorded to for 'row_ttl' from the view's
+  // data. Eviction happens when recorded data is periodically merged into
+  // views, so rows may outlive the TTL by a few seconds. The default,
+  // absl::InfiniteDuration(), keeps rows for the life of the view. Interval
+  // views, with or without a row TTL, also evict rows that hold no data within
+  // the interval.
+  ViewDescriptor& set_row_ttl(absl::Duration row_ttl);
+  absl::Duration row_ttl() const { return row_ttl_; }
+
+  // The value of every column in a view's overflow row.
+  static constexpr char kOverflowTagValue[] = "__overflow__";
+
   //////////////////////////////////////////////////////////////////////////////
   // View registration
 
@@ -113,6 +134,8 @@ class ViewDescriptor final {
   AggregationWindow aggregation_window_;
   std::vector<opencensus::tags::TagKey> columns_;
   std::string description_;
+  int64_t max_rows_ = 0;
+  absl::Duration row_ttl_ = absl::InfiniteDuration();
 };
 
 }  // namespace stats
@@ -25,7 +25,7 @@ namespace tags {
 class ContextPeer {
  public:
   static const TagMap& GetTagMapFromContext(const Context& ctx) {
-    return ctx.tags_;
+    return *ctx.tags_;
   }
 };
 
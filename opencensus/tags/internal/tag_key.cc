@@ -15,20 +15,26 @@
 #include "opencensus/tags/tag_key.h"
 
 #include <cstdint>
-#include <memory>
 #include <string>
-#include <unordered_map>
-#include <utility>
-#include <vector>
 
+#include "absl/base/attributes.h"
 #include "absl/base/thread_annotations.h"
-#include "absl/memory/memory.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "opencensus/common/internal/append_only_table.h"
 
 namespace opencensus {
 namespace tags {
 
+namespace {
+
+// The registered names, indexed by TagKey id. Readers need no lock, and
+// references to names remain valid forever.
+ABSL_CONST_INIT common::AppendOnlyTable<const std::string> tag_key_names;
+
+}  // namespace
+
 class TagKeyRegistry {
  public:
   static TagKeyRegistry* Get() {
@@ -38,34 +44,36 @@ class TagKeyRegistry {
 
   TagKey Register(absl::string_view name) ABSL_LOCKS_EXCLUDED(mu_);
 
-  const std::string& TagKeyName(TagKey key) const ABSL_LOCKS_EXCLUDED(mu_) {
-    absl::ReaderMutexLock l(&mu_);
-    return *registered_tag_keys_[key.id_];
+  static const std::string& TagKeyName(TagKey key) {
+    return *tag_key_names[key.id_];
   }
 
  private:
+  // Serializes registration, and so appends to tag_key_names.
   mutable absl::Mutex mu_;
-  // The registered tag keys. Tag key ids are indices into this vector.  Strings
-  // are allocated individually so that they don't move around when the vector
-  // storage moves due to resize.
-  std::vector<std::unique_ptr<std::string>> registered_tag_keys_
+  // A map from names to IDs. Keys point into the names in tag_key_names, so
+  // lookups by string_view neither copy nor allocate.
+  absl::flat_hash_map<absl::string_view, uint64_t> id_map_
       ABSL_GUARDED_BY(mu_);
-  // A map from names to IDs.
-  // TODO: change to string_view when a suitable hash is available.
-  std::unordered_map<std::string, uint64_t> id_map_ ABSL_GUARDED_BY(mu_);
 };
 
 TagKey TagKeyRegistry::Register(absl::string_view name) {
+  {
+    absl::ReaderMutexLock l(&mu_);
+    const auto it = id_map_.find(name);
+    if (it != id_map_.end()) {
+      return TagKey(it->second);
+    }
+  }
   absl::MutexLock l(&mu_);
-  const std::string string_name(name);
-  const auto it = id_map_.find(string_name);
-  if (it == id_map_.end()) {
-    const uint64_t id = registered_tag_keys_.size();
-    registered_tag_keys_.emplace_back(absl::make_unique<std::string>(name));
-    id_map_.emplace_hint(it, string_name, id);
-    return TagKey(id);
+  const auto it = id_map_.find(name);
+  if (it != id_map_.end()) {
+    return TagKey(it->second);
   }
-  return TagKey(it->second);
+  const std::string* stored_name = new std::string(name);
+  const uint64_t id = tag_key_names.Append(stored_name);
+  id_map_.emplace(*stored_name, id);
+  return TagKey(id);
 }
 
 TagKey TagKey::Register(absl::string_view name) {
@@ -73,7 +81,15 @@ TagKey TagKey::Register(absl::string_view name) {
 }
 
 const std::string& TagKey::name() const {
-  return TagKeyRegistry::Get()->TagKeyName(*this);
+  return TagKeyRegistry::TagKeyName(*this);
+}
+
+constexpr uint64_t StaticTagKey::kUnregistered;
+
+TagKey StaticTagKey::RegisterSlow() const {
+  const TagKey key = TagKey::Register(name_);
+  id_.store(key.id_, std::memory_order_release);
+  return key;
 }
 
 }  // namespace tags
@@ -0,0 +1,63 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/tags/tag_key.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace opencensus {
+namespace tags {
+namespace {
+
+void BM_TagKeyName(benchmark::State& state) {
+  const TagKey key = TagKey::Register("key");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(key.name());
+  }
+}
+BENCHMARK(BM_TagKeyName)->ThreadRange(1, 16);
+
+void BM_TagKeyNameManyKeys(benchmark::State& state) {
+  for (int i = 0; i < state.range(0); ++i) {
+    TagKey::Register(absl::StrCat("many_keys_", i));
+  }
+  const TagKey key = TagKey::Register("last_key");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(key.name());
+  }
+}
+BENCHMARK(BM_TagKeyNameManyKeys)->Range(1, 1 << 14);
+
+void BM_TagKeyRegisterExisting(benchmark::State& state) {
+  TagKey::Register("existing_key");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(TagKey::Register("existing_key"));
+  }
+}
+BENCHMARK(BM_TagKeyRegisterExisting)->ThreadRange(1, 16);
+
+void BM_StaticTagKey(benchmark::State& state) {
+  static constexpr StaticTagKey kKey("static_key");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(kKey.key());
+  }
+}
+BENCHMARK(BM_StaticTagKey)->ThreadRange(1, 16);
+
+}  // namespace
+}  // namespace tags
+}  // namespace opencensus
+
+BENCHMARK_MAIN();
@@ -14,6 +14,10 @@
 
 #include "opencensus/tags/tag_key.h"
 
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "absl/hash/hash.h"
 #include "absl/strings/str_cat.h"
 #include "gtest/gtest.h"
@@ -53,6 +57,36 @@ TEST(TagKeyTest, GrowRegistry) {
   }
 }
 
+TEST(TagKeyTest, ConcurrentRegistration) {
+  std::vector<std::thread> threads;
+  std::vector<TagKey> keys(8, TagKey::Register("placeholder"));
+  for (size_t t = 0; t < keys.size(); ++t) {
+    threads.emplace_back([t, &keys]() {
+      for (int i = 0; i < 200; ++i) {
+        TagKey::Register(absl::StrCat("concurrent_", t, "_", i));
+      }
+      keys[t] = TagKey::Register("concurrent_shared");
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const TagKey& key : keys) {
+    EXPECT_EQ(keys[0], key);
+    EXPECT_EQ("concurrent_shared", key.name());
+  }
+  EXPECT_EQ("concurrent_3_150",
+            TagKey::Register("concurrent_3_150").name());
+}
+
+TEST(TagKeyTest, StaticTagKey) {
+  static constexpr StaticTagKey kKey("static_key");
+  EXPECT_EQ("static_key", kKey.name());
+  EXPECT_EQ(TagKey::Register("static_key"), kKey.key());
+  EXPECT_EQ(kKey.key(), kKey.key());
+  EXPECT_EQ("static_key", kKey.key().name());
+}
+
 }  // namespace
 }  // namespace tags
 }  // namespace opencensus
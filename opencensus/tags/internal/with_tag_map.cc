@@ -27,25 +27,26 @@ namespace opencensus {
 namespace tags {
 
 WithTagMap::WithTagMap(const TagMap& tags, bool cond)
-    : swapped_tags_(tags)
+    : tags_(&tags)
 #ifndef NDEBUG
       ,
       original_context_(Context::InternalMutableCurrent())
 #endif
       ,
       cond_(cond) {
-  ConditionalSwap();
+  Install();
 }
 
 WithTagMap::WithTagMap(TagMap&& tags, bool cond)
-    : swapped_tags_(std::move(tags))
+    : owned_tags_(std::move(tags)),
+      tags_(&*owned_tags_)
 #ifndef NDEBUG
       ,
       original_context_(Context::InternalMutableCurrent())
 #endif
       ,
       cond_(cond) {
-  ConditionalSwap();
+  Install();
 }
 
 WithTagMap::~WithTagMap() {
@@ -54,13 +55,19 @@ WithTagMap::~WithTagMap() {
          "WithTagMap must be destructed on the same thread as it was "
          "constructed.");
 #endif
-  ConditionalSwap();
+  if (cond_) {
+    Context* ctx = Context::InternalMutableCurrent();
+    assert(ctx->tags_ == tags_ &&
+           "WithTagMap must be destructed in LIFO order.");
+    ctx->tags_ = prev_tags_;
+  }
 }
 
-void WithTagMap::ConditionalSwap() {
+void WithTagMap::Install() {
   if (cond_) {
-    using std::swap;
-    swap(Context::InternalMutableCurrent()->tags_, swapped_tags_);
+    Context* ctx = Context::InternalMutableCurrent();
+    prev_tags_ = ctx->tags_;
+    ctx->tags_ = tags_;
   }
 }
 
@@ -15,6 +15,7 @@
 #include "opencensus/tags/with_tag_map.h"
 
 #include <cstdlib>
+#include <functional>
 
 #include "benchmark/benchmark.h"
 #include "opencensus/tags/tag_key.h"
@@ -48,6 +49,32 @@ void BM_WithTagMapCopyConditionFalse(benchmark::State& state) {
 }
 BENCHMARK(BM_WithTagMapCopyConditionFalse);
 
+// Installs a chain of nested WithTagMaps, as a deep call stack would.
+void BM_WithTagMapNested(benchmark::State& state) {
+  const auto tags = Tags();
+  const int depth = state.range(0);
+  std::function<void(int)> nest = [&](int n) {
+    if (n == 0) return;
+    WithTagMap wt(tags);
+    nest(n - 1);
+  };
+  for (auto _ : state) {
+    nest(depth);
+  }
+}
+BENCHMARK(BM_WithTagMapNested)->Arg(1)->Arg(8)->Arg(64);
+
+// For comparison with the above: the copy that installing a TagMap into the
+// context used to cost on every scope entry.
+void BM_TagMapCopy(benchmark::State& state) {
+  const auto tags = Tags();
+  for (auto _ : state) {
+    TagMap copy(tags);
+    benchmark::DoNotOptimize(copy);
+  }
+}
+BENCHMARK(BM_TagMapCopy);
+
 void BM_TagMapConstruct(benchmark::State& state) {
   for (auto _ : state) {
     auto tags = Tags();
@@ -27,7 +27,7 @@ namespace context {
 class ContextTestPeer {
  public:
   static const opencensus::tags::TagMap& CurrentTags() {
-    return Context::InternalMutableCurrent()->tags_;
+    return *Context::InternalMutableCurrent()->tags_;
   }
 };
 }  // namespace context
@@ -15,11 +15,13 @@
 #ifndef OPENCENSUS_TAGS_TAG_KEY_H_
 #define OPENCENSUS_TAGS_TAG_KEY_H_
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <string>
 
 #include "absl/base/macros.h"
+#include "absl/base/optimization.h"
 #include "absl/hash/hash.h"
 #include "absl/strings/string_view.h"
 
@@ -35,6 +37,8 @@ class TagKey final {
   // equal TagKeys.
   static TagKey Register(absl::string_view name);
 
+  // Returns the name the key was registered with. This does not lock; the
+  // returned reference remains valid for the lifetime of the process.
   const std::string& name() const;
 
   bool operator==(TagKey other) const { return id_ == other.id_; }
@@ -53,12 +57,52 @@ class TagKey final {
   }
 
  private:
+  friend class StaticTagKey;
   friend class TagKeyRegistry;
   explicit TagKey(uint64_t id) : id_(id) {}
 
   uint64_t id_;
 };
 
+// StaticTagKey declares a TagKey without dynamic initialization, so that keys
+// can be constexpr globals or function-local statics:
+//
+//   constexpr StaticTagKey kMethodKey("method");
+//   ...
+//   TagMap tags({{kMethodKey.key(), "GET"}});
+//
+// The key is registered on the first call to key(); subsequent calls are a
+// single atomic load. 'name' must outlive the StaticTagKey, which is the case
+// for string literals.
+class StaticTagKey final {
+ public:
+  constexpr explicit StaticTagKey(absl::string_view name)
+      : name_(name), id_(kUnregistered) {}
+
+  TagKey key() const {
+    const uint64_t id = id_.load(std::memory_order_acquire);
+    if (ABSL_PREDICT_FALSE(id == kUnregistered)) {
+      return RegisterSlow();
+    }
+    return TagKey(id);
+  }
+
+  absl::string_view name() const { return name_; }
+
+ private:
+  static constexpr uint64_t kUnregistered = ~uint64_t{0};
+
+  StaticTagKey(const StaticTagKey&) = delete;
+  StaticTagKey& operator=(const StaticTagKey&) = delete;
+
+  TagKey RegisterSlow() const;
+
+  const absl::string_view name_;
+  // The registered id, or kUnregistered. Registration is idempotent, so racing
+  // first calls store the same value.
+  mutable std::atomic<uint64_t> id_;
+};
+
 }  // namespace tags
 }  // namespace opencensus
 
@@ -15,6 +15,7 @@
 #ifndef OPENCENSUS_TAGS_WITH_TAG_MAP_H_
 #define OPENCENSUS_TAGS_WITH_TAG_MAP_H_
 
+#include "absl/types/optional.h"
 #include "opencensus/context/context.h"
 #include "opencensus/tags/tag_map.h"
 
@@ -29,6 +30,11 @@ namespace tags {
 // a WithTagMap in one thread and deallocate in another. A simple way to ensure
 // this is to only ever stack-allocate it.
 //
+// WithTagMap does not copy the TagMap: the current context refers to the given
+// TagMap until the WithTagMap is destroyed, so it must outlive the WithTagMap
+// and must not be assigned to in the meantime. A TagMap passed by rvalue is
+// moved into the WithTagMap.
+//
 // Example usage:
 // {
 //   WithTagMap wt(tags);
@@ -47,9 +53,14 @@ class WithTagMap {
   WithTagMap& operator=(const WithTagMap&) = delete;
   WithTagMap& operator=(WithTagMap&&) = delete;
 
-  void ConditionalSwap();
+  void Install();
 
-  TagMap swapped_tags_;
+  // Only engaged when constructed from an rvalue TagMap.
+  absl::optional<TagMap> owned_tags_;
+  // The TagMap installed in the current context.
+  const TagMap* const tags_;
+  // The previously installed TagMap, restored on destruction.
+  const TagMap* prev_tags_;
 #ifndef NDEBUG
   const ::opencensus::context::Context* original_context_;
 #endif
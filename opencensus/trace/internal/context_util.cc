@@ -25,7 +25,7 @@ namespace trace {
 class ContextPeer {
  public:
   static const Span& GetSpanFromContext(const Context& ctx) {
-    return ctx.span_;
+    return *ctx.span_;
   }
 };
 
@@ -15,6 +15,8 @@
 #include "opencensus/trace/internal/local_span_store_impl.h"
 
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <queue>
 #include <string>
@@ -40,6 +42,10 @@ namespace exporter {
 
 namespace {
 constexpr int kMaxSpans = 128;
+// Record-only spans kept per span name in each latency bucket and for errors.
+constexpr int kMaxRecordOnlySpansPerBucket = 8;
+// Record-only spans of further names are dropped.
+constexpr int kMaxRecordOnlySpanNames = 256;
 
 using ErrorFilter = LocalSpanStore::ErrorFilter;
 using LatencyBucketBoundary = LocalSpanStore::LatencyBucketBoundary;
@@ -101,25 +107,69 @@ void LocalSpanStoreImpl::AddSpan(const std::shared_ptr<SpanImpl>& span) {
   spans_.emplace_front(span->ToSpanData());
 }
 
+void LocalSpanStoreImpl::AddRecordOnlySpan(SpanData&& span) {
+  const LatencyBucketBoundary bucket =
+      GetLatencyBucketBoundary(span.end_time() - span.start_time());
+  const bool ok = span.status().ok();
+  std::string name(span.name());
+  absl::MutexLock l(&record_only_mu_);
+  auto it = record_only_spans_.find(name);
+  if (it == record_only_spans_.end()) {
+    if (record_only_spans_.size() >= kMaxRecordOnlySpanNames) {
+      return;
+    }
+    it = record_only_spans_.emplace(std::move(name), RecordOnlySpans()).first;
+  }
+  std::deque<SpanData>& spans =
+      ok ? it->second.latency[bucket] : it->second.errors;
+  if (spans.size() >= kMaxRecordOnlySpansPerBucket) {
+    spans.pop_back();  // Make room.
+  }
+  spans.emplace_front(std::move(span));
+}
+
+void LocalSpanStoreImpl::VisitRecordOnlySpans(
+    const std::function<bool(const SpanData&)>& visit) const {
+  absl::MutexLock l(&record_only_mu_);
+  for (const auto& name_spans : record_only_spans_) {
+    for (const auto& spans : name_spans.second.latency) {
+      for (const auto& span : spans) {
+        if (!visit(span)) return;
+      }
+    }
+    for (const auto& span : name_spans.second.errors) {
+      if (!visit(span)) return;
+    }
+  }
+}
+
 Summary LocalSpanStoreImpl::GetSummary() const {
   Summary summary;
-  absl::MutexLock l(&mu_);
-  for (const auto& span : spans_) {
+  auto add_to_summary = [&summary](const SpanData& span) {
     PerSpanNameSummary& curr = GetPerSpanNameSummary(span.name(), &summary);
     const absl::Duration latency = span.end_time() - span.start_time();
     MapIncrement(GetLatencyBucketBoundary(latency),
                  &curr.number_of_latency_sampled_spans);
     MapIncrement(span.status().CanonicalCode(),
                  &curr.number_of_error_sampled_spans);
+    return true;
+  };
+  {
+    absl::MutexLock l(&mu_);
+    for (const auto& span : spans_) {
+      add_to_summary(span);
+    }
   }
+  VisitRecordOnlySpans(add_to_summary);
   return summary;
 }
 
 std::vector<SpanData> LocalSpanStoreImpl::GetLatencySampledSpans(
     const LatencyFilter& filter) const {
   std::vector<SpanData> out;
-  absl::MutexLock l(&mu_);
-  for (const auto& span : spans_) {
+  // Returns false once enough spans have been found.
+  auto collect = [&filter, &out](const SpanData& span) {
+    if (out.size() >= filter.max_spans_to_return) return false;
     uint64_t latency_ns =
         (span.end_time() - span.start_time()) / absl::Nanoseconds(1);
     if ((filter.span_name.empty() || (span.name() == filter.span_name)) &&
@@ -127,34 +177,60 @@ std::vector<SpanData> LocalSpanStoreImpl::GetLatencySampledSpans(
         latency_ns < filter.upper_latency_ns) {
       out.emplace_back(span);
     }
-    if (out.size() >= filter.max_spans_to_return) break;
+    return true;
+  };
+  {
+    absl::MutexLock l(&mu_);
+    for (const auto& span : spans_) {
+      if (!collect(span)) break;
+    }
   }
+  VisitRecordOnlySpans(collect);
   return out;
 }
 
 std::vector<SpanData> LocalSpanStoreImpl::GetErrorSampledSpans(
     const ErrorFilter& filter) const {
   std::vector<SpanData> out;
-  absl::MutexLock l(&mu_);
-  for (const auto& span : spans_) {
+  // Returns false once enough spans have been found.
+  auto collect = [&filter, &out](const SpanData& span) {
+    if (out.size() >= filter.max_spans_to_return) return false;
     if ((filter.span_name.empty() || (span.name() == filter.span_name)) &&
         filter.canonical_code == span.status().CanonicalCode()) {
       out.emplace_back(span);
     }
-    if (out.size() >= filter.max_spans_to_return) break;
+    return true;
+  };
+  {
+    absl::MutexLock l(&mu_);
+    for (const auto& span : spans_) {
+      if (!collect(span)) break;
+    }
   }
+  VisitRecordOnlySpans(collect);
   return out;
 }
 
 std::vector<SpanData> LocalSpanStoreImpl::GetSpans() const {
-  absl::MutexLock l(&mu_);
-  std::vector<SpanData> out(spans_.begin(), spans_.end());
+  std::vector<SpanData> out;
+  {
+    absl::MutexLock l(&mu_);
+    out.assign(spans_.begin(), spans_.end());
+  }
+  VisitRecordOnlySpans([&out](const SpanData& span) {
+    out.emplace_back(span);
+    return true;
+  });
   return out;
 }
 
 void LocalSpanStoreImpl::ClearForTesting() {
-  absl::MutexLock l(&mu_);
-  spans_.clear();
+  {
+    absl::MutexLock l(&mu_);
+    spans_.clear();
+  }
+  absl::MutexLock l(&record_only_mu_);
+  record_only_spans_.clear();
 }
 
 }  // namespace exporter
@@ -19,6 +19,7 @@
 
 #include <cstdint>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -52,6 +53,13 @@ class LocalSpanStoreImpl {
   // Adds a new running Span. Only Span::End should call this.
   void AddSpan(const std::shared_ptr<SpanImpl>& span) ABSL_LOCKS_EXCLUDED(mu_);
 
+  // Adds an ended record-only Span. These are kept apart from sampled spans,
+  // so that they never evict them, and sampled by name and latency: only the
+  // latest few spans of each name are kept in each latency bucket, and in a
+  // separate bucket for errors. Only RecordOnlySpan::End should call this.
+  void AddRecordOnlySpan(SpanData&& span)
+      ABSL_LOCKS_EXCLUDED(record_only_mu_);
+
   // Returns a summary of the data available in the LocalSpanStore.
   LocalSpanStore::Summary GetSummary() const ABSL_LOCKS_EXCLUDED(mu_);
 
@@ -71,11 +79,28 @@ class LocalSpanStoreImpl {
   // Private so only Get() can call it.
   LocalSpanStoreImpl() {}
 
+  // The record-only spans of one name. Spans with an OK status are kept by
+  // latency, the others in 'errors'.
+  struct RecordOnlySpans {
+    std::deque<SpanData> latency[LocalSpanStore::k100s_plus + 1];
+    std::deque<SpanData> errors;
+  };
+
+  // Calls 'visit' on each record-only span, newest first within a bucket,
+  // until it returns false.
+  void VisitRecordOnlySpans(
+      const std::function<bool(const SpanData&)>& visit) const
+      ABSL_LOCKS_EXCLUDED(record_only_mu_);
+
   // Clears all currently active spans from the store.
-  void ClearForTesting() ABSL_LOCKS_EXCLUDED(mu_);
+  void ClearForTesting() ABSL_LOCKS_EXCLUDED(mu_, record_only_mu_);
 
   mutable absl::Mutex mu_;
   std::deque<SpanData> spans_ ABSL_GUARDED_BY(mu_);
+
+  mutable absl::Mutex record_only_mu_;
+  std::unordered_map<std::string, RecordOnlySpans> record_only_spans_
+      ABSL_GUARDED_BY(record_only_mu_);
 };
 
 }  // namespace exporter
@@ -14,10 +14,14 @@
 
 #include "opencensus/trace/internal/local_span_store.h"
 
+#include <vector>
+
 #include "gtest/gtest.h"
+#include "opencensus/trace/exporter/span_data.h"
 #include "opencensus/trace/internal/local_span_store_impl.h"
 #include "opencensus/trace/sampler.h"
 #include "opencensus/trace/span.h"
+#include "opencensus/trace/status_code.h"
 
 namespace opencensus {
 namespace trace {
@@ -47,6 +51,66 @@ TEST(LocalSpanStoreTest, GetSummary) {
   // number_of_latency_sampled_spans[].
 }
 
+TEST(LocalSpanStoreTest, RecordsNotSampledSpans) {
+  exporter::LocalSpanStoreImplTestPeer::ClearForTesting();
+  static NeverSampler sampler;
+  auto span = Span::StartSpan("SpanName", /*parent=*/nullptr,
+                              {&sampler, {}, /*record_events=*/true});
+  span.AddAnnotation("Annotation");
+  span.SetName("NewName");
+  span.SetStatus(StatusCode::ABORTED, "Aborted");
+  const Span copy = span;
+  span.End();
+  // Calls through copies of an ended Span have no effect, even once another
+  // Span reuses its storage.
+  copy.SetStatus(StatusCode::OK);
+  copy.End();
+  auto other = Span::StartSpan("OtherName", /*parent=*/nullptr,
+                               {&sampler, {}, /*record_events=*/true});
+  copy.SetName("Overwritten");
+  copy.End();
+
+  const std::vector<SpanData> spans = LocalSpanStore::GetSpans();
+  ASSERT_EQ(1, spans.size());
+  EXPECT_EQ("NewName", spans[0].name());
+  EXPECT_EQ(span.context(), spans[0].context());
+  EXPECT_EQ(StatusCode::ABORTED, spans[0].status().CanonicalCode());
+  EXPECT_EQ("Aborted", spans[0].status().error_message());
+  EXPECT_TRUE(spans[0].has_ended());
+  EXPECT_TRUE(spans[0].annotations().events().empty());
+  EXPECT_LE(spans[0].start_time(), spans[0].end_time());
+
+  other.End();
+  EXPECT_EQ(2, LocalSpanStore::GetSpans().size());
+  EXPECT_EQ(1, LocalSpanStore::GetSummary().per_span_name_summary.count(
+                   "OtherName"));
+}
+
+TEST(LocalSpanStoreTest, NotSampledSpansDoNotEvictSampledSpans) {
+  exporter::LocalSpanStoreImplTestPeer::ClearForTesting();
+  static AlwaysSampler always;
+  static NeverSampler never;
+  Span::StartSpan("Sampled", /*parent=*/nullptr, {&always}).End();
+  for (int i = 0; i < 1000; ++i) {
+    auto span = Span::StartSpan("NotSampled", /*parent=*/nullptr,
+                                {&never, {}, /*record_events=*/true});
+    if (i % 2 == 0) span.SetStatus(StatusCode::ABORTED);
+    span.End();
+  }
+
+  const std::vector<SpanData> spans = LocalSpanStore::GetSpans();
+  ASSERT_FALSE(spans.empty());
+  EXPECT_EQ("Sampled", spans[0].name());
+  // Only the latest few not sampled spans are kept per latency bucket, and
+  // both OK and error spans are kept.
+  EXPECT_LT(spans.size(), 100);
+  LocalSpanStore::ErrorFilter filter = {"NotSampled", 1000,
+                                        StatusCode::ABORTED, false};
+  EXPECT_FALSE(LocalSpanStore::GetErrorSampledSpans(filter).empty());
+  filter.canonical_code = StatusCode::OK;
+  EXPECT_FALSE(LocalSpanStore::GetErrorSampledSpans(filter).empty());
+}
+
 }  // namespace
 }  // namespace exporter
 }  // namespace trace
@@ -0,0 +1,171 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/trace/internal/record_only_span.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "opencensus/common/internal/clock.h"
+#include "opencensus/trace/exporter/span_data.h"
+#include "opencensus/trace/exporter/status.h"
+#include "opencensus/trace/internal/local_span_store_impl.h"
+#include "opencensus/trace/internal/span_end_hook.h"
+
+namespace opencensus {
+namespace trace {
+
+namespace {
+
+// Each thread caches up to kMaxThreadCacheSize free RecordOnlySpans, and moves
+// them to and from the shared pool kTransferBatchSize at a time.
+constexpr size_t kMaxThreadCacheSize = 64;
+constexpr size_t kTransferBatchSize = 32;
+
+struct SharedPool {
+  absl::Mutex mu;
+  std::vector<RecordOnlySpan*> free ABSL_GUARDED_BY(mu);
+};
+
+SharedPool* GetSharedPool() {
+  static SharedPool* shared_pool = new SharedPool;
+  return shared_pool;
+}
+
+// Moves up to 'n' elements from the back of 'from' to 'to'.
+void Transfer(size_t n, std::vector<RecordOnlySpan*>* from,
+              std::vector<RecordOnlySpan*>* to) {
+  n = std::min(n, from->size());
+  to->insert(to->end(), from->end() - n, from->end());
+  from->resize(from->size() - n);
+}
+
+class ThreadCache {
+ public:
+  ~ThreadCache() {
+    SharedPool* pool = GetSharedPool();
+    absl::MutexLock l(&pool->mu);
+    Transfer(free_.size(), &free_, &pool->free);
+  }
+
+  // Returns nullptr if there are no free RecordOnlySpans.
+  RecordOnlySpan* Pop() {
+    if (free_.empty()) {
+      SharedPool* pool = GetSharedPool();
+      absl::MutexLock l(&pool->mu);
+      Transfer(kTransferBatchSize, &pool->free, &free_);
+    }
+    if (free_.empty()) {
+      return nullptr;
+    }
+    RecordOnlySpan* span = free_.back();
+    free_.pop_back();
+    return span;
+  }
+
+  void Push(RecordOnlySpan* span) {
+    free_.push_back(span);
+    if (free_.size() > kMaxThreadCacheSize) {
+      SharedPool* pool = GetSharedPool();
+      absl::MutexLock l(&pool->mu);
+      Transfer(kTransferBatchSize, &free_, &pool->free);
+    }
+  }
+
+ private:
+  std::vector<RecordOnlySpan*> free_;
+};
+
+thread_local ThreadCache thread_cache;
+
+}  // namespace
+
+RecordOnlySpan* RecordOnlySpan::Start(const SpanContext& context,
+                                      absl::string_view name,
+                                      const SpanId& parent_span_id,
+                                      bool remote_parent,
+                                      uint32_t* generation) {
+  RecordOnlySpan* span = thread_cache.Pop();
+  if (span == nullptr) {
+    span = new RecordOnlySpan;
+  }
+  absl::MutexLock l(&span->mu_);
+  span->name_.assign(name.data(), name.size());
+  span->context_ = context;
+  span->parent_span_id_ = parent_span_id;
+  span->remote_parent_ = remote_parent;
+  span->start_time_ = common::Clock::Now();
+  span->status_ = exporter::Status();
+  *generation = span->generation_;
+  return span;
+}
+
+void RecordOnlySpan::SetStatus(uint32_t generation,
+                               exporter::Status&& status) {
+  absl::MutexLock l(&mu_);
+  if (generation == generation_) {
+    status_ = std::move(status);
+  }
+}
+
+void RecordOnlySpan::SetName(uint32_t generation, absl::string_view name) {
+  absl::MutexLock l(&mu_);
+  if (generation == generation_) {
+    name_.assign(name.data(), name.size());
+  }
+}
+
+void RecordOnlySpan::End(uint32_t generation) {
+  std::string name;
+  SpanContext context;
+  SpanId parent_span_id;
+  bool remote_parent;
+  absl::Time start_time;
+  exporter::Status status;
+  {
+    absl::MutexLock l(&mu_);
+    if (generation != generation_) {
+      // The Span already ended, ignore this call.
+      return;
+    }
+    ++generation_;
+    name = name_;
+    context = context_;
+    parent_span_id = parent_span_id_;
+    remote_parent = remote_parent_;
+    start_time = start_time_;
+    status = std::move(status_);
+  }
+  const absl::Time end_time = common::Clock::Now();
+  // This object may be reused as soon as it is back in the pool, and the hook
+  // and the store take locks of their own, so neither runs under mu_.
+  thread_cache.Push(this);
+  RunSpanEndHook(name, start_time, end_time, status.CanonicalCode());
+  exporter::LocalSpanStoreImpl::Get()->AddRecordOnlySpan(exporter::SpanData(
+      name, context, parent_span_id,
+      exporter::SpanData::TimeEvents<exporter::Annotation>({}, 0),
+      exporter::SpanData::TimeEvents<exporter::MessageEvent>({}, 0),
+      /*links=*/{}, /*num_links_dropped=*/0, /*attributes=*/{},
+      /*num_attributes_dropped=*/0, /*has_ended=*/true, start_time, end_time,
+      std::move(status), remote_parent));
+}
+
+}  // namespace trace
+}  // namespace opencensus
@@ -0,0 +1,86 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPENCENSUS_TRACE_INTERNAL_RECORD_ONLY_SPAN_H_
+#define OPENCENSUS_TRACE_INTERNAL_RECORD_ONLY_SPAN_H_
+
+#include <cstdint>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "opencensus/trace/exporter/status.h"
+#include "opencensus/trace/span_context.h"
+#include "opencensus/trace/span_id.h"
+
+namespace opencensus {
+namespace trace {
+
+// RecordOnlySpan is the underlying representation of a Span that records events
+// but isn't sampled (see StartSpanOptions::record_events). It keeps only what
+// the LocalSpanStore needs--name, times and status--and drops attributes,
+// annotations, message events and links.
+//
+// RecordOnlySpans are never freed: End() returns them to a pool, with
+// per-thread caches, for reuse by later spans. Each use of a RecordOnlySpan
+// has a generation number, which a Span passes to every call so that calls
+// through copies of an ended Span are ignored even after the RecordOnlySpan
+// has been reused.
+//
+// This is not a public API, please refer to ../span.h.
+//
+// RecordOnlySpan is thread-safe.
+class RecordOnlySpan final {
+ public:
+  RecordOnlySpan(const RecordOnlySpan&) = delete;
+  RecordOnlySpan& operator=(const RecordOnlySpan&) = delete;
+
+  // Takes a RecordOnlySpan from the pool and starts a span in it. Sets
+  // *generation to the generation of this use.
+  static RecordOnlySpan* Start(const SpanContext& context,
+                               absl::string_view name,
+                               const SpanId& parent_span_id,
+                               bool remote_parent, uint32_t* generation);
+
+  void SetStatus(uint32_t generation, exporter::Status&& status)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  void SetName(uint32_t generation, absl::string_view name)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Ends the span, adds it to the LocalSpanStore and returns this object to
+  // the pool.
+  void End(uint32_t generation) ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  RecordOnlySpan() = default;
+
+  absl::Mutex mu_;
+  // Incremented by End(), invalidating outstanding handles.
+  uint32_t generation_ ABSL_GUARDED_BY(mu_) = 0;
+  // Reused between spans, to keep its capacity.
+  std::string name_ ABSL_GUARDED_BY(mu_);
+  SpanContext context_ ABSL_GUARDED_BY(mu_);
+  SpanId parent_span_id_ ABSL_GUARDED_BY(mu_);
+  bool remote_parent_ ABSL_GUARDED_BY(mu_) = false;
+  absl::Time start_time_ ABSL_GUARDED_BY(mu_);
+  exporter::Status status_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace trace
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_TRACE_INTERNAL_RECORD_ONLY_SPAN_H_
@@ -69,7 +69,7 @@ TEST(RunningSpanStoreTest, ForceSamplingViaStartSpanOptions) {
 TEST(RunningSpanStoreTest, ForceSamplingOffViaTraceConfig) {
   // No sampling requested, but trace_params forces it.
   TraceConfig::SetCurrentTraceParams(
-      TraceParams{32, 32, 128, 128, ProbabilitySampler(0.0)});
+      TraceParams{32, 32, 128, 128, ProbabilitySampler(0.0), 0, 0});
   for (int i = 0; i < 1000; ++i) {
     auto span = Span::StartSpan("SpanName");
     EXPECT_FALSE(span.IsSampled());
@@ -14,10 +14,12 @@
 
 #include "opencensus/trace/sampler.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 
 #include "absl/base/attributes.h"
+#include "absl/time/clock.h"
 
 namespace opencensus {
 namespace trace {
@@ -48,6 +50,48 @@ uint64_t CalculateThresholdFromBuffer(const TraceId& trace_id) {
   }
   return res;
 }
+
+// FNV-1a, which is cheap for short strings like span names, and is the same in
+// every process.
+uint32_t HashName(absl::string_view name) {
+  uint32_t hash = 2166136261u;
+  for (const char c : name) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+  }
+  return hash;
+}
+
+constexpr int64_t kNanosPerSecond = 1000000000;
+
+// Converts a rate limit to nanoseconds between tokens, or 0 if unlimited.
+int64_t CalculateInterval(double max_per_second) {
+  if (!(max_per_second > 0)) return 0;
+  // Cap the interval at about 30 years so that it can't overflow.
+  const double interval =
+      std::min(kNanosPerSecond / max_per_second, 1e9 * kNanosPerSecond);
+  return std::max<int64_t>(1, static_cast<int64_t>(interval));
+}
+
+// Takes a token from the bucket whose next token is due at 'next', allowing a
+// burst of one second's worth of tokens.  This is the generic cell rate
+// algorithm: rather than a token count, the bucket keeps the time at which it
+// would be empty, which fits in a single atomic.
+bool TakeToken(std::atomic<int64_t>* next, int64_t interval, int64_t now) {
+  if (interval == 0) return true;
+  const int64_t burst = std::max<int64_t>(0, kNanosPerSecond - interval);
+  int64_t due = next->load(std::memory_order_relaxed);
+  do {
+    if (due - now > burst) return false;
+  } while (!next->compare_exchange_weak(due, std::max(due, now) + interval,
+                                        std::memory_order_relaxed));
+  return true;
+}
+
+// Returns a token taken by TakeToken() that went unused.
+void RefundToken(std::atomic<int64_t>* next, int64_t interval) {
+  if (interval == 0) return;
+  next->fetch_sub(interval, std::memory_order_relaxed);
+}
 }  // namespace
 
 ProbabilitySampler::ProbabilitySampler(double probability)
@@ -65,5 +109,52 @@ bool ProbabilitySampler::ShouldSample(
   return CalculateThresholdFromBuffer(trace_id) <= threshold_;
 }
 
+RateLimitingSampler::RateLimitingSampler(double max_spans_per_second,
+                                         double max_spans_per_second_per_name)
+    : next_(0) {
+  for (auto& next : name_next_) {
+    next.store(0, std::memory_order_relaxed);
+  }
+  SetLimits(max_spans_per_second, max_spans_per_second_per_name);
+}
+
+void RateLimitingSampler::SetLimits(double max_spans_per_second,
+                                    double max_spans_per_second_per_name) {
+  interval_.store(CalculateInterval(max_spans_per_second),
+                  std::memory_order_relaxed);
+  name_interval_.store(CalculateInterval(max_spans_per_second_per_name),
+                       std::memory_order_relaxed);
+}
+
+bool RateLimitingSampler::HasLimits() const {
+  return interval_.load(std::memory_order_relaxed) != 0 ||
+         name_interval_.load(std::memory_order_relaxed) != 0;
+}
+
+bool RateLimitingSampler::ShouldSample(
+    const SpanContext* parent_context, bool has_remote_parent,
+    const TraceId& trace_id ABSL_ATTRIBUTE_UNUSED,
+    const SpanId& span_id ABSL_ATTRIBUTE_UNUSED, absl::string_view name,
+    const std::vector<Span*>& parent_links ABSL_ATTRIBUTE_UNUSED) const {
+  if (parent_context != nullptr && !has_remote_parent) return false;
+  return ShouldSampleAt(name, absl::GetCurrentTimeNanos());
+}
+
+bool RateLimitingSampler::ShouldSampleAt(absl::string_view name,
+                                         int64_t now) const {
+  // Check the per-name limit first, so that a span name over its own limit
+  // doesn't use up the total, and give its token back if the total is used
+  // up, so that the name's limit only counts sampled spans.
+  std::atomic<int64_t>* name_next =
+      &name_next_[HashName(name) % kNumNameLimits];
+  const int64_t name_interval = name_interval_.load(std::memory_order_relaxed);
+  if (!TakeToken(name_next, name_interval, now)) return false;
+  if (!TakeToken(&next_, interval_.load(std::memory_order_relaxed), now)) {
+    RefundToken(name_next, name_interval);
+    return false;
+  }
+  return true;
+}
+
 }  // namespace trace
 }  // namespace opencensus
@@ -15,6 +15,7 @@
 #include <string>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "benchmark/benchmark.h"
 #include "opencensus/trace/sampler.h"
 #include "opencensus/trace/span.h"
@@ -46,6 +47,38 @@ void BM_ProbabilitySampler(benchmark::State& state) {
 }
 BENCHMARK(BM_ProbabilitySampler);
 
+// Argument: the total limit, in spans per second.  A low limit measures the
+// rejecting path, which dominates during traffic spikes; a very high limit
+// measures the sampling path, where threads race to take tokens.
+void BM_RateLimitingSampler(benchmark::State& state) {
+  // Unused:
+  SpanContext parent_context;
+  bool has_remote_parent = true;
+  SpanId span_id;
+  TraceId trace_id;
+  std::vector<Span*> parent_links;
+  // Used:
+  const std::string name = absl::StrCat("MyName", state.thread_index());
+  static RateLimitingSampler* sampler;
+  if (state.thread_index() == 0) {
+    sampler = new RateLimitingSampler(state.range(0), state.range(0));
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        sampler->ShouldSample(&parent_context, has_remote_parent, trace_id,
+                              span_id, name, parent_links));
+  }
+  if (state.thread_index() == 0) {
+    delete sampler;
+  }
+}
+BENCHMARK(BM_RateLimitingSampler)
+    ->Arg(100)
+    ->Arg(1000000000)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
 }  // namespace
 }  // namespace trace
 }  // namespace opencensus
@@ -15,15 +15,34 @@
 #include "opencensus/trace/sampler.h"
 
 #include <atomic>
+#include <cstdint>
 
 #include "absl/strings/str_cat.h"
-#include "absl/time/clock.h"
+#include "absl/strings/string_view.h"
 #include "gtest/gtest.h"
 #include "opencensus/trace/span.h"
 #include "opencensus/trace/trace_params.h"
 
 namespace opencensus {
 namespace trace {
+
+constexpr int64_t kNanosPerMilli = 1000000;
+
+class RateLimitingSamplerTestPeer {
+ public:
+  // Counts how many of 'n' spans named 'name' at 'now_millis' are sampled.
+  static int CountSampled(const RateLimitingSampler& sampler,
+                          absl::string_view name, int n, int64_t now_millis) {
+    int sampled = 0;
+    for (int i = 0; i < n; ++i) {
+      if (sampler.ShouldSampleAt(name, now_millis * kNanosPerMilli)) {
+        ++sampled;
+      }
+    }
+    return sampled;
+  }
+};
+
 namespace {
 
 // Example of a stateful sampler class.
@@ -56,6 +75,80 @@ class SampleEveryNth : public Sampler {
   std::shared_ptr<State> state_;
 };
 
+TEST(SamplerTest, RateLimitingSamplerTotal) {
+  RateLimitingSampler sampler(10, 0);
+  const int64_t t0 = 1000000;
+  // One second's burst.
+  EXPECT_EQ(10, RateLimitingSamplerTestPeer::CountSampled(sampler, "MySpan",
+                                                          1000, t0));
+  // Tokens refill at the limit's rate.
+  EXPECT_EQ(3, RateLimitingSamplerTestPeer::CountSampled(sampler, "MySpan",
+                                                         1000, t0 + 300));
+  // The burst does not grow while idle.
+  EXPECT_EQ(10, RateLimitingSamplerTestPeer::CountSampled(sampler, "MySpan",
+                                                          1000, t0 + 60000));
+}
+
+TEST(SamplerTest, RateLimitingSamplerPerName) {
+  RateLimitingSampler sampler(0, 5);
+  const int64_t t0 = 1000000;
+  // Both names get their own limit (and don't hash to the same one).
+  EXPECT_EQ(5, RateLimitingSamplerTestPeer::CountSampled(sampler, "SpanA",
+                                                         1000, t0));
+  EXPECT_EQ(5, RateLimitingSamplerTestPeer::CountSampled(sampler, "SpanB",
+                                                         1000, t0));
+  EXPECT_EQ(1, RateLimitingSamplerTestPeer::CountSampled(sampler, "SpanA",
+                                                         1000, t0 + 200));
+}
+
+TEST(SamplerTest, RateLimitingSamplerTotalRejectionKeepsNameToken) {
+  // Two spans per second in total, and one per second per name.
+  RateLimitingSampler sampler(2, 1);
+  const int64_t t0 = 1000000;
+  EXPECT_EQ(1,
+            RateLimitingSamplerTestPeer::CountSampled(sampler, "SpanB", 1, t0));
+  EXPECT_EQ(1,
+            RateLimitingSamplerTestPeer::CountSampled(sampler, "SpanC", 1, t0));
+  // The total is used up, so SpanA is not sampled...
+  EXPECT_EQ(0,
+            RateLimitingSamplerTestPeer::CountSampled(sampler, "SpanA", 5, t0));
+  // ...and keeps its own token for when the total has one again.
+  EXPECT_EQ(1, RateLimitingSamplerTestPeer::CountSampled(sampler, "SpanA", 5,
+                                                         t0 + 500));
+}
+
+TEST(SamplerTest, RateLimitingSamplerSamplesSpans) {
+  RateLimitingSampler sampler(10, 0);
+  int sampled = 0;
+  for (int i = 0; i < 1000; ++i) {
+    auto span = Span::StartSpan(absl::StrCat("MySpan", i), nullptr, {&sampler});
+    if (span.IsSampled()) ++sampled;
+  }
+  // At least the burst; only a loop taking many seconds would sample more.
+  EXPECT_GE(sampled, 10);
+  EXPECT_LT(sampled, 100);
+}
+
+TEST(SamplerTest, RateLimitingSamplerSkipsLocalChildren) {
+  RateLimitingSampler sampler(1000, 0);
+  NeverSampler never;
+  auto parent = Span::StartSpan("Parent", nullptr, {&never});
+  ASSERT_FALSE(parent.IsSampled());
+  auto child = Span::StartSpan("Child", &parent, {&sampler});
+  EXPECT_FALSE(child.IsSampled());
+  auto remote_child =
+      Span::StartSpanWithRemoteParent("Child", parent.context(), {&sampler});
+  EXPECT_TRUE(remote_child.IsSampled());
+}
+
+TEST(SamplerTest, RateLimitingSamplerUnlimited) {
+  RateLimitingSampler sampler(0, 0);
+  for (int i = 0; i < 1000; ++i) {
+    auto span = Span::StartSpan("MySpan", nullptr, {&sampler});
+    EXPECT_TRUE(span.IsSampled());
+  }
+}
+
 TEST(SamplerTest, SampleNth) {
   static constexpr int kSampleRate = 4;
   SampleEveryNth sampler(kSampleRate);
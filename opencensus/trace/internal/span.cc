@@ -25,10 +25,11 @@
 #include "opencensus/trace/exporter/message_event.h"
 #include "opencensus/trace/exporter/status.h"
 #include "opencensus/trace/internal/local_span_store_impl.h"
+#include "opencensus/trace/internal/record_only_span.h"
 #include "opencensus/trace/internal/running_span_store.h"
 #include "opencensus/trace/internal/running_span_store_impl.h"
-#include "opencensus/trace/internal/span_exporter_impl.h"
 #include "opencensus/trace/internal/span_impl.h"
+#include "opencensus/trace/internal/tail_sampler_impl.h"
 #include "opencensus/trace/internal/trace_config_impl.h"
 #include "opencensus/trace/sampler.h"
 #include "opencensus/trace/span.h"
@@ -84,20 +85,25 @@ class SpanGenerator {
             parent_ctx, has_remote_parent, trace_id, span_id, name,
             options.parent_links);
       } else {
-        should_sample =
-            TraceConfigImpl::Get()->current_trace_params().sampler.ShouldSample(
-                parent_ctx, has_remote_parent, trace_id, span_id, name,
-                options.parent_links);
+        should_sample = TraceConfigImpl::Get()->ShouldSample(
+            parent_ctx, has_remote_parent, trace_id, span_id, name,
+            options.parent_links);
       }
       trace_options = trace_options.WithSampling(should_sample);
     }
     SpanContext context(trace_id, span_id, trace_options);
     SpanImpl* impl = nullptr;
+    RecordOnlySpan* record_only = nullptr;
+    uint32_t record_only_generation = 0;
     if (trace_options.IsSampled()) {
       // Only Spans that are sampled are backed by a SpanImpl.
       impl =
           new SpanImpl(context, TraceConfigImpl::Get()->current_trace_params(),
                        name, parent_span_id, has_remote_parent);
+    } else if (options.record_events) {
+      record_only =
+          RecordOnlySpan::Start(context, name, parent_span_id,
+                                has_remote_parent, &record_only_generation);
     }
     // Add links.
     for (const auto& parent_link : options.parent_links) {
@@ -108,6 +114,9 @@ class SpanGenerator {
       }
       parent_link->AddChildLink(context);
     }
+    if (record_only != nullptr) {
+      return Span(context, record_only, record_only_generation);
+    }
     return Span(context, impl);
   }
 };
@@ -134,27 +143,33 @@ Span Span::StartSpanWithRemoteParent(absl::string_view name,
 
 Span::Span(const SpanContext& context, SpanImpl* impl)
     : context_(context), span_impl_(impl) {
-  if (IsRecording()) {
+  if (span_impl_ != nullptr) {
     exporter::RunningSpanStoreImpl::Get()->AddSpan(span_impl_);
   }
 }
 
+Span::Span(const SpanContext& context, RecordOnlySpan* record_only,
+           uint32_t record_only_generation)
+    : context_(context),
+      record_only_(record_only),
+      record_only_generation_(record_only_generation) {}
+
 void Span::AddAttribute(absl::string_view key,
                         AttributeValueRef attribute) const {
-  if (IsRecording()) {
+  if (span_impl_ != nullptr) {
     span_impl_->AddAttributes({{key, attribute}});
   }
 }
 
 void Span::AddAttributes(AttributesRef attributes) const {
-  if (IsRecording()) {
+  if (span_impl_ != nullptr) {
     span_impl_->AddAttributes(attributes);
   }
 }
 
 void Span::AddAnnotation(absl::string_view description,
                          AttributesRef attributes) const {
-  if (IsRecording()) {
+  if (span_impl_ != nullptr) {
     span_impl_->AddAnnotation(description, attributes);
   }
 }
@@ -162,7 +177,7 @@ void Span::AddAnnotation(absl::string_view description,
 void Span::AddSentMessageEvent(uint32_t message_id,
                                uint32_t compressed_message_size,
                                uint32_t uncompressed_message_size) const {
-  if (IsRecording()) {
+  if (span_impl_ != nullptr) {
     span_impl_->AddMessageEvent(exporter::MessageEvent::Type::SENT, message_id,
                                 compressed_message_size,
                                 uncompressed_message_size);
@@ -172,7 +187,7 @@ void Span::AddSentMessageEvent(uint32_t message_id,
 void Span::AddReceivedMessageEvent(uint32_t message_id,
                                    uint32_t compressed_message_size,
                                    uint32_t uncompressed_message_size) const {
-  if (IsRecording()) {
+  if (span_impl_ != nullptr) {
     span_impl_->AddMessageEvent(exporter::MessageEvent::Type::RECEIVED,
                                 message_id, compressed_message_size,
                                 uncompressed_message_size);
@@ -181,7 +196,7 @@ void Span::AddReceivedMessageEvent(uint32_t message_id,
 
 void Span::AddParentLink(const SpanContext& parent_ctx,
                          AttributesRef attributes) const {
-  if (IsRecording()) {
+  if (span_impl_ != nullptr) {
     span_impl_->AddLink(parent_ctx, exporter::Link::Type::kParentLinkedSpan,
                         attributes);
   }
@@ -189,7 +204,7 @@ void Span::AddParentLink(const SpanContext& parent_ctx,
 
 void Span::AddChildLink(const SpanContext& child_ctx,
                         AttributesRef attributes) const {
-  if (IsRecording()) {
+  if (span_impl_ != nullptr) {
     span_impl_->AddLink(child_ctx, exporter::Link::Type::kChildLinkedSpan,
                         attributes);
   }
@@ -197,26 +212,33 @@ void Span::AddChildLink(const SpanContext& child_ctx,
 
 void Span::SetStatus(StatusCode canonical_code,
                      absl::string_view message) const {
-  if (IsRecording()) {
+  if (span_impl_ != nullptr) {
     span_impl_->SetStatus(exporter::Status(canonical_code, message));
+  } else if (record_only_ != nullptr) {
+    record_only_->SetStatus(record_only_generation_,
+                            exporter::Status(canonical_code, message));
   }
 }
 
 void Span::SetName(absl::string_view name) const {
-  if (IsRecording()) {
+  if (span_impl_ != nullptr) {
     span_impl_->SetName(name);
+  } else if (record_only_ != nullptr) {
+    record_only_->SetName(record_only_generation_, name);
   }
 }
 
 void Span::End() const {
-  if (IsRecording()) {
+  if (span_impl_ != nullptr) {
     if (!span_impl_->End()) {
       // The Span already ended, ignore this call.
       return;
     }
     exporter::RunningSpanStoreImpl::Get()->RemoveSpan(span_impl_);
     exporter::LocalSpanStoreImpl::Get()->AddSpan(span_impl_);
-    exporter::SpanExporterImpl::Get()->AddSpan(span_impl_);
+    exporter::TailSamplerImpl::Get()->AddSpan(span_impl_);
+  } else if (record_only_ != nullptr) {
+    record_only_->End(record_only_generation_);
   }
 }
 
@@ -224,12 +246,16 @@ const SpanContext& Span::context() const { return context_; }
 
 bool Span::IsSampled() const { return context_.trace_options().IsSampled(); }
 
-bool Span::IsRecording() const { return span_impl_ != nullptr; }
+bool Span::IsRecording() const {
+  return span_impl_ != nullptr || record_only_ != nullptr;
+}
 
 void swap(Span& a, Span& b) {
   using std::swap;
   swap(a.context_, b.context_);
   swap(a.span_impl_, b.span_impl_);
+  swap(a.record_only_, b.record_only_);
+  swap(a.record_only_generation_, b.record_only_generation_);
 }
 
 }  // namespace trace
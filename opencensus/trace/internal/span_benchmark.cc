@@ -15,6 +15,7 @@
 #include "benchmark/benchmark.h"
 #include "opencensus/trace/span.h"
 #include "opencensus/trace/span_context.h"
+#include "opencensus/trace/tail_sampling.h"
 
 namespace {
 
@@ -89,5 +90,37 @@ void BM_StartEndSpanAndSetStatus(benchmark::State& state) {
 }
 BENCHMARK(BM_StartEndSpanAndSetStatus);
 
+void BM_StartEndSpanRecordOnly(benchmark::State& state) {
+  static ::opencensus::trace::NeverSampler sampler;
+  while (state.KeepRunning()) {
+    auto span = ::opencensus::trace::Span::StartSpan(
+        "SpanName", /*parent=*/nullptr,
+        {&sampler, {}, /*record_events=*/true});
+    span.AddAnnotation("This is an annotation.");
+    span.End();
+  }
+}
+BENCHMARK(BM_StartEndSpanRecordOnly)->ThreadRange(1, 16);
+
+// Must run last, since it leaves tail sampling enabled.
+void BM_StartEndTraceTailSampled(benchmark::State& state) {
+  static ::opencensus::trace::AlwaysSampler sampler;
+  static const bool enabled = [] {
+    ::opencensus::trace::TailSamplingParams params;
+    params.probability = 0.01;
+    ::opencensus::trace::TailSampling::Enable(params);
+    return true;
+  }();
+  (void)enabled;
+  while (state.KeepRunning()) {
+    auto root = ::opencensus::trace::Span::StartSpan(
+        "SpanName", /*parent=*/nullptr, {&sampler});
+    auto child = ::opencensus::trace::Span::StartSpan("ChildName", &root);
+    child.End();
+    root.End();
+  }
+}
+BENCHMARK(BM_StartEndTraceTailSampled)->ThreadRange(1, 16);
+
 }  // namespace
 BENCHMARK_MAIN();
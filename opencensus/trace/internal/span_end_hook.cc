@@ -0,0 +1,43 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/trace/internal/span_end_hook.h"
+
+#include <atomic>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "opencensus/trace/status_code.h"
+
+namespace opencensus {
+namespace trace {
+
+namespace {
+std::atomic<SpanEndHook> span_end_hook{nullptr};
+}  // namespace
+
+void SetSpanEndHook(SpanEndHook hook) {
+  span_end_hook.store(hook, std::memory_order_release);
+}
+
+void RunSpanEndHook(absl::string_view name, absl::Time start_time,
+                    absl::Time end_time, StatusCode code) {
+  const SpanEndHook hook = span_end_hook.load(std::memory_order_acquire);
+  if (hook != nullptr) {
+    hook(name, start_time, end_time, code);
+  }
+}
+
+}  // namespace trace
+}  // namespace opencensus
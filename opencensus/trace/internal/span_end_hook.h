@@ -0,0 +1,45 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPENCENSUS_TRACE_INTERNAL_SPAN_END_HOOK_H_
+#define OPENCENSUS_TRACE_INTERNAL_SPAN_END_HOOK_H_
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "opencensus/trace/status_code.h"
+
+namespace opencensus {
+namespace trace {
+
+// A function called as each Span that is recording events ends, with its name,
+// start and end times, and status code. It is called after the Span has ended,
+// outside the Span's lock.
+//
+// This lets libraries that the trace library can't depend on, such as
+// SpanStats (../span_stats.h), derive data from ended Spans. It is not a public
+// API.
+using SpanEndHook = void (*)(absl::string_view name, absl::Time start_time,
+                             absl::Time end_time, StatusCode code);
+
+// Installs 'hook', replacing the previous one. nullptr uninstalls it.
+void SetSpanEndHook(SpanEndHook hook);
+
+// Calls the installed hook, if any.
+void RunSpanEndHook(absl::string_view name, absl::Time start_time,
+                    absl::Time end_time, StatusCode code);
+
+}  // namespace trace
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_TRACE_INTERNAL_SPAN_END_HOOK_H_
@@ -18,8 +18,10 @@
 #include <utility>
 
 #include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
 #include "opencensus/trace/exporter/span_data.h"
 #include "opencensus/trace/exporter/span_exporter.h"
+#include "opencensus/trace/internal/tail_sampler_impl.h"
 
 namespace opencensus {
 namespace trace {
@@ -82,6 +84,10 @@ void SpanExporterImpl::RunWorkerLoop() {
       size = batch_size_;
       next_forced_export_time = absl::Now() + interval_;
     }
+    // Tail-sampled traces whose root never ends are only decided here once no
+    // more spans arrive. Kept spans are added back through AddSpan(), so this
+    // must not hold span_mu_.
+    TailSamplerImpl::Get()->ExpireTraces(absl::Now());
     {
       absl::MutexLock l(&span_mu_);
       cached_batch_size_ = size;
@@ -114,6 +120,7 @@ void SpanExporterImpl::Export(const std::vector<SpanData>& span_data) {
 void SpanExporterImpl::ExportForTesting() {
   std::vector<opencensus::trace::exporter::SpanData> span_data_;
   std::vector<std::shared_ptr<opencensus::trace::SpanImpl>> batch_;
+  TailSamplerImpl::Get()->ExpireTraces(absl::Now());
   {
     absl::MutexLock l(&span_mu_);
     std::swap(batch_, spans_);
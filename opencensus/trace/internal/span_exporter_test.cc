@@ -22,6 +22,7 @@
 #include "opencensus/trace/exporter/span_data.h"
 #include "opencensus/trace/sampler.h"
 #include "opencensus/trace/span.h"
+#include "opencensus/trace/tail_sampling.h"
 
 namespace opencensus {
 namespace trace {
@@ -92,6 +93,30 @@ TEST_F(SpanExporterTest, BasicExportTest) {
   EXPECT_EQ(3, Counter::Get()->value());
 }
 
+TEST_F(SpanExporterTest, ExpiresTailSampledTraceWithoutRoot) {
+  TailSamplingParams params;
+  params.decision_wait = absl::ZeroDuration();
+  params.probability = 1.0;
+  TailSampling::Enable(params);
+  const int before = Counter::Get()->value();
+
+  ::opencensus::trace::AlwaysSampler sampler;
+  ::opencensus::trace::StartSpanOptions opts = {&sampler};
+  auto root = ::opencensus::trace::Span::StartSpan("Root", nullptr, opts);
+  auto child = ::opencensus::trace::Span::StartSpan("Child", &root, opts);
+  child.End();
+
+  // No further span ends, so only the exporter can decide the trace.
+  for (int i = 0; i < 10; ++i) {
+    if (Counter::Get()->value() > before) break;
+    absl::SleepFor(absl::Seconds(1));
+  }
+  EXPECT_EQ(before + 1, Counter::Get()->value());
+
+  TailSampling::Disable();
+  root.End();
+}
+
 }  // namespace
 }  // namespace trace
 }  // namespace opencensus
@@ -15,18 +15,22 @@
 #include "opencensus/trace/internal/span_impl.h"
 
 #include <deque>
+#include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
-#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "opencensus/common/internal/clock.h"
 #include "opencensus/trace/attribute_value_ref.h"
 #include "opencensus/trace/exporter/attribute_value.h"
 #include "opencensus/trace/exporter/message_event.h"
 #include "opencensus/trace/internal/local_span_store_impl.h"
 #include "opencensus/trace/internal/running_span_store_impl.h"
+#include "opencensus/trace/internal/span_end_hook.h"
 #include "opencensus/trace/internal/span_exporter_impl.h"
 #include "opencensus/trace/span.h"
+#include "opencensus/trace/status_code.h"
 
 namespace opencensus {
 namespace trace {
@@ -78,7 +82,7 @@ std::unordered_map<std::string, exporter::AttributeValue> CopyAttributes(
 SpanImpl::SpanImpl(const SpanContext& context, const TraceParams& trace_params,
                    absl::string_view name, const SpanId& parent_span_id,
                    bool remote_parent)
-    : start_time_(absl::Now()),
+    : start_time_(common::Clock::Now()),
       name_(name),
       parent_span_id_(parent_span_id),
       context_(context),
@@ -104,7 +108,7 @@ void SpanImpl::AddAnnotation(absl::string_view description,
   absl::MutexLock l(&mu_);
   if (!has_ended_) {
     annotations_.AddEvent(EventWithTime<exporter::Annotation>(
-        absl::Now(),
+        common::Clock::Now(),
         exporter::Annotation(description, CopyAttributes(attributes))));
   }
 }
@@ -116,7 +120,7 @@ void SpanImpl::AddMessageEvent(exporter::MessageEvent::Type type,
   absl::MutexLock l(&mu_);
   if (!has_ended_) {
     message_events_.AddEvent(EventWithTime<exporter::MessageEvent>(
-        absl::Now(),
+        common::Clock::Now(),
         exporter::MessageEvent(type, message_id, compressed_message_size,
                                uncompressed_message_size)));
   }
@@ -145,14 +149,27 @@ void SpanImpl::SetName(absl::string_view name) {
 }
 
 bool SpanImpl::End() {
-  absl::MutexLock l(&mu_);
-  if (has_ended_) {
-    assert(false && "Invalid attempt to End() the same Span more than once.");
-    // In non-debug builds, just ignore the second End().
-    return false;
+  std::string name;
+  absl::Time start_time;
+  absl::Time end_time;
+  StatusCode code;
+  {
+    absl::MutexLock l(&mu_);
+    if (has_ended_) {
+      assert(false && "Invalid attempt to End() the same Span more than once.");
+      // In non-debug builds, just ignore the second End().
+      return false;
+    }
+    has_ended_ = true;
+    end_time_ = common::Clock::Now();
+    name = name_;
+    start_time = start_time_;
+    end_time = end_time_;
+    code = status_.CanonicalCode();
   }
-  has_ended_ = true;
-  end_time_ = absl::Now();
+  // The hook records stats, which take locks of their own, so it doesn't run
+  // under mu_.
+  RunSpanEndHook(name, start_time, end_time, code);
   return true;
 }
 
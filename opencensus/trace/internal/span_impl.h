@@ -44,6 +44,7 @@ namespace exporter {
 class LocalSpanStoreImpl;
 class RunningSpanStoreImpl;
 class SpanExporterImpl;
+class TailSamplerImpl;
 }  // namespace exporter
 
 class SpanTestPeer;
@@ -103,10 +104,14 @@ class SpanImpl final {
 
   SpanId parent_span_id() const { return parent_span_id_; }
 
+  // Returns true if the parent Span is in a different process.
+  bool remote_parent() const { return remote_parent_; }
+
  private:
   friend class ::opencensus::trace::exporter::RunningSpanStoreImpl;
   friend class ::opencensus::trace::exporter::LocalSpanStoreImpl;
   friend class ::opencensus::trace::exporter::SpanExporterImpl;
+  friend class ::opencensus::trace::exporter::TailSamplerImpl;
   friend class ::opencensus::trace::SpanTestPeer;
 
   // Makes a deep copy of span contents and returns copied data in SpanData.
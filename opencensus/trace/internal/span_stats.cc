@@ -0,0 +1,101 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/trace/span_stats.h"
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "opencensus/stats/stats.h"
+#include "opencensus/tags/tag_key.h"
+#include "opencensus/trace/internal/span_end_hook.h"
+#include "opencensus/trace/status_code.h"
+
+namespace opencensus {
+namespace trace {
+
+namespace {
+
+constexpr char kLatencyMeasureName[] = "opencensus.io/trace/span_latency";
+constexpr char kLatencyViewName[] =
+    "opencensus.io/trace/span_latency/cumulative";
+
+void RecordSpanLatency(absl::string_view name, absl::Time start_time,
+                       absl::Time end_time, StatusCode code) {
+  // Retrieve these once, since SpanStats::Enable() made sure they exist.
+  static const stats::MeasureDouble measure = SpanStats::LatencyMeasure();
+  static const tags::TagKey name_key = SpanStats::SpanNameKey();
+  static const tags::TagKey status_key = SpanStats::SpanStatusKey();
+  stats::Record(
+      {{measure, absl::ToDoubleMilliseconds(end_time - start_time)}},
+      {{name_key, name}, {status_key, StatusCodeToString(code)}});
+}
+
+}  // namespace
+
+void SpanStats::Enable() {
+  // Register the measure and keys before any span can end.
+  LatencyMeasure();
+  SpanNameKey();
+  SpanStatusKey();
+  SetSpanEndHook(&RecordSpanLatency);
+}
+
+void SpanStats::Disable() { SetSpanEndHook(nullptr); }
+
+stats::MeasureDouble SpanStats::LatencyMeasure() {
+  static const stats::MeasureDouble measure = [] {
+    const stats::MeasureDouble registered =
+        stats::MeasureRegistry::GetMeasureDoubleByName(kLatencyMeasureName);
+    if (registered.IsValid()) {
+      return registered;
+    }
+    return stats::MeasureDouble::Register(
+        kLatencyMeasureName, "The latency of ended spans.", "ms");
+  }();
+  return measure;
+}
+
+tags::TagKey SpanStats::SpanNameKey() {
+  static const tags::TagKey key = tags::TagKey::Register("span_name");
+  return key;
+}
+
+tags::TagKey SpanStats::SpanStatusKey() {
+  static const tags::TagKey key = tags::TagKey::Register("span_status");
+  return key;
+}
+
+const stats::ViewDescriptor& SpanStats::LatencyView() {
+  static const stats::ViewDescriptor* const descriptor = [] {
+    // set_measure() requires the measure to be registered.
+    LatencyMeasure();
+    return new stats::ViewDescriptor(
+        stats::ViewDescriptor()
+            .set_name(kLatencyViewName)
+            .set_measure(kLatencyMeasureName)
+            .set_aggregation(stats::Aggregation::Distribution(
+                stats::BucketBoundaries::Explicit({0, 1, 2, 5, 10, 20, 50, 100,
+                                                   200, 500, 1000, 2000, 5000,
+                                                   10000})))
+            .add_column(SpanNameKey())
+            .add_column(SpanStatusKey())
+            .set_description(
+                "Cumulative distribution of span latency in milliseconds, by "
+                "span name and status."));
+  }();
+  return *descriptor;
+}
+
+}  // namespace trace
+}  // namespace opencensus
@@ -0,0 +1,74 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/trace/span_stats.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+#include "opencensus/stats/stats.h"
+#include "opencensus/stats/testing/test_utils.h"
+#include "opencensus/trace/sampler.h"
+#include "opencensus/trace/span.h"
+#include "opencensus/trace/status_code.h"
+
+namespace opencensus {
+namespace trace {
+namespace {
+
+TEST(SpanStatsTest, RecordsLatencyByNameAndStatus) {
+  SpanStats::Enable();
+  stats::View view(SpanStats::LatencyView());
+  ASSERT_TRUE(view.IsValid());
+
+  AlwaysSampler always;
+  NeverSampler never;
+  auto sampled = Span::StartSpan("Sampled", nullptr, {&always});
+  absl::SleepFor(absl::Milliseconds(20));
+  sampled.End();
+  auto recording = Span::StartSpan("Recording", nullptr,
+                                   {&never, {}, /*record_events=*/true});
+  recording.SetStatus(StatusCode::DEADLINE_EXCEEDED);
+  recording.End();
+  // Not recording, so there is no start time.
+  Span::StartSpan("NotRecording", nullptr, {&never}).End();
+
+  stats::testing::TestUtils::Flush();
+  const stats::ViewData data = view.GetData();
+  ASSERT_EQ(2, data.distribution_data().size());
+  const auto sampled_data =
+      data.distribution_data().find(std::vector<std::string>{"Sampled", "OK"});
+  ASSERT_NE(data.distribution_data().end(), sampled_data);
+  EXPECT_EQ(1, sampled_data->second.count());
+  EXPECT_LE(20, sampled_data->second.mean());
+  const auto recording_data = data.distribution_data().find(
+      std::vector<std::string>{"Recording", "DEADLINE_EXCEEDED"});
+  ASSERT_NE(data.distribution_data().end(), recording_data);
+  EXPECT_EQ(1, recording_data->second.count());
+
+  SpanStats::Disable();
+  Span::StartSpan("Sampled", nullptr, {&always}).End();
+  stats::testing::TestUtils::Flush();
+  EXPECT_EQ(1, view.GetData()
+                   .distribution_data()
+                   .find(std::vector<std::string>{"Sampled", "OK"})
+                   ->second.count());
+}
+
+}  // namespace
+}  // namespace trace
+}  // namespace opencensus
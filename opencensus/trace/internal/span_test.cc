@@ -56,6 +56,18 @@ TEST(SpanTest, NotSampledSpan) {
   EXPECT_FALSE(span.IsRecording());
 }
 
+TEST(SpanTest, RecordingNotSampledSpan) {
+  NeverSampler sampler;
+  auto span = Span::StartSpan("MySpan", /*parent=*/nullptr,
+                              {&sampler, {}, /*record_events=*/true});
+  EXPECT_FALSE(span.IsSampled());
+  EXPECT_TRUE(span.IsRecording());
+  auto child = Span::StartSpan("MyChildSpan", &span);
+  EXPECT_FALSE(child.IsRecording()) << "record_events is not inherited.";
+  child.End();
+  span.End();
+}
+
 TEST(SpanTest, ChildInheritsSamplingFromParent) {
   AlwaysSampler sampler;
   auto root_span =
@@ -301,7 +313,7 @@ TEST(SpanTest, ChildInheritsTraceOption) {
 TEST(SpanTest, ForceSamplingOnViaTraceConfig) {
   // No sampling requested, but trace_params forces it.
   TraceConfig::SetCurrentTraceParams(
-      TraceParams{32, 32, 128, 128, ProbabilitySampler(1.0)});
+      TraceParams{32, 32, 128, 128, ProbabilitySampler(1.0), 0, 0});
   for (int i = 0; i < 1000; ++i) {
     auto span = Span::StartSpan("SpanName");
     EXPECT_TRUE(span.IsSampled());
@@ -312,7 +324,7 @@ TEST(SpanTest, ForceSamplingOnViaTraceConfig) {
 TEST(SpanTest, ForceSamplingOffViaTraceConfig) {
   // No sampling requested, but trace_params forces it.
   TraceConfig::SetCurrentTraceParams(
-      TraceParams{32, 32, 128, 128, ProbabilitySampler(0.0)});
+      TraceParams{32, 32, 128, 128, ProbabilitySampler(0.0), 0, 0});
   for (int i = 0; i < 1000; ++i) {
     auto span = Span::StartSpan("SpanName");
     EXPECT_FALSE(span.IsSampled());
@@ -320,6 +332,23 @@ TEST(SpanTest, ForceSamplingOffViaTraceConfig) {
   }
 }
 
+TEST(SpanTest, RateLimitViaTraceConfig) {
+  // Sample everything, but at most 10 spans per second.
+  TraceConfig::SetCurrentTraceParams(
+      TraceParams{32, 32, 128, 128, ProbabilitySampler(1.0), 10, 0});
+  int sampled = 0;
+  for (int i = 0; i < 1000; ++i) {
+    auto span = Span::StartSpan("SpanName");
+    if (span.IsSampled()) ++sampled;
+    span.End();
+  }
+  // Allow for a token or two to refill while the loop runs.
+  EXPECT_GE(sampled, 10);
+  EXPECT_LE(sampled, 12);
+  TraceConfig::SetCurrentTraceParams(
+      TraceParams{32, 32, 128, 128, ProbabilitySampler(1.0), 0, 0});
+}
+
 TEST(SpanTest, CheckSpanData) {
   AlwaysSampler sampler;
   auto current_span = Span::StartSpan("test_span", nullptr, {&sampler});
@@ -0,0 +1,258 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/trace/internal/tail_sampler_impl.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "opencensus/trace/internal/span_exporter_impl.h"
+#include "opencensus/trace/internal/span_impl.h"
+#include "opencensus/trace/span_id.h"
+#include "opencensus/trace/tail_sampling.h"
+#include "opencensus/trace/trace_id.h"
+
+namespace opencensus {
+namespace trace {
+namespace exporter {
+
+namespace {
+
+// Returns true if 'span' is the root of the trace in this process.
+bool IsLocalRoot(const SpanImpl& span) {
+  return !span.parent_span_id().IsValid() || span.remote_parent();
+}
+
+}  // namespace
+
+size_t TailSamplerImpl::TraceIdHash::operator()(
+    const TraceId& trace_id) const {
+  // TraceIds are random, so any 8 bytes of them make a good hash.
+  uint64_t hash;
+  memcpy(&hash, trace_id.Value(), sizeof(hash));
+  return static_cast<size_t>(hash);
+}
+
+TailSamplerImpl* TailSamplerImpl::Get() {
+  static TailSamplerImpl* global_tail_sampler_impl =
+      new TailSamplerImpl([](const std::shared_ptr<SpanImpl>& span) {
+        SpanExporterImpl::Get()->AddSpan(span);
+      });
+  return global_tail_sampler_impl;
+}
+
+TailSamplerImpl::TailSamplerImpl(ExportFunction export_span)
+    : export_span_(std::move(export_span)) {}
+
+void TailSamplerImpl::SetParams(const TailSamplingParams& params) {
+  absl::MutexLock l(&config_mu_);
+  const uint32_t max_spans =
+      std::max<uint32_t>(1, params.max_buffered_spans / kNumStripes);
+  for (Stripe& stripe : stripes_) {
+    ResetStripe(&stripe, absl::make_unique<const Policy>(params, max_spans));
+  }
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+void TailSamplerImpl::ClearParams() {
+  absl::MutexLock l(&config_mu_);
+  enabled_.store(false, std::memory_order_relaxed);
+  for (Stripe& stripe : stripes_) {
+    ResetStripe(&stripe, nullptr);
+  }
+}
+
+void TailSamplerImpl::AddSpan(const std::shared_ptr<SpanImpl>& span,
+                              absl::Time now) {
+  if (!enabled_.load(std::memory_order_relaxed)) {
+    export_span_(span);
+    return;
+  }
+  const TraceId trace_id = span->context().trace_id();
+  Stripe& stripe = StripeFor(trace_id);
+  bool export_now = false;
+  SpanList to_export;
+  {
+    absl::MutexLock l(&stripe.mu);
+    if (stripe.policy == nullptr) {
+      // Disabled since we checked enabled_.
+      export_now = true;
+    } else {
+      ExpireLocked(&stripe, now, &to_export);
+      while (stripe.num_spans >= stripe.policy->max_spans &&
+             DecideOldestLocked(&stripe, absl::InfiniteFuture(), now,
+                                &to_export)) {
+      }
+      const auto decided = stripe.decided.find(trace_id);
+      if (decided != stripe.decided.end()) {
+        export_now = decided->second.keep;
+      } else {
+        auto it = stripe.pending.find(trace_id);
+        if (it == stripe.pending.end()) {
+          it = stripe.pending.emplace(trace_id, PendingTrace()).first;
+          it->second.order = stripe.pending_order.emplace(
+              stripe.pending_order.end(),
+              now + stripe.policy->params.decision_wait, trace_id);
+        }
+        PendingTrace& trace = it->second;
+        trace.spans.push_back(span);
+        ++stripe.num_spans;
+        {
+          absl::MutexLock span_lock(&span->mu_);
+          trace.has_error |= !span->status_.ok();
+        }
+        if (IsLocalRoot(*span)) {
+          DecideLocked(&stripe, it, span.get(), now, &to_export);
+        }
+      }
+    }
+  }
+  if (export_now) {
+    export_span_(span);
+  }
+  for (const auto& kept : to_export) {
+    export_span_(kept);
+  }
+}
+
+void TailSamplerImpl::ExpireTraces(absl::Time now) {
+  for (Stripe& stripe : stripes_) {
+    SpanList to_export;
+    {
+      absl::MutexLock l(&stripe.mu);
+      if (stripe.policy != nullptr) {
+        ExpireLocked(&stripe, now, &to_export);
+      }
+    }
+    for (const auto& kept : to_export) {
+      export_span_(kept);
+    }
+  }
+}
+
+uint32_t TailSamplerImpl::num_buffered_spans() const {
+  uint32_t total = 0;
+  for (const Stripe& stripe : stripes_) {
+    absl::MutexLock l(&stripe.mu);
+    total += stripe.num_spans;
+  }
+  return total;
+}
+
+void TailSamplerImpl::ResetStripe(Stripe* stripe,
+                                  std::unique_ptr<const Policy> policy) {
+  SpanList to_export;
+  {
+    absl::MutexLock l(&stripe->mu);
+    const absl::Time now = absl::Now();
+    while (!stripe->pending.empty()) {
+      DecideLocked(stripe, stripe->pending.begin(), nullptr, now, &to_export);
+    }
+    stripe->decided.clear();
+    stripe->decided_order.clear();
+    stripe->policy = std::move(policy);
+  }
+  for (const auto& kept : to_export) {
+    export_span_(kept);
+  }
+}
+
+void TailSamplerImpl::ExpireLocked(Stripe* stripe, absl::Time now,
+                                   SpanList* to_export) {
+  while (DecideOldestLocked(stripe, now, now, to_export)) {
+  }
+  while (!stripe->decided_order.empty() &&
+         stripe->decided_order.front().first <= now) {
+    stripe->decided.erase(stripe->decided_order.front().second);
+    stripe->decided_order.pop_front();
+  }
+}
+
+bool TailSamplerImpl::DecideOldestLocked(Stripe* stripe, absl::Time deadline,
+                                         absl::Time now, SpanList* to_export) {
+  if (stripe->pending_order.empty() ||
+      stripe->pending_order.front().first > deadline) {
+    return false;
+  }
+  const TraceId oldest = stripe->pending_order.front().second;
+  DecideLocked(stripe, stripe->pending.find(oldest), nullptr, now, to_export);
+  return true;
+}
+
+void TailSamplerImpl::DecideLocked(Stripe* stripe, PendingMap::iterator it,
+                                   const SpanImpl* root, absl::Time now,
+                                   SpanList* to_export) {
+  const TraceId trace_id = it->first;
+  PendingTrace& trace = it->second;
+  const bool keep = ShouldKeep(*stripe->policy, trace_id, trace, root);
+  if (keep) {
+    to_export->insert(to_export->end(),
+                      std::make_move_iterator(trace.spans.begin()),
+                      std::make_move_iterator(trace.spans.end()));
+  }
+  stripe->num_spans -= trace.spans.size();
+  stripe->pending_order.erase(trace.order);
+  stripe->pending.erase(it);
+
+  // Only traces without a decision are pending, and decisions are forgotten
+  // together with their entry in decided_order, so each trace has at most one
+  // entry there and forgetting it cannot drop a newer decision.
+  const auto order = stripe->decided_order.emplace(
+      stripe->decided_order.end(), now + stripe->policy->params.decision_wait,
+      trace_id);
+  stripe->decided.emplace(trace_id, Decision{keep, order});
+  // Bound the decisions kept like the spans, forgetting the oldest first.
+  while (stripe->decided_order.size() > stripe->policy->max_spans) {
+    stripe->decided.erase(stripe->decided_order.front().second);
+    stripe->decided_order.pop_front();
+  }
+}
+
+bool TailSamplerImpl::ShouldKeep(const Policy& policy, const TraceId& trace_id,
+                                 const PendingTrace& trace,
+                                 const SpanImpl* root) {
+  const TailSamplingParams& params = policy.params;
+  if (params.keep_errors && trace.has_error) {
+    return true;
+  }
+  if (root != nullptr) {
+    absl::MutexLock l(&root->mu_);
+    if (root->end_time_ - root->start_time_ >= params.min_root_latency) {
+      return true;
+    }
+    const auto& attributes = root->attributes_.attributes();
+    for (const auto& wanted : params.root_attributes) {
+      const auto found = attributes.find(wanted.first);
+      if (found != attributes.end() && found->second == wanted.second) {
+        return true;
+      }
+    }
+  }
+  return policy.sampler.ShouldSample(/*parent_context=*/nullptr,
+                                     /*has_remote_parent=*/false, trace_id,
+                                     SpanId(), /*name=*/"",
+                                     /*parent_links=*/{});
+}
+
+}  // namespace exporter
+}  // namespace trace
+}  // namespace opencensus
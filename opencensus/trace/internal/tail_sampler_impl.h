@@ -0,0 +1,175 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPENCENSUS_TRACE_INTERNAL_TAIL_SAMPLER_IMPL_H_
+#define OPENCENSUS_TRACE_INTERNAL_TAIL_SAMPLER_IMPL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "opencensus/trace/internal/span_impl.h"
+#include "opencensus/trace/sampler.h"
+#include "opencensus/trace/tail_sampling.h"
+#include "opencensus/trace/trace_id.h"
+
+namespace opencensus {
+namespace trace {
+namespace exporter {
+
+// TailSamplerImpl implements the TailSampling API. Please refer to
+// opencensus/trace/tail_sampling.h for usage.
+//
+// Ended spans are buffered per TraceId in one of kNumStripes independently
+// locked stripes, so that spans of different traces rarely contend. Each stripe
+// holds at most 1/kNumStripes of max_buffered_spans and remembers recent
+// decisions, so that spans ending after their local root follow the root's
+// decision. Expired traces are decided when another span is added to the same
+// stripe, and by ExpireTraces(), which the span exporter calls on every export
+// interval.
+//
+// This class is thread-safe.
+class TailSamplerImpl {
+ public:
+  // Called with each span that is to be exported.
+  using ExportFunction = std::function<void(const std::shared_ptr<SpanImpl>&)>;
+
+  // Returns the global instance of TailSamplerImpl, which exports to
+  // SpanExporterImpl.
+  static TailSamplerImpl* Get();
+
+  explicit TailSamplerImpl(ExportFunction export_span);
+
+  void SetParams(const TailSamplingParams& params);
+  void ClearParams();
+
+  // Passes an ended span on for export, either immediately if tail sampling is
+  // disabled or once its trace has been decided. This is intended to be called
+  // at Span::End().
+  void AddSpan(const std::shared_ptr<SpanImpl>& span) {
+    AddSpan(span, absl::Now());
+  }
+  void AddSpan(const std::shared_ptr<SpanImpl>& span, absl::Time now);
+
+  // Decides all traces whose decision_wait has passed at 'now'.
+  void ExpireTraces(absl::Time now);
+
+  // Returns the number of spans currently held back.
+  uint32_t num_buffered_spans() const;
+
+ private:
+  static constexpr int kNumStripes = 16;
+
+  struct TraceIdHash {
+    size_t operator()(const TraceId& trace_id) const;
+  };
+
+  // The params in effect, and derived state.
+  struct Policy {
+    Policy(const TailSamplingParams& params, uint32_t max_spans)
+        : params(params), sampler(params.probability), max_spans(max_spans) {}
+
+    const TailSamplingParams params;
+    const ProbabilitySampler sampler;
+    // The maximum number of spans and decisions held by each stripe.
+    const uint32_t max_spans;
+  };
+
+  // Traces in order of deadline. Entries are erased together with the trace
+  // or decision they belong to, so the list is never longer than the map.
+  using OrderList = std::list<std::pair<absl::Time, TraceId>>;
+
+  struct PendingTrace {
+    std::vector<std::shared_ptr<SpanImpl>> spans;
+    // The trace's entry in Stripe::pending_order, holding the time at which it
+    // will be decided if its local root hasn't ended.
+    OrderList::iterator order;
+    bool has_error = false;
+  };
+
+  struct Decision {
+    // True if the trace is kept.
+    bool keep;
+    // The decision's entry in Stripe::decided_order, holding the time at which
+    // it will be forgotten.
+    OrderList::iterator order;
+  };
+
+  using SpanList = std::vector<std::shared_ptr<SpanImpl>>;
+  using PendingMap = std::unordered_map<TraceId, PendingTrace, TraceIdHash>;
+  using DecidedMap = std::unordered_map<TraceId, Decision, TraceIdHash>;
+
+  struct Stripe {
+    mutable absl::Mutex mu;
+    // nullptr if tail sampling is disabled.
+    std::unique_ptr<const Policy> policy ABSL_GUARDED_BY(mu);
+    PendingMap pending ABSL_GUARDED_BY(mu);
+    // Undecided traces, in order of deadline.
+    OrderList pending_order ABSL_GUARDED_BY(mu);
+    // Recent decisions, in order of when to forget them.
+    DecidedMap decided ABSL_GUARDED_BY(mu);
+    OrderList decided_order ABSL_GUARDED_BY(mu);
+    // The total number of spans in pending.
+    uint32_t num_spans ABSL_GUARDED_BY(mu) = 0;
+  };
+
+  Stripe& StripeFor(const TraceId& trace_id) {
+    return stripes_[TraceIdHash()(trace_id) % kNumStripes];
+  }
+
+  // Decides every pending trace, then installs 'policy'.
+  void ResetStripe(Stripe* stripe, std::unique_ptr<const Policy> policy)
+      ABSL_LOCKS_EXCLUDED(stripe->mu);
+
+  // Decides expired traces and forgets expired decisions.
+  void ExpireLocked(Stripe* stripe, absl::Time now, SpanList* to_export)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(stripe->mu);
+
+  // Decides the undecided trace with the earliest deadline, if that deadline
+  // is at most 'deadline'. Returns false if there is no such trace.
+  bool DecideOldestLocked(Stripe* stripe, absl::Time deadline, absl::Time now,
+                          SpanList* to_export)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(stripe->mu);
+
+  // Decides the trace at 'it', whose local root is 'root' or nullptr if it
+  // hasn't ended, appending its spans to 'to_export' if it is kept.
+  void DecideLocked(Stripe* stripe, PendingMap::iterator it,
+                    const SpanImpl* root, absl::Time now, SpanList* to_export)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(stripe->mu);
+
+  static bool ShouldKeep(const Policy& policy, const TraceId& trace_id,
+                         const PendingTrace& trace, const SpanImpl* root);
+
+  const ExportFunction export_span_;
+  // Serializes SetParams() and ClearParams().
+  absl::Mutex config_mu_;
+  // Lets AddSpan() skip the stripes while tail sampling is disabled.
+  std::atomic<bool> enabled_{false};
+  Stripe stripes_[kNumStripes];
+};
+
+}  // namespace exporter
+}  // namespace trace
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_TRACE_INTERNAL_TAIL_SAMPLER_IMPL_H_
@@ -0,0 +1,224 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/trace/internal/tail_sampler_impl.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+#include "opencensus/trace/attribute_value_ref.h"
+#include "opencensus/trace/exporter/attribute_value.h"
+#include "opencensus/trace/exporter/status.h"
+#include "opencensus/trace/internal/span_impl.h"
+#include "opencensus/trace/sampler.h"
+#include "opencensus/trace/span_context.h"
+#include "opencensus/trace/span_id.h"
+#include "opencensus/trace/status_code.h"
+#include "opencensus/trace/tail_sampling.h"
+#include "opencensus/trace/trace_id.h"
+#include "opencensus/trace/trace_options.h"
+#include "opencensus/trace/trace_params.h"
+
+namespace opencensus {
+namespace trace {
+namespace exporter {
+namespace {
+
+TraceId MakeTraceId(uint8_t n) {
+  uint8_t buf[TraceId::kSize];
+  for (int i = 0; i < TraceId::kSize; ++i) {
+    buf[i] = n * 37 + i;
+  }
+  return TraceId(buf);
+}
+
+SpanId MakeSpanId(uint8_t n) {
+  const uint8_t buf[SpanId::kSize] = {1, 0, 0, 0, 0, 0, 0, n};
+  return SpanId(buf);
+}
+
+class TailSamplerImplTest : public ::testing::Test {
+ protected:
+  TailSamplerImplTest()
+      : sampler_([this](const std::shared_ptr<SpanImpl>& span) {
+          exported_.push_back(span);
+        }) {}
+
+  // Returns an ended span in trace 'trace', whose parent is 'parent' (an
+  // invalid SpanId for a root span).
+  static std::shared_ptr<SpanImpl> EndedSpan(
+      const TraceId& trace, uint8_t id, const SpanId& parent,
+      StatusCode code = StatusCode::OK) {
+    auto span = std::make_shared<SpanImpl>(
+        SpanContext(trace, MakeSpanId(id), TraceOptions()),
+        TraceParams{32, 32, 128, 128, ProbabilitySampler(1.0), 0, 0}, "Span",
+        parent, /*remote_parent=*/false);
+    span->SetStatus(exporter::Status(code, ""));
+    span->End();
+    return span;
+  }
+
+  static TailSamplingParams DropAllParams() {
+    TailSamplingParams params;
+    params.probability = 0.0;
+    return params;
+  }
+
+  std::vector<std::shared_ptr<SpanImpl>> exported_;
+  TailSamplerImpl sampler_;
+};
+
+TEST_F(TailSamplerImplTest, DisabledPassesSpansThrough) {
+  sampler_.AddSpan(EndedSpan(MakeTraceId(1), 2, MakeSpanId(1)));
+  EXPECT_EQ(1, exported_.size());
+  EXPECT_EQ(0, sampler_.num_buffered_spans());
+}
+
+TEST_F(TailSamplerImplTest, DropsOkTraceWhenRootEnds) {
+  sampler_.SetParams(DropAllParams());
+  const TraceId trace = MakeTraceId(1);
+  sampler_.AddSpan(EndedSpan(trace, 2, MakeSpanId(1)));
+  EXPECT_EQ(1, sampler_.num_buffered_spans());
+  sampler_.AddSpan(EndedSpan(trace, 1, SpanId()));
+  EXPECT_EQ(0, sampler_.num_buffered_spans());
+  EXPECT_TRUE(exported_.empty());
+}
+
+TEST_F(TailSamplerImplTest, KeepsWholeTraceWithError) {
+  sampler_.SetParams(DropAllParams());
+  const TraceId trace = MakeTraceId(1);
+  sampler_.AddSpan(EndedSpan(trace, 3, MakeSpanId(2)));
+  sampler_.AddSpan(EndedSpan(trace, 2, MakeSpanId(1), StatusCode::INTERNAL));
+  EXPECT_TRUE(exported_.empty());
+  sampler_.AddSpan(EndedSpan(trace, 1, SpanId()));
+  EXPECT_EQ(3, exported_.size());
+  EXPECT_EQ(0, sampler_.num_buffered_spans());
+}
+
+TEST_F(TailSamplerImplTest, KeepsSlowRoot) {
+  TailSamplingParams params = DropAllParams();
+  params.min_root_latency = absl::ZeroDuration();
+  sampler_.SetParams(params);
+  const TraceId trace = MakeTraceId(1);
+  sampler_.AddSpan(EndedSpan(trace, 2, MakeSpanId(1)));
+  sampler_.AddSpan(EndedSpan(trace, 1, SpanId()));
+  EXPECT_EQ(2, exported_.size());
+
+  params.min_root_latency = absl::Hours(1);
+  sampler_.SetParams(params);
+  sampler_.AddSpan(EndedSpan(MakeTraceId(2), 1, SpanId()));
+  EXPECT_EQ(2, exported_.size());
+}
+
+TEST_F(TailSamplerImplTest, KeepsRootWithAttribute) {
+  TailSamplingParams params = DropAllParams();
+  params.root_attributes.emplace_back(
+      "debug", exporter::AttributeValue(AttributeValueRef(true)));
+  sampler_.SetParams(params);
+
+  auto root = std::make_shared<SpanImpl>(
+      SpanContext(MakeTraceId(1), MakeSpanId(1), TraceOptions()),
+      TraceParams{32, 32, 128, 128, ProbabilitySampler(1.0), 0, 0}, "Span",
+      SpanId(), /*remote_parent=*/false);
+  root->AddAttributes({{"debug", false}});
+  root->End();
+  sampler_.AddSpan(root);
+  EXPECT_TRUE(exported_.empty());
+
+  root = std::make_shared<SpanImpl>(
+      SpanContext(MakeTraceId(2), MakeSpanId(1), TraceOptions()),
+      TraceParams{32, 32, 128, 128, ProbabilitySampler(1.0), 0, 0}, "Span",
+      SpanId(), /*remote_parent=*/false);
+  root->AddAttributes({{"debug", true}});
+  root->End();
+  sampler_.AddSpan(root);
+  EXPECT_EQ(1, exported_.size());
+}
+
+TEST_F(TailSamplerImplTest, ProbabilityOneKeepsEverything) {
+  TailSamplingParams params;
+  params.probability = 1.0;
+  sampler_.SetParams(params);
+  for (int i = 0; i < 10; ++i) {
+    sampler_.AddSpan(EndedSpan(MakeTraceId(i), 1, SpanId()));
+  }
+  EXPECT_EQ(10, exported_.size());
+}
+
+TEST_F(TailSamplerImplTest, LateSpanFollowsDecision) {
+  sampler_.SetParams(DropAllParams());
+  const TraceId kept = MakeTraceId(1);
+  const TraceId dropped = MakeTraceId(2);
+  sampler_.AddSpan(EndedSpan(kept, 1, SpanId(), StatusCode::INTERNAL));
+  sampler_.AddSpan(EndedSpan(dropped, 1, SpanId()));
+  EXPECT_EQ(1, exported_.size());
+
+  sampler_.AddSpan(EndedSpan(kept, 2, MakeSpanId(1)));
+  sampler_.AddSpan(EndedSpan(dropped, 2, MakeSpanId(1)));
+  EXPECT_EQ(2, exported_.size());
+  EXPECT_EQ(0, sampler_.num_buffered_spans());
+}
+
+TEST_F(TailSamplerImplTest, DecidesWithoutRootAfterWait) {
+  TailSamplingParams params = DropAllParams();
+  params.decision_wait = absl::Seconds(10);
+  sampler_.SetParams(params);
+  const absl::Time now = absl::Now();
+  sampler_.AddSpan(EndedSpan(MakeTraceId(1), 2, MakeSpanId(1)), now);
+  sampler_.AddSpan(
+      EndedSpan(MakeTraceId(2), 2, MakeSpanId(1), StatusCode::INTERNAL), now);
+  EXPECT_EQ(2, sampler_.num_buffered_spans());
+
+  sampler_.ExpireTraces(now + absl::Seconds(9));
+  EXPECT_EQ(2, sampler_.num_buffered_spans());
+  sampler_.ExpireTraces(now + absl::Seconds(10));
+  EXPECT_EQ(0, sampler_.num_buffered_spans());
+  ASSERT_EQ(1, exported_.size());
+  EXPECT_EQ(MakeTraceId(2), exported_[0]->context().trace_id());
+}
+
+TEST_F(TailSamplerImplTest, MemoryCapDecidesOldestTraces) {
+  TailSamplingParams params = DropAllParams();
+  params.max_buffered_spans = 32;
+  sampler_.SetParams(params);
+  for (int i = 0; i < 200; ++i) {
+    sampler_.AddSpan(
+        EndedSpan(MakeTraceId(i), 2, MakeSpanId(1), StatusCode::INTERNAL));
+    EXPECT_LE(sampler_.num_buffered_spans(), 32);
+  }
+  // Traces decided early are still kept for their errors.
+  EXPECT_EQ(200, exported_.size() + sampler_.num_buffered_spans());
+}
+
+TEST_F(TailSamplerImplTest, ClearParamsDecidesPendingTraces) {
+  sampler_.SetParams(DropAllParams());
+  sampler_.AddSpan(EndedSpan(MakeTraceId(1), 2, MakeSpanId(1)));
+  sampler_.AddSpan(
+      EndedSpan(MakeTraceId(2), 2, MakeSpanId(1), StatusCode::INTERNAL));
+  sampler_.ClearParams();
+  EXPECT_EQ(0, sampler_.num_buffered_spans());
+  EXPECT_EQ(1, exported_.size());
+
+  sampler_.AddSpan(EndedSpan(MakeTraceId(3), 2, MakeSpanId(1)));
+  EXPECT_EQ(2, exported_.size());
+}
+
+}  // namespace
+}  // namespace exporter
+}  // namespace trace
+}  // namespace opencensus
@@ -0,0 +1,31 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opencensus/trace/tail_sampling.h"
+
+#include "opencensus/trace/internal/tail_sampler_impl.h"
+
+namespace opencensus {
+namespace trace {
+
+void TailSampling::Enable(const TailSamplingParams& params) {
+  exporter::TailSamplerImpl::Get()->SetParams(params);
+}
+
+void TailSampling::Disable() {
+  exporter::TailSamplerImpl::Get()->ClearParams();
+}
+
+}  // namespace trace
+}  // namespace opencensus
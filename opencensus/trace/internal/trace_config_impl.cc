@@ -30,9 +30,13 @@ constexpr uint32_t kMaxLinks = 32;
 constexpr double kDefaultSamplingProbability = 1e-4;
 
 TraceParams MakeDefaultTraceParams() {
-  return TraceParams{kMaxAttributes, kMaxAnnotations, kMaxMessageEvents,
+  return TraceParams{kMaxAttributes,
+                     kMaxAnnotations,
+                     kMaxMessageEvents,
                      kMaxLinks,
-                     ProbabilitySampler{kDefaultSamplingProbability}};
+                     ProbabilitySampler{kDefaultSamplingProbability},
+                     /*max_sampled_spans_per_second=*/0,
+                     /*max_sampled_spans_per_second_per_name=*/0};
 }
 }  // namespace
 
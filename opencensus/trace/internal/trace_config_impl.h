@@ -16,7 +16,9 @@
 #define OPENCENSUS_TRACE_INTERNAL_TRACE_CONFIG_IMPL_H_
 
 #include <memory>
+#include <vector>
 
+#include "absl/strings/string_view.h"
 #include "opencensus/trace/internal/trace_params_impl.h"
 #include "opencensus/trace/trace_config.h"
 #include "opencensus/trace/trace_params.h"
@@ -39,6 +41,16 @@ class TraceConfigImpl {
     return current_trace_params_.Get();
   }
 
+  // Makes the sampling decision of the current TraceParams.
+  bool ShouldSample(const SpanContext* parent_context, bool has_remote_parent,
+                    const TraceId& trace_id, const SpanId& span_id,
+                    absl::string_view name,
+                    const std::vector<Span*>& parent_links) const {
+    return current_trace_params_.ShouldSample(parent_context,
+                                              has_remote_parent, trace_id,
+                                              span_id, name, parent_links);
+  }
+
  private:
   TraceConfigImpl(const TraceParams& params) : current_trace_params_(params) {}
 
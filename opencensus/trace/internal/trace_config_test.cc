@@ -26,6 +26,12 @@ namespace opencensus {
 namespace trace {
 namespace {
 
+TEST(TraceConfigTest, RateLimitsDefaultToZero) {
+  const TraceParams params{32, 32, 128, 128, ProbabilitySampler(1.0)};
+  EXPECT_EQ(0, params.max_sampled_spans_per_second);
+  EXPECT_EQ(0, params.max_sampled_spans_per_second_per_name);
+}
+
 TEST(TraceConfigTest, MultiThreaded) {
   std::atomic<bool> running(true);
 
@@ -35,8 +41,9 @@ TEST(TraceConfigTest, MultiThreaded) {
     while (running) {
       n = (n + 1) % (denom + 1);
       TraceConfig::SetCurrentTraceParams(
-          {128, 128, 64, 64,
-           ProbabilitySampler(n / static_cast<double>(denom))});
+          {128, 128, 64, 64, ProbabilitySampler(n / static_cast<double>(denom)),
+           /*max_sampled_spans_per_second=*/n % 2 == 0 ? 0.0 : 1000.0,
+           /*max_sampled_spans_per_second_per_name=*/n % 3 == 0 ? 0.0 : 100.0});
     }
   };
 
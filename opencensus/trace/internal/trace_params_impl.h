@@ -17,6 +17,9 @@
 
 #include <atomic>
 #include <cstdint>
+#include <vector>
+
+#include "absl/strings/string_view.h"
 
 #include "opencensus/trace/sampler.h"
 #include "opencensus/trace/trace_params.h"
@@ -33,7 +36,9 @@ namespace trace {
 // global lock.
 class TraceParamsImpl final {
  public:
-  explicit TraceParamsImpl(const TraceParams& p) { Set(p); }
+  explicit TraceParamsImpl(const TraceParams& p) : rate_limiter_(0, 0) {
+    Set(p);
+  }
 
   // TraceParamsImpl can be updated non-atomically: the
   // individual elements are updated separately.
@@ -44,6 +49,12 @@ class TraceParamsImpl final {
     max_links_.store(p.max_links, std::memory_order_release);
     probability_threshold_.store(p.sampler.threshold_,
                                  std::memory_order_release);
+    max_sampled_spans_per_second_.store(p.max_sampled_spans_per_second,
+                                        std::memory_order_release);
+    max_sampled_spans_per_second_per_name_.store(
+        p.max_sampled_spans_per_second_per_name, std::memory_order_release);
+    rate_limiter_.SetLimits(p.max_sampled_spans_per_second,
+                            p.max_sampled_spans_per_second_per_name);
   }
 
   TraceParams Get() const {
@@ -52,7 +63,28 @@ class TraceParamsImpl final {
                        max_message_events_.load(std::memory_order_acquire),
                        max_links_.load(std::memory_order_acquire),
                        ProbabilitySampler(probability_threshold_.load(
-                           std::memory_order_acquire))};
+                           std::memory_order_acquire)),
+                       max_sampled_spans_per_second_.load(
+                           std::memory_order_acquire),
+                       max_sampled_spans_per_second_per_name_.load(
+                           std::memory_order_acquire)};
+  }
+
+  // Makes the sampling decision of the active sampler, without constructing
+  // the whole TraceParams.
+  bool ShouldSample(const SpanContext* parent_context, bool has_remote_parent,
+                    const TraceId& trace_id, const SpanId& span_id,
+                    absl::string_view name,
+                    const std::vector<Span*>& parent_links) const {
+    if (!ProbabilitySampler(
+             probability_threshold_.load(std::memory_order_acquire))
+             .ShouldSample(parent_context, has_remote_parent, trace_id,
+                           span_id, name, parent_links)) {
+      return false;
+    }
+    return !rate_limiter_.HasLimits() ||
+           rate_limiter_.ShouldSample(parent_context, has_remote_parent,
+                                      trace_id, span_id, name, parent_links);
   }
 
  private:
@@ -61,6 +93,9 @@ class TraceParamsImpl final {
   std::atomic<uint32_t> max_message_events_;
   std::atomic<uint32_t> max_links_;
   std::atomic<uint64_t> probability_threshold_;
+  std::atomic<double> max_sampled_spans_per_second_;
+  std::atomic<double> max_sampled_spans_per_second_per_name_;
+  RateLimitingSampler rate_limiter_;
 };
 
 }  // namespace trace
@@ -27,7 +27,7 @@ namespace opencensus {
 namespace trace {
 
 WithSpan::WithSpan(const Span& span, bool cond, bool end_span)
-    : swapped_span_(span)
+    : span_(&span)
 #ifndef NDEBUG
       ,
       original_context_(Context::InternalMutableCurrent())
@@ -35,7 +35,20 @@ WithSpan::WithSpan(const Span& span, bool cond, bool end_span)
       ,
       cond_(cond),
       end_span_(end_span) {
-  ConditionalSwap();
+  Install();
+}
+
+WithSpan::WithSpan(Span&& span, bool cond, bool end_span)
+    : owned_span_(std::move(span)),
+      span_(&*owned_span_)
+#ifndef NDEBUG
+      ,
+      original_context_(Context::InternalMutableCurrent())
+#endif
+      ,
+      cond_(cond),
+      end_span_(end_span) {
+  Install();
 }
 
 WithSpan::~WithSpan() {
@@ -44,16 +57,21 @@ WithSpan::~WithSpan() {
          "WithSpan must be destructed on the same thread as it was "
          "constructed.");
 #endif
-  if (cond_ && end_span_) {
-    Context::InternalMutableCurrent()->span_.End();
+  if (cond_) {
+    Context* ctx = Context::InternalMutableCurrent();
+    assert(ctx->span_ == span_ && "WithSpan must be destructed in LIFO order.");
+    if (end_span_) {
+      span_->End();
+    }
+    ctx->span_ = prev_span_;
   }
-  ConditionalSwap();
 }
 
-void WithSpan::ConditionalSwap() {
+void WithSpan::Install() {
   if (cond_) {
-    using std::swap;
-    swap(Context::InternalMutableCurrent()->span_, swapped_span_);
+    Context* ctx = Context::InternalMutableCurrent();
+    prev_span_ = ctx->span_;
+    ctx->span_ = span_;
   }
 }
 
@@ -15,6 +15,7 @@
 #include "opencensus/trace/with_span.h"
 
 #include <cstdlib>
+#include <functional>
 
 #include "benchmark/benchmark.h"
 #include "opencensus/trace/sampler.h"
@@ -59,6 +60,36 @@ void BM_WithSpanConditionFalse(benchmark::State& state) {
 }
 BENCHMARK(BM_WithSpanConditionFalse);
 
+// Installs a chain of nested WithSpans, as a deep call stack would.
+void BM_WithSpanNested(benchmark::State& state) {
+  static ::opencensus::trace::AlwaysSampler sampler;
+  auto span = Span::StartSpan("MySpan", /*parent=*/nullptr, {&sampler});
+  const int depth = state.range(0);
+  std::function<void(int)> nest = [&](int n) {
+    if (n == 0) return;
+    WithSpan ws(span);
+    nest(n - 1);
+  };
+  for (auto _ : state) {
+    nest(depth);
+  }
+  span.End();
+}
+BENCHMARK(BM_WithSpanNested)->Arg(1)->Arg(8)->Arg(64);
+
+// For comparison with the above: the refcount traffic that copying the Span
+// into the context used to cost on every scope entry and exit.
+void BM_SpanCopy(benchmark::State& state) {
+  static ::opencensus::trace::AlwaysSampler sampler;
+  auto span = Span::StartSpan("MySpan", /*parent=*/nullptr, {&sampler});
+  for (auto _ : state) {
+    Span copy(span);
+    benchmark::DoNotOptimize(copy);
+  }
+  span.End();
+}
+BENCHMARK(BM_SpanCopy);
+
 }  // namespace
 }  // namespace trace
 }  // namespace opencensus
@@ -27,7 +27,7 @@ namespace context {
 class ContextTestPeer {
  public:
   static const opencensus::trace::SpanContext& CurrentCtx() {
-    return Context::InternalMutableCurrent()->span_.context();
+    return Context::InternalMutableCurrent()->span_->context();
   }
 };
 }  // namespace context
@@ -118,6 +118,18 @@ TEST(WithSpanTest, EndSpan) {
   // TODO: Check End() was called.
 }
 
+TEST(WithSpanTest, RvalueConstructor) {
+  auto span = opencensus::trace::Span::StartSpan("MySpan");
+  const opencensus::trace::SpanContext ctx = span.context();
+  ExpectNoSpan();
+  {
+    opencensus::trace::WithSpan ws(std::move(span), /*cond=*/true,
+                                   /*end_span=*/true);
+    EXPECT_EQ(ctx, ContextTestPeer::CurrentCtx()) << "Span was installed.";
+  }
+  ExpectNoSpan();
+}
+
 #ifndef NDEBUG
 TEST(WithSpanDeathTest, DestructorOnWrongThread) {
   auto span = opencensus::trace::Span::StartSpan("MySpan");
@@ -15,6 +15,7 @@
 #ifndef OPENCENSUS_TRACE_SAMPLER_H_
 #define OPENCENSUS_TRACE_SAMPLER_H_
 
+#include <atomic>
 #include <cstdint>
 #include <vector>
 
@@ -28,6 +29,7 @@ namespace opencensus {
 namespace trace {
 
 class Span;
+class RateLimitingSamplerTestPeer;
 
 // Samplers decide whether or not a given Span will be sampled.
 // All implementations of Sampler must be thread-safe!
@@ -65,6 +67,58 @@ class ProbabilitySampler final : public Sampler {
   const uint64_t threshold_;
 };
 
+// Samples at most a fixed number of spans per second, both in total and for
+// each span name, so that traffic spikes can't swamp the collector while
+// low-traffic span names still get sampled.  Each limit allows bursts of up to
+// one second's worth of spans.
+//
+// Only root spans and spans with a remote parent are sampled; local children
+// of an unsampled span are not, so that sampled traces are whole.  Span names
+// are hashed into a fixed number of per-name limits, so names that collide
+// share a limit.
+//
+// ShouldSample() is lock-free and doesn't allocate.  Each limit is a single
+// atomic (a token bucket kept as the time its next token is due), which is
+// written only when a span is sampled.  Above the limit, ShouldSample() only
+// reads, so threads don't contend for a cache line on the rejected path.
+class RateLimitingSampler final : public Sampler {
+ public:
+  // A limit that isn't positive means no limit.
+  RateLimitingSampler(double max_spans_per_second,
+                      double max_spans_per_second_per_name);
+
+  bool ShouldSample(const SpanContext* parent_context, bool has_remote_parent,
+                    const TraceId& trace_id, const SpanId& span_id,
+                    absl::string_view name,
+                    const std::vector<Span*>& parent_links) const override;
+
+ private:
+  friend class TraceParamsImpl;  // For the global RateLimitingSampler.
+  friend class RateLimitingSamplerTestPeer;
+
+  static constexpr int kNumNameLimits = 256;
+
+  // ShouldSample() for a root span named 'name' at 'now' (in nanoseconds since
+  // the Unix epoch).
+  bool ShouldSampleAt(absl::string_view name, int64_t now) const;
+
+  // Limits can be changed while ShouldSample() runs concurrently.
+  void SetLimits(double max_spans_per_second,
+                 double max_spans_per_second_per_name);
+
+  // Whether any limit is set.
+  bool HasLimits() const;
+
+  // Nanoseconds between tokens for the total and per-name limits, or 0 if
+  // unlimited.
+  std::atomic<int64_t> interval_;
+  std::atomic<int64_t> name_interval_;
+  // Times (in nanoseconds since the Unix epoch) at which the next span of the
+  // total and per-name limits is due.
+  mutable std::atomic<int64_t> next_;
+  mutable std::atomic<int64_t> name_next_[kNumNameLimits];
+};
+
 // Always samples.
 class AlwaysSampler final : public Sampler {
  public:
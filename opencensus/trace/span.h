@@ -15,6 +15,7 @@
 #ifndef OPENCENSUS_TRACE_SPAN_H_
 #define OPENCENSUS_TRACE_SPAN_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -40,6 +41,7 @@ class LocalSpanStoreImpl;
 class RunningSpanStoreImpl;
 }  // namespace exporter
 
+class RecordOnlySpan;
 class Span;
 class SpanGenerator;
 class SpanImpl;
@@ -54,8 +56,11 @@ using AttributesRef =
 // Options for Starting a Span.
 struct StartSpanOptions {
   StartSpanOptions(Sampler* sampler = nullptr,  // Default Sampler.
-                   const std::vector<Span*>& parent_links = {})
-      : sampler(sampler), parent_links(parent_links) {}
+                   const std::vector<Span*>& parent_links = {},
+                   bool record_events = false)
+      : sampler(sampler),
+        parent_links(parent_links),
+        record_events(record_events) {}
 
   // The Sampler to use. It must remain valid for the duration of the
   // StartSpan() call. If nullptr, use the default Sampler from TraceConfig.
@@ -67,6 +72,12 @@ struct StartSpanOptions {
   // Pointers to Spans in *other Traces* that are parents of this Span. They
   // must remain valid for the duration of the StartSpan() call.
   const std::vector<Span*> parent_links;
+
+  // If true, a Span that isn't sampled still records its name, latency and
+  // status, and appears in the LocalSpanStore once it ends. Other events are
+  // discarded. This is much cheaper than sampling, so it can be enabled for
+  // every request.
+  const bool record_events;
 };
 
 // Span represents an operation. A Trace consists of one or more Spans.
@@ -176,6 +187,8 @@ class Span final {
  private:
   Span() = delete;
   Span(const SpanContext& context, SpanImpl* impl);
+  Span(const SpanContext& context, RecordOnlySpan* record_only,
+       uint32_t record_only_generation);
 
   // Returns span_impl_, only used for testing.
   std::shared_ptr<SpanImpl> span_impl_for_test() { return span_impl_; }
@@ -189,10 +202,16 @@ class Span final {
   SpanContext context_;
 
   // Shared pointer to the underlying Span representation. This is nullptr for
-  // Spans which are not recording events. This is an implementation detail, not
+  // Spans which are not sampled. This is an implementation detail, not
   // part of the public API. We don't mark it const so that we can swap() Spans.
   std::shared_ptr<SpanImpl> span_impl_;
 
+  // The representation of Spans which are recording events but not sampled,
+  // or nullptr. Only valid for record_only_generation_; see
+  // internal/record_only_span.h.
+  RecordOnlySpan* record_only_ = nullptr;
+  uint32_t record_only_generation_ = 0;
+
   friend class ::opencensus::context::Context;
   friend class ::opencensus::trace::exporter::RunningSpanStoreImpl;
   friend class ::opencensus::trace::exporter::LocalSpanStoreImpl;
@@ -0,0 +1,61 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPENCENSUS_TRACE_SPAN_STATS_H_
+#define OPENCENSUS_TRACE_SPAN_STATS_H_
+
+#include "opencensus/stats/stats.h"
+#include "opencensus/tags/tag_key.h"
+
+namespace opencensus {
+namespace trace {
+
+// SpanStats records the latency of every Span that ends, tagged with the span
+// name and status, so that code which already traces an operation needn't
+// also record its latency with stats::Record(). Only Spans which are recording
+// events have a start time: sampled Spans, and unsampled Spans started with
+// StartSpanOptions::record_events.
+//
+// Example:
+//   opencensus::trace::SpanStats::Enable();
+//   opencensus::trace::SpanStats::LatencyView().RegisterForExport();
+//
+// SpanStats is thread-safe.
+class SpanStats final {
+ public:
+  // Starts recording the latency of ended Spans to LatencyMeasure().
+  static void Enable();
+
+  // Stops recording.
+  static void Disable();
+
+  // The measure that span latencies are recorded to, in milliseconds.
+  static stats::MeasureDouble LatencyMeasure();
+
+  // The tag keys that latencies are recorded under: the span name, and the
+  // name of the span's status code (e.g. "OK" or "DEADLINE_EXCEEDED").
+  static tags::TagKey SpanNameKey();
+  static tags::TagKey SpanStatusKey();
+
+  // A cumulative distribution of LatencyMeasure() by span name and status.
+  static const stats::ViewDescriptor& LatencyView();
+
+ private:
+  SpanStats() = delete;
+};
+
+}  // namespace trace
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_TRACE_SPAN_STATS_H_
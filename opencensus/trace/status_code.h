@@ -17,6 +17,8 @@
 
 #include <cstdint>
 
+#include "absl/strings/string_view.h"
+
 namespace opencensus {
 namespace trace {
 
@@ -177,6 +179,9 @@ enum StatusCode : uint8_t {
   DATA_LOSS = 15,
 };
 
+// Returns the name of 'code', e.g. "DEADLINE_EXCEEDED".
+absl::string_view StatusCodeToString(StatusCode code);
+
 }  // namespace trace
 }  // namespace opencensus
 
@@ -0,0 +1,83 @@
+// Copyright 2019, OpenCensus Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPENCENSUS_TRACE_TAIL_SAMPLING_H_
+#define OPENCENSUS_TRACE_TAIL_SAMPLING_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "opencensus/trace/exporter/attribute_value.h"
+
+namespace opencensus {
+namespace trace {
+
+// TailSamplingParams configure tail-based sampling: sampled spans are held
+// back from the exporters when they end, and once the local root span of their
+// trace ends the whole local trace is either exported or dropped based on the
+// root's latency and attributes and the status of every span.
+//
+// Tail sampling only chooses among spans that were sampled when they started,
+// so it is typically combined with a high sampling probability in
+// TraceParams.
+struct TailSamplingParams {
+  // How long to wait for the local root span after the first span of a trace
+  // ended. If the root has not ended by then, the trace is decided on the
+  // spans seen so far. Expired traces are checked at least once per
+  // SpanExporter interval, so decisions may come up to that much later.
+  absl::Duration decision_wait = absl::Seconds(30);
+
+  // The maximum number of spans held back across all traces. When it is
+  // reached, the oldest undecided traces are decided early to make room.
+  uint32_t max_buffered_spans = 10000;
+
+  // Keep traces with a span whose status is not OK.
+  bool keep_errors = true;
+
+  // Keep traces whose local root span took at least this long.
+  absl::Duration min_root_latency = absl::InfiniteDuration();
+
+  // Keep traces whose local root span has any of these attributes, with an
+  // equal value.
+  std::vector<std::pair<std::string, exporter::AttributeValue>>
+      root_attributes;
+
+  // The fraction of the remaining traces to keep, chosen by TraceId in the
+  // same way as ProbabilitySampler.
+  double probability = 0.0;
+};
+
+// TailSampling turns tail-based sampling on and off. It is off by default.
+// TailSampling is thread-safe.
+class TailSampling final {
+ public:
+  // Enables tail sampling with 'params', replacing any previous params.
+  // Traces held back under the previous params are decided immediately.
+  static void Enable(const TailSamplingParams& params);
+
+  // Disables tail sampling. Traces held back are decided immediately, and
+  // subsequent spans go straight to the exporters.
+  static void Disable();
+
+ private:
+  TailSampling() = delete;
+};
+
+}  // namespace trace
+}  // namespace opencensus
+
+#endif  // OPENCENSUS_TRACE_TAIL_SAMPLING_H_
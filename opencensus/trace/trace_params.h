@@ -24,15 +24,37 @@ namespace trace {
 
 // TraceParams holds the limits for attributes, annotations, message_events,
 // links, and a ProbabilitySampler. For performance, only ProbabilitySampler is
-// supported as the globally active sampler.
+// supported as the globally active sampler, optionally capped by the limits of
+// a RateLimitingSampler.
 //
 // The currently active TraceParams is set in TraceConfig.
 struct TraceParams final {
+  // Not an aggregate, since C++11 aggregates can't have default member
+  // initializers, but brace-initializable the same way: the rate limits may be
+  // left out.
+  TraceParams(uint32_t max_attributes, uint32_t max_annotations,
+              uint32_t max_message_events, uint32_t max_links,
+              ProbabilitySampler sampler,
+              double max_sampled_spans_per_second = 0,
+              double max_sampled_spans_per_second_per_name = 0)
+      : max_attributes(max_attributes),
+        max_annotations(max_annotations),
+        max_message_events(max_message_events),
+        max_links(max_links),
+        sampler(sampler),
+        max_sampled_spans_per_second(max_sampled_spans_per_second),
+        max_sampled_spans_per_second_per_name(
+            max_sampled_spans_per_second_per_name) {}
+
   uint32_t max_attributes;
   uint32_t max_annotations;
   uint32_t max_message_events;
   uint32_t max_links;
   ProbabilitySampler sampler;
+  // Caps the spans sampled by 'sampler', in total and per span name, as a
+  // RateLimitingSampler does.  Zero (the default) means no limit.
+  double max_sampled_spans_per_second = 0;
+  double max_sampled_spans_per_second_per_name = 0;
 };
 
 }  // namespace trace
@@ -15,6 +15,7 @@
 #ifndef OPENCENSUS_TRACE_WITH_SPAN_H_
 #define OPENCENSUS_TRACE_WITH_SPAN_H_
 
+#include "absl/types/optional.h"
 #include "opencensus/context/context.h"
 #include "opencensus/trace/span.h"
 
@@ -30,6 +31,10 @@ namespace trace {
 // WithSpan in one thread and deallocate in another. A simple way to ensure this
 // is to only ever stack-allocate it.
 //
+// WithSpan does not copy the Span: the current context refers to the given Span
+// until the WithSpan is destroyed, so it must outlive the WithSpan and must not
+// be assigned to in the meantime. A temporary Span is moved into the WithSpan.
+//
 // Example usage:
 // {
 //   WithSpan ws(span);
@@ -40,9 +45,10 @@ class WithSpan {
   explicit WithSpan(const Span& span, bool cond = true, bool end_span = false);
   ~WithSpan();
 
-  // No Span&& constructor because it encourages "consuming" the Span with a
-  // std::move(). It's better to hold on to the Span object because we have to
-  // call End() on it when the operation is finished.
+  // Takes ownership of a temporary Span, e.g. one returned by StartSpan() for
+  // use with end_span. Prefer holding on to the Span object where possible
+  // because we have to call End() on it when the operation is finished.
+  explicit WithSpan(Span&& span, bool cond = true, bool end_span = false);
 
  private:
   WithSpan() = delete;
@@ -51,9 +57,14 @@ class WithSpan {
   WithSpan& operator=(const WithSpan&) = delete;
   WithSpan& operator=(WithSpan&&) = delete;
 
-  void ConditionalSwap();
+  void Install();
 
-  Span swapped_span_;
+  // Only engaged when constructed from a temporary Span.
+  absl::optional<Span> owned_span_;
+  // The Span installed in the current context.
+  const Span* const span_;
+  // The previously installed Span, restored on destruction.
+  const Span* prev_span_;
 #ifndef NDEBUG
   const ::opencensus::context::Context* original_context_;
 #endif